@@ -49,6 +49,7 @@
 #include "pathmatcher/MultiMatcher.h"
 #include "pathmatcher/SimplePrefixMatcher.h"
 #include "tasks/Task.h"
+#include "tasks/WorkerPool.h"
 #include "tools/GenericProfiler.h"
 #include "ui/InstanceWindow.h"
 #include "ui/MainWindow.h"
@@ -109,6 +110,9 @@
 #include <minecraft/auth/AccountList.h>
 #include "icons/IconList.h"
 #include "net/HttpMetaCache.h"
+#include "net/Scheduler.h"
+
+#include "modplatform/helpers/HashCache.h"
 
 #include "ui/GuiUtil.h"
 
@@ -233,6 +237,10 @@ Application::Application(int& argc, char** argv) : QApplication(argc, argv)
     setDesktopFileName(BuildConfig.LAUNCHER_DESKTOPFILENAME);
     startTime = QDateTime::currentDateTime();
 
+    m_workerPool = std::make_unique<WorkerPool>(WorkerPool::defaultThreads());
+    m_ioPool = std::make_unique<WorkerPool>(WorkerPool::s_ioThreads);
+    WorkerPool::setShared(m_workerPool.get(), m_ioPool.get());
+
     // Don't quit on hiding the last window
     this->setQuitOnLastWindowClosed(false);
     this->setQuitLockEnabled(false);
@@ -838,6 +846,7 @@ Application::Application(int& argc, char** argv) : QApplication(argc, argv)
         QString user = settings()->get("ProxyUser").toString();
         QString pass = settings()->get("ProxyPass").toString();
         updateProxySettings(proxyTypeStr, addr, port, user, pass);
+        updateDownloadLimits();
         qDebug() << "<> Network done.";
     }
 
@@ -878,7 +887,7 @@ Application::Application(int& argc, char** argv) : QApplication(argc, argv)
         connect(InstDirSetting.get(), &Setting::SettingChanged, m_instances.get(), &InstanceList::on_InstFolderChanged);
         qDebug() << "Loading Instances...";
         m_instances->loadList();
-        qDebug() << "<> Instances loaded.";
+        qDebug() << "<> Instances are being discovered.";
     }
 
     // and accounts
@@ -912,6 +921,20 @@ Application::Application(int& argc, char** argv) : QApplication(argc, argv)
         qDebug() << "<> Cache initialized.";
     }
 
+    // and the file hash cache
+    {
+        m_hashCache.reset(new Hashing::HashCache("hashcache"));
+        m_hashCache->Load();
+        qDebug() << "<> Hash cache initialized.";
+    }
+
+    // and the record of which asset objects were verified
+    {
+        m_assetJournal.reset(new Hashing::HashCache("assets/objects/journal"));
+        m_assetJournal->Load();
+        qDebug() << "<> Asset journal initialized.";
+    }
+
     // now we have network, download translation updates
     m_translations->downloadIndex();
 
@@ -1207,6 +1230,15 @@ void Application::setupWizardFinished(int status)
 void Application::performMainStartupAction()
 {
     m_status = Application::Initialized;
+    if ((!m_instanceIdToLaunch.isEmpty() || !m_instanceIdToShowWindowOf.isEmpty()) && !m_instances->isListLoaded()) {
+        // the instances are still being looked for
+        std::shared_ptr<QMetaObject::Connection> connection{ new QMetaObject::Connection };
+        *connection = connect(m_instances.get(), &InstanceList::listLoaded, this, [this, connection] {
+            disconnect(*connection);
+            performMainStartupAction();
+        });
+        return;
+    }
     if (!m_instanceIdToLaunch.isEmpty()) {
         auto inst = instances()->getInstanceById(m_instanceIdToLaunch);
         if (inst) {
@@ -1308,6 +1340,10 @@ void Application::showFatalErrorMessage(const QString& title, const QString& con
 
 Application::~Application()
 {
+    // the jobs still running finish before anything they use (the asset journal, say) goes away
+    m_ioPool->shutdown();
+    m_workerPool->shutdown();
+
     // Shut down logger by setting the logger function to nothing
     qInstallMessageHandler(nullptr);
 
@@ -1351,6 +1387,15 @@ void Application::messageReceived(const QByteArray& message)
         }
         m_mainWindow->processURLs({ normalizeImportUrl(url) });
     } else if (command == "launch") {
+        if (!m_instances->isListLoaded()) {
+            // the instances are still being looked for
+            std::shared_ptr<QMetaObject::Connection> connection{ new QMetaObject::Connection };
+            *connection = connect(m_instances.get(), &InstanceList::listLoaded, this, [this, connection, message] {
+                disconnect(*connection);
+                messageReceived(message);
+            });
+            return;
+        }
         QString id = received.args["id"];
         QString server = received.args["server"];
         QString world = received.args["world"];
@@ -1668,6 +1713,13 @@ void Application::on_windowClose()
     }
 }
 
+void Application::updateDownloadLimits()
+{
+    // a single job gets as much as before, but all of them together only get one job's worth from a single host
+    auto downloads = settings()->get("NumberOfConcurrentDownloads").toInt();
+    Net::Scheduler::instance().setLimits(downloads * 2, downloads);
+}
+
 void Application::updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password)
 {
     // Set the application proxy settings.
@@ -1721,6 +1773,16 @@ shared_qobject_ptr<HttpMetaCache> Application::metacache()
     return m_metacache;
 }
 
+shared_qobject_ptr<Hashing::HashCache> Application::hashCache()
+{
+    return m_hashCache;
+}
+
+shared_qobject_ptr<Hashing::HashCache> Application::assetJournal()
+{
+    return m_assetJournal;
+}
+
 shared_qobject_ptr<QNetworkAccessManager> Application::network()
 {
     return m_network;
@@ -72,11 +72,16 @@ class ITheme;
 class MCEditTool;
 class ThemeManager;
 class IconTheme;
+class WorkerPool;
 
 namespace Meta {
 class Index;
 }
 
+namespace Hashing {
+class HashCache;
+}
+
 #if defined(APPLICATION)
 #undef APPLICATION
 #endif
@@ -139,11 +144,17 @@ class Application : public QApplication {
     const QMap<QString, std::shared_ptr<BaseProfilerFactory>>& profilers() const { return m_profilers; }
 
     void updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password);
+    // hands the download settings to the Net::Scheduler
+    void updateDownloadLimits();
 
     shared_qobject_ptr<QNetworkAccessManager> network();
 
     shared_qobject_ptr<HttpMetaCache> metacache();
 
+    shared_qobject_ptr<Hashing::HashCache> hashCache();
+
+    shared_qobject_ptr<Hashing::HashCache> assetJournal();
+
     shared_qobject_ptr<Meta::Index> metadataIndex();
 
     void updateCapabilities();
@@ -236,6 +247,11 @@ class Application : public QApplication {
     bool shouldExitNow() const;
 
    private:
+    // the shared WorkerPools. the destructor shuts them down first thing, they're declared first so they go last, as
+    // whatever gets torn down can still start (and drop) jobs on them
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::unique_ptr<WorkerPool> m_ioPool;
+
     QDateTime startTime;
 
     shared_qobject_ptr<QNetworkAccessManager> m_network;
@@ -244,6 +260,8 @@ class Application : public QApplication {
     shared_qobject_ptr<AccountList> m_accounts;
 
     shared_qobject_ptr<HttpMetaCache> m_metacache;
+    shared_qobject_ptr<Hashing::HashCache> m_hashCache;
+    shared_qobject_ptr<Hashing::HashCache> m_assetJournal;
     shared_qobject_ptr<Meta::Index> m_metadataIndex;
 
     std::shared_ptr<SettingsObject> m_settings;
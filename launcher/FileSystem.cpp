@@ -1643,6 +1643,12 @@ bool canLink(const QString& src, const QString& dst)
     return canLinkOnFS(src) && canLinkOnFS(dst);
 }
 
+bool hard_link_file(const QString& src, const QString& dst, std::error_code& ec)
+{
+    fs::create_hard_link(StringUtils::toStdString(src), StringUtils::toStdString(dst), ec);
+    return !ec;
+}
+
 uintmax_t hardLinkCount(const QString& path)
 {
     std::error_code err;
@@ -1654,6 +1660,34 @@ uintmax_t hardLinkCount(const QString& path)
     return count;
 }
 
+PlaceMethod placeMethod(const QString& src, const QString& dst, bool allowHardLink)
+{
+    if (canClone(src, dst))
+        return PlaceMethod::Clone;
+    if (allowHardLink && statFS(src).rootPath == statFS(dst).rootPath && canLink(src, dst))
+        return PlaceMethod::HardLink;
+    return PlaceMethod::Copy;
+}
+
+bool placeFile(const QString& src, const QString& dst, PlaceMethod method, bool allowHardLink)
+{
+    std::error_code ec;
+    if (method == PlaceMethod::Clone) {
+        if (clone_file(src, dst, ec))
+            return true;
+        // a failed clone can leave an empty file behind
+        QFile::remove(dst);
+        method = allowHardLink ? PlaceMethod::HardLink : PlaceMethod::Copy;
+    }
+    if (method == PlaceMethod::HardLink) {
+        ec.clear();
+        if (hard_link_file(src, dst, ec))
+            return true;
+        QFile::remove(dst);
+    }
+    return QFile::copy(src, dst);
+}
+
 #ifdef Q_OS_WIN
 // returns 8.3 file format from long path
 QString shortPathName(const QString& file)
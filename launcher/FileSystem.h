@@ -554,8 +554,30 @@ bool canLinkOnFS(FilesystemType type);
  */
 bool canLink(const QString& src, const QString& dst);
 
+/**
+ * @brief hard link file from src to dst, both have to be on the same device
+ *
+ */
+bool hard_link_file(const QString& src, const QString& dst, std::error_code& ec);
+
 uintmax_t hardLinkCount(const QString& path);
 
+enum class PlaceMethod { Clone, HardLink, Copy };
+
+/**
+ * @brief the cheapest way to put copies of files from the src folder into the dst folder, both have to exist.
+ * hard links share their data with the source, so neither side may be written to in place. leave them out with
+ * allowHardLink if the copies are meant to be edited
+ *
+ */
+PlaceMethod placeMethod(const QString& src, const QString& dst, bool allowHardLink = true);
+
+/**
+ * @brief puts a copy of the src file at dst with method, falling back towards a plain copy
+ *
+ */
+bool placeFile(const QString& src, const QString& dst, PlaceMethod method, bool allowHardLink = true);
+
 #ifdef Q_OS_WIN
 QString getPathNameInLocal8bit(const QString& file);
 #endif
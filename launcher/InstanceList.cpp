@@ -34,6 +34,8 @@
  *      limitations under the License.
  */
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
@@ -44,6 +46,7 @@
 #include <QJsonDocument>
 #include <QMimeData>
 #include <QPair>
+#include <QSaveFile>
 #include <QSet>
 #include <QStack>
 #include <QTextStream>
@@ -52,6 +55,8 @@
 #include <QUuid>
 #include <QXmlStreamReader>
 
+#include <vector>
+
 #include "BaseInstance.h"
 #include "ExponentialSeries.h"
 #include "FileSystem.h"
@@ -60,7 +65,10 @@
 #include "NullInstance.h"
 #include "WatchLock.h"
 #include "minecraft/MinecraftInstance.h"
+#include "minecraft/mod/ResourceParseCache.h"
+#include "modplatform/helpers/HashCache.h"
 #include "settings/INISettingsObject.h"
+#include "tasks/WorkerPool.h"
 
 #ifdef Q_OS_WIN32
 #include <Windows.h>
@@ -68,6 +76,28 @@
 
 const static int GROUP_FILE_FORMAT_VERSION = 1;
 
+// the settings of an instance that get read without opening it: the instance view (and sorting it), the links between
+// instances, and what BaseInstance looks at on its own. those are kept in the summary cache, the rest of instance.cfg is
+// only read once something else is needed, like when the instance gets edited or launched
+static const QStringList s_summaryKeys = {
+    "InstanceType", "name", "iconKey", "notes", "lastLaunchTime", "totalTimePlayed", "lastTimePlayed", "linkedInstances",
+    "OverrideGameTime", "ShowGameTime", "RecordGameTime", "OverrideConsole", "ConsoleMaxLines", "ConsoleOverflowStop",
+    "ManagedPack", "ManagedPackType", "ManagedPackID", "ManagedPackName", "ManagedPackVersionID", "ManagedPackVersionName"
+};
+static const QString s_summaryCachePath = "cache/instances.dat";
+static const quint32 s_summaryCacheMagic = 0x494e5354;  // "INST"
+static const quint32 s_summaryCacheVersion = 2;
+
+static INIFile summaryOf(const INIFile& values)
+{
+    INIFile summary;
+    for (auto const& key : s_summaryKeys) {
+        if (values.contains(key))
+            summary.insert(key, values.value(key));
+    }
+    return summary;
+}
+
 InstanceList::InstanceList(SettingsObjectPtr settings, const QString& instDir, QObject* parent)
     : QAbstractListModel(parent), m_globalSettings(settings)
 {
@@ -86,7 +116,11 @@ InstanceList::InstanceList(SettingsObjectPtr settings, const QString& instDir, Q
     m_watcher->addPath(m_instDir);
 }
 
-InstanceList::~InstanceList() {}
+InstanceList::~InstanceList()
+{
+    // the discovery jobs hand what they found back to this
+    m_discoveryPool.shutdown();
+}
 
 Qt::DropActions InstanceList::supportedDragActions() const
 {
@@ -352,6 +386,8 @@ bool InstanceList::trashInstance(const InstanceId& id)
         return false;
     }
 
+    // an undo can bring it back under another id, so there's no point in keeping what was parsed in it
+    FS::deletePath(ResourceParseCache::instanceCacheDir(id));
     qDebug() << "Instance" << id << "has been trashed by the launcher.";
     m_trashHistory.push({ id, inst->instanceRoot(), trashedLoc, cachedGroupId });
 
@@ -408,6 +444,7 @@ void InstanceList::deleteInstance(const InstanceId& id)
         return;
     }
 
+    FS::deletePath(ResourceParseCache::instanceCacheDir(id));
     qDebug() << "Instance" << id << "has been deleted by the launcher.";
 }
 
@@ -426,45 +463,135 @@ static QMap<InstanceId, InstanceLocator> getIdMapping(const QList<InstancePtr>&
     return out;
 }
 
-QList<InstanceId> InstanceList::discoverInstances()
+std::optional<InstanceList::InstanceSummary> InstanceList::probeInstance(const QString& dir,
+                                                                        const QString& instDirPath,
+                                                                        const InstanceSummary& cached)
+{
+    QFileInfo dirInfo(dir);
+    QFileInfo configInfo(FS::PathCombine(dir, "instance.cfg"));
+    if (!configInfo.exists())
+        return {};
+    // if it is a symlink, ignore it if it goes to the instance folder
+    if (dirInfo.isSymLink()) {
+        QFileInfo targetInfo(dirInfo.symLinkTarget());
+        if (targetInfo.canonicalPath() == instDirPath) {
+            qDebug() << "Ignoring symlink" << dir << "that leads into the instances folder";
+            return {};
+        }
+    }
+
+    auto identity = Hashing::FileIdentity::of(configInfo.filePath());
+    InstanceSummary summary;
+    summary.size = identity.size;
+    summary.modified = identity.mtime;
+    summary.inode = identity.inode;
+    summary.checked = identity.taken;
+    // a file changed in the same tick of the clock as it was looked at keeps its time, so only trust the ones that were
+    // already older than that. a file saved by replacing it gets a new inode, whatever its time
+    bool settled = cached.modified < cached.checked - Hashing::FileIdentity::s_mtimeGranularity;
+    if (settled && summary.size == cached.size && summary.modified == cached.modified && summary.inode == cached.inode) {
+        summary.values = cached.values;
+        return summary;
+    }
+
+    summary.values.loadFile(configInfo.filePath());
+    summary.complete = true;
+    return summary;
+}
+
+void InstanceList::discoverInstances()
 {
     qDebug() << "Discovering instances in" << m_instDir;
-    QList<InstanceId> out;
-    QDirIterator iter(m_instDir, QDir::Dirs | QDir::NoDot | QDir::NoDotDot | QDir::Readable | QDir::Hidden, QDirIterator::FollowSymlinks);
-    while (iter.hasNext()) {
-        QString subDir = iter.next();
-        QFileInfo dirInfo(subDir);
-        if (!QFileInfo(FS::PathCombine(subDir, "instance.cfg")).exists())
-            continue;
-        // if it is a symlink, ignore it if it goes to the instance folder
-        if (dirInfo.isSymLink()) {
-            QFileInfo targetInfo(dirInfo.symLinkTarget());
-            QFileInfo instDirInfo(m_instDir);
-            if (targetInfo.canonicalPath() == instDirInfo.canonicalFilePath()) {
-                qDebug() << "Ignoring symlink" << subDir << "that leads into the instances folder";
-                continue;
-            }
+    auto discovery = std::make_shared<Discovery>();
+    discovery->instDir = m_instDir;
+    discovery->cacheLoaded = m_summaryCacheLoaded;
+    discovery->cached = m_summaries;
+
+    // listing the folder and the few trips to the disk every instance takes add up on network drives, so none of it
+    // happens here. the instances are all looked at at once, and whichever is done last hands them back
+    auto handBack = [this, discovery] {
+        QMetaObject::invokeMethod(this, [this, discovery] { instancesDiscovered(*discovery); }, Qt::QueuedConnection);
+    };
+    m_discoveryPool.start([this, discovery, handBack] {
+        if (!discovery->cacheLoaded)
+            discovery->cached = loadSummaryCache(discovery->instDir);
+
+        QDirIterator iter(discovery->instDir, QDir::Dirs | QDir::NoDot | QDir::NoDotDot | QDir::Readable | QDir::Hidden,
+                          QDirIterator::FollowSymlinks);
+        while (iter.hasNext())
+            discovery->dirs.append(iter.next());
+        if (discovery->dirs.isEmpty()) {
+            handBack();
+            return;
+        }
+
+        discovery->probed.resize(discovery->dirs.size());
+        discovery->remaining = discovery->dirs.size();
+        auto instDirPath = QFileInfo(discovery->instDir).canonicalFilePath();
+        for (int i = 0; i < discovery->dirs.size(); i++) {
+            m_discoveryPool.start([discovery, handBack, i, instDirPath] {
+                const auto& dir = discovery->dirs.at(i);
+                discovery->probed[i] = probeInstance(dir, instDirPath, discovery->cached.value(QFileInfo(dir).fileName()));
+                if (--discovery->remaining == 0)
+                    handBack();
+            });
         }
-        auto id = dirInfo.fileName();
-        out.append(id);
+    });
+}
+
+InstanceList::InstListError InstanceList::loadList()
+{
+    // one at a time. whatever changes meanwhile is picked up by another one right after
+    if (m_discovering) {
+        m_rediscover = true;
+        return NoError;
+    }
+    m_discovering = true;
+    discoverInstances();
+    return NoError;
+}
+
+void InstanceList::instancesDiscovered(Discovery& discovery)
+{
+    m_discovering = false;
+    // the instance folder changed while the old one was looked at
+    if (discovery.instDir != m_instDir) {
+        m_rediscover = false;
+        loadList();
+        return;
+    }
+    m_summaryCacheLoaded = true;
+
+    QList<InstanceId> ids;
+    QHash<InstanceId, InstanceSummary> summaries;
+    // anything read again, or gone
+    bool changed = false;
+    for (int i = 0; i < discovery.dirs.size(); i++) {
+        if (!discovery.probed[i])
+            continue;
+        auto id = QFileInfo(discovery.dirs.at(i)).fileName();
+        ids.append(id);
         qDebug() << "Found instance ID" << id;
+        changed |= discovery.probed[i]->complete;
+        summaries.insert(id, std::move(*discovery.probed[i]));
     }
+    changed |= summaries.size() != discovery.cached.size();
+    m_summaries = std::move(summaries);
+    if (changed)
+        saveSummaryCache();
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    instanceSet = QSet<QString>(out.begin(), out.end());
+    instanceSet = QSet<QString>(ids.begin(), ids.end());
 #else
-    instanceSet = out.toSet();
+    instanceSet = ids.toSet();
 #endif
     m_instancesProbed = true;
-    return out;
-}
 
-InstanceList::InstListError InstanceList::loadList()
-{
     auto existingIds = getIdMapping(m_instances);
 
     QList<InstancePtr> newList;
 
-    for (auto& id : discoverInstances()) {
+    for (auto& id : ids) {
         if (existingIds.contains(id)) {
             auto instPair = existingIds[id];
             existingIds.remove(id);
@@ -518,7 +645,16 @@ InstanceList::InstListError InstanceList::loadList()
     }
     m_dirty = false;
     updateTotalPlayTime();
-    return NoError;
+    emit listLoaded();
+
+    if (!m_pendingSelection.isEmpty() && instanceSet.contains(m_pendingSelection)) {
+        emit instanceSelectRequest(m_pendingSelection);
+        m_pendingSelection.clear();
+    }
+    if (m_rediscover) {
+        m_rediscover = false;
+        loadList();
+    }
 }
 
 void InstanceList::updateTotalPlayTime()
@@ -628,7 +764,25 @@ InstancePtr InstanceList::loadInstance(const InstanceId& id)
     }
 
     auto instanceRoot = FS::PathCombine(m_instDir, id);
-    auto instanceSettings = std::make_shared<INISettingsObject>(FS::PathCombine(instanceRoot, "instance.cfg"));
+    auto configPath = FS::PathCombine(instanceRoot, "instance.cfg");
+    std::shared_ptr<INISettingsObject> instanceSettings;
+    auto summary = m_summaries.find(id);
+    if (summary == m_summaries.end()) {
+        instanceSettings = std::make_shared<INISettingsObject>(configPath);
+    } else if (summary->complete) {
+        // it was just read while discovering the instance
+        instanceSettings = std::make_shared<INISettingsObject>(configPath, summary->values);
+        summary->values = summaryOf(summary->values);
+        summary->complete = false;
+    } else {
+        instanceSettings = std::make_shared<INISettingsObject>(configPath, summary->values,
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+                                                               QSet<QString>(s_summaryKeys.begin(), s_summaryKeys.end())
+#else
+                                                               s_summaryKeys.toSet()
+#endif
+        );
+    }
     InstancePtr inst;
 
     instanceSettings->registerSetting("InstanceType", "");
@@ -646,6 +800,61 @@ InstancePtr InstanceList::loadInstance(const InstanceId& id)
     return inst;
 }
 
+QHash<InstanceId, InstanceList::InstanceSummary> InstanceList::loadSummaryCache(const QString& instDir)
+{
+    QFile file(s_summaryCachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version, count;
+    QString cachedInstDir;
+    in >> magic >> version >> cachedInstDir >> count;
+    // the cache is for one instance folder at a time
+    if (in.status() != QDataStream::Ok || magic != s_summaryCacheMagic || version != s_summaryCacheVersion || cachedInstDir != instDir)
+        return {};
+
+    QHash<InstanceId, InstanceSummary> summaries;
+    summaries.reserve(count);
+    for (quint32 i = 0; i < count; i++) {
+        InstanceId id;
+        InstanceSummary summary;
+        in >> id >> summary.size >> summary.modified >> summary.inode >> summary.checked >>
+            static_cast<QMap<QString, QVariant>&>(summary.values);
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Ignoring damaged instance cache" << s_summaryCachePath;
+            return {};
+        }
+        summaries.insert(id, summary);
+    }
+    return summaries;
+}
+
+void InstanceList::saveSummaryCache()
+{
+    if (!FS::ensureFilePathExists(s_summaryCachePath))
+        return;
+    QSaveFile file(s_summaryCachePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << s_summaryCacheMagic << s_summaryCacheVersion << m_instDir << quint32(m_summaries.size());
+    for (auto it = m_summaries.constBegin(); it != m_summaries.constEnd(); ++it) {
+        // only what's needed to show the instance, everything else is read from the instance itself when it's needed
+        auto values = it->complete ? summaryOf(it->values) : it->values;
+        out << it.key() << it->size << it->modified << it->inode << it->checked << static_cast<const QMap<QString, QVariant>&>(values);
+    }
+
+    if (out.status() != QDataStream::Ok)
+        file.cancelWriting();
+    if (!file.commit())
+        qWarning() << "Could not write instance cache" << s_summaryCachePath;
+}
+
 void InstanceList::increaseGroupCount(const QString& group)
 {
     if (group.isEmpty())
@@ -840,6 +1049,8 @@ void InstanceList::on_InstFolderChanged([[maybe_unused]] const Setting& setting,
         }
         m_instDir = newInstDir;
         m_groupsLoaded = false;
+        m_summaries.clear();
+        m_summaryCacheLoaded = false;
         beginRemoveRows(QModelIndex(), 0, count());
         m_instances.erase(m_instances.begin(), m_instances.end());
         endRemoveRows();
@@ -1022,8 +1233,9 @@ bool InstanceList::commitStagedInstance(const QString& path,
 
         instanceSet.insert(instID);
 
+        // it's only in the list once it has been discovered
+        m_pendingSelection = instID;
         emit instancesChanged();
-        emit instanceSelectRequest(instID);
     }
 
     saveGroupList();
@@ -36,13 +36,20 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPair>
 #include <QSet>
 #include <QStack>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "BaseInstance.h"
+#include "settings/INIFile.h"
+#include "tasks/WorkerPool.h"
 
 class QFileSystemWatcher;
 class InstanceTask;
@@ -94,7 +101,10 @@ class InstanceList : public QAbstractListModel {
 
     int count() const { return m_instances.count(); }
 
+    /* Looks for instances in the background, the list is updated (and listLoaded() emitted) once that's done. */
     InstListError loadList();
+    // whether the instance folder has been looked through at least once
+    bool isListLoaded() const { return m_instancesProbed; }
     void saveNow();
 
     /* O(n) */
@@ -158,6 +168,7 @@ class InstanceList : public QAbstractListModel {
     void instancesChanged();
     void instanceSelectRequest(QString instanceId);
     void groupsChanged(QSet<QString> groups);
+    void listLoaded();
 
    public slots:
     void on_InstFolderChanged(const Setting& setting, QVariant value);
@@ -169,6 +180,19 @@ class InstanceList : public QAbstractListModel {
     void instanceDirContentsChanged(const QString& path);
 
    private:
+    /* What discoverInstances() read of an instance's instance.cfg. */
+    struct InstanceSummary {
+        qint64 size = -1;
+        qint64 modified = 0;
+        quint64 inode = 0;
+        // when size, modified and inode were taken
+        qint64 checked = 0;
+        // the settings that get read without opening the instance, see s_summaryKeys
+        INIFile values;
+        // whether values has all of the file, because it just got read
+        bool complete = false;
+    };
+
     int getInstIndex(BaseInstance* inst) const;
     void updateTotalPlayTime();
     void suspendWatch();
@@ -176,8 +200,23 @@ class InstanceList : public QAbstractListModel {
     void add(const QList<InstancePtr>& list);
     void loadGroupList();
     void saveGroupList();
-    QList<InstanceId> discoverInstances();
+    /* One look through the instance folder, shared by the jobs doing it. */
+    struct Discovery {
+        QString instDir;
+        bool cacheLoaded = false;
+        // id -> summary, from the cache or the last discovery
+        QHash<InstanceId, InstanceSummary> cached;
+        QStringList dirs;
+        std::vector<std::optional<InstanceSummary>> probed;
+        std::atomic<int> remaining{ 0 };
+    };
+
+    void discoverInstances();
+    void instancesDiscovered(Discovery& discovery);
+    static std::optional<InstanceSummary> probeInstance(const QString& dir, const QString& instDirPath, const InstanceSummary& cached);
     InstancePtr loadInstance(const InstanceId& id);
+    static QHash<InstanceId, InstanceSummary> loadSummaryCache(const QString& instDir);
+    void saveSummaryCache();
 
     void increaseGroupCount(const QString& group);
     void decreaseGroupCount(const QString& group);
@@ -199,6 +238,16 @@ class InstanceList : public QAbstractListModel {
     QSet<InstanceId> instanceSet;
     bool m_groupsLoaded = false;
     bool m_instancesProbed = false;
+    // id -> summary, of the instances discoverInstances() found last
+    QHash<InstanceId, InstanceSummary> m_summaries;
+    bool m_summaryCacheLoaded = false;
+    // whether a discovery is running, and whether another one is needed after it
+    bool m_discovering = false;
+    bool m_rediscover = false;
+    // instance to select once it's in the list
+    InstanceId m_pendingSelection;
+    // its own threads, so the instances don't wait for whatever else is going on in the shared pools
+    WorkerPool m_discoveryPool{ WorkerPool::s_ioThreads };
 
     QStack<TrashHistoryItem> m_trashHistory;
 };
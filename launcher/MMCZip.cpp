@@ -45,6 +45,8 @@
 #include <QFileInfo>
 #include <QUrl>
 
+#include <algorithm>
+
 #if defined(LAUNCHER_APPLICATION)
 #include <QtConcurrentRun>
 #endif
@@ -228,27 +230,45 @@ bool createModdedJar(QString sourceJarPath, QString targetJarPath, const QList<M
 #endif
 
 // ours
-QString findFolderOfFileInZip(QuaZip* zip, const QString& what, const QStringList& ignore_paths, const QString& root)
+// The first match of a depth first search that looks at the files of a folder before its subfolders, and at those by
+// name. That's the match with the smallest list of folders, compared element by element (so a parent comes first).
+static QString findFolderOfFile(const QStringList& names, const QString& what, const QStringList& ignore_paths, const QString& root)
 {
-    QuaZipDir rootDir(zip, root);
-    for (auto&& fileName : rootDir.entryList(QDir::Files)) {
-        if (fileName == what)
-            return root;
-
-        QCoreApplication::processEvents();
-    }
+    QString found;
+    QStringList found_folders;
+    bool any = false;
+    for (auto const& name : names) {
+        if (!name.startsWith(root) || name.endsWith('/'))
+            continue;
+        auto slash = name.lastIndexOf('/');
+        if (name.size() - slash - 1 != what.size() || !name.endsWith(what))
+            continue;
 
-    // Recurse the search to non-ignored subfolders
-    for (auto&& fileName : rootDir.entryList(QDir::Dirs)) {
-        if (ignore_paths.contains(fileName))
+        auto path = name.left(slash + 1);
+        auto relative = path.mid(root.size());
+        QStringList folders = relative.isEmpty() ? QStringList() : relative.chopped(1).split('/');
+        if (std::any_of(folders.begin(), folders.end(), [&ignore_paths](const QString& folder) {
+                return ignore_paths.contains(folder + '/') || ignore_paths.contains(folder);
+            }))
             continue;
 
-        QString result = findFolderOfFileInZip(zip, what, ignore_paths, root + fileName);
-        if (!result.isEmpty())
-            return result;
+        if (!any || folders < found_folders) {
+            any = true;
+            found = path;
+            found_folders = folders;
+        }
     }
+    return found;
+}
 
-    return {};
+QString findFolderOfFileInZip(QuaZip* zip, const QString& what, const QStringList& ignore_paths, const QString& root)
+{
+    return findFolderOfFile(zip->getFileNameList(), what, ignore_paths, root);
+}
+
+QString findFolderOfFileInZip(const ZipReader& zip, const QString& what, const QStringList& ignore_paths, const QString& root)
+{
+    return findFolderOfFile(zip.fileNames(), what, ignore_paths, root);
 }
 
 // ours
@@ -52,6 +52,7 @@
 #if defined(LAUNCHER_APPLICATION)
 #include "minecraft/mod/Mod.h"
 #endif
+#include "ZipReader.h"
 #include "tasks/Task.h"
 
 namespace MMCZip {
@@ -96,6 +97,10 @@ bool createModdedJar(QString sourceJarPath, QString targetJarPath, const QList<M
  * \return the path prefix where the file is
  */
 QString findFolderOfFileInZip(QuaZip* zip, const QString& what, const QStringList& ignore_paths = {}, const QString& root = QString(""));
+QString findFolderOfFileInZip(const ZipReader& zip,
+                              const QString& what,
+                              const QStringList& ignore_paths = {},
+                              const QString& root = QString(""));
 
 /**
  * Find a multiple files of the same name in archive by file name
@@ -34,7 +34,9 @@
  */
 #include "Untar.h"
 #include <quagzipfile.h>
+#include <zlib.h>
 #include <QByteArray>
+#include <QDir>
 #include <QFileInfo>
 #include <QIODevice>
 #include <QString>
@@ -87,26 +89,6 @@ enum class TypeFlag : char {
 //                         /* 500 */
 // };
 
-bool readLonglink(QIODevice* in, qint64 size, QByteArray& longlink)
-{
-    qint64 n = 0;
-    size--;  // ignore trailing null
-    if (size < 0) {
-        qCritical() << "The filename size is negative";
-        return false;
-    }
-    longlink.resize(size + (BLOCKSIZE - size % BLOCKSIZE));  // make the size divisible by BLOCKSIZE
-    for (qint64 offset = 0; offset < longlink.size(); offset += BLOCKSIZE) {
-        n = in->read(longlink.data() + offset, BLOCKSIZE);
-        if (n != BLOCKSIZE) {
-            qCritical() << "The expected blocksize was not respected for the name";
-            return false;
-        }
-    }
-    longlink.truncate(qstrlen(longlink.constData()));
-    return true;
-}
-
 int getOctal(char* buffer, int maxlenght, bool* ok)
 {
     return QByteArray(buffer, qstrnlen(buffer, maxlenght)).toInt(ok, 8);
@@ -116,135 +98,231 @@ QString decodeName(char* name)
 {
     return QFile::decodeName(QByteArray(name, qstrnlen(name, 100)));
 }
-bool Tar::extract(QIODevice* in, QString dst)
-{
-    char buffer[BLOCKSIZE];
-    QString name, symlink, firstFolderName;
-    bool doNotReset = false, ok;
-    while (true) {
-        auto n = in->read(buffer, BLOCKSIZE);
-        if (n != BLOCKSIZE) {  // allways expect complete blocks
-            qCritical() << "The expected blocksize was not respected";
-            return false;
-        }
-        if (buffer[0] == 0) {  // end of archive
-            return true;
-        }
-        int mode = getOctal(buffer + 100, 8, &ok) | QFile::ReadUser | QFile::WriteUser;  // hack to ensure write and read permisions
-        if (!ok) {
-            qCritical() << "The file mode can't be read";
-            return false;
-        }
-        // there are names that are exactly 100 bytes long
-        // and neither longlink nor \0 terminated (bug:101472)
 
-        if (name.isEmpty()) {
-            name = decodeName(buffer);
-            if (!firstFolderName.isEmpty() && name.startsWith(firstFolderName)) {
-                name = name.mid(firstFolderName.size());
-            }
-        }
-        if (symlink.isEmpty())
-            symlink = decodeName(buffer);
-        qint64 size = getOctal(buffer + 124, 12, &ok);
-        if (!ok) {
-            qCritical() << "The file size can't be read";
-            return false;
-        }
-        switch (TypeFlag(buffer[156])) {
-            case TypeFlag::Regular:
-                /* fallthrough */
-            case TypeFlag::ARegular: {
-                auto fileName = FS::PathCombine(dst, name);
-                if (!FS::ensureFilePathExists(fileName)) {
-                    qCritical() << "Can't ensure the file path to exist: " << fileName;
-                    return false;
-                }
-                QFile out(fileName);
-                if (!out.open(QFile::WriteOnly)) {
-                    qCritical() << "Can't open file:" << fileName;
-                    return false;
-                }
-                out.setPermissions(QFile::Permissions(mode));
-                while (size > 0) {
-                    QByteArray tmp(BLOCKSIZE, 0);
-                    n = in->read(tmp.data(), BLOCKSIZE);
-                    if (n != BLOCKSIZE) {
-                        qCritical() << "The expected blocksize was not respected when reading file";
-                        return false;
-                    }
-                    tmp.truncate(qMin(qint64(BLOCKSIZE), size));
-                    out.write(tmp);
-                    size -= BLOCKSIZE;
+bool Tar::Extractor::write(const char* data, qint64 size)
+{
+    while (size > 0) {
+        qint64 n = 0;
+        switch (m_state) {
+            case State::Finished:
+                return true;
+            case State::Failed:
+                return false;
+            case State::Header: {
+                n = qMin<qint64>(BLOCKSIZE - m_header.size(), size);
+                m_header.append(data, n);
+                if (m_header.size() == BLOCKSIZE) {
+                    if (!processHeader())
+                        m_state = State::Failed;
+                    m_header.clear();
                 }
                 break;
             }
-            case TypeFlag::Directory: {
-                if (firstFolderName.isEmpty()) {
-                    firstFolderName = name;
-                    break;
-                }
-                auto folderPath = FS::PathCombine(dst, name);
-                if (!FS::ensureFolderPathExists(folderPath)) {
-                    qCritical() << "Can't ensure that folder exists: " << folderPath;
+            case State::FileData: {
+                n = qMin(m_remaining, size);
+                if (m_out->write(data, n) != n) {
+                    qCritical() << "Can't write file:" << m_out->fileName();
+                    m_state = State::Failed;
                     return false;
                 }
-                break;
-            }
-            case TypeFlag::GNULongLink: {
-                doNotReset = true;
-                QByteArray longlink;
-                if (readLonglink(in, size, longlink)) {
-                    symlink = QFile::decodeName(longlink.constData());
-                } else {
-                    qCritical() << "Failed to read long link";
-                    return false;
+                m_remaining -= n;
+                if (m_remaining == 0) {
+                    m_out.reset();
+                    endEntry();
                 }
                 break;
             }
-            case TypeFlag::GNULongName: {
-                doNotReset = true;
-                QByteArray longlink;
-                if (readLonglink(in, size, longlink)) {
-                    name = QFile::decodeName(longlink.constData());
-                } else {
-                    qCritical() << "Failed to read long name";
-                    return false;
+            case State::LongLink: {
+                n = qMin(m_remaining, size);
+                m_longLink.append(data, n);
+                m_remaining -= n;
+                if (m_remaining == 0) {
+                    auto longlink = QFile::decodeName(m_longLink.left(qstrnlen(m_longLink.constData(), m_longLink.size())));
+                    if (TypeFlag(m_longLinkType) == TypeFlag::GNULongLink) {
+                        m_symlink = longlink;
+                    } else {
+                        m_name = longlink;
+                        // same as for short names
+                        if (!m_firstFolderName.isEmpty() && m_name.startsWith(m_firstFolderName))
+                            m_name = m_name.mid(m_firstFolderName.size());
+                    }
+                    endEntry();
                 }
                 break;
             }
-            case TypeFlag::Link:
-                /* fallthrough */
-            case TypeFlag::Symlink: {
-                auto fileName = FS::PathCombine(dst, name);
-                if (!FS::create_link(FS::PathCombine(QFileInfo(fileName).path(), symlink), fileName)()) {  // do not use symlinks
-                    qCritical() << "Can't create link for:" << fileName << " to:" << FS::PathCombine(QFileInfo(fileName).path(), symlink);
-                    return false;
-                }
-                FS::ensureFilePathExists(fileName);
-                QFile::setPermissions(fileName, QFile::Permissions(mode));
+            case State::Padding: {
+                n = qMin(m_padding, size);
+                m_padding -= n;
+                if (m_padding == 0)
+                    m_state = State::Header;
                 break;
             }
-            case TypeFlag::Character:
-                /* fallthrough */
-            case TypeFlag::Block:
-                /* fallthrough */
-            case TypeFlag::FIFO:
-                /* fallthrough */
-            case TypeFlag::Contiguous:
-                /* fallthrough */
-            case TypeFlag::GlobalPosixHeader:
-                /* fallthrough */
-            case TypeFlag::ExtendedPosixHeader:
-                /* fallthrough */
-            default:
+        }
+        data += n;
+        size -= n;
+    }
+    return m_state != State::Failed;
+}
+
+QString Tar::Extractor::targetPath(const QString& name) const
+{
+    // nothing may end up outside of the destination, no matter what the archive says
+    QDir destination(m_dst);
+    auto path = QDir::cleanPath(destination.absoluteFilePath(name));
+    if (!path.startsWith(destination.absolutePath() + '/')) {
+        qCritical() << "Not extracting" << name << "outside of" << m_dst;
+        return {};
+    }
+    return path;
+}
+
+void Tar::Extractor::endEntry()
+{
+    m_state = m_padding > 0 ? State::Padding : State::Header;
+}
+
+bool Tar::Extractor::processHeader()
+{
+    char* buffer = m_header.data();
+    bool ok;
+    if (buffer[0] == 0) {  // end of archive
+        m_state = State::Finished;
+        return true;
+    }
+    int mode = getOctal(buffer + 100, 8, &ok) | QFile::ReadUser | QFile::WriteUser;  // hack to ensure write and read permisions
+    if (!ok) {
+        qCritical() << "The file mode can't be read";
+        return false;
+    }
+    // there are names that are exactly 100 bytes long
+    // and neither longlink nor \0 terminated (bug:101472)
+
+    if (m_name.isEmpty()) {
+        m_name = decodeName(buffer);
+        if (!m_firstFolderName.isEmpty() && m_name.startsWith(m_firstFolderName)) {
+            m_name = m_name.mid(m_firstFolderName.size());
+        }
+    }
+    if (m_symlink.isEmpty())
+        m_symlink = decodeName(buffer);
+    qint64 size = getOctal(buffer + 124, 12, &ok);
+    if (!ok || size < 0) {
+        qCritical() << "The file size can't be read";
+        return false;
+    }
+
+    // entry data is padded to full blocks. whatever data isn't needed below gets skipped
+    qint64 padding = (BLOCKSIZE - size % BLOCKSIZE) % BLOCKSIZE;
+    m_remaining = 0;
+    m_padding = size + padding;
+    endEntry();
+
+    switch (TypeFlag(buffer[156])) {
+        case TypeFlag::Regular:
+            /* fallthrough */
+        case TypeFlag::ARegular: {
+            auto fileName = targetPath(m_name);
+            if (fileName.isEmpty())
+                return false;
+            if (!FS::ensureFilePathExists(fileName)) {
+                qCritical() << "Can't ensure the file path to exist: " << fileName;
+                return false;
+            }
+            m_out.reset(new QFile(fileName));
+            if (!m_out->open(QFile::WriteOnly)) {
+                qCritical() << "Can't open file:" << fileName;
+                return false;
+            }
+            m_out->setPermissions(QFile::Permissions(mode));
+            if (size > 0) {
+                m_remaining = size;
+                m_padding = padding;
+                m_state = State::FileData;
+            } else {
+                m_out.reset();
+            }
+            break;
+        }
+        case TypeFlag::Directory: {
+            if (m_firstFolderName.isEmpty()) {
+                m_firstFolderName = m_name;
                 break;
+            }
+            auto folderPath = targetPath(m_name);
+            if (folderPath.isEmpty())
+                return false;
+            if (!FS::ensureFolderPathExists(folderPath)) {
+                qCritical() << "Can't ensure that folder exists: " << folderPath;
+                return false;
+            }
+            break;
         }
-        if (!doNotReset) {
-            name.truncate(0);
-            symlink.truncate(0);
+        case TypeFlag::GNULongLink:
+            /* fallthrough */
+        case TypeFlag::GNULongName: {
+            m_doNotReset = true;
+            if (size < 1) {
+                qCritical() << "The filename size is negative";
+                return false;
+            }
+            m_longLinkType = buffer[156];
+            m_longLink.clear();
+            m_remaining = size;
+            m_padding = padding;
+            m_state = State::LongLink;
+            break;
+        }
+        case TypeFlag::Link:
+            /* fallthrough */
+        case TypeFlag::Symlink: {
+            auto fileName = targetPath(m_name);
+            // relative to the link, and just as bound to the destination
+            auto linkTarget = fileName.isEmpty() ? QString() : targetPath(FS::PathCombine(QFileInfo(m_name).path(), m_symlink));
+            if (linkTarget.isEmpty())
+                return false;
+            if (!FS::create_link(linkTarget, fileName)()) {  // do not use symlinks
+                qCritical() << "Can't create link for:" << fileName << " to:" << linkTarget;
+                return false;
+            }
+            FS::ensureFilePathExists(fileName);
+            QFile::setPermissions(fileName, QFile::Permissions(mode));
+            break;
         }
-        doNotReset = false;
+        case TypeFlag::Character:
+            /* fallthrough */
+        case TypeFlag::Block:
+            /* fallthrough */
+        case TypeFlag::FIFO:
+            /* fallthrough */
+        case TypeFlag::Contiguous:
+            /* fallthrough */
+        case TypeFlag::GlobalPosixHeader:
+            /* fallthrough */
+        case TypeFlag::ExtendedPosixHeader:
+            /* fallthrough */
+        default:
+            break;
+    }
+    if (!m_doNotReset) {
+        m_name.truncate(0);
+        m_symlink.truncate(0);
+    }
+    m_doNotReset = false;
+    return true;
+}
+
+bool Tar::extract(QIODevice* in, QString dst)
+{
+    Extractor extractor(dst);
+    QByteArray buffer(64 * 1024, Qt::Uninitialized);
+    while (!extractor.isFinished()) {
+        auto n = in->read(buffer.data(), buffer.size());
+        if (n <= 0) {  // allways expect complete blocks
+            qCritical() << "The expected blocksize was not respected";
+            return false;
+        }
+        if (!extractor.write(buffer.constData(), n))
+            return false;
     }
     return true;
 }
@@ -257,4 +335,50 @@ bool GZTar::extract(QString src, QString dst)
         return false;
     }
     return Tar::extract(&a, dst);
-}
\ No newline at end of file
+}
+
+GZTar::Extractor::Extractor(QString dst) : m_tar(dst), m_stream(new z_stream_s)
+{
+    memset(m_stream.get(), 0, sizeof(z_stream_s));
+    // gzip header
+    m_initialized = inflateInit2(m_stream.get(), 16 + MAX_WBITS) == Z_OK;
+    m_failed = !m_initialized;
+}
+
+GZTar::Extractor::~Extractor()
+{
+    if (m_initialized)
+        inflateEnd(m_stream.get());
+}
+
+bool GZTar::Extractor::write(const QByteArray& data)
+{
+    if (m_failed)
+        return false;
+    if (m_streamEnd)
+        return true;
+
+    char out[64 * 1024];
+    m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    m_stream->avail_in = data.size();
+    // a full output buffer can mean there's more to come out, even without input left
+    do {
+        m_stream->next_out = reinterpret_cast<Bytef*>(out);
+        m_stream->avail_out = sizeof(out);
+        auto err = inflate(m_stream.get(), Z_NO_FLUSH);
+        if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR) {
+            qCritical() << "Failed to inflate the tar archive:" << (m_stream->msg ? m_stream->msg : "unknown error");
+            m_failed = true;
+            return false;
+        }
+        if (!m_tar.write(out, sizeof(out) - m_stream->avail_out)) {
+            m_failed = true;
+            return false;
+        }
+        if (err == Z_STREAM_END) {
+            m_streamEnd = true;
+            break;
+        }
+    } while (m_stream->avail_in > 0 || m_stream->avail_out == 0);
+    return true;
+}
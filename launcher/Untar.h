@@ -33,14 +33,70 @@
  *      limitations under the License.
  */
 #pragma once
+#include <QFile>
 #include <QIODevice>
+#include <memory>
+
+struct z_stream_s;
 
 // this is a hack used for the java downloader (feel free to remove it in favor of a library)
 // both extract functions will extract the first folder inside dest(disregarding the prefix)
 namespace Tar {
 bool extract(QIODevice* in, QString dst);
-}
+
+/* The same extraction, but the archive gets pushed in as it arrives, in chunks of any size. */
+class Extractor {
+   public:
+    explicit Extractor(QString dst) : m_dst(dst) {}
+
+    // false if the archive is broken or a file couldn't be written. everything after the end of the archive is ignored
+    bool write(const char* data, qint64 size);
+    // whether the end of the archive was reached
+    bool isFinished() const { return m_state == State::Finished; }
+
+   private:
+    enum class State { Header, FileData, LongLink, Padding, Finished, Failed };
+
+    bool processHeader();
+    // where an entry goes, or nothing if that would be outside of m_dst
+    QString targetPath(const QString& name) const;
+    // on to the padding after the entry data, or the next header
+    void endEntry();
+
+    QString m_dst;
+    State m_state = State::Header;
+    // the header block read so far
+    QByteArray m_header;
+    // data of a GNU long name/link entry
+    QByteArray m_longLink;
+    char m_longLinkType = 0;
+    // data left in the current entry, and the padding after it
+    qint64 m_remaining = 0;
+    qint64 m_padding = 0;
+    std::unique_ptr<QFile> m_out;
+
+    QString m_name, m_symlink, m_firstFolderName;
+    bool m_doNotReset = false;
+};
+}  // namespace Tar
 
 namespace GZTar {
 bool extract(QString src, QString dst);
-}
\ No newline at end of file
+
+/* Tar::Extractor for gzipped archives, inflating the chunks as they come in. */
+class Extractor {
+   public:
+    explicit Extractor(QString dst);
+    ~Extractor();
+
+    bool write(const QByteArray& data);
+    bool isFinished() const { return m_tar.isFinished(); }
+
+   private:
+    Tar::Extractor m_tar;
+    std::unique_ptr<z_stream_s> m_stream;
+    bool m_initialized = false;
+    bool m_streamEnd = false;
+    bool m_failed = false;
+};
+}  // namespace GZTar
\ No newline at end of file
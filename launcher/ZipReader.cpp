@@ -0,0 +1,429 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ZipReader.h"
+
+#include <QtEndian>
+
+#include <zlib.h>
+#include <limits>
+
+static const quint32 s_local_header = 0x04034b50;
+static const quint32 s_central_header = 0x02014b50;
+static const quint32 s_end_of_central_directory = 0x06054b50;
+static const quint32 s_zip64_end_of_central_directory = 0x06064b50;
+static const quint32 s_zip64_locator = 0x07064b50;
+static const quint16 s_zip64_extra = 0x0001;
+
+static const int s_local_header_size = 30;
+static const int s_central_header_size = 46;
+static const int s_end_of_central_directory_size = 22;
+static const int s_zip64_end_of_central_directory_size = 56;
+static const int s_zip64_locator_size = 20;
+// what a deflated entry gets to start with, it doubles from there
+static const int s_initial_inflate_size = 256 * 1024;
+
+static quint16 le16(const uchar* p)
+{
+    return qFromLittleEndian<quint16>(p);
+}
+
+static quint32 le32(const uchar* p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+static quint64 le64(const uchar* p)
+{
+    return qFromLittleEndian<quint64>(p);
+}
+
+ZipReader::ZipReader(const QString& path) : m_file(path) {}
+
+ZipReader::~ZipReader()
+{
+    close();
+}
+
+bool ZipReader::fail(const QString& error)
+{
+    close();
+    m_error = error;
+    return false;
+}
+
+bool ZipReader::open()
+{
+    close();
+    m_error.clear();
+
+    if (!m_file.open(QIODevice::ReadOnly))
+        return fail(m_file.errorString());
+
+    m_size = m_file.size();
+    if (m_size < s_end_of_central_directory_size)
+        return fail("not a zip archive");
+
+    return readCentralDirectory() || fail(m_error.isEmpty() ? "damaged central directory" : m_error);
+}
+
+void ZipReader::close()
+{
+    m_folded_index.clear();
+    m_index.clear();
+    m_entries.clear();
+    m_directory.clear();
+    m_size = 0;
+    m_file.close();
+}
+
+void ZipReader::setCaseSensitivity(Qt::CaseSensitivity sensitivity)
+{
+    m_case_sensitivity = sensitivity;
+    indexFoldedNames();
+}
+
+bool ZipReader::readAt(qint64 offset, qint64 length, QByteArray& buffer) const
+{
+    if (offset < 0 || length < 0 || offset > m_size || length > m_size - offset || length > std::numeric_limits<int>::max())
+        return false;
+    buffer.resize(int(length));
+    return m_file.seek(offset) && m_file.read(buffer.data(), length) == length;
+}
+
+bool ZipReader::readCentralDirectory()
+{
+    // the end of central directory record is at the very end, followed only by a comment of up to 64 KiB
+    qint64 tail_offset = qMax<qint64>(0, m_size - s_end_of_central_directory_size - 0xffff);
+    QByteArray tail;
+    if (!readAt(tail_offset, m_size - tail_offset, tail)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    auto tail_data = reinterpret_cast<const uchar*>(tail.constData());
+
+    qint64 end = -1;
+    for (qint64 pos = tail.size() - s_end_of_central_directory_size; pos >= 0; pos--) {
+        if (tail_data[pos] == 'P' && le32(tail_data + pos) == s_end_of_central_directory) {
+            end = pos;
+            break;
+        }
+    }
+    if (end < 0) {
+        m_error = "not a zip archive";
+        return false;
+    }
+
+    quint64 count = le16(tail_data + end + 10);
+    quint64 directory_size = le32(tail_data + end + 12);
+    quint64 directory_offset = le32(tail_data + end + 16);
+    end += tail_offset;
+    // whatever was put in front of the archive (a launcher script, for instance)
+    qint64 prefix = 0;
+
+    if (count == 0xffff || directory_size == 0xffffffff || directory_offset == 0xffffffff) {
+        qint64 locator = end - s_zip64_locator_size;
+        QByteArray buffer;
+        if (!readAt(locator, s_zip64_locator_size, buffer))
+            return false;
+        auto locator_data = reinterpret_cast<const uchar*>(buffer.constData());
+        if (le32(locator_data) != s_zip64_locator)
+            return false;
+        quint64 record = le64(locator_data + 8);
+        if (locator < s_zip64_end_of_central_directory_size || record > quint64(locator - s_zip64_end_of_central_directory_size) ||
+            !readAt(qint64(record), s_zip64_end_of_central_directory_size, buffer))
+            return false;
+        auto record_data = reinterpret_cast<const uchar*>(buffer.constData());
+        if (le32(record_data) != s_zip64_end_of_central_directory)
+            return false;
+        count = le64(record_data + 32);
+        directory_size = le64(record_data + 40);
+        directory_offset = le64(record_data + 48);
+    } else {
+        prefix = end - qint64(directory_size + directory_offset);
+        if (prefix < 0)
+            return false;
+    }
+
+    quint64 start = directory_offset + prefix;
+    if (start > quint64(end) || directory_size > quint64(end) - start || !readAt(qint64(start), qint64(directory_size), m_directory))
+        return false;
+    auto directory = reinterpret_cast<const uchar*>(m_directory.constData());
+
+    m_entries.reserve(int(qMin<quint64>(count, directory_size / s_central_header_size)));
+    m_index.reserve(m_entries.capacity());
+    quint64 pos = 0;
+    for (quint64 i = 0; i < count; i++) {
+        if (pos + s_central_header_size > directory_size || le32(directory + pos) != s_central_header)
+            return false;
+        const uchar* header = directory + pos;
+
+        quint16 name_length = le16(header + 28);
+        quint16 extra_length = le16(header + 30);
+        quint16 comment_length = le16(header + 32);
+        quint64 next = pos + s_central_header_size + name_length + extra_length + comment_length;
+        if (next > directory_size)
+            return false;
+
+        Entry entry;
+        entry.made_by = le16(header + 4);
+        entry.flags = le16(header + 8);
+        entry.method = le16(header + 10);
+        entry.crc = le32(header + 16);
+        entry.compressed_size = le32(header + 20);
+        entry.size = le32(header + 24);
+        entry.external_attributes = le32(header + 38);
+        entry.local_offset = le32(header + 42);
+        entry.name = QByteArray::fromRawData(reinterpret_cast<const char*>(header + s_central_header_size), name_length);
+
+        // sizes and offset that don't fit are in the zip64 extra field, in this order
+        const uchar* extra = header + s_central_header_size + name_length;
+        const uchar* extra_end = extra + extra_length;
+        while (extra + 4 <= extra_end) {
+            quint16 id = le16(extra);
+            quint16 length = le16(extra + 2);
+            const uchar* field = extra + 4;
+            const uchar* field_end = field + length;
+            if (field_end > extra_end)
+                break;
+            if (id == s_zip64_extra) {
+                for (auto* value : { &entry.size, &entry.compressed_size, &entry.local_offset }) {
+                    if (*value != 0xffffffff)
+                        continue;
+                    if (field + 8 > field_end)
+                        return false;
+                    *value = le64(field);
+                    field += 8;
+                }
+            }
+            extra = field_end;
+        }
+        entry.local_offset += prefix;
+
+        // like everyone else, the first entry with a name wins
+        if (!m_index.contains(entry.name))
+            m_index.insert(entry.name, m_entries.size());
+        m_entries.append(entry);
+
+        pos = next;
+    }
+    indexFoldedNames();
+    return true;
+}
+
+void ZipReader::indexFoldedNames()
+{
+    m_folded_index.clear();
+    if (m_case_sensitivity == Qt::CaseSensitive)
+        return;
+    m_folded_index.reserve(m_entries.size());
+    for (int i = 0; i < m_entries.size(); i++) {
+        auto name = QString::fromUtf8(m_entries[i].name).toLower();
+        if (!m_folded_index.contains(name))
+            m_folded_index.insert(name, i);
+    }
+}
+
+QStringList ZipReader::fileNames() const
+{
+    QStringList names;
+    names.reserve(m_entries.size());
+    for (auto const& entry : m_entries)
+        names.append(QString::fromUtf8(entry.name));
+    return names;
+}
+
+const ZipReader::Entry* ZipReader::find(const QString& name) const
+{
+    auto it = m_index.constFind(name.toUtf8());
+    if (it != m_index.constEnd())
+        return &m_entries[it.value()];
+    if (m_case_sensitivity == Qt::CaseInsensitive) {
+        auto folded = m_folded_index.constFind(name.toLower());
+        if (folded != m_folded_index.constEnd())
+            return &m_entries[folded.value()];
+    }
+    return nullptr;
+}
+
+bool ZipReader::contains(const QString& name) const
+{
+    return find(name) != nullptr;
+}
+
+bool ZipReader::containsDirectory(const QString& path) const
+{
+    if (contains(path + '/'))
+        return true;
+    // not every archive has entries for its directories
+    auto prefix = path.toUtf8() + '/';
+    for (auto const& entry : m_entries) {
+        if (entry.name.startsWith(prefix))
+            return true;
+    }
+    if (m_case_sensitivity == Qt::CaseInsensitive) {
+        auto folded = path.toLower() + '/';
+        for (auto it = m_folded_index.constBegin(); it != m_folded_index.constEnd(); ++it) {
+            if (it.key().startsWith(folded))
+                return true;
+        }
+    }
+    return false;
+}
+
+QString ZipReader::findFirst(const QStringList& names) const
+{
+    for (auto const& name : names) {
+        if (contains(name))
+            return name;
+    }
+    return {};
+}
+
+qint64 ZipReader::size(const QString& name) const
+{
+    auto entry = find(name);
+    return entry ? qint64(entry->size) : -1;
+}
+
+QFile::Permissions ZipReader::permissions(const QString& name) const
+{
+    auto entry = find(name);
+    // only archives made on unix have them, in the upper half of the external attributes
+    if (!entry || (entry->made_by >> 8) != 3)
+        return {};
+    quint32 mode = entry->external_attributes >> 16;
+
+    QFile::Permissions permissions;
+    if (mode & 0400)
+        permissions |= QFile::ReadOwner | QFile::ReadUser;
+    if (mode & 0200)
+        permissions |= QFile::WriteOwner | QFile::WriteUser;
+    if (mode & 0100)
+        permissions |= QFile::ExeOwner | QFile::ExeUser;
+    if (mode & 0040)
+        permissions |= QFile::ReadGroup;
+    if (mode & 0020)
+        permissions |= QFile::WriteGroup;
+    if (mode & 0010)
+        permissions |= QFile::ExeGroup;
+    if (mode & 0004)
+        permissions |= QFile::ReadOther;
+    if (mode & 0002)
+        permissions |= QFile::WriteOther;
+    if (mode & 0001)
+        permissions |= QFile::ExeOther;
+    return permissions;
+}
+
+bool ZipReader::read(const QString& name, QByteArray& buffer, qint64 max_size) const
+{
+    auto entry = find(name);
+    if (!entry || !isOpen())
+        return false;
+    if (max_size >= 0 && entry->size > quint64(max_size))
+        return false;
+    // encrypted
+    if (entry->flags & 0x1)
+        return false;
+    if (entry->size > quint64(std::numeric_limits<int>::max()))
+        return false;
+
+    QByteArray header;
+    if (entry->local_offset > quint64(m_size) || !readAt(qint64(entry->local_offset), s_local_header_size, header))
+        return false;
+    auto header_data = reinterpret_cast<const uchar*>(header.constData());
+    if (le32(header_data) != s_local_header)
+        return false;
+    // the local header can have a different extra field than the central one
+    quint64 data_offset = entry->local_offset + s_local_header_size + le16(header_data + 26) + le16(header_data + 28);
+    if (data_offset > quint64(m_size) || entry->compressed_size > quint64(m_size) - data_offset)
+        return false;
+
+    switch (entry->method) {
+        case 0:  // stored
+            if (entry->compressed_size != entry->size || !readAt(qint64(data_offset), qint64(entry->size), buffer))
+                return false;
+            break;
+        case Z_DEFLATED:
+            if (!inflate(*entry, qint64(data_offset), buffer))
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    return crc32(0, reinterpret_cast<const Bytef*>(buffer.constData()), buffer.size()) == entry->crc;
+}
+
+QByteArray ZipReader::read(const QString& name, qint64 max_size) const
+{
+    QByteArray buffer;
+    if (!read(name, buffer, max_size))
+        return {};
+    // tell empty entries apart from failures
+    if (buffer.isNull())
+        buffer = QByteArray("");
+    return buffer;
+}
+
+bool ZipReader::inflate(const Entry& entry, qint64 offset, QByteArray& buffer) const
+{
+    // the size in the header is only taken as the most there can be. the buffer grows as the data comes in, so an entry
+    // that claims to be huge doesn't get the memory for it up front
+    buffer.resize(int(qMin<quint64>(entry.size, s_initial_inflate_size)));
+    if (entry.size == 0)
+        return true;
+    if (!m_file.seek(offset))
+        return false;
+
+    z_stream stream = {};
+    // raw deflate, there is no zlib header in zip entries
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    quint64 remaining = entry.compressed_size;
+    QByteArray input(int(qMin<quint64>(remaining, 64 * 1024)), Qt::Uninitialized);
+    stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    stream.avail_out = uInt(buffer.size());
+
+    int result = Z_OK;
+    while (result == Z_OK) {
+        if (stream.avail_out == 0 && stream.total_out < entry.size) {
+            buffer.resize(int(qMin<quint64>(entry.size, quint64(buffer.size()) * 2)));
+            stream.next_out = reinterpret_cast<Bytef*>(buffer.data()) + stream.total_out;
+            stream.avail_out = uInt(quint64(buffer.size()) - stream.total_out);
+        }
+        if (stream.avail_in == 0 && remaining > 0) {
+            auto chunk = qint64(qMin<quint64>(remaining, quint64(input.size())));
+            if (m_file.read(input.data(), chunk) != chunk)
+                break;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = uInt(chunk);
+            remaining -= chunk;
+        }
+        result = ::inflate(&stream, remaining == 0 ? Z_FINISH : Z_NO_FLUSH);
+        // Z_BUF_ERROR with input left means there is more output than the entry claims
+        if (result == Z_BUF_ERROR && stream.avail_in == 0 && remaining > 0)
+            result = Z_OK;
+    }
+    bool ok = result == Z_STREAM_END && stream.total_out == entry.size;
+    inflateEnd(&stream);
+    if (!ok)
+        buffer.clear();
+    return ok;
+}
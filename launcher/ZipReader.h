@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * A read-only zip archive, for when all we want is to look at a few entries.
+ *
+ * The central directory is read once, into a hash of the entry names. Checking whether an entry exists is a lookup in
+ * that hash, and reading one seeks to it and inflates it into the caller's buffer, without reopening anything.
+ * The archive is read, not mapped: it's usually some user's jar that can change under us, and a mapping of a file that
+ * gets truncated ends with a SIGBUS rather than a failed read. Reading seeks, so don't share one reader between threads.
+ *
+ * Stored and deflated entries are supported, as well as zip64 archives. Encrypted entries are not.
+ * Names are expected to be UTF-8 (which is what jars use). Like QuaZip, they're case insensitive on Windows and case
+ * sensitive everywhere else, unless told otherwise with setCaseSensitivity().
+ */
+class ZipReader {
+   public:
+    explicit ZipReader(const QString& path);
+    ~ZipReader();
+
+    /* Opens the archive and reads its central directory. */
+    bool open();
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    Qt::CaseSensitivity caseSensitivity() const { return m_case_sensitivity; }
+    void setCaseSensitivity(Qt::CaseSensitivity sensitivity);
+
+    QString path() const { return m_file.fileName(); }
+    QString errorString() const { return m_error; }
+
+    /* Names of all entries, in the order of the central directory. Directories end with a '/'. */
+    QStringList fileNames() const;
+    int count() const { return m_entries.size(); }
+
+    bool contains(const QString& name) const;
+    /* Whether there is a directory `path` (without the trailing '/'), be it an entry of its own or just part of the
+     * path of other entries. */
+    bool containsDirectory(const QString& path) const;
+    /* The first of `names` that is in the archive, or an empty string. */
+    QString findFirst(const QStringList& names) const;
+
+    /* Uncompressed size of the entry, or -1 if there is no such entry. */
+    qint64 size(const QString& name) const;
+    /* Unix permissions of the entry, if the archive has any for it. */
+    QFile::Permissions permissions(const QString& name) const;
+
+    /* Inflates the entry into `buffer`, which gets resized to fit. Entries of more than `max_size` bytes (if it isn't
+     * negative) fail without reading anything, for small files like metadata that a broken archive claims are huge. */
+    bool read(const QString& name, QByteArray& buffer, qint64 max_size = -1) const;
+    /* The contents of the entry, or a null QByteArray if it can't be read. */
+    QByteArray read(const QString& name, qint64 max_size = -1) const;
+
+   private:
+    struct Entry {
+        QByteArray name;
+        quint64 local_offset = 0;
+        quint64 compressed_size = 0;
+        quint64 size = 0;
+        quint32 crc = 0;
+        quint16 method = 0;
+        quint16 flags = 0;
+        quint16 made_by = 0;
+        quint32 external_attributes = 0;
+    };
+
+    bool fail(const QString& error);
+    bool readCentralDirectory();
+    bool readAt(qint64 offset, qint64 length, QByteArray& buffer) const;
+    void indexFoldedNames();
+    const Entry* find(const QString& name) const;
+    bool inflate(const Entry& entry, qint64 offset, QByteArray& buffer) const;
+
+   private:
+    mutable QFile m_file;
+    qint64 m_size = 0;
+    QString m_error;
+#ifdef Q_OS_WIN
+    Qt::CaseSensitivity m_case_sensitivity = Qt::CaseInsensitive;
+#else
+    Qt::CaseSensitivity m_case_sensitivity = Qt::CaseSensitive;
+#endif
+
+    // the central directory as it is in the archive, the entry names point into it
+    QByteArray m_directory;
+    QVector<Entry> m_entries;
+    QHash<QByteArray, int> m_index;
+    // lower case names, only kept when names are case insensitive
+    QHash<QString, int> m_folded_index;
+
+    Q_DISABLE_COPY(ZipReader)
+};
@@ -21,10 +21,11 @@
 #include "MMCZip.h"
 
 #include "Application.h"
-#include "Untar.h"
+#include "java/download/RuntimeStore.h"
 #include "net/ChecksumValidator.h"
 #include "net/NetJob.h"
 #include "tasks/Task.h"
+#include "tasks/WorkerPool.h"
 
 namespace Java {
 ArchiveDownloadTask::ArchiveDownloadTask(QUrl url, QString final_path, QString checksumType, QString checksumHash)
@@ -36,10 +37,23 @@ void ArchiveDownloadTask::executeTask()
     // JRE found ! download the zip
     setStatus(tr("Downloading Java"));
 
-    MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry("java", m_url.fileName());
+    auto fileName = m_url.fileName();
+    bool isTar = fileName.endsWith("tar");
+    bool isGZTar = fileName.endsWith("tar.gz") || fileName.endsWith("taz") || fileName.endsWith("tgz");
 
     auto download = makeShared<NetJob>(QString("JRE::DownloadJava"), APPLICATION->network());
-    auto action = Net::Download::makeCached(m_url, entry);
+    download->setPriority(Net::Scheduler::Priority::Bulk);
+    Net::Download::Ptr action;
+    QString fullPath;
+    if (isTar || isGZTar) {
+        // tar archives get extracted as they come in, so there's nothing left to do afterwards.
+        // the archive is only kept until it's complete, so an interrupted download can be resumed
+        action = Net::Download::makeTarArchive(m_url, QDir(m_final_path).absolutePath(), isGZTar, Net::Download::Option::Resumable);
+    } else {
+        MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry("java", fileName);
+        action = Net::Download::makeCached(m_url, entry, Net::Download::Option::Resumable);
+        fullPath = entry->getFullPath();
+    }
     if (!m_checksum_hash.isEmpty() && !m_checksum_type.isEmpty()) {
         auto hashType = QCryptographicHash::Algorithm::Sha1;
         if (m_checksum_type == "sha256") {
@@ -48,17 +62,20 @@ void ArchiveDownloadTask::executeTask()
         action->addValidator(new Net::ChecksumValidator(hashType, QByteArray::fromHex(m_checksum_hash.toUtf8())));
     }
     download->addNetAction(action);
-    auto fullPath = entry->getFullPath();
 
     connect(download.get(), &Task::failed, this, &ArchiveDownloadTask::emitFailed);
     connect(download.get(), &Task::progress, this, &ArchiveDownloadTask::setProgress);
     connect(download.get(), &Task::stepProgress, this, &ArchiveDownloadTask::propagateStepProgress);
     connect(download.get(), &Task::status, this, &ArchiveDownloadTask::setStatus);
     connect(download.get(), &Task::details, this, &ArchiveDownloadTask::setDetails);
-    connect(download.get(), &Task::succeeded, [this, fullPath] {
-        // This should do all of the extracting and creating folders
-        extractJava(fullPath);
-    });
+    if (fullPath.isEmpty()) {
+        connect(download.get(), &Task::succeeded, this, &ArchiveDownloadTask::storeJava);
+    } else {
+        connect(download.get(), &Task::succeeded, [this, fullPath] {
+            // This should do all of the extracting and creating folders
+            extractJava(fullPath);
+        });
+    }
     m_task = download;
     m_task->start();
 }
@@ -66,28 +83,7 @@ void ArchiveDownloadTask::executeTask()
 void ArchiveDownloadTask::extractJava(QString input)
 {
     setStatus(tr("Extracting Java"));
-    if (input.endsWith("tar")) {
-        setStatus(tr("Extracting Java (Progress is not reported for tar archives)"));
-        QFile in(input);
-        if (!in.open(QFile::ReadOnly)) {
-            emitFailed(tr("Unable to open supplied tar file."));
-            return;
-        }
-        if (!Tar::extract(&in, QDir(m_final_path).absolutePath())) {
-            emitFailed(tr("Unable to extract supplied tar file."));
-            return;
-        }
-        emitSucceeded();
-        return;
-    } else if (input.endsWith("tar.gz") || input.endsWith("taz") || input.endsWith("tgz")) {
-        setStatus(tr("Extracting Java (Progress is not reported for tar archives)"));
-        if (!GZTar::extract(input, QDir(m_final_path).absolutePath())) {
-            emitFailed(tr("Unable to extract supplied tar file."));
-            return;
-        }
-        emitSucceeded();
-        return;
-    } else if (input.endsWith("zip")) {
+    if (input.endsWith("zip")) {
         auto zip = std::make_shared<QuaZip>(input);
         if (!zip->open(QuaZip::mdUnzip)) {
             emitFailed(tr("Unable to open supplied zip file."));
@@ -106,7 +102,7 @@ void ArchiveDownloadTask::extractJava(QString input)
             stepProgress(*progressStep);
         });
 
-        connect(m_task.get(), &Task::succeeded, this, &ArchiveDownloadTask::emitSucceeded);
+        connect(m_task.get(), &Task::succeeded, this, &ArchiveDownloadTask::storeJava);
         connect(m_task.get(), &Task::aborted, this, &ArchiveDownloadTask::emitAborted);
         connect(m_task.get(), &Task::failed, this, [this, progressStep](QString reason) {
             progressStep->state = TaskStepState::Failed;
@@ -130,6 +126,22 @@ void ArchiveDownloadTask::extractJava(QString input)
     emitFailed(tr("Could not determine archive type!"));
 }
 
+void ArchiveDownloadTask::storeJava()
+{
+    auto store = RuntimeStore::forRuntime(m_final_path);
+    if (!store.isUsable()) {
+        emitSucceeded();
+        return;
+    }
+    setStatus(tr("Sharing files with other Java installations"));
+    // failing to share anything just leaves the runtime as it was extracted
+    connect(&m_storeWatcher, &QFutureWatcher<void>::finished, this, &ArchiveDownloadTask::emitSucceeded);
+    m_storeWatcher.setFuture(WorkerPool::io().run([store, path = m_final_path] {
+        store.ingest(path);
+        store.collectGarbage();
+    }));
+}
+
 bool ArchiveDownloadTask::abort()
 {
     auto aborted = canAbort();
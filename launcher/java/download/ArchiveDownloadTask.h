@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QUrl>
 #include "tasks/Task.h"
 
@@ -34,6 +35,8 @@ class ArchiveDownloadTask : public Task {
 
    private slots:
     void extractJava(QString input);
+    // shares the extracted files with the other runtimes, see RuntimeStore
+    void storeJava();
 
    protected:
     QUrl m_url;
@@ -41,5 +44,6 @@ class ArchiveDownloadTask : public Task {
     QString m_checksum_type;
     QString m_checksum_hash;
     Task::Ptr m_task;
+    QFutureWatcher<void> m_storeWatcher;
 };
 }  // namespace Java
\ No newline at end of file
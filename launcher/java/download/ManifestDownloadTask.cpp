@@ -21,24 +21,66 @@
 #include "FileSystem.h"
 #include "Json.h"
 #include "net/ChecksumValidator.h"
+#include "net/LzmaFileSink.h"
 #include "net/NetJob.h"
+#include "tasks/WorkerPool.h"
 
-struct File {
-    QString path;
-    QString url;
-    QByteArray hash;
-    bool isExec;
-};
+
+#include <optional>
+
+namespace {
+using File = Java::ManifestDownloadTask::File;
+
+void setExecutable(const File& file)
+{
+    QFile(file.path).setPermissions(QFile(file.path).permissions() | QFileDevice::Permissions(0x1111));
+}
+
+// downloaded files go into the store right away, so they don't have to be downloaded again even if the rest fails
+Net::Download::Ptr makeFileDownload(const File& file, bool compressed, std::optional<Java::RuntimeStore> store)
+{
+    auto dl = compressed ? Net::Download::makeLzmaFile(file.lzmaUrl, file.path) : Net::Download::makeFile(file.url, file.path);
+    // the hash is the one of the uncompressed file either way, the compressed download gets checked after decompressing it
+    if (!file.hash.isEmpty()) {
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, file.hash));
+    }
+    QObject::connect(dl.get(), &Net::Download::succeeded, [file, store] {
+        // before it's in the store, see RuntimeStore::adopt()
+        if (file.isExec)
+            setExecutable(file);
+        if (store)
+            store->adopt(file.path, QString::fromLatin1(file.hash.toHex()));
+    });
+    return dl;
+}
+}  // namespace
 
 namespace Java {
 ManifestDownloadTask::ManifestDownloadTask(QUrl url, QString final_path, QString checksumType, QString checksumHash)
-    : m_url(url), m_final_path(final_path), m_checksum_type(checksumType), m_checksum_hash(checksumHash)
-{}
+    : m_url(url)
+    , m_final_path(final_path)
+    , m_checksum_type(checksumType)
+    , m_checksum_hash(checksumHash)
+    , m_store(RuntimeStore::forRuntime(final_path))
+{
+    connect(&m_storeWatcher, &QFutureWatcher<Stored>::finished, this, [this] {
+        // aborted in the meantime
+        if (!isRunning())
+            return;
+        auto stored = m_storeWatcher.result();
+        m_useStore = stored.store.has_value();
+        if (m_useStore)
+            m_store = *stored.store;
+        downloadMissing(std::move(stored.missing));
+    });
+}
 
 void ManifestDownloadTask::executeTask()
 {
     setStatus(tr("Downloading Java"));
-    auto download = makeShared<NetJob>(QString("JRE::DownloadJava"), APPLICATION->network());
+    if (!m_network)
+        m_network = APPLICATION->network();
+    auto download = makeShared<NetJob>(QString("JRE::DownloadJava"), m_network);
     auto files = std::make_shared<QByteArray>();
 
     auto action = Net::Download::makeByteArray(m_url, files);
@@ -92,40 +134,116 @@ void ManifestDownloadTask::downloadJava(const QJsonDocument& doc)
                 QFile::link(path, file);
             }
         } else if (type == "file") {
-            // TODO download compressed version if it exists ?
-            auto raw = Json::ensureObject(Json::ensureObject(meta, "downloads"), "raw");
+            auto downloads = Json::ensureObject(meta, "downloads");
+            auto raw = Json::ensureObject(downloads, "raw");
+            auto lzma = Json::ensureObject(downloads, "lzma");
             auto isExec = Json::ensureBoolean(meta, "executable", false);
             auto url = Json::ensureString(raw, "url");
             if (!url.isEmpty() && QUrl(url).isValid()) {
-                auto f = File{ file, url, QByteArray::fromHex(Json::ensureString(raw, "sha1").toLatin1()), isExec };
+                auto f = File{ file, url, Json::ensureString(lzma, "url"), QByteArray::fromHex(Json::ensureString(raw, "sha1").toLatin1()),
+                               isExec };
                 toDownload.push_back(f);
             }
         }
     }
-    auto elementDownload = makeShared<NetJob>("JRE::FileDownload", APPLICATION->network());
+
+    // whatever another runtime was installed with already doesn't need to be downloaded again
+    m_storeWatcher.setFuture(WorkerPool::io().run(
+        [store = m_store, path = m_final_path, toDownload] { return placeStored(store, path, toDownload); }));
+}
+
+ManifestDownloadTask::Stored ManifestDownloadTask::placeStored(RuntimeStore store, QString runtimePath, std::vector<File> files)
+{
+    if (!store.isUsable())
+        return { std::nullopt, std::move(files) };
+
+    QStringList sha1s;
+    for (const auto& file : files) {
+        if (!file.hash.isEmpty())
+            sha1s << QString::fromLatin1(file.hash.toHex());
+    }
+    // before anything gets linked, so cleaning up the store doesn't take the objects away in the meantime
+    if (!store.setRefs(runtimePath, sha1s))
+        return { std::nullopt, std::move(files) };
+
+    std::vector<File> missing;
+    for (const auto& file : files) {
+        auto sha1 = QString::fromLatin1(file.hash.toHex());
+        if (file.hash.isEmpty() || !store.has(sha1) || !store.materialize(sha1, file.path, file.isExec))
+            missing.push_back(file);
+    }
+    qDebug() << files.size() - missing.size() << "of" << files.size() << "Java runtime files were in the store already";
+    return { store, std::move(missing) };
+}
+
+void ManifestDownloadTask::downloadMissing(std::vector<File> toDownload)
+{
+    if (toDownload.empty()) {
+        finishInstall();
+        return;
+    }
+    auto store = m_useStore ? std::make_optional(m_store) : std::nullopt;
+
+    // the compressed files are about half the size. whatever fails gets another round uncompressed,
+    // which also gets to ask the user about retrying
+    auto elementDownload = makeShared<NetJob>("JRE::FileDownload", m_network);
+    elementDownload->setPriority(Net::Scheduler::Priority::Bulk);
+    auto requests = std::make_shared<QHash<Net::NetRequest*, File>>();
+    bool anyCompressed = false;
     for (const auto& file : toDownload) {
-        auto dl = Net::Download::makeFile(file.url, file.path);
-        if (!file.hash.isEmpty()) {
-            dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, file.hash));
-        }
-        if (file.isExec) {
-            connect(dl.get(), &Net::Download::succeeded,
-                    [file] { QFile(file.path).setPermissions(QFile(file.path).permissions() | QFileDevice::Permissions(0x1111)); });
-        }
+        bool compressed = Net::LzmaFileSink::isSupported() && !file.lzmaUrl.isEmpty() && QUrl(file.lzmaUrl).isValid();
+        auto dl = makeFileDownload(file, compressed, store);
+        requests->insert(dl.get(), file);
         elementDownload->addNetAction(dl);
+        anyCompressed |= compressed;
     }
 
-    connect(elementDownload.get(), &Task::failed, this, &ManifestDownloadTask::emitFailed);
-    connect(elementDownload.get(), &Task::progress, this, &ManifestDownloadTask::setProgress);
-    connect(elementDownload.get(), &Task::stepProgress, this, &ManifestDownloadTask::propagateStepProgress);
-    connect(elementDownload.get(), &Task::status, this, &ManifestDownloadTask::setStatus);
-    connect(elementDownload.get(), &Task::details, this, &ManifestDownloadTask::setDetails);
+    if (!anyCompressed) {
+        connect(elementDownload.get(), &Task::failed, this, &ManifestDownloadTask::emitFailed);
+        downloadFiles(elementDownload);
+        return;
+    }
 
-    connect(elementDownload.get(), &Task::succeeded, this, &ManifestDownloadTask::emitSucceeded);
-    m_task = elementDownload;
+    elementDownload->setAskRetry(false);
+    connect(elementDownload.get(), &Task::failed, this, [this, job = elementDownload.get(), requests, store](QString reason) {
+        auto failed = job->getFailedActions();
+        if (failed.isEmpty()) {
+            emitFailed(reason);
+            return;
+        }
+        auto retry = makeShared<NetJob>("JRE::FileDownload", m_network);
+        retry->setPriority(Net::Scheduler::Priority::Bulk);
+        for (auto request : failed) {
+            const auto& file = (*requests)[request];
+            qWarning() << "Download of" << file.path << "failed, trying again uncompressed";
+            retry->addNetAction(makeFileDownload(file, false, store));
+        }
+        connect(retry.get(), &Task::failed, this, &ManifestDownloadTask::emitFailed);
+        downloadFiles(retry);
+    });
+    downloadFiles(elementDownload);
+}
+
+void ManifestDownloadTask::downloadFiles(NetJob::Ptr job)
+{
+    connect(job.get(), &Task::progress, this, &ManifestDownloadTask::setProgress);
+    connect(job.get(), &Task::stepProgress, this, &ManifestDownloadTask::propagateStepProgress);
+    connect(job.get(), &Task::status, this, &ManifestDownloadTask::setStatus);
+    connect(job.get(), &Task::details, this, &ManifestDownloadTask::setDetails);
+
+    connect(job.get(), &Task::succeeded, this, &ManifestDownloadTask::finishInstall);
+    m_task = job;
     m_task->start();
 }
 
+void ManifestDownloadTask::finishInstall()
+{
+    // an install is a good time to notice the runtimes that were removed since the last one
+    if (m_useStore)
+        WorkerPool::io().start([store = m_store] { store.collectGarbage(); }, WorkerPool::Priority::Low);
+    emitSucceeded();
+}
+
 bool ManifestDownloadTask::abort()
 {
     auto aborted = canAbort();
@@ -18,7 +18,16 @@
 
 #pragma once
 
+#include <QFutureWatcher>
+#include <QNetworkAccessManager>
 #include <QUrl>
+
+#include <optional>
+#include <vector>
+
+#include "QObjectPtr.h"
+#include "java/download/RuntimeStore.h"
+#include "net/NetJob.h"
 #include "tasks/Task.h"
 
 namespace Java {
@@ -26,6 +35,15 @@ namespace Java {
 class ManifestDownloadTask : public Task {
     Q_OBJECT
    public:
+    struct File {
+        QString path;
+        QString url;
+        // the same file, compressed. empty if the manifest doesn't have it
+        QString lzmaUrl;
+        QByteArray hash;
+        bool isExec;
+    };
+
     ManifestDownloadTask(QUrl url, QString final_path, QString checksumType = "", QString checksumHash = "");
     virtual ~ManifestDownloadTask() = default;
 
@@ -33,14 +51,35 @@ class ManifestDownloadTask : public Task {
     void executeTask() override;
     virtual bool abort() override;
 
+    // defaults to the application's
+    void setNetwork(shared_qobject_ptr<QNetworkAccessManager> network) { m_network = network; }
+
    private slots:
     void downloadJava(const QJsonDocument& doc);
 
+   private:
+    // what the store had, and what's left to download
+    struct Stored {
+        std::optional<RuntimeStore> store;
+        std::vector<File> missing;
+    };
+    // puts the files the store has in place. lots of file system work, so it runs on the thread pool
+    static Stored placeStored(RuntimeStore store, QString runtimePath, std::vector<File> files);
+
+    void downloadMissing(std::vector<File> files);
+    // runs a job downloading runtime files. failures are up to the caller
+    void downloadFiles(NetJob::Ptr job);
+    void finishInstall();
+
    protected:
     QUrl m_url;
     QString m_final_path;
     QString m_checksum_type;
     QString m_checksum_hash;
     Task::Ptr m_task;
+    shared_qobject_ptr<QNetworkAccessManager> m_network;
+    RuntimeStore m_store;
+    bool m_useStore = false;
+    QFutureWatcher<Stored> m_storeWatcher;
 };
 }  // namespace Java
\ No newline at end of file
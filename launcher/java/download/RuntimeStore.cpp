@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "java/download/RuntimeStore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSet>
+#include <QVector>
+
+#include "modplatform/helpers/HashUtils.h"
+#include "tasks/WorkerPool.h"
+
+namespace Java {
+
+namespace {
+const int s_sha1Length = 40;
+}
+
+RuntimeStore::RuntimeStore(const QString& javaPath)
+    : m_javaPath(QDir(javaPath).absolutePath()), m_path(FS::PathCombine(m_javaPath, ".objects"))
+{}
+
+RuntimeStore RuntimeStore::forRuntime(const QString& runtimePath)
+{
+    return RuntimeStore(QFileInfo(runtimePath).absolutePath());
+}
+
+bool RuntimeStore::isUsable()
+{
+    if (!FS::ensureFolderPathExists(m_path)) {
+        qWarning() << "Could not create the Java runtime store at" << m_path;
+        return false;
+    }
+    m_method = FS::placeMethod(m_path, m_javaPath);
+    return m_method != FS::PlaceMethod::Copy;
+}
+
+FS::PlaceMethod RuntimeStore::ownMethod(bool executable) const
+{
+    return executable && m_method == FS::PlaceMethod::HardLink ? FS::PlaceMethod::Copy : m_method;
+}
+
+QString RuntimeStore::objectPath(const QString& sha1) const
+{
+    return FS::PathCombine(m_path, sha1.left(2), sha1);
+}
+
+bool RuntimeStore::has(const QString& sha1) const
+{
+    return QFileInfo(objectPath(sha1)).isFile();
+}
+
+bool RuntimeStore::materialize(const QString& sha1, const QString& target, bool executable) const
+{
+    QFile::remove(target);
+    FS::ensureFilePathExists(target);
+    // executables need permissions of their own
+    if (!FS::placeFile(objectPath(sha1), target, ownMethod(executable), !executable))
+        return false;
+    if (executable)
+        QFile::setPermissions(target, QFile::permissions(target) | QFileDevice::Permissions(0x1111));
+    return true;
+}
+
+bool RuntimeStore::adopt(const QString& file, const QString& sha1) const
+{
+    if (sha1.size() != s_sha1Length)
+        return false;
+    auto object = objectPath(sha1);
+    if (QFileInfo(object).isFile())
+        return true;
+
+    // placed under another name first, so nobody can see a half written object
+    auto temporary = object + ".tmp";
+    FS::ensureFilePathExists(object);
+    // an executable can't be linked, the object must not be executable
+    bool executable = QFileInfo(file).isExecutable();
+    if (!FS::placeFile(file, temporary, ownMethod(executable), !executable)) {
+        QFile::remove(temporary);
+        return false;
+    }
+    if (executable)
+        QFile::setPermissions(temporary, QFile::permissions(temporary) & ~QFileDevice::Permissions(0x1111));
+    if (!QFile::rename(temporary, object)) {
+        QFile::remove(temporary);
+        // somebody else got there first
+        return QFileInfo(object).isFile();
+    }
+    return true;
+}
+
+bool RuntimeStore::ingest(const QString& runtimePath) const
+{
+    struct Entry {
+        QString path;
+        QString sha1;
+    };
+    QVector<Entry> files;
+    QDirIterator it(runtimePath, QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        files.append({ it.next(), QString() });
+
+    WorkerPool::instance().blockingMap(files, [](Entry& entry) {
+        QFile file(entry.path);
+        entry.sha1 = Hashing::hash(&file, Hashing::Algorithm::Sha1);
+    });
+
+    QStringList sha1s;
+    for (const auto& entry : files) {
+        if (entry.sha1.size() == s_sha1Length)
+            sha1s << entry.sha1;
+    }
+    if (!setRefs(runtimePath, sha1s))
+        return false;
+
+    int shared = 0;
+    for (const auto& entry : files) {
+        if (entry.sha1.size() != s_sha1Length)
+            continue;
+        if (!has(entry.sha1)) {
+            adopt(entry.path, entry.sha1);
+            continue;
+        }
+
+        auto permissions = QFile::permissions(entry.path);
+        bool executable = QFileInfo(entry.path).isExecutable();
+        auto temporary = entry.path + ".tmp";
+        if (!materialize(entry.sha1, temporary, executable) || !FS::move(temporary, entry.path)) {
+            QFile::remove(temporary);
+            continue;
+        }
+        // a file of its own keeps whatever the extracted one was allowed to do. a link has the object's permissions
+        if (FS::hardLinkCount(entry.path) <= 1)
+            QFile::setPermissions(entry.path, permissions);
+        shared++;
+    }
+    qDebug() << "Added" << files.size() << "files of" << runtimePath << "to the Java runtime store," << shared << "were there already";
+    return true;
+}
+
+QString RuntimeStore::refsPath(const QString& runtimePath) const
+{
+    return FS::PathCombine(m_path, "refs", QFileInfo(runtimePath).fileName());
+}
+
+QString RuntimeStore::lockPath() const
+{
+    return FS::PathCombine(m_path, "lock");
+}
+
+bool RuntimeStore::setRefs(const QString& runtimePath, const QStringList& sha1s) const
+{
+    FS::ensureFolderPathExists(m_path);
+    QLockFile lock(lockPath());
+    // collecting the garbage can take a while
+    lock.setStaleLockTime(0);
+    if (!lock.lock()) {
+        qWarning() << "Could not lock the Java runtime store at" << m_path;
+        return false;
+    }
+    try {
+        FS::write(refsPath(runtimePath), sha1s.join('\n').toLatin1());
+    } catch (const FS::FileSystemException& e) {
+        qWarning() << "Could not record the files of" << runtimePath << ":" << e.cause();
+        return false;
+    }
+    return true;
+}
+
+int RuntimeStore::collectGarbage() const
+{
+    // so no runtime can refer to more objects between reading the refs and removing what they don't refer to
+    QLockFile lock(lockPath());
+    lock.setStaleLockTime(0);
+    if (!QDir(m_path).exists() || !lock.lock())
+        return 0;
+
+    QSet<QString> used;
+    QDir refs(FS::PathCombine(m_path, "refs"));
+    for (const auto& runtime : refs.entryList(QDir::Files)) {
+        auto refsFile = refs.absoluteFilePath(runtime);
+        if (!QFileInfo(FS::PathCombine(m_javaPath, runtime)).isDir()) {
+            QFile::remove(refsFile);
+            continue;
+        }
+        QFile file(refsFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            // can't tell what it uses, so keep everything
+            qWarning() << "Could not read" << refsFile << ", not cleaning up the Java runtime store";
+            return 0;
+        }
+        for (const auto& sha1 : file.readAll().split('\n'))
+            used.insert(QString::fromLatin1(sha1));
+    }
+
+    int removed = 0;
+    QDir store(m_path);
+    for (const auto& prefix : store.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        // that's "refs"
+        if (prefix.size() != 2)
+            continue;
+        QDir objects(store.absoluteFilePath(prefix));
+        // leftover temporary files are named differently, and might be in use
+        for (const auto& object : objects.entryList(QDir::Files | QDir::Hidden | QDir::System)) {
+            if (object.size() != s_sha1Length || used.contains(object))
+                continue;
+            if (QFile::remove(objects.absoluteFilePath(object)))
+                removed++;
+        }
+        store.rmdir(prefix);
+    }
+    if (removed > 0)
+        qDebug() << "Removed" << removed << "unused files from the Java runtime store";
+    return removed;
+}
+
+}  // namespace Java
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "FileSystem.h"
+
+namespace Java {
+
+/**
+ * Content addressed storage for the files of the downloaded Java runtimes.
+ *
+ * Runtimes, especially different versions of the same one, have a lot of identical files. Every file of an installed
+ * runtime gets an entry in `<java folder>/.objects/<first two hex digits of its SHA-1>/<SHA-1>`, and the file in the
+ * runtime is a clone or a hard link of that object. Runtimes installed later reuse the objects that are already there
+ * instead of downloading and storing them again.
+ *
+ * `.objects/refs/<runtime folder name>` lists the objects each runtime was installed with. collectGarbage() removes the
+ * objects no installed runtime refers to anymore. That can never break a runtime, each one has its own link to its files.
+ *
+ * The store only gets used where files can be cloned or hard linked, a store of plain copies would just double the space taken.
+ *
+ * Hard links share their permissions with the object, so those are never changed once an object is in the store. Objects are
+ * not executable, the executable files of a runtime are clones or copies with permissions of their own.
+ */
+class RuntimeStore {
+   public:
+    /* The store shared by all the runtimes in `javaPath`. */
+    explicit RuntimeStore(const QString& javaPath);
+    /* The store shared by the runtime in `runtimePath` and the other runtimes next to it. */
+    static RuntimeStore forRuntime(const QString& runtimePath);
+
+    QString path() const { return m_path; }
+
+    /* Whether the runtimes can share files with the store. Creates the store if it doesn't exist yet. */
+    bool isUsable();
+
+    QString objectPath(const QString& sha1) const;
+    bool has(const QString& sha1) const;
+
+    /* Puts the object at `target`, replacing whatever is there. */
+    bool materialize(const QString& sha1, const QString& target, bool executable = false) const;
+    /* Adds `file`, which has the given SHA-1, to the store. Does nothing if the store has it already.
+     * The runtime has to refer to it already, see setRefs(). */
+    bool adopt(const QString& file, const QString& sha1) const;
+
+    /* Adds all files of an extracted runtime to the store, turning the ones the store already has into links to it,
+     * and records them as the runtime's. Hashes the files on the thread pool and blocks until it's done. */
+    bool ingest(const QString& runtimePath) const;
+
+    /* Records the objects the runtime in `runtimePath` is installed with. Has to happen before they're adopted or
+     * materialized, so collectGarbage() doesn't take them away in the meantime. */
+    bool setRefs(const QString& runtimePath, const QStringList& sha1s) const;
+
+    /* Forgets the runtimes that were removed and deletes every object none of the remaining ones refers to.
+     * Returns the number of objects removed. Blocks setRefs() (in any launcher) while it runs, don't call it on the GUI thread. */
+    int collectGarbage() const;
+
+   private:
+    QString refsPath(const QString& runtimePath) const;
+    // held while the refs are written or collected
+    QString lockPath() const;
+    // how to place a file, executables can't share their permissions with the object
+    FS::PlaceMethod ownMethod(bool executable) const;
+
+   private:
+    QString m_javaPath;
+    QString m_path;
+    FS::PlaceMethod m_method = FS::PlaceMethod::Copy;
+};
+
+}  // namespace Java
@@ -38,13 +38,19 @@
 #include "launch/LaunchTask.h"
 #include <assert.h>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QEventLoop>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include "FileSystem.h"
 #include "MessageLevel.h"
 #include "tasks/Task.h"
+#include "tasks/WorkerPool.h"
+
+// number of launches whose complete logs are kept around
+static const int s_keptLogArchives = 5;
 
 void LaunchTask::init()
 {
@@ -131,16 +137,12 @@ void LaunchTask::onProgressReportingRequested()
 
 void LaunchTask::setCensorFilter(QMap<QString, QString> filter)
 {
-    m_censorFilter = filter;
+    m_censor = LogCensor(filter);
 }
 
 QString LaunchTask::censorPrivateInfo(QString in)
 {
-    auto iter = m_censorFilter.begin();
-    while (iter != m_censorFilter.end()) {
-        in.replace(iter.key(), iter.value());
-        iter++;
-    }
+    m_censor.censor(in);
     return in;
 }
 
@@ -214,14 +216,44 @@ shared_qobject_ptr<LogModel> LaunchTask::getLogModel()
     return m_logModel;
 }
 
+std::shared_ptr<LogArchive> LaunchTask::getLogArchive()
+{
+    if (!m_logArchive) {
+        auto archives = FS::PathCombine(m_instance->instanceRoot(), "launcher_logs");
+        auto name = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss-zzz");
+        m_logArchive = std::make_shared<LogArchive>(FS::PathCombine(archives, name));
+        // this one is the newest, so it stays
+        WorkerPool::io().start([archives] { LogArchive::prune(archives, s_keptLogArchives); }, WorkerPool::Priority::Low);
+    }
+    return m_logArchive;
+}
+
 void LaunchTask::onLogLines(const QStringList& lines, MessageLevel::Enum defaultLevel)
 {
-    for (auto& line : lines) {
-        onLogLine(line, defaultLevel);
+    QVector<LogModel::Line> batch;
+    batch.reserve(lines.size());
+    for (auto line : lines) {
+        auto level = prepareLogLine(line, defaultLevel);
+        batch.append({ level, line });
     }
+
+    auto archive = getLogArchive();
+    auto first = archive->lineCount();
+    archive->append(batch);
+    getLogModel()->append(batch, first);
 }
 
 void LaunchTask::onLogLine(QString line, MessageLevel::Enum level)
+{
+    level = prepareLogLine(line, level);
+
+    auto archive = getLogArchive();
+    auto first = archive->lineCount();
+    archive->append(level, line);
+    getLogModel()->append({ { level, line } }, first);
+}
+
+MessageLevel::Enum LaunchTask::prepareLogLine(QString& line, MessageLevel::Enum level)
 {
     // if the launcher part set a log level, use it
     auto innerLevel = MessageLevel::fromLine(line);
@@ -235,21 +267,24 @@ void LaunchTask::onLogLine(QString line, MessageLevel::Enum level)
     }
 
     // censor private user info
-    line = censorPrivateInfo(line);
+    m_censor.censor(line);
 
-    auto& model = *getLogModel();
-    model.append(level, line);
+    return level;
 }
 
 void LaunchTask::emitSucceeded()
 {
     m_instance->setRunning(false);
+    if (m_logArchive)
+        m_logArchive->flush();
     Task::emitSucceeded();
 }
 
 void LaunchTask::emitFailed(QString reason)
 {
     m_instance->setRunning(false);
+    if (m_logArchive)
+        m_logArchive->flush();
     m_instance->setCrashed(true);
     Task::emitFailed(reason);
 }
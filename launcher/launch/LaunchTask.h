@@ -41,6 +41,8 @@
 #include <QProcess>
 #include "BaseInstance.h"
 #include "LaunchStep.h"
+#include "LogArchive.h"
+#include "LogCensor.h"
 #include "LogModel.h"
 #include "MessageLevel.h"
 
@@ -86,6 +88,11 @@ class LaunchTask : public Task {
 
     shared_qobject_ptr<LogModel> getLogModel();
 
+    /**
+     * @brief the complete log of this launch, kept on disk (the log model only holds the last lines)
+     */
+    std::shared_ptr<LogArchive> getLogArchive();
+
    public:
     void substituteVariables(QStringList& args) const;
     void substituteVariables(QString& cmd) const;
@@ -114,12 +121,15 @@ class LaunchTask : public Task {
 
    private: /*methods */
     void finalizeSteps(bool successful, const QString& error);
+    /* Works out the level of a line of output and censors it in place. */
+    MessageLevel::Enum prepareLogLine(QString& line, MessageLevel::Enum level);
 
    protected: /* data */
     MinecraftInstancePtr m_instance;
     shared_qobject_ptr<LogModel> m_logModel;
+    std::shared_ptr<LogArchive> m_logArchive;
     QList<shared_qobject_ptr<LaunchStep>> m_steps;
-    QMap<QString, QString> m_censorFilter;
+    LogCensor m_censor;
     int currentStep = -1;
     State state = NotStarted;
     qint64 m_pid = -1;
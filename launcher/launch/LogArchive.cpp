@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogArchive.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "FileSystem.h"
+#include "GZip.h"
+#include "tasks/WorkerPool.h"
+
+static const quint32 s_magic = 0x4c4f4741;  // "LOGA"
+static const quint32 s_version = 1;
+
+/* The segments on their way to disk. They are written one after the other, in the order they were queued, so writing
+ * the open segment again can't be overtaken by an older version of it. */
+struct LogArchive::Writes {
+    QString directory;
+    QMutex lock;
+    std::deque<std::pair<int, std::shared_ptr<const Segment>>> queue;
+    // the newest version of every segment in the queue (or being written), by number
+    QMap<int, std::shared_ptr<const Segment>> unwritten;
+    bool writing = false;
+    // the job draining the queue, which gets dropped instead if the pool shuts down first
+    QFuture<void> job;
+};
+
+QString LogArchive::Segment::lineText(int line) const
+{
+    quint32 start = line == 0 ? 0 : ends[line - 1];
+    return QString::fromUtf8(text.constData() + start, ends[line] - start);
+}
+
+LogModel::Line LogArchive::Segment::line(int line) const
+{
+    return { static_cast<MessageLevel::Enum>(levels[line]), lineText(line) };
+}
+
+LogArchive::LogArchive(const QString& directory) : m_directory(directory), m_writes(std::make_shared<Writes>())
+{
+    m_writes->directory = m_directory;
+    if (!FS::ensureFolderPathExists(m_directory)) {
+        qWarning() << "Could not create log archive directory" << m_directory;
+        return;
+    }
+
+    // pick up where an earlier archive in the same directory left off
+    auto files = QDir(m_directory).entryList({ "*.seg" }, QDir::Files, QDir::Name);
+    if (files.isEmpty())
+        return;
+
+    m_sealed = files.size() - 1;
+    if (!readSegment(segmentPath(m_directory, m_sealed), m_open)) {
+        m_open = Segment();
+    } else if (m_open.size() == s_segmentLines) {
+        m_sealed++;
+        m_open = Segment();
+    }
+}
+
+LogArchive::~LogArchive()
+{
+    // the writes don't need the archive, they finish on their own
+    flush();
+}
+
+QString LogArchive::segmentPath(const QString& directory, int segment)
+{
+    return FS::PathCombine(directory, QString("%1.seg").arg(segment, 6, 10, QChar('0')));
+}
+
+void LogArchive::append(MessageLevel::Enum level, const QString& line)
+{
+    m_open.text.append(line.toUtf8());
+    m_open.ends.append(m_open.text.size());
+    m_open.levels.append(static_cast<char>(level));
+
+    if (m_open.size() == s_segmentLines)
+        seal();
+}
+
+void LogArchive::append(const QVector<LogModel::Line>& lines)
+{
+    for (const auto& line : lines)
+        append(line.level, line.text);
+}
+
+qint64 LogArchive::lineCount() const
+{
+    return qint64(m_sealed) * s_segmentLines + m_open.size();
+}
+
+LogArchive::Reader LogArchive::reader() const
+{
+    Reader reader;
+    reader.m_directory = m_directory;
+    reader.m_sealed = m_sealed;
+    // shares the data with m_open until the next append
+    reader.m_open = std::make_shared<const Segment>(m_open);
+    QMutexLocker locker(&m_writes->lock);
+    reader.m_unwritten = m_writes->unwritten;
+    return reader;
+}
+
+qint64 LogArchive::Reader::lineCount() const
+{
+    return qint64(m_sealed) * s_segmentLines + m_open->size();
+}
+
+LogModel::Line LogArchive::Reader::line(qint64 index)
+{
+    if (index < 0 || index >= lineCount())
+        return { MessageLevel::Unknown, QString() };
+
+    auto* seg = segment(index / s_segmentLines);
+    if (!seg)
+        return { MessageLevel::Unknown, QString() };
+    return seg->line(index % s_segmentLines);
+}
+
+QVector<LogModel::Line> LogArchive::Reader::lines(qint64 first, int count)
+{
+    QVector<LogModel::Line> result;
+    if (first < 0)
+        first = 0;
+    qint64 end = qMin(first + count, lineCount());
+    if (first >= end)
+        return result;
+
+    result.reserve(end - first);
+    while (first < end) {
+        auto* seg = segment(first / s_segmentLines);
+        if (!seg)
+            break;
+        qint64 base = (first / s_segmentLines) * s_segmentLines;
+        int last = static_cast<int>(qMin<qint64>(end - base, seg->size()));
+        for (int i = static_cast<int>(first - base); i < last; i++)
+            result.append(seg->line(i));
+        first = base + s_segmentLines;
+    }
+    return result;
+}
+
+qint64 LogArchive::Reader::find(const QString& text, qint64 from, bool reverse, Qt::CaseSensitivity cs)
+{
+    const qint64 count = lineCount();
+    if (text.isEmpty() || from < 0 || from >= count)
+        return -1;
+
+    qint64 current = from;
+    while (current >= 0 && current < count) {
+        int number = current / s_segmentLines;
+        qint64 base = qint64(number) * s_segmentLines;
+        auto* seg = segment(number);
+        if (!seg)
+            return -1;
+
+        // most segments won't contain the text at all, so check all of it at once before going line by line.
+        // this can only give false positives for matches spanning two lines
+        if (QString::fromUtf8(seg->text).contains(text, cs)) {
+            int i = static_cast<int>(current - base);
+            for (; i >= 0 && i < seg->size(); i += reverse ? -1 : 1) {
+                if (seg->lineText(i).contains(text, cs))
+                    return base + i;
+            }
+        }
+
+        current = reverse ? base - 1 : base + s_segmentLines;
+    }
+    return -1;
+}
+
+bool LogArchive::Reader::writeTo(QIODevice* out)
+{
+    int segments = m_sealed + (m_open->size() > 0 ? 1 : 0);
+    for (int number = 0; number < segments; number++) {
+        auto* seg = segment(number);
+        if (!seg)
+            return false;
+
+        QByteArray buffer;
+        buffer.reserve(seg->text.size() + seg->size());
+        quint32 start = 0;
+        for (auto end : seg->ends) {
+            buffer.append(seg->text.constData() + start, end - start);
+            buffer.append('\n');
+            start = end;
+        }
+        if (out->write(buffer) != buffer.size())
+            return false;
+    }
+    return true;
+}
+
+const LogArchive::Segment* LogArchive::Reader::segment(int number)
+{
+    if (number == m_sealed)
+        return m_open.get();
+    if (auto unwritten = m_unwritten.value(number))
+        return unwritten.get();
+    if (number == m_cachedIndex)
+        return &m_cached;
+
+    // everything else was written before this reader was made
+    m_cachedIndex = -1;
+    auto path = segmentPath(m_directory, number);
+    if (!readSegment(path, m_cached)) {
+        qWarning() << "Could not read log archive segment" << path;
+        return nullptr;
+    }
+    m_cachedIndex = number;
+    return &m_cached;
+}
+
+void LogArchive::flush()
+{
+    if (m_open.size() == 0)
+        return;
+    // the open segment gets written again, with more lines, the next time around
+    queueWrite(m_sealed, std::make_shared<const Segment>(m_open));
+}
+
+void LogArchive::prune(const QString& parentDirectory, int keep)
+{
+    QDir parent(parentDirectory);
+    auto archives = parent.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::Reversed);
+    for (int i = keep; i < archives.size(); i++) {
+        if (!FS::deletePath(parent.absoluteFilePath(archives[i])))
+            qWarning() << "Could not remove old log archive" << archives[i];
+    }
+}
+
+void LogArchive::seal()
+{
+    // this is called for whatever the game prints, so it queues up behind the writes instead of waiting for them
+    queueWrite(m_sealed, std::make_shared<const Segment>(std::move(m_open)));
+    m_open = Segment();
+    m_sealed++;
+}
+
+void LogArchive::queueWrite(int number, std::shared_ptr<const Segment> segment)
+{
+    QMutexLocker locker(&m_writes->lock);
+    m_writes->unwritten.insert(number, segment);
+    m_writes->queue.emplace_back(number, std::move(segment));
+    if (m_writes->writing)
+        return;
+    m_writes->writing = true;
+    m_writes->job = WorkerPool::io().run([writes = m_writes] { drainWrites(writes); }, WorkerPool::Priority::Low);
+}
+
+void LogArchive::drainWrites(std::shared_ptr<Writes> writes)
+{
+    QMutexLocker locker(&writes->lock);
+    while (!writes->queue.empty()) {
+        auto [number, segment] = std::move(writes->queue.front());
+        writes->queue.pop_front();
+
+        locker.unlock();
+        auto path = segmentPath(writes->directory, number);
+        if (!writeSegment(path, *segment))
+            qWarning() << "Could not write log archive segment" << path;
+        locker.relock();
+
+        // unless a newer version of it got queued meanwhile, it's on disk now
+        if (writes->unwritten.value(number) == segment)
+            writes->unwritten.remove(number);
+    }
+    writes->writing = false;
+}
+
+void LogArchive::waitForWrites()
+{
+    QMutexLocker locker(&m_writes->lock);
+    while (m_writes->writing) {
+        auto job = m_writes->job;
+        locker.unlock();
+        job.waitForFinished();
+        // nothing queues another job while this one is pending, so what it left is written from here
+        if (job.isCanceled())
+            drainWrites(m_writes);
+        locker.relock();
+    }
+}
+
+bool LogArchive::writeSegment(const QString& path, const Segment& segment)
+{
+    QByteArray compressed;
+    if (!GZip::zip(segment.text, compressed))
+        return false;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << s_magic << s_version << segment.ends << segment.levels << compressed;
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool LogArchive::readSegment(const QString& path, Segment& segment)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != s_magic || version != s_version)
+        return false;
+
+    QByteArray compressed;
+    in >> segment.ends >> segment.levels >> compressed;
+    if (in.status() != QDataStream::Ok || segment.ends.size() != segment.levels.size())
+        return false;
+
+    if (!GZip::unzip(compressed, segment.text))
+        return false;
+    return segment.ends.isEmpty() || segment.ends.last() == static_cast<quint32>(segment.text.size());
+}
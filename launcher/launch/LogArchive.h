@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QFuture>
+#include <QIODevice>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include <memory>
+
+#include "LogModel.h"
+#include "MessageLevel.h"
+
+/**
+ * The complete log of one launch, kept on disk.
+ *
+ * LogModel only holds the last few thousand lines for display. Everything the game prints also goes here:
+ * lines are collected into segments of a fixed number of lines, and every full segment is compressed and written
+ * out on a worker thread (so is the open segment, on flush()). Appending never waits for those writes, they queue up
+ * behind each other. Only the segments that are being filled or written stay in memory, so the full history can be
+ * paged through, searched and exported no matter how much the game logs.
+ *
+ * Reading goes through a Reader, which can be used on any thread while lines keep being appended here.
+ *
+ * Segments are files named `<number>.seg` in the archive directory. Each holds a small index (line end offsets and
+ * levels) followed by the gzipped UTF-8 text of its lines.
+ */
+class LogArchive {
+   private /* types */:
+    struct Segment {
+        QByteArray text;
+        // end offset of every line in `text`
+        QVector<quint32> ends;
+        // one MessageLevel::Enum per line
+        QByteArray levels;
+
+        int size() const { return ends.size(); }
+        QString lineText(int line) const;
+        LogModel::Line line(int line) const;
+    };
+    struct Writes;
+
+   public:
+    // lines per segment
+    static const int s_segmentLines = 16384;
+
+    /** The archive as it was when the reader was made. Reading decompresses segments from disk, so better not do it
+     *  on the GUI thread. Only the last segment read is kept in memory. */
+    class Reader {
+       public:
+        qint64 lineCount() const;
+
+        LogModel::Line line(qint64 index);
+        /* Up to `count` lines, starting at `first`. */
+        QVector<LogModel::Line> lines(qint64 first, int count);
+
+        /* Index of the first line from `from` on (or backwards from it, if `reverse`) that contains `text`, or -1.
+         * Only one segment is decompressed at a time. */
+        qint64 find(const QString& text, qint64 from, bool reverse, Qt::CaseSensitivity cs = Qt::CaseInsensitive);
+
+        /* Writes the whole log as newline separated UTF-8, one segment at a time. */
+        bool writeTo(QIODevice* out);
+
+       private:
+        friend class LogArchive;
+        // the segment with the given number, loading it from disk if needed. nullptr if it can't be read
+        const Segment* segment(int number);
+
+        QString m_directory;
+        int m_sealed = 0;
+        std::shared_ptr<const Segment> m_open;
+        // the segments that weren't on disk yet
+        QMap<int, std::shared_ptr<const Segment>> m_unwritten;
+
+        Segment m_cached;
+        int m_cachedIndex = -1;
+    };
+
+    /* Opens the archive in `directory`, picking up any segments already written there. */
+    explicit LogArchive(const QString& directory);
+    ~LogArchive();
+
+    QString directory() const { return m_directory; }
+
+    void append(MessageLevel::Enum level, const QString& line);
+    void append(const QVector<LogModel::Line>& lines);
+
+    qint64 lineCount() const;
+
+    Reader reader() const;
+
+    /* Writes out everything appended so far, including the segment that is still being filled.
+     * This doesn't wait for the write, see waitForWrites(). */
+    void flush();
+    /* Waits until the writes queued so far are done. */
+    void waitForWrites();
+
+    /* Removes all but the `keep` newest archives in `parentDirectory`. This goes through the whole of them,
+     * so better not do it on the GUI thread. */
+    static void prune(const QString& parentDirectory, int keep);
+
+   private:
+    static QString segmentPath(const QString& directory, int segment);
+    void seal();
+    void queueWrite(int segment, std::shared_ptr<const Segment> contents);
+    static void drainWrites(std::shared_ptr<Writes> writes);
+
+    static bool writeSegment(const QString& path, const Segment& segment);
+    static bool readSegment(const QString& path, Segment& segment);
+
+   private: /* data */
+    QString m_directory;
+    // number of full segments, all of them on disk or on their way there
+    int m_sealed = 0;
+    // the segment being filled
+    Segment m_open;
+
+    // shared with the job writing the segments out, which outlives the archive
+    std::shared_ptr<Writes> m_writes;
+
+    Q_DISABLE_COPY(LogArchive)
+};
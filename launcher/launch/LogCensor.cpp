@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogCensor.h"
+
+#include <QQueue>
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+LogCensor::LogCensor(const QMap<QString, QString>& filter)
+{
+    if (filter.isEmpty())
+        return;
+
+    // root
+    m_nodes.append(Node());
+
+    // build the trie
+    for (auto it = filter.constBegin(); it != filter.constEnd(); ++it) {
+        const auto& secret = it.key();
+        if (secret.isEmpty())
+            continue;
+
+        int node = 0;
+        for (QChar c : secret) {
+            int next = child(node, c.unicode());
+            if (next == -1) {
+                next = m_nodes.size();
+                m_nodes.append(Node());
+                m_nodes[node].children.append({ c.unicode(), next });
+            }
+            node = next;
+        }
+        m_nodes[node].secret = m_replacements.size();
+        m_lengths.append(secret.size());
+        m_replacements.append(it.value());
+    }
+
+    // and the fail / dictionary links, breadth first
+    QQueue<int> queue;
+    for (const auto& [c, next] : m_nodes[0].children)
+        queue.enqueue(next);
+
+    while (!queue.isEmpty()) {
+        int node = queue.dequeue();
+        for (const auto& [c, next] : m_nodes[node].children) {
+            int fail = m_nodes[node].fail;
+            int target;
+            while ((target = child(fail, c)) == -1 && fail != 0)
+                fail = m_nodes[fail].fail;
+            m_nodes[next].fail = target == -1 ? 0 : target;
+
+            const auto& failNode = m_nodes[m_nodes[next].fail];
+            m_nodes[next].dictLink = failNode.secret != -1 ? m_nodes[next].fail : failNode.dictLink;
+
+            queue.enqueue(next);
+        }
+    }
+}
+
+int LogCensor::child(int node, char16_t c) const
+{
+    for (const auto& [key, next] : m_nodes[node].children) {
+        if (key == c)
+            return next;
+    }
+    return -1;
+}
+
+bool LogCensor::censor(QString& line) const
+{
+    if (m_replacements.isEmpty())
+        return false;
+
+    struct Match {
+        int start;
+        int secret;
+    };
+    QVarLengthArray<Match, 8> matches;
+
+    const QChar* data = line.constData();
+    const int size = line.size();
+    int node = 0;
+    for (int i = 0; i < size; i++) {
+        char16_t c = data[i].unicode();
+        int next;
+        while ((next = child(node, c)) == -1 && node != 0)
+            node = m_nodes[node].fail;
+        node = next == -1 ? 0 : next;
+
+        for (int out = m_nodes[node].secret != -1 ? node : m_nodes[node].dictLink; out != -1; out = m_nodes[out].dictLink) {
+            int secret = m_nodes[out].secret;
+            matches.append({ i + 1 - m_lengths[secret], secret });
+        }
+    }
+
+    if (matches.isEmpty())
+        return false;
+
+    std::sort(matches.begin(), matches.end(), [this](const Match& a, const Match& b) {
+        if (a.start != b.start)
+            return a.start < b.start;
+        return m_lengths[a.secret] > m_lengths[b.secret];
+    });
+
+    QString result;
+    result.reserve(size);
+    int pos = 0;
+    for (const auto& match : matches) {
+        // overlaps with something we already replaced
+        if (match.start < pos)
+            continue;
+        result.append(data + pos, match.start - pos);
+        result.append(m_replacements[match.secret]);
+        pos = match.start + m_lengths[match.secret];
+    }
+    result.append(data + pos, size - pos);
+
+    line = result;
+    return true;
+}
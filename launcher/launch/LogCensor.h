@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+/**
+ * Replaces private information (tokens, profile IDs, ...) in log lines.
+ *
+ * All secrets are compiled into a single Aho-Corasick automaton when the filter is set,
+ * so censoring a line is one pass over it, no matter how many secrets there are.
+ */
+class LogCensor {
+   public:
+    LogCensor() = default;
+    // maps every secret to its replacement
+    explicit LogCensor(const QMap<QString, QString>& filter);
+
+    bool isEmpty() const { return m_replacements.isEmpty(); }
+
+    /* Censors the line in place.
+     * Where secrets overlap, the leftmost one wins, and the longest one of those starting at the same place.
+     * Returns whether anything was replaced. If not, the line is left alone and nothing is allocated. */
+    bool censor(QString& line) const;
+
+    QString censored(QString line) const
+    {
+        censor(line);
+        return line;
+    }
+
+   private:
+    struct Node {
+        // there are only a few secrets, so most nodes have a single child
+        QVector<QPair<char16_t, int>> children;
+        int fail = 0;
+        // secret ending exactly at this node, if any
+        int secret = -1;
+        // closest node on the fail chain that ends a secret
+        int dictLink = -1;
+    };
+
+    int child(int node, char16_t c) const;
+
+    QVector<Node> m_nodes;
+    QVector<int> m_lengths;
+    QVector<QString> m_replacements;
+};
@@ -1,8 +1,17 @@
 #include "LogModel.h"
 
+#include <algorithm>
+
+// lines per storage chunk
+static const int s_chunkLines = 4096;
+// how often views are updated, about once per frame
+static const int s_flushInterval = 16;
+
 LogModel::LogModel(QObject* parent) : QAbstractListModel(parent)
 {
-    m_content.resize(m_maxLines);
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(s_flushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogModel::flush);
 }
 
 int LogModel::rowCount(const QModelIndex& parent) const
@@ -18,43 +27,141 @@ QVariant LogModel::data(const QModelIndex& index, int role) const
     if (index.row() < 0 || index.row() >= m_numLines)
         return QVariant();
 
-    auto row = index.row();
-    auto realRow = (row + m_firstLine) % m_maxLines;
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
-        return m_content[realRow].line;
+        return lineAt(index.row());
     }
     if (role == LevelRole) {
-        return m_content[realRow].level;
+        return levelAt(index.row());
     }
 
     return QVariant();
 }
 
+QString LogModel::lineAt(int row) const
+{
+    int line = m_firstLine + row;
+    const Chunk& chunk = m_chunks[line / s_chunkLines];
+    int index = line % s_chunkLines;
+    int start = index == 0 ? 0 : chunk.ends[index - 1];
+    return QString::fromUtf8(chunk.text.constData() + start, chunk.ends[index] - start);
+}
+
+MessageLevel::Enum LogModel::levelAt(int row) const
+{
+    int line = m_firstLine + row;
+    return static_cast<MessageLevel::Enum>(m_chunks[line / s_chunkLines].levels[line % s_chunkLines]);
+}
+
+qint64 LogModel::archiveLineAt(int row) const
+{
+    int line = m_firstLine + row;
+    return m_chunks[line / s_chunkLines].archiveLines[line % s_chunkLines];
+}
+
+void LogModel::archiveRange(qint64& first, qint64& end) const
+{
+    first = end = -1;
+    // the launcher's own messages are few and far between, so these stop after a row or two
+    for (int row = 0; row < m_numLines && first < 0; row++)
+        first = archiveLineAt(row);
+    for (int row = m_numLines - 1; row >= 0 && end < 0; row--) {
+        auto line = archiveLineAt(row);
+        if (line >= 0)
+            end = line + 1;
+    }
+}
+
+void LogModel::appendLine(MessageLevel::Enum level, const QString& line, qint64 archiveLine)
+{
+    const QString* text = &line;
+    int total = m_numLines + m_pendingLines;
+    if (m_stopOnOverflow && total >= m_maxLines) {
+        // nothing more to do, the buffer is full
+        return;
+    } else if (m_stopOnOverflow && total == m_maxLines - 1) {
+        level = MessageLevel::Fatal;
+        text = &m_overflowMessage;
+        archiveLine = -1;
+    }
+
+    if (m_chunks.empty() || m_chunks.back().ends.size() == s_chunkLines) {
+        // the previous chunk is full, so give back the slack
+        if (!m_chunks.empty())
+            m_chunks.back().text.squeeze();
+        m_chunks.emplace_back();
+        m_chunks.back().ends.reserve(s_chunkLines);
+        m_chunks.back().levels.reserve(s_chunkLines);
+        m_chunks.back().archiveLines.reserve(s_chunkLines);
+    }
+    Chunk& chunk = m_chunks.back();
+    chunk.text.append(text->toUtf8());
+    chunk.ends.append(chunk.text.size());
+    chunk.levels.append(static_cast<char>(level));
+    chunk.archiveLines.append(archiveLine);
+    m_pendingLines++;
+}
+
 void LogModel::append(MessageLevel::Enum level, QString line)
 {
-    if (m_suspended) {
+    append(QVector<Line>{ { level, line } });
+}
+
+void LogModel::append(const QVector<Line>& lines, qint64 archiveFirst)
+{
+    if (m_suspended || lines.isEmpty()) {
+        return;
+    }
+    for (const auto& line : lines) {
+        appendLine(line.level, line.text, archiveFirst);
+        if (archiveFirst >= 0)
+            archiveFirst++;
+    }
+
+    // don't let a flood of lines pile up between updates
+    if (m_pendingLines >= m_maxLines) {
+        flush();
+    } else if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void LogModel::flush()
+{
+    m_flushTimer.stop();
+    if (m_pendingLines == 0) {
         return;
     }
-    int lineNum = (m_firstLine + m_numLines) % m_maxLines;
-    // overflow
-    if (m_numLines == m_maxLines) {
-        if (m_stopOnOverflow) {
-            // nothing more to do, the buffer is full
-            return;
+
+    // overflow, throw away the oldest lines
+    int overflow = m_numLines + m_pendingLines - m_maxLines;
+    if (overflow > 0) {
+        int visible = std::min(overflow, m_numLines);
+        if (visible > 0) {
+            beginRemoveRows(QModelIndex(), 0, visible - 1);
+            m_firstLine += visible;
+            m_numLines -= visible;
+            endRemoveRows();
         }
-        beginRemoveRows(QModelIndex(), 0, 0);
-        m_firstLine = (m_firstLine + 1) % m_maxLines;
-        m_numLines--;
-        endRemoveRows();
-    } else if (m_numLines == m_maxLines - 1 && m_stopOnOverflow) {
-        level = MessageLevel::Fatal;
-        line = m_overflowMessage;
+        // pending lines that would scroll out right away are never shown at all
+        int hidden = overflow - visible;
+        m_firstLine += hidden;
+        m_pendingLines -= hidden;
     }
-    beginInsertRows(QModelIndex(), m_numLines, m_numLines);
-    m_numLines++;
-    m_content[lineNum].level = level;
-    m_content[lineNum].line = line;
+
+    beginInsertRows(QModelIndex(), m_numLines, m_numLines + m_pendingLines - 1);
+    m_numLines += m_pendingLines;
+    m_pendingLines = 0;
     endInsertRows();
+
+    dropStaleChunks();
+}
+
+void LogModel::dropStaleChunks()
+{
+    while (m_firstLine >= s_chunkLines) {
+        m_chunks.pop_front();
+        m_firstLine -= s_chunkLines;
+    }
 }
 
 void LogModel::suspend(bool suspend)
@@ -69,22 +176,30 @@ bool LogModel::suspended()
 
 void LogModel::clear()
 {
+    m_flushTimer.stop();
     beginResetModel();
+    m_chunks.clear();
     m_firstLine = 0;
     m_numLines = 0;
+    m_pendingLines = 0;
     endResetModel();
 }
 
 QString LogModel::toPlainText()
 {
-    QString out;
+    flush();
+
+    QByteArray out;
     out.reserve(m_numLines * 80);
     for (int i = 0; i < m_numLines; i++) {
-        QString& line = m_content[(m_firstLine + i) % m_maxLines].line;
-        out.append(line + '\n');
+        int line = m_firstLine + i;
+        const Chunk& chunk = m_chunks[line / s_chunkLines];
+        int index = line % s_chunkLines;
+        int start = index == 0 ? 0 : chunk.ends[index - 1];
+        out.append(chunk.text.constData() + start, chunk.ends[index] - start);
+        out.append('\n');
     }
-    out.squeeze();
-    return out;
+    return QString::fromUtf8(out);
 }
 
 void LogModel::setMaxLines(int maxLines)
@@ -93,33 +208,16 @@ void LogModel::setMaxLines(int maxLines)
     if (maxLines == m_maxLines) {
         return;
     }
-    // if it all still fits in the buffer, just resize it
-    if (m_firstLine + m_numLines < m_maxLines) {
-        m_maxLines = maxLines;
-        m_content.resize(maxLines);
-        return;
-    }
-    // otherwise, we need to reorganize the data because it crosses the wrap boundary
-    QVector<entry> newContent;
-    newContent.resize(maxLines);
-    if (m_numLines <= maxLines) {
-        // if it all fits in the new buffer, just copy it over
-        for (int i = 0; i < m_numLines; i++) {
-            newContent[i] = m_content[(m_firstLine + i) % m_maxLines];
-        }
-        m_content.swap(newContent);
-    } else {
-        // if it doesn't fit, part of the data needs to be thrown away (the oldest log messages)
+    flush();
+    // if it doesn't fit, part of the data needs to be thrown away (the oldest log messages)
+    if (m_numLines > maxLines) {
         int lead = m_numLines - maxLines;
         beginRemoveRows(QModelIndex(), 0, lead - 1);
-        for (int i = 0; i < maxLines; i++) {
-            newContent[i] = m_content[(m_firstLine + lead + i) % m_maxLines];
-        }
-        m_numLines = m_maxLines;
-        m_content.swap(newContent);
+        m_firstLine += lead;
+        m_numLines -= lead;
         endRemoveRows();
+        dropStaleChunks();
     }
-    m_firstLine = 0;
     m_maxLines = maxLines;
 }
 
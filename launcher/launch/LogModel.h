@@ -2,6 +2,9 @@
 
 #include <QAbstractListModel>
 #include <QString>
+#include <QTimer>
+#include <QVector>
+#include <deque>
 #include "MessageLevel.h"
 
 class LogModel : public QAbstractListModel {
@@ -12,14 +15,30 @@ class LogModel : public QAbstractListModel {
     int rowCount(const QModelIndex& parent = QModelIndex()) const;
     QVariant data(const QModelIndex& index, int role) const;
 
+    struct Line {
+        MessageLevel::Enum level;
+        QString text;
+    };
+
     void append(MessageLevel::Enum, QString line);
+    /* Appends a batch of lines. Views are told about new lines at most once per display frame, see flush().
+     * If the lines are also in the complete log of the launch (see LogArchive), `archiveFirst` is the number of the
+     * first of them there. */
+    void append(const QVector<Line>& lines, qint64 archiveFirst = -1);
     void clear();
 
+    /* Makes all appended lines visible to views right away, instead of waiting for the next coalesced update. */
+    void flush();
+
     void suspend(bool suspend);
     bool suspended();
 
     QString toPlainText();
 
+    /* Which lines of the complete log the rows came from: the number of the first one and one past the last one.
+     * Rows that aren't in the complete log, like the launcher's own messages, don't count. -1 for both if no row is. */
+    void archiveRange(qint64& first, qint64& end) const;
+
     int getMaxLines();
     void setMaxLines(int maxLines);
     void setStopOnOverflow(bool stop);
@@ -31,22 +50,39 @@ class LogModel : public QAbstractListModel {
     enum Roles { LevelRole = Qt::UserRole };
 
    private /* types */:
-    struct entry {
-        MessageLevel::Enum level;
-        QString line;
+    /* A block of lines stored back to back as UTF-8, so a million lines don't mean a million QStrings. */
+    struct Chunk {
+        QByteArray text;
+        // end offset of every line in `text`
+        QVector<int> ends;
+        // one MessageLevel::Enum per line
+        QByteArray levels;
+        // the number of every line in the complete log, -1 if it isn't in there
+        QVector<qint64> archiveLines;
     };
 
+   private:
+    void appendLine(MessageLevel::Enum level, const QString& line, qint64 archiveLine);
+    QString lineAt(int row) const;
+    MessageLevel::Enum levelAt(int row) const;
+    qint64 archiveLineAt(int row) const;
+    // removes lines before m_firstLine from the storage
+    void dropStaleChunks();
+
    private: /* data */
-    QVector<entry> m_content;
+    std::deque<Chunk> m_chunks;
     int m_maxLines = 1000;
-    // first line in the circular buffer
+    // first line in the first chunk
     int m_firstLine = 0;
-    // number of lines occupied in the circular buffer
+    // number of lines views know about
     int m_numLines = 0;
+    // number of lines appended after those, waiting for the next flush
+    int m_pendingLines = 0;
     bool m_stopOnOverflow = false;
     QString m_overflowMessage = "OVERFLOW";
     bool m_suspended = false;
     bool m_lineWrap = true;
+    QTimer m_flushTimer;
 
    private:
     Q_DISABLE_COPY(LogModel)
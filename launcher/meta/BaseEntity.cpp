@@ -153,6 +153,8 @@ void BaseEntityLoadTask::executeTask()
         return;
     }
     m_task.reset(new NetJob(QObject::tr("Download of meta file %1").arg(m_entity->localFilename()), APPLICATION->network()));
+    // everything else is waiting for the metadata
+    m_task->setPriority(Net::Scheduler::Priority::Interactive);
     auto url = m_entity->url();
     auto entry = APPLICATION->metacache()->resolveEntry("meta", m_entity->localFilename());
     entry->setStale(true);
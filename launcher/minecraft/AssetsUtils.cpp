@@ -34,6 +34,7 @@
  */
 
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
@@ -43,6 +44,8 @@
 #include <QJsonParseError>
 #include <QVariant>
 
+#include <algorithm>
+
 #include "AssetsUtils.h"
 #include "BuildConfig.h"
 #include "FileSystem.h"
@@ -51,7 +54,9 @@
 #include "net/Download.h"
 
 #include "Application.h"
+#include "modplatform/helpers/HashCache.h"
 #include "net/NetRequest.h"
+#include "tasks/WorkerPool.h"
 
 namespace {
 QSet<QString> collectPathsFromDir(QString dirPath)
@@ -70,7 +75,6 @@ QSet<QString> collectPathsFromDir(QString dirPath)
         QFileInfo info(value);
         if (info.isFile()) {
             out.insert(value);
-            qDebug() << value;
         }
     }
     return out;
@@ -201,6 +205,40 @@ QDir getAssetsDir(const QString& assetsId, const QString& resourcesFolder)
     return virtualRoot;
 }
 
+namespace {
+
+// written into a reconstructed folder, so the next launch can tell nothing changed since
+const char* s_manifestName = ".reconstructed.json";
+
+// a failing disk doesn't change the mtime, so objects get hashed again after this long (in secs)
+const qint64 s_reverifyAge = 60 * 60 * 24 * 90;
+
+struct AssetPlacement {
+    QString source;
+    QString target;
+    QString hash;
+    qint64 size = 0;
+    // the target is already there, with the right size
+    bool upToDate = false;
+    // the source object exists
+    bool available = false;
+    // the journal found the source to be corrupted, so it's left out until it's downloaded again
+    bool corrupted = false;
+    bool placed = false;
+};
+
+QJsonObject manifestFor(const QString& assetsId, const QFileInfo& indexInfo, int objects)
+{
+    QJsonObject manifest;
+    manifest["id"] = assetsId;
+    manifest["indexSize"] = indexInfo.size();
+    manifest["indexModified"] = indexInfo.lastModified().toMSecsSinceEpoch();
+    manifest["objects"] = objects;
+    return manifest;
+}
+
+}  // namespace
+
 // FIXME: ugly code duplication
 bool reconstructAssets(QString assetsId, QString resourcesFolder)
 {
@@ -218,8 +256,6 @@ bool reconstructAssets(QString assetsId, QString resourcesFolder)
         return false;
     }
 
-    qDebug() << "reconstructAssets" << assetsDir.path() << indexDir.path() << objectDir.path() << virtualDir.path() << virtualRoot.path();
-
     AssetsIndex index;
     if (!AssetsUtils::loadAssetsIndexJson(assetsId, indexPath, index)) {
         qCritical() << "Failed to load asset index file" << indexPath << "; can't reconstruct assets!";
@@ -231,59 +267,220 @@ bool reconstructAssets(QString assetsId, QString resourcesFolder)
     if (index.isVirtual) {
         targetPath = virtualRoot.path();
         removeLeftovers = true;
-        qDebug() << "Reconstructing virtual assets folder at" << targetPath;
     } else if (index.mapToResources) {
         targetPath = resourcesFolder;
-        qDebug() << "Reconstructing resources folder at" << targetPath;
     }
 
-    if (!targetPath.isNull()) {
-        auto presentFiles = collectPathsFromDir(targetPath);
-        for (QString map : index.objects.keys()) {
-            AssetObject asset_object = index.objects.value(map);
-            QString target_path = FS::PathCombine(targetPath, map);
-            QFile target(target_path);
-
-            QString tlk = asset_object.hash.left(2);
-
-            QString original_path = FS::PathCombine(objectDir.path(), tlk, asset_object.hash);
-            QFile original(original_path);
-            if (!original.exists())
-                continue;
-
-            presentFiles.remove(target_path);
+    if (targetPath.isNull())
+        return true;
+
+    // the resources folder belongs to the instance, and whatever is in there can get edited in place. as hard links that
+    // would change the object store for every instance. clones are copy-on-write, so those are still fine
+    bool allowHardLink = index.isVirtual;
+    auto journal = APPLICATION->assetJournal();
+
+    QVector<AssetPlacement> assets;
+    assets.reserve(index.objects.size());
+    for (auto it = index.objects.cbegin(); it != index.objects.cend(); ++it) {
+        AssetPlacement asset;
+        asset.source = FS::PathCombine(objectDir.path(), it->hash.left(2), it->hash);
+        asset.target = FS::PathCombine(targetPath, it.key());
+        asset.hash = it->hash;
+        asset.size = it->size;
+        assets.append(asset);
+    }
 
-            if (!target.exists()) {
-                QFileInfo info(target_path);
-                QDir target_dir = info.dir();
+    // stat everything on the I/O pool, there are thousands of small files
+    WorkerPool::io().blockingMap(assets, [allowHardLink, journal](AssetPlacement& asset) {
+        // only what the journal already knows, nothing gets hashed here. the target was placed from it, so it's no better
+        auto source = Hashing::FileIdentity::of(asset.source);
+        auto known = journal->get(source, Hashing::Algorithm::Sha1);
+        asset.corrupted = !known.isEmpty() && known != asset.hash;
+        if (asset.corrupted)
+            return;
+        QFileInfo target(asset.target);
+        // a hard link where there shouldn't be one is left over from before, it gets replaced by a copy
+        asset.upToDate = target.isFile() && target.size() == asset.size && (allowHardLink || FS::hardLinkCount(asset.target) <= 1);
+        asset.available = source.isValid();
+    });
+    bool complete = std::all_of(assets.cbegin(), assets.cend(), [](const AssetPlacement& asset) { return asset.upToDate; });
+
+    // all there, and nothing to clean up if the folder was completely reconstructed from the same index before
+    QString manifestPath = FS::PathCombine(targetPath, s_manifestName);
+    auto manifest = manifestFor(assetsId, QFileInfo(indexPath), index.objects.size());
+    QFile manifestFile(manifestPath);
+    if (complete && manifestFile.open(QIODevice::ReadOnly) && QJsonDocument::fromJson(manifestFile.readAll()).object() == manifest) {
+        qDebug() << "Assets folder" << targetPath << "is up to date";
+        return true;
+    }
+    manifestFile.close();
 
-                qDebug() << target_dir.path();
-                FS::ensureFolderPathExists(target_dir.path());
+    qDebug() << "Reconstructing assets folder at" << targetPath;
+    if (!FS::ensureFolderPathExists(targetPath)) {
+        qCritical() << "Failed to create assets folder" << targetPath;
+        return false;
+    }
 
-                bool couldCopy = original.copy(target_path);
-                qDebug() << " Copying" << original_path << "to" << target_path << QString::number(couldCopy);
-            }
+    QSet<QString> directories;
+    for (const auto& asset : assets) {
+        if (asset.available && !asset.upToDate)
+            directories.insert(QFileInfo(asset.target).path());
+    }
+    for (const auto& directory : directories)
+        FS::ensureFolderPathExists(directory);
+
+    // hard links share the object store's files, which is fine for the virtual folders because the game never writes to them
+    auto method = FS::placeMethod(objectDir.absolutePath(), QDir(targetPath).absolutePath(), allowHardLink);
+
+    WorkerPool::io().blockingMap(assets, [method, allowHardLink, removeLeftovers](AssetPlacement& asset) {
+        // a missing file beats a corrupted one in the virtual folders, and it is placed again once it got downloaded
+        if (asset.corrupted && removeLeftovers)
+            QFile::remove(asset.target);
+        if (asset.upToDate || !asset.available)
+            return;
+        // replace whatever is there, it has the wrong size (or is a hard link)
+        QFile::remove(asset.target);
+        asset.placed = FS::placeFile(asset.source, asset.target, method, allowHardLink);
+    });
+
+    int missing = 0, corrupted = 0, placed = 0, failed = 0;
+    for (const auto& asset : assets) {
+        if (asset.upToDate)
+            continue;
+        if (asset.corrupted)
+            corrupted++;
+        else if (!asset.available)
+            missing++;
+        else if (asset.placed)
+            placed++;
+        else
+            failed++;
+    }
+    qDebug() << "Placed" << placed << "assets in" << targetPath << "(" << failed << "failed," << missing << "missing," << corrupted
+             << "corrupted objects)";
+
+    if (removeLeftovers) {
+        auto leftovers = collectPathsFromDir(targetPath);
+        for (const auto& asset : assets)
+            leftovers.remove(asset.target);
+        leftovers.remove(manifestPath);
+        for (const auto& file : leftovers) {
+            if (!QFile::remove(file))
+                qWarning() << "Failed to remove leftover asset" << file;
         }
+        if (!leftovers.isEmpty())
+            qDebug() << "Removed" << leftovers.size() << "leftover assets from" << targetPath;
+    }
 
-        // TODO: Write last used time to virtualRoot/.lastused
-        if (removeLeftovers) {
-            for (auto& file : presentFiles) {
-                qDebug() << "Would remove" << file;
-            }
+    // only remember complete reconstructions, missing and corrupted objects may still get downloaded
+    if (missing == 0 && corrupted == 0 && failed == 0) {
+        try {
+            FS::write(manifestPath, QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+        } catch (const FS::FileSystemException& e) {
+            qWarning() << "Failed to write assets manifest:" << e.cause();
         }
     }
     return true;
 }
 
+bool needsDownload(const AssetObjectCheck& object, Hashing::HashCache& journal)
+{
+    auto identity = Hashing::FileIdentity::of(object.path);
+    if (!identity.isValid() || identity.size != object.size)
+        return true;
+    auto known = journal.get(identity, Hashing::Algorithm::Sha1);
+    return !known.isEmpty() && known != object.hash;
+}
+
+bool verifyObject(const AssetObjectCheck& object, Hashing::HashCache& journal)
+{
+    auto identity = Hashing::FileIdentity::of(object.path);
+    // missing or truncated, needsDownload() will take care of it
+    if (!identity.isValid() || identity.size != object.size)
+        return false;
+
+    auto actual = journal.get(identity, Hashing::Algorithm::Sha1);
+    if (actual.isEmpty() || journal.verifiedAt(identity) < QDateTime::currentSecsSinceEpoch() - s_reverifyAge) {
+        QFile file(object.path);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        actual = Hashing::hash(&file, Hashing::Algorithm::Sha1);
+        // corrupted objects get recorded too, that's how needsDownload() knows about them
+        journal.put(identity, Hashing::Algorithm::Sha1, actual);
+        if (actual != object.hash)
+            qWarning() << "Asset object" << object.path << "is corrupted, it will be downloaded again";
+    }
+    return actual == object.hash;
+}
+
+void recordDownloadedObject(const AssetObjectCheck& object, Hashing::HashCache& journal)
+{
+    auto identity = Hashing::FileIdentity::of(object.path);
+    if (identity.isValid() && identity.size == object.size)
+        journal.put(identity, Hashing::Algorithm::Sha1, object.hash);
+}
+
+void redownloadObjects(const QVector<AssetObjectCheck>& objects)
+{
+    auto job = new NetJob(QObject::tr("Corrupted assets"), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Bulk);
+    for (const auto& object : objects) {
+        AssetObject asset{ object.hash, object.size };
+        if (auto dl = asset.getDownloadAction())
+            job->addNetAction(dl);
+    }
+    if (!job->size()) {
+        delete job;
+        return;
+    }
+
+    qDebug() << "Downloading" << job->size() << "corrupted asset objects again";
+    QObject::connect(job, &NetJob::failed, job, [](QString reason) { qWarning() << "Failed to download corrupted assets:" << reason; });
+    QObject::connect(job, &NetJob::finished, job, &NetJob::deleteLater);
+    job->start();
+}
+
+void verifyObjectsInBackground(const QVector<AssetObjectCheck>& objects)
+{
+    auto journal = APPLICATION->assetJournal();
+    WorkerPool::io().start(
+        [objects, journal] {
+            struct Check {
+                AssetObjectCheck object;
+                bool intact = false;
+            };
+            QVector<Check> checks;
+            checks.reserve(objects.size());
+            for (const auto& object : objects)
+                checks.append({ object });
+            WorkerPool::io().blockingMap(
+                checks, [journal](Check& check) { check.intact = verifyObject(check.object, *journal); }, WorkerPool::Priority::Low);
+
+            QVector<AssetObjectCheck> failed;
+            for (const auto& check : checks) {
+                if (!check.intact)
+                    failed.append(check.object);
+            }
+            // the downloads belong to the main thread
+            if (!failed.isEmpty())
+                QMetaObject::invokeMethod(APPLICATION, [failed] { redownloadObjects(failed); }, Qt::QueuedConnection);
+        },
+        WorkerPool::Priority::Low);
+}
+
 }  // namespace AssetsUtils
 
 Net::NetRequest::Ptr AssetObject::getDownloadAction()
 {
-    QFileInfo objectFile(getLocalPath());
-    if ((!objectFile.isFile()) || (objectFile.size() != size)) {
-        auto objectDL = Net::ApiDownload::makeFile(getUrl(), objectFile.filePath());
+    AssetObjectCheck check{ getLocalPath(), hash, size };
+    if (AssetsUtils::needsDownload(check, *APPLICATION->assetJournal())) {
+        // this goes through a temporary file, so a corrupted object is only replaced once the new one is complete
+        auto objectDL = Net::ApiDownload::makeFile(getUrl(), check.path);
         if (hash.size()) {
             objectDL->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, hash));
+            // checksummed already, no need to hash it again later
+            QObject::connect(objectDL.get(), &Task::succeeded, objectDL.get(),
+                             [check] { AssetsUtils::recordDownloadedObject(check, *APPLICATION->assetJournal()); });
         }
         objectDL->setProgress(objectDL->getProgress(), size);
         return objectDL;
@@ -306,13 +503,30 @@ QString AssetObject::getRelPath()
     return hash.left(2) + "/" + hash;
 }
 
+QVector<AssetObjectCheck> AssetsIndex::objectChecks()
+{
+    QVector<AssetObjectCheck> checks;
+    checks.reserve(objects.size());
+    // several names can share one object
+    QSet<QString> seen;
+    for (auto& object : objects) {
+        if (seen.contains(object.hash))
+            continue;
+        seen.insert(object.hash);
+        checks.append({ object.getLocalPath(), object.hash, object.size });
+    }
+    return checks;
+}
+
 NetJob::Ptr AssetsIndex::getDownloadJob()
 {
     auto job = makeShared<NetJob>(QObject::tr("Assets for %1").arg(id), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Bulk);
     for (auto& object : objects.values()) {
         auto dl = object.getDownloadAction();
         if (dl) {
-            job->addNetAction(dl);
+            // the few big sounds first, so they don't end up as the last few downloads running on their own
+            job->addNetAction(dl, object.size > 1024 * 1024 ? NetJob::Priority::High : NetJob::Priority::Normal);
         }
     }
     if (job->size())
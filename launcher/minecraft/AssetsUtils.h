@@ -20,6 +20,10 @@
 #include "net/NetJob.h"
 #include "net/NetRequest.h"
 
+namespace Hashing {
+class HashCache;
+}
+
 struct AssetObject {
     QString getRelPath();
     QUrl getUrl();
@@ -30,7 +34,17 @@ struct AssetObject {
     qint64 size;
 };
 
+/// One object in the asset store and what it should be, see AssetsUtils::verifyObject()
+struct AssetObjectCheck {
+    QString path;
+    QString hash;
+    qint64 size;
+};
+
 struct AssetsIndex {
+    /// Every object of the index, ready to be checked
+    QVector<AssetObjectCheck> objectChecks();
+
     NetJob::Ptr getDownloadJob();
 
     QString id;
@@ -47,4 +61,23 @@ QDir getAssetsDir(const QString& assetsId, const QString& resourcesFolder);
 
 /// Reconstruct a virtual assets folder for the given assets ID and return the folder
 bool reconstructAssets(QString assetsId, QString resourcesFolder);
+
+/// Whether an object has to be downloaded: it's missing, has the wrong size, or the journal knows it is corrupted.
+/// Only a stat, nothing gets hashed.
+bool needsDownload(const AssetObjectCheck& object, Hashing::HashCache& journal);
+
+/// Check that an object in the store is present and intact. Objects the journal has seen with the same size, mtime and
+/// inode are only stat'ed, others (and those verified a long time ago) are hashed and the result is recorded, corrupted or not.
+/// The store is shared, so corrupted objects are left alone until a download replaces them. Safe to call from any thread.
+bool verifyObject(const AssetObjectCheck& object, Hashing::HashCache& journal);
+
+/// Record an object that was just downloaded (and checksummed), so it doesn't get hashed again
+void recordDownloadedObject(const AssetObjectCheck& object, Hashing::HashCache& journal);
+
+/// Download objects that need it again, in the background. Call this on the main thread.
+void redownloadObjects(const QVector<AssetObjectCheck>& objects);
+
+/// Check objects on the worker pool at low priority, without holding anything up.
+/// Corrupted ones are then downloaded again right away, and left out of reconstructed folders until they are.
+void verifyObjectsInBackground(const QVector<AssetObjectCheck>& objects);
 }  // namespace AssetsUtils
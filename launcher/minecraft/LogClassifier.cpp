@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogClassifier.h"
+
+#include <QStringView>
+
+namespace LogClassifier {
+
+namespace {
+
+// the character classes below are ASCII only, same as in the (non-unicode) regular expressions this used to run
+
+bool isDigit(QChar c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool isSpace(QChar c)
+{
+    auto u = c.unicode();
+    return u == ' ' || u == '\t' || u == '\n' || u == '\v' || u == '\f' || u == '\r';
+}
+
+// [a-zA-Z_$]
+bool isIdentifierStart(QChar c)
+{
+    auto u = c.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_' || u == '$';
+}
+
+// [a-zA-Z\d_$]
+bool isIdentifierPart(QChar c)
+{
+    return isIdentifierStart(c) || isDigit(c);
+}
+
+MessageLevel::Enum log4jLevel(QStringView levelStr, MessageLevel::Enum level)
+{
+    if (levelStr == QLatin1String("INFO"))
+        return MessageLevel::Message;
+    if (levelStr == QLatin1String("WARN"))
+        return MessageLevel::Warning;
+    if (levelStr == QLatin1String("ERROR"))
+        return MessageLevel::Error;
+    if (levelStr == QLatin1String("FATAL"))
+        return MessageLevel::Fatal;
+    if (levelStr == QLatin1String("TRACE") || levelStr == QLatin1String("DEBUG"))
+        return MessageLevel::Debug;
+    return level;
+}
+
+/* Finds the first `[HH:MM:SS] [thread/LEVEL]` in the line, like "\[[0-9:]+\] \[[^/]+/([^\]]+)\]" would.
+ * Returns false if there is none. */
+bool findLog4jLevel(const QString& line, QStringView& levelStr)
+{
+    const qsizetype size = line.size();
+    for (qsizetype open = line.indexOf('['); open != -1; open = line.indexOf('[', open + 1)) {
+        // timestamp
+        qsizetype i = open + 1;
+        while (i < size && (isDigit(line[i]) || line[i] == ':'))
+            i++;
+        if (i == open + 1 || i + 2 >= size || line[i] != ']' || line[i + 1] != ' ' || line[i + 2] != '[')
+            continue;
+
+        // thread name, which can be anything but a slash
+        qsizetype threadStart = i + 3;
+        qsizetype slash = line.indexOf('/', threadStart);
+        if (slash == -1)
+            return false;  // no later '[' can match either
+        if (slash == threadStart)
+            continue;
+
+        qsizetype close = line.indexOf(']', slash + 1);
+        if (close == -1)
+            return false;
+        if (close == slash + 1)
+            continue;
+
+        levelStr = QStringView(line).mid(slash + 1, close - slash - 1);
+        return true;
+    }
+    return false;
+}
+
+MessageLevel::Enum oldForgeLevel(const QString& line, MessageLevel::Enum level)
+{
+    bool message = false, error = false, warning = false, debug = false;
+
+    auto view = QStringView(line);
+    for (qsizetype open = line.indexOf('['); open != -1; open = line.indexOf('[', open + 1)) {
+        auto rest = view.mid(open);
+        if (rest.startsWith(QLatin1String("[INFO]")) || rest.startsWith(QLatin1String("[CONFIG]")) ||
+            rest.startsWith(QLatin1String("[FINE]")) || rest.startsWith(QLatin1String("[FINER]")) ||
+            rest.startsWith(QLatin1String("[FINEST]")))
+            message = true;
+        else if (rest.startsWith(QLatin1String("[SEVERE]")) || rest.startsWith(QLatin1String("[STDERR]")))
+            error = true;
+        else if (rest.startsWith(QLatin1String("[WARNING]")))
+            warning = true;
+        else if (rest.startsWith(QLatin1String("[DEBUG]")))
+            debug = true;
+    }
+
+    // later rules used to overwrite earlier ones
+    if (debug)
+        return MessageLevel::Debug;
+    if (warning)
+        return MessageLevel::Warning;
+    if (error)
+        return MessageLevel::Error;
+    if (message)
+        return MessageLevel::Message;
+    return level;
+}
+
+/* "([a-zA-Z_$][a-zA-Z\d_$]*\.)+[a-zA-Z_$][a-zA-Z\d_$]*" anchored at `pos`.
+ * That boils down to an identifier, a dot and the start of another identifier. */
+bool javaSymbolAt(const QString& line, qsizetype pos)
+{
+    const qsizetype size = line.size();
+    if (pos >= size || !isIdentifierStart(line[pos]))
+        return false;
+    pos++;
+    while (pos < size && isIdentifierPart(line[pos]))
+        pos++;
+    return pos + 1 < size && line[pos] == '.' && isIdentifierStart(line[pos + 1]);
+}
+
+// "\s+at <java symbol>"
+bool hasStackFrame(const QString& line)
+{
+    for (qsizetype at = line.indexOf(QLatin1String("at ")); at != -1; at = line.indexOf(QLatin1String("at "), at + 1)) {
+        if (at > 0 && isSpace(line[at - 1]) && javaSymbolAt(line, at + 3))
+            return true;
+    }
+    return false;
+}
+
+// "Caused by: <java symbol>"
+bool hasCausedBy(const QString& line)
+{
+    static const QLatin1String causedBy("Caused by: ");
+    for (qsizetype pos = line.indexOf(causedBy); pos != -1; pos = line.indexOf(causedBy, pos + 1)) {
+        if (javaSymbolAt(line, pos + causedBy.size()))
+            return true;
+    }
+    return false;
+}
+
+/* "([a-zA-Z_$][a-zA-Z\d_$]*\.)+[a-zA-Z_$]?[a-zA-Z\d_$]*(Exception|Error|Throwable)"
+ * Which is the same as: the keyword, preceded by identifier characters back to a dot,
+ * which is preceded by identifier characters that aren't all digits. */
+bool hasThrowableName(const QString& line)
+{
+    static const QLatin1String keywords[] = { QLatin1String("Exception"), QLatin1String("Error"), QLatin1String("Throwable") };
+    for (const auto& keyword : keywords) {
+        for (qsizetype pos = line.indexOf(keyword); pos != -1; pos = line.indexOf(keyword, pos + 1)) {
+            qsizetype dot = pos - 1;
+            while (dot >= 0 && isIdentifierPart(line[dot]))
+                dot--;
+            if (dot < 1 || line[dot] != '.')
+                continue;
+
+            for (qsizetype i = dot - 1; i >= 0 && isIdentifierPart(line[i]); i--) {
+                if (isIdentifierStart(line[i]))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// "... \d+ more$"
+bool hasMoreFrames(const QString& line)
+{
+    // '$' also matches right before a final newline
+    qsizetype end = line.size();
+    if (end > 0 && line[end - 1] == '\n')
+        end--;
+
+    static const QLatin1String more(" more");
+    if (end < more.size() || QStringView(line).mid(end - more.size(), more.size()) != more)
+        return false;
+
+    qsizetype digits = end - more.size();
+    qsizetype i = digits;
+    while (i > 0 && isDigit(line[i - 1]))
+        i--;
+    if (i == digits)
+        return false;
+
+    // a space, and three of anything but a newline before that
+    qsizetype space = i - 1;
+    if (space < 3 || line[space] != ' ')
+        return false;
+    return line[space - 1] != '\n' && line[space - 2] != '\n' && line[space - 3] != '\n';
+}
+
+}  // namespace
+
+MessageLevel::Enum guessLevel(const QString& line, MessageLevel::Enum level)
+{
+    QStringView levelStr;
+    if (findLog4jLevel(line, levelStr)) {
+        // New style logs from log4j
+        level = log4jLevel(levelStr, level);
+    } else {
+        // Old style forge logs
+        level = oldForgeLevel(line, level);
+    }
+
+    if (line.contains(QLatin1String("overwriting existing")))
+        return MessageLevel::Fatal;
+
+    if (line.contains(QLatin1String("Exception in thread")) || hasStackFrame(line) || hasCausedBy(line) || hasThrowableName(line) ||
+        hasMoreFrames(line))
+        return MessageLevel::Error;
+    return level;
+}
+
+}  // namespace LogClassifier
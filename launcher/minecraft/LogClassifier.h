@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include "MessageLevel.h"
+
+/**
+ * Guesses the level of a line of game output.
+ *
+ * This gets called for every line the game prints, so it scans the line by hand instead of running regular expressions.
+ * It follows the rules the launcher used to match with them, noted next to each of the scanners.
+ */
+namespace LogClassifier {
+
+MessageLevel::Enum guessLevel(const QString& line, MessageLevel::Enum level);
+
+}  // namespace LogClassifier
@@ -17,11 +17,11 @@
 #include <launch/LaunchTask.h>
 #include <minecraft/MinecraftInstance.h>
 
-#include <quazip/quazip.h>
-#include <quazip/quazipdir.h>
+#include <QDebug>
 #include <QDir>
+#include <QFile>
 #include "FileSystem.h"
-#include "MMCZip.h"
+#include "ZipReader.h"
 
 #ifdef major
 #undef major
@@ -41,28 +41,39 @@ static QString replaceSuffix(QString target, const QString& suffix, const QStrin
 
 static bool unzipNatives(QString source, QString targetFolder, bool applyJnilibHack)
 {
-    QuaZip zip(source);
-    if (!zip.open(QuaZip::mdUnzip)) {
+    ZipReader zip(source);
+    if (!zip.open()) {
         return false;
     }
     QDir directory(targetFolder);
-    if (!zip.goToFirstFile()) {
-        return false;
-    }
-    do {
-        QString name = zip.getCurrentFileName();
-        auto lowercase = name.toLower();
+    QByteArray contents;
+    for (auto const& entry : zip.fileNames()) {
+        QString name = entry;
         if (applyJnilibHack) {
             name = replaceSuffix(name, ".jnilib", ".dylib");
         }
-        QString absFilePath = directory.absoluteFilePath(name);
-        if (!JlCompress::extractFile(&zip, "", absFilePath)) {
+        QString absFilePath = QDir::cleanPath(directory.absoluteFilePath(name));
+        if (!absFilePath.startsWith(directory.absolutePath() + '/')) {
+            qWarning() << "Not extracting" << entry << "from" << source << "outside of the natives folder";
+            continue;
+        }
+        if (entry.endsWith('/')) {
+            if (!FS::ensureFolderPathExists(absFilePath)) {
+                return false;
+            }
+            continue;
+        }
+        if (!zip.read(entry, contents) || !FS::ensureFilePathExists(absFilePath)) {
             return false;
         }
-    } while (zip.goToNextFile());
-    zip.close();
-    if (zip.getZipError() != 0) {
-        return false;
+        QFile file(absFilePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(contents) != contents.size()) {
+            return false;
+        }
+        auto permissions = zip.permissions(entry);
+        if (permissions != QFile::Permissions()) {
+            file.setPermissions(permissions);
+        }
     }
     return true;
 }
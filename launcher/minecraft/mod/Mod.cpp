@@ -38,6 +38,7 @@
 #include "Mod.h"
 #include <qpixmap.h>
 
+#include <QDataStream>
 #include <QDebug>
 #include <QDir>
 #include <QRegularExpression>
@@ -48,6 +49,7 @@
 #include "Version.h"
 #include "minecraft/mod/ModDetails.h"
 #include "minecraft/mod/Resource.h"
+#include "minecraft/mod/ResourceParseCache.h"
 #include "minecraft/mod/tasks/LocalModParseTask.h"
 #include "modplatform/ModIndex.h"
 
@@ -297,19 +299,29 @@ QPixmap Mod::setIcon(QImage new_image) const
 
     Q_ASSERT(!new_image.isNull());
 
+    // scale the image to avoid flooding the pixmapcache
+    auto scaled = scaleIcon(new_image);
+    m_icon_thumbnail = ResourceParseCache::encodeImage(scaled);
+    return cacheIcon(scaled);
+}
+
+QPixmap Mod::cacheIcon(const QImage& scaled) const
+{
     if (m_packImageCacheKey.key.isValid())
         PixmapCache::remove(m_packImageCacheKey.key);
 
-    // scale the image to avoid flooding the pixmapcache
-    auto pixmap =
-        QPixmap::fromImage(new_image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
-
+    auto pixmap = QPixmap::fromImage(scaled);
     m_packImageCacheKey.key = PixmapCache::insert(pixmap);
     m_packImageCacheKey.wasEverUsed = true;
     m_packImageCacheKey.wasReadAttempt = true;
     return pixmap;
 }
 
+QImage Mod::scaleIcon(const QImage& image)
+{
+    return image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+}
+
 QPixmap Mod::icon(QSize size, Qt::AspectRatioMode mode) const
 {
     auto pixmap_transform = [&size, &mode](QPixmap pixmap) {
@@ -333,6 +345,13 @@ QPixmap Mod::icon(QSize size, Qt::AspectRatioMode mode) const
     }
     // Image got evicted from the cache or an attempt to load it has not been made. load it and retry.
     m_packImageCacheKey.wasReadAttempt = true;
+    {
+        // kept from an earlier run, much cheaper than digging it out of the mod again. it's already scaled and encoded.
+        QMutexLocker locker(&m_data_lock);
+        auto thumbnail = QImage::fromData(m_icon_thumbnail, "PNG");
+        if (!thumbnail.isNull())
+            return pixmap_transform(cacheIcon(thumbnail));
+    }
     if (ModUtils::loadIconFile(*this, &cached_image)) {
         return pixmap_transform(cached_image);
     }
@@ -340,6 +359,52 @@ QPixmap Mod::icon(QSize size, Qt::AspectRatioMode mode) const
     return {};
 }
 
+QByteArray Mod::saveParsed() const
+{
+    if (!m_is_resolved || !valid())
+        return {};
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+
+    const auto& details = m_local_details;
+    out << details.mod_id << details.name << details.version << details.mcversion << details.homeurl << details.description
+        << details.authors << details.issue_tracker << details.icon_file;
+    out << quint32(details.licenses.size());
+    for (const auto& license : details.licenses)
+        out << license.name << license.id << license.url << license.description;
+
+    QMutexLocker locker(&m_data_lock);
+    out << m_icon_thumbnail;
+    return data;
+}
+
+bool Mod::restoreParsed(const QByteArray& data)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    ModDetails details;
+    quint32 licenses;
+    in >> details.mod_id >> details.name >> details.version >> details.mcversion >> details.homeurl >> details.description >>
+        details.authors >> details.issue_tracker >> details.icon_file >> licenses;
+    for (quint32 i = 0; i < licenses && in.status() == QDataStream::Ok; i++) {
+        ModLicense license;
+        in >> license.name >> license.id >> license.url >> license.description;
+        details.licenses.append(license);
+    }
+    QByteArray thumbnail;
+    in >> thumbnail;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    finishResolvingWithDetails(std::move(details));
+    QMutexLocker locker(&m_data_lock);
+    m_icon_thumbnail = thumbnail;
+    return true;
+}
+
 bool Mod::valid() const
 {
     return !m_local_details.mod_id.isEmpty();
@@ -83,6 +83,8 @@ class Mod : public Resource {
     [[nodiscard]] QPixmap icon(QSize size, Qt::AspectRatioMode mode = Qt::AspectRatioMode::IgnoreAspectRatio) const;
     /** Thread-safe. */
     QPixmap setIcon(QImage new_image) const;
+    /** The size icons are kept at. */
+    static QImage scaleIcon(const QImage& image);
 
     auto metadata() -> std::shared_ptr<Metadata::ModStruct>;
     auto metadata() const -> const std::shared_ptr<Metadata::ModStruct>;
@@ -97,6 +99,9 @@ class Mod : public Resource {
     [[nodiscard]] int compare(Resource const& other, SortType type) const override;
     [[nodiscard]] bool applyFilter(QRegularExpression filter) const override;
 
+    [[nodiscard]] QByteArray saveParsed() const override;
+    bool restoreParsed(const QByteArray& data) override;
+
     // Delete all the files of this mod
     auto destroy(QDir& index_dir, bool preserve_metadata = false, bool attempt_trash = true) -> bool;
     // Delete the metadata only
@@ -114,4 +119,10 @@ class Mod : public Resource {
         bool wasEverUsed = false;
         bool wasReadAttempt = false;
     } mutable m_packImageCacheKey;
+    // the icon as it went into the pixmap cache, as PNG
+    mutable QByteArray m_icon_thumbnail;
+
+   private:
+    /** Puts an already scaled icon into the pixmap cache. Expects m_data_lock to be held. */
+    QPixmap cacheIcon(const QImage& scaled) const;
 };
@@ -76,6 +76,10 @@ ModFolderModel::ModFolderModel(const QString& dir, BaseInstance* instance, bool
                               QHeaderView::Interactive, QHeaderView::Interactive, QHeaderView::Interactive };
     m_columnsHideable = { false, true, false, true, true, true, true, true, true, true, true };
     m_columnsHiddenByDefault = { false, false, false, false, false, false, false, true, true, true, true };
+
+    connect(&m_parse_pipeline, &ModParsePipeline::finished, this, &ModFolderModel::onParseBatchFinished);
+    if (APPLICATION_DYN)  // in tests the application macro doesn't work
+        m_parse_pipeline.setMaxInFlight(APPLICATION->settings()->get("NumberOfConcurrentTasks").toInt());
 }
 
 QVariant ModFolderModel::data(const QModelIndex& index, int role) const
@@ -238,7 +242,7 @@ int ModFolderModel::columnCount(const QModelIndex& parent) const
 Task* ModFolderModel::createUpdateTask()
 {
     auto index_dir = indexDir();
-    auto task = new ModFolderLoadTask(dir(), index_dir, m_is_indexed, m_first_folder_load);
+    auto task = new ModFolderLoadTask(dir(), index_dir, m_is_indexed, m_first_folder_load, m_snapshot);
     m_first_folder_load = false;
     return task;
 }
@@ -248,6 +252,21 @@ Task* ModFolderModel::createParseTask(Resource& resource)
     return new LocalModParseTask(m_next_resolution_ticket, resource.type(), resource.fileinfo());
 }
 
+void ModFolderModel::resolveResource(Resource::Ptr res)
+{
+    if (!res->shouldResolve() || restoreFromParseCache(*res))
+        return;
+
+    int ticket = m_next_resolution_ticket.fetch_add(1);
+    auto task = makeShared<LocalModParseTask>(ticket, res->type(), res->fileinfo());
+
+    res->setResolving(true, ticket);
+    m_active_parse_tasks.insert(ticket, task);
+    m_parse_ids.insert(ticket, res->internal_id());
+
+    m_parse_pipeline.add(task);
+}
+
 bool ModFolderModel::uninstallMod(const QString& filename, bool preserve_metadata)
 {
     for (auto mod : allMods()) {
@@ -347,26 +366,39 @@ void ModFolderModel::onUpdateSucceeded()
     auto update_results = static_cast<ModFolderLoadTask*>(m_current_update_task.get())->result();
 
     auto& new_mods = update_results->mods;
+    m_snapshot = update_results->snapshot;
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    auto current_list = m_resources_index.keys();
-    QSet<QString> current_set(current_list.begin(), current_list.end());
-
     auto new_list = new_mods.keys();
     QSet<QString> new_set(new_list.begin(), new_list.end());
 #else
-    QSet<QString> current_set(m_resources_index.keys().toSet());
     QSet<QString> new_set(new_mods.keys().toSet());
 #endif
 
+    QSet<QString> current_set;
+    if (update_results->incremental) {
+        // only what changed on disk was loaded again, so leave the rest of the rows alone
+        for (auto const& id : new_set + update_results->removed) {
+            if (m_resources_index.contains(id))
+                current_set.insert(id);
+        }
+    } else {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        auto current_list = m_resources_index.keys();
+        current_set = QSet<QString>(current_list.begin(), current_list.end());
+#else
+        current_set = m_resources_index.keys().toSet();
+#endif
+    }
+
     applyUpdates(current_set, new_set, new_mods);
 }
 
-void ModFolderModel::onParseSucceeded(int ticket, QString mod_id)
+int ModFolderModel::applyParseResult(int ticket, const QString& mod_id)
 {
     auto iter = m_active_parse_tasks.constFind(ticket);
-    if (iter == m_active_parse_tasks.constEnd())
-        return;
+    if (iter == m_active_parse_tasks.constEnd() || !m_resources_index.contains(mod_id))
+        return -1;
 
     int row = m_resources_index[mod_id];
 
@@ -381,9 +413,47 @@ void ModFolderModel::onParseSucceeded(int ticket, QString mod_id)
     if (result && resource)
         resource->finishResolvingWithDetails(std::move(result->details));
 
+    return row;
+}
+
+void ModFolderModel::onParseSucceeded(int ticket, QString mod_id)
+{
+    int row = applyParseResult(ticket, mod_id);
+    if (row < 0)
+        return;
+
     emit dataChanged(index(row), index(row, columnCount(QModelIndex()) - 1));
 }
 
+void ModFolderModel::onParseBatchFinished(QList<LocalModParseTask::Ptr> tasks)
+{
+    // one change covering all the rows of the batch, the view repaints once for it either way
+    int first = -1;
+    int last = -1;
+    for (auto const& task : tasks) {
+        auto ticket = task->token();
+        if (!task->isAborted()) {
+            int row = applyParseResult(ticket, m_parse_ids.value(ticket));
+            if (row >= 0) {
+                first = first < 0 ? row : qMin(first, row);
+                last = qMax(last, row);
+            }
+        } else if (auto resource = find(m_parse_ids.value(ticket)); resource && resource->resolutionTicket() == ticket) {
+            // it never got parsed, so it still should be
+            resource->setResolving(false, ticket);
+        }
+        m_active_parse_tasks.remove(ticket);
+        m_parse_ids.remove(ticket);
+    }
+
+    if (first >= 0)
+        emit dataChanged(index(first), index(last, columnCount(QModelIndex()) - 1));
+
+    if (m_active_parse_tasks.isEmpty())
+        saveParseCache();
+    emit parseFinished();
+}
+
 static const FlameAPI flameAPI;
 bool ModFolderModel::installMod(QString file_path, ModPlatform::IndexedVersion& vers)
 {
@@ -39,6 +39,7 @@
 
 #include <QAbstractListModel>
 #include <QDir>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QSet>
@@ -49,6 +50,7 @@
 
 #include "minecraft/mod/tasks/LocalModParseTask.h"
 #include "minecraft/mod/tasks/ModFolderLoadTask.h"
+#include "minecraft/mod/tasks/ModParsePipeline.h"
 #include "modplatform/ModIndex.h"
 
 class LegacyInstance;
@@ -88,6 +90,8 @@ class ModFolderModel : public ResourceFolderModel {
 
     [[nodiscard]] Task* createUpdateTask() override;
     [[nodiscard]] Task* createParseTask(Resource&) override;
+    /** Parses the mod in m_parse_pipeline instead of running a task for it. */
+    void resolveResource(Resource::Ptr res) override;
 
     bool installMod(QString file_path) { return ResourceFolderModel::installResource(file_path); }
     bool installMod(QString file_path, ModPlatform::IndexedVersion& vers);
@@ -112,8 +116,18 @@ class ModFolderModel : public ResourceFolderModel {
    private slots:
     void onUpdateSucceeded() override;
     void onParseSucceeded(int ticket, QString resource_id) override;
+    void onParseBatchFinished(QList<LocalModParseTask::Ptr> tasks);
+
+   private:
+    /** Gives the mod what the parse found. Returns its row, or -1 if that parse doesn't matter anymore. */
+    int applyParseResult(int ticket, const QString& mod_id);
 
    protected:
     bool m_is_indexed;
     bool m_first_folder_load = true;
+    // what the folder looked like after the last load, to only look at what changed the next time
+    ModFolderLoadTask::SnapshotPtr m_snapshot;
+    ModParsePipeline m_parse_pipeline;
+    // which mod each of the parses in m_parse_pipeline is for
+    QHash<int, QString> m_parse_ids;
 };
@@ -99,6 +99,15 @@ class Resource : public QObject {
      */
     [[nodiscard]] virtual bool applyFilter(QRegularExpression filter) const;
 
+    /** Everything parsing found out about the resource, for a ResourceParseCache.
+     *  Empty if there's nothing worth keeping, or the resource type doesn't support it.
+     */
+    [[nodiscard]] virtual QByteArray saveParsed() const { return {}; }
+    /** Restores what saveParsed() returned, instead of parsing the resource again.
+     *  Returns false if that didn't work out, and the resource has to be parsed after all.
+     */
+    virtual bool restoreParsed([[maybe_unused]] const QByteArray& data) { return false; }
+
     /** Changes the enabled property, according to 'action'.
      *
      *  Returns whether a change was applied to the Resource's properties.
@@ -10,6 +10,7 @@
 #include <QMimeData>
 #include <QStyle>
 #include <QThreadPool>
+#include <QtConcurrentRun>
 #include <QUrl>
 
 #include "Application.h"
@@ -37,13 +38,45 @@ ResourceFolderModel::ResourceFolderModel(QDir dir, BaseInstance* instance, QObje
     connect(&m_helper_thread_task, &ConcurrentTask::finished, this, [this] { m_helper_thread_task.clear(); });
     if (APPLICATION_DYN) {  // in tests the application macro doesn't work
         m_helper_thread_task.setMaxConcurrent(APPLICATION->settings()->get("NumberOfConcurrentTasks").toInt());
+        if (m_instance)
+            setParseCache(FS::PathCombine(ResourceParseCache::instanceCacheDir(m_instance->id()), m_dir.dirName() + ".dat"));
     }
 }
 
 ResourceFolderModel::~ResourceFolderModel()
 {
-    while (!QThreadPool::globalInstance()->waitForDone(100))
-        QCoreApplication::processEvents();
+    // only our own parses matter here, whatever else is on the thread pool can take as long as it likes
+    m_helper_thread_start.waitForFinished();
+    if (m_helper_thread_task.isRunning()) {
+        disconnect(&m_helper_thread_task, nullptr, this, nullptr);
+        m_helper_thread_task.abort();
+    }
+    saveParseCache();
+}
+
+void ResourceFolderModel::setParseCache(const QString& path)
+{
+    if (path.isEmpty())
+        m_parse_cache.reset();
+    else
+        m_parse_cache = std::make_unique<ResourceParseCache>(path);
+}
+
+void ResourceFolderModel::saveParseCache()
+{
+    if (!m_parse_cache)
+        return;
+
+    // resources can find out more after parsing (icons are only loaded when shown), so look at all of them again
+    QSet<QString> keys;
+    for (auto const& resource : qAsConst(m_resources)) {
+        auto file = resource->fileinfo();
+        keys.insert(ResourceParseCache::key(file));
+        if (!resource->isResolving())
+            m_parse_cache->insert(file, resource->saveParsed());
+    }
+    m_parse_cache->retain(keys);
+    m_parse_cache->save();
 }
 
 bool ResourceFolderModel::startWatching(const QStringList& paths)
@@ -267,6 +300,9 @@ void ResourceFolderModel::resolveResource(Resource::Ptr res)
         return;
     }
 
+    if (restoreFromParseCache(*res))
+        return;
+
     Task::Ptr task{ createParseTask(*res) };
     if (!task)
         return;
@@ -286,17 +322,28 @@ void ResourceFolderModel::resolveResource(Resource::Ptr res)
         task.get(), &Task::finished, this,
         [this, ticket] {
             m_active_parse_tasks.remove(ticket);
+            if (m_active_parse_tasks.isEmpty())
+                saveParseCache();
             emit parseFinished();
         },
         Qt::ConnectionType::QueuedConnection);
 
     m_helper_thread_task.addTask(task);
 
-    if (!m_helper_thread_task.isRunning()) {
-        QThreadPool::globalInstance()->start(&m_helper_thread_task);
+    if (!m_helper_thread_task.isRunning() && !m_helper_thread_start.isRunning()) {
+        m_helper_thread_start = QtConcurrent::run(QThreadPool::globalInstance(), [this] { m_helper_thread_task.start(); });
     }
 }
 
+bool ResourceFolderModel::restoreFromParseCache(Resource& res)
+{
+    // nothing changed since the last time it got parsed, no need to open it again
+    if (!m_parse_cache)
+        return false;
+    auto parsed = m_parse_cache->find(res.fileinfo());
+    return parsed && res.restoreParsed(*parsed);
+}
+
 void ResourceFolderModel::onUpdateSucceeded()
 {
     auto update_results = static_cast<BasicFolderLoadTask*>(m_current_update_task.get())->result();
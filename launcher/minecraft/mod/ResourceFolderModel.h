@@ -4,13 +4,17 @@
 #include <QAction>
 #include <QDir>
 #include <QFileSystemWatcher>
+#include <QFuture>
 #include <QHeaderView>
 #include <QMutex>
 #include <QSet>
 #include <QSortFilterProxyModel>
 #include <QTreeView>
 
+#include <memory>
+
 #include "Resource.h"
+#include "ResourceParseCache.h"
 
 #include "BaseInstance.h"
 
@@ -93,6 +97,13 @@ class ResourceFolderModel : public QAbstractListModel {
      */
     [[nodiscard]] bool hasPendingParseTasks() const;
 
+    /** Keeps what the parse tasks find out in the cache file at `path`, so resources that didn't change since
+     *  don't get parsed again the next time around. An empty path turns that off.
+     *
+     *  By default, that's a file per instance and folder in the launcher's cache.
+     */
+    void setParseCache(const QString& path);
+
     /* Qt behavior */
 
     /* Basic columns */
@@ -162,6 +173,11 @@ class ResourceFolderModel : public QAbstractListModel {
      */
     [[nodiscard]] virtual Task* createParseTask(Resource&) { return nullptr; }
 
+    /** Brings the parse cache up to date with the resources we have now, and writes it out. */
+    void saveParseCache();
+    /** Fills in `res` from the parse cache, if it has anything for it. Returns whether it did. */
+    bool restoreFromParseCache(Resource& res);
+
     /** Standard implementation of the model update logic.
      *
      *  It uses set operations to find differences between the current state and the updated state,
@@ -217,8 +233,11 @@ class ResourceFolderModel : public QAbstractListModel {
     QMap<QString, int> m_resources_index;
 
     ConcurrentTask m_helper_thread_task;
+    // m_helper_thread_task getting started on the thread pool
+    QFuture<void> m_helper_thread_start;
     QMap<int, Task::Ptr> m_active_parse_tasks;
     std::atomic<int> m_next_resolution_ticket = 0;
+    std::unique_ptr<ResourceParseCache> m_parse_cache;
 };
 
 /* A macro to define useful functions to handle Resource* -> T* more easily on derived classes */
@@ -256,6 +275,8 @@ class ResourceFolderModel : public QAbstractListModel {
 template <typename T>
 void ResourceFolderModel::applyUpdates(QSet<QString>& current_set, QSet<QString>& new_set, QMap<QString, T>& new_resources)
 {
+    bool rows_changed = false;
+
     // see if the kept resources changed in some way
     {
         QSet<QString> kept_set = current_set;
@@ -317,6 +338,7 @@ void ResourceFolderModel::applyUpdates(QSet<QString>& current_set, QSet<QString>
             beginRemoveRows(QModelIndex(), removed_index, removed_index);
             m_resources.erase(removed_it);
             endRemoveRows();
+            rows_changed = true;
         }
     }
 
@@ -337,11 +359,12 @@ void ResourceFolderModel::applyUpdates(QSet<QString>& current_set, QSet<QString>
             }
 
             endInsertRows();
+            rows_changed = true;
         }
     }
 
-    // update index
-    {
+    // update index, replacing a resource keeps its row
+    if (rows_changed) {
         m_resources_index.clear();
         int idx = 0;
         for (auto const& mod : qAsConst(m_resources)) {
@@ -1,12 +1,14 @@
 #include "ResourcePack.h"
 
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDebug>
 #include <QMap>
 #include <QRegularExpression>
 
 #include "MTPixmapCache.h"
 #include "Version.h"
+#include "minecraft/mod/ResourceParseCache.h"
 
 #include "minecraft/mod/tasks/LocalResourcePackParseTask.h"
 
@@ -55,13 +57,18 @@ void ResourcePack::setImage(QImage new_image) const
 
     Q_ASSERT(!new_image.isNull());
 
+    // scale the image to avoid flooding the pixmapcache
+    auto scaled = new_image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    m_image_thumbnail = ResourceParseCache::encodeImage(scaled);
+    cacheImage(scaled);
+}
+
+QPixmap ResourcePack::cacheImage(const QImage& scaled) const
+{
     if (m_pack_image_cache_key.key.isValid())
         PixmapCache::instance().remove(m_pack_image_cache_key.key);
 
-    // scale the image to avoid flooding the pixmapcache
-    auto pixmap =
-        QPixmap::fromImage(new_image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
-
+    auto pixmap = QPixmap::fromImage(scaled);
     m_pack_image_cache_key.key = PixmapCache::instance().insert(pixmap);
     m_pack_image_cache_key.was_ever_used = true;
 
@@ -70,6 +77,7 @@ void ResourcePack::setImage(QImage new_image) const
         qWarning() << "Could not insert a image cache entry! Ignoring it.";
         m_pack_image_cache_key.was_ever_used = false;
     }
+    return pixmap;
 }
 
 QPixmap ResourcePack::image(QSize size, Qt::AspectRatioMode mode) const
@@ -82,13 +90,28 @@ QPixmap ResourcePack::image(QSize size, Qt::AspectRatioMode mode) const
     }
 
     // No valid image we can get
-    if (!m_pack_image_cache_key.was_ever_used) {
+    if (!m_pack_image_cache_key.was_ever_used && m_image_thumbnail.isEmpty()) {
         return {};
-    } else {
+    } else if (m_pack_image_cache_key.was_ever_used) {
         qDebug() << "Resource Pack" << name() << "Had it's image evicted from the cache. reloading...";
         PixmapCache::markCacheMissByEviciton();
     }
 
+    // The scaled down image we kept around (maybe from an earlier run) is much cheaper to get back than re-processing the pack.
+    // It's already scaled and encoded, so it only has to be decoded.
+    QPixmap pixmap;
+    {
+        QMutexLocker locker(&m_data_lock);
+        auto thumbnail = QImage::fromData(m_image_thumbnail, "PNG");
+        if (!thumbnail.isNull())
+            pixmap = cacheImage(thumbnail);
+    }
+    if (!pixmap.isNull()) {
+        if (size.isNull())
+            return pixmap;
+        return pixmap.scaled(size, mode, Qt::SmoothTransformation);
+    }
+
     // Imaged got evicted from the cache. Re-process it and retry.
     ResourcePackUtils::processPackPNG(*this);
     return image(size);
@@ -143,3 +166,35 @@ bool ResourcePack::valid() const
 {
     return m_pack_format != 0;
 }
+
+QByteArray ResourcePack::saveParsed() const
+{
+    if (!valid())
+        return {};
+
+    QMutexLocker locker(&m_data_lock);
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << qint32(m_pack_format) << m_description << m_image_thumbnail;
+    return data;
+}
+
+bool ResourcePack::restoreParsed(const QByteArray& data)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    qint32 pack_format;
+    QString description;
+    QByteArray thumbnail;
+    in >> pack_format >> description >> thumbnail;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    setPackFormat(pack_format);
+    setDescription(description);
+    QMutexLocker locker(&m_data_lock);
+    m_image_thumbnail = thumbnail;
+    return true;
+}
@@ -44,6 +44,9 @@ class ResourcePack : public Resource {
 
     bool valid() const override;
 
+    [[nodiscard]] QByteArray saveParsed() const override;
+    bool restoreParsed(const QByteArray& data) override;
+
     [[nodiscard]] int compare(Resource const& other, SortType type) const override;
     [[nodiscard]] bool applyFilter(QRegularExpression filter) const override;
 
@@ -68,4 +71,10 @@ class ResourcePack : public Resource {
         QPixmapCache::Key key;
         bool was_ever_used = false;
     } mutable m_pack_image_cache_key;
+    // the image as it went into the pixmap cache, as PNG
+    mutable QByteArray m_image_thumbnail;
+
+   private:
+    /** Puts an already scaled image into the pixmap cache. Expects m_data_lock to be held. */
+    QPixmap cacheImage(const QImage& scaled) const;
 };
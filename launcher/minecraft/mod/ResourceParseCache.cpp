@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ResourceParseCache.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "FileSystem.h"
+
+static const quint32 s_magic = 0x50415253;  // "PARS"
+// bump this whenever a parser starts finding out something different, so old results get parsed again
+static const quint32 s_version = 2;
+
+ResourceParseCache::ResourceParseCache(const QString& path) : m_path(path)
+{
+    load();
+}
+
+std::optional<QByteArray> ResourceParseCache::find(const QFileInfo& file) const
+{
+    if (!cacheable(file))
+        return {};
+    auto it = m_entries.constFind(key(file));
+    if (it == m_entries.constEnd() || it->size != file.size() || it->modified != file.lastModified().toMSecsSinceEpoch())
+        return {};
+    return it->data;
+}
+
+void ResourceParseCache::insert(const QFileInfo& file, const QByteArray& data)
+{
+    if (!cacheable(file) || data.isEmpty())
+        return;
+    Entry entry{ file.size(), file.lastModified().toMSecsSinceEpoch(), data };
+    auto& current = m_entries[key(file)];
+    if (current.size == entry.size && current.modified == entry.modified && current.data == entry.data)
+        return;
+    current = entry;
+    m_changed = true;
+}
+
+void ResourceParseCache::retain(const QSet<QString>& keys)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (keys.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+            m_changed = true;
+        }
+    }
+}
+
+QString ResourceParseCache::key(const QFileInfo& file)
+{
+    auto name = file.fileName();
+    if (name.endsWith(".disabled"))
+        name.chop(9);
+    return name;
+}
+
+QString ResourceParseCache::instanceCacheDir(const QString& instance_id)
+{
+    return QDir("cache/parsed").absoluteFilePath(instance_id);
+}
+
+void ResourceParseCache::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != s_magic || version != s_version)
+        return;
+
+    QHash<QString, Entry> entries;
+    entries.reserve(count);
+    for (quint32 i = 0; i < count; i++) {
+        QString name;
+        Entry entry;
+        in >> name >> entry.size >> entry.modified >> entry.data;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Ignoring damaged resource cache" << m_path;
+            return;
+        }
+        entries.insert(name, entry);
+    }
+    m_entries = std::move(entries);
+}
+
+QByteArray ResourceParseCache::encodeImage(const QImage& image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    if (image.isNull() || !buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, "PNG"))
+        return {};
+    return data;
+}
+
+bool ResourceParseCache::save()
+{
+    if (!m_changed)
+        return true;
+
+    if (!FS::ensureFilePathExists(m_path))
+        return false;
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << s_magic << s_version << quint32(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+        out << it.key() << it->size << it->modified << it->data;
+
+    if (out.status() != QDataStream::Ok)
+        file.cancelWriting();
+    if (!file.commit()) {
+        qWarning() << "Could not write resource cache" << m_path;
+        return false;
+    }
+    m_changed = false;
+    return true;
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QSet>
+#include <QString>
+#include <optional>
+
+/**
+ * Remembers what parsing the resources of one folder found out, so they don't have to be opened and parsed again
+ * every time the folder gets loaded.
+ *
+ * Entries are keyed by file name (without a trailing ".disabled", so turning a resource off and on again doesn't lose it),
+ * and only count as long as the file still has the same size and modification time.
+ * What goes into an entry is up to the resource, see Resource::saveParsed(). Only plain files get cached, the contents
+ * of a folder can change without the folder itself looking any different.
+ *
+ * The cache is a single file, read when the cache is created and written back by save().
+ */
+class ResourceParseCache {
+   public:
+    /* Loads the cache from `path`, if it's there. */
+    explicit ResourceParseCache(const QString& path);
+
+    QString path() const { return m_path; }
+
+    /* What was stored for `file`, unless the file changed since. */
+    std::optional<QByteArray> find(const QFileInfo& file) const;
+    void insert(const QFileInfo& file, const QByteArray& data);
+
+    /* Forgets about all files but the ones with these keys, see key(). */
+    void retain(const QSet<QString>& keys);
+
+    /* What `file` is known by in the cache. */
+    static QString key(const QFileInfo& file);
+
+    /* Where the caches for the resource folders of the instance `instance_id` go. */
+    static QString instanceCacheDir(const QString& instance_id);
+
+    /* Writes the cache back, if anything changed. */
+    bool save();
+
+    /* `image` as PNG, for resources that keep their (already scaled down) images in the cache. */
+    static QByteArray encodeImage(const QImage& image);
+
+   private:
+    struct Entry {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray data;
+    };
+
+    static bool cacheable(const QFileInfo& file) { return file.isFile(); }
+    void load();
+
+   private:
+    QString m_path;
+    QHash<QString, Entry> m_entries;
+    bool m_changed = false;
+};
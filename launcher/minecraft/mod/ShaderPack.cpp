@@ -22,6 +22,7 @@
 
 #include "ShaderPack.h"
 
+#include <QDataStream>
 #include <QRegularExpression>
 
 void ShaderPack::setPackFormat(ShaderPackFormat new_format)
@@ -35,3 +36,30 @@ bool ShaderPack::valid() const
 {
     return m_pack_format != ShaderPackFormat::INVALID;
 }
+
+QByteArray ShaderPack::saveParsed() const
+{
+    // invalid packs are cheap to find out about again, and might just be missing their shaders folder for now
+    if (!valid())
+        return {};
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << qint32(m_pack_format);
+    return data;
+}
+
+bool ShaderPack::restoreParsed(const QByteArray& data)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    qint32 format;
+    in >> format;
+    if (in.status() != QDataStream::Ok || format != qint32(ShaderPackFormat::VALID))
+        return false;
+
+    setPackFormat(ShaderPackFormat::VALID);
+    return true;
+}
@@ -55,6 +55,9 @@ class ShaderPack : public Resource {
 
     bool valid() const override;
 
+    [[nodiscard]] QByteArray saveParsed() const override;
+    bool restoreParsed(const QByteArray& data) override;
+
    protected:
     mutable QMutex m_data_lock;
 
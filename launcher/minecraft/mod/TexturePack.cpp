@@ -19,12 +19,15 @@
 
 #include "TexturePack.h"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QMap>
 #include <QRegularExpression>
 
 #include "MTPixmapCache.h"
 
+#include "minecraft/mod/ResourceParseCache.h"
+
 #include "minecraft/mod/tasks/LocalTexturePackParseTask.h"
 
 void TexturePack::setDescription(QString new_description)
@@ -40,15 +43,21 @@ void TexturePack::setImage(QImage new_image) const
 
     Q_ASSERT(!new_image.isNull());
 
+    // scale the image to avoid flooding the pixmapcache
+    auto scaled = new_image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    m_image_thumbnail = ResourceParseCache::encodeImage(scaled);
+    cacheImage(scaled);
+}
+
+QPixmap TexturePack::cacheImage(const QImage& scaled) const
+{
     if (m_pack_image_cache_key.key.isValid())
         PixmapCache::remove(m_pack_image_cache_key.key);
 
-    // scale the image to avoid flooding the pixmapcache
-    auto pixmap =
-        QPixmap::fromImage(new_image.scaled({ 64, 64 }, Qt::AspectRatioMode::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
-
+    auto pixmap = QPixmap::fromImage(scaled);
     m_pack_image_cache_key.key = PixmapCache::insert(pixmap);
     m_pack_image_cache_key.was_ever_used = true;
+    return pixmap;
 }
 
 QPixmap TexturePack::image(QSize size, Qt::AspectRatioMode mode) const
@@ -61,13 +70,28 @@ QPixmap TexturePack::image(QSize size, Qt::AspectRatioMode mode) const
     }
 
     // No valid image we can get
-    if (!m_pack_image_cache_key.was_ever_used) {
+    if (!m_pack_image_cache_key.was_ever_used && m_image_thumbnail.isEmpty()) {
         return {};
-    } else {
+    } else if (m_pack_image_cache_key.was_ever_used) {
         qDebug() << "Texture Pack" << name() << "Had it's image evicted from the cache. reloading...";
         PixmapCache::markCacheMissByEviciton();
     }
 
+    // The scaled down image we kept around (maybe from an earlier run) is much cheaper to get back than re-processing the pack.
+    // It's already scaled and encoded, so it only has to be decoded.
+    QPixmap pixmap;
+    {
+        QMutexLocker locker(&m_data_lock);
+        auto thumbnail = QImage::fromData(m_image_thumbnail, "PNG");
+        if (!thumbnail.isNull())
+            pixmap = cacheImage(thumbnail);
+    }
+    if (!pixmap.isNull()) {
+        if (size.isNull())
+            return pixmap;
+        return pixmap.scaled(size, mode, Qt::SmoothTransformation);
+    }
+
     // Imaged got evicted from the cache. Re-process it and retry.
     TexturePackUtils::processPackPNG(*this);
     return image(size);
@@ -77,3 +101,33 @@ bool TexturePack::valid() const
 {
     return m_description != nullptr;
 }
+
+QByteArray TexturePack::saveParsed() const
+{
+    if (!valid())
+        return {};
+
+    QMutexLocker locker(&m_data_lock);
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << m_description << m_image_thumbnail;
+    return data;
+}
+
+bool TexturePack::restoreParsed(const QByteArray& data)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    QString description;
+    QByteArray thumbnail;
+    in >> description >> thumbnail;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    setDescription(description);
+    QMutexLocker locker(&m_data_lock);
+    m_image_thumbnail = thumbnail;
+    return true;
+}
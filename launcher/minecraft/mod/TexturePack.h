@@ -50,6 +50,9 @@ class TexturePack : public Resource {
 
     bool valid() const override;
 
+    [[nodiscard]] QByteArray saveParsed() const override;
+    bool restoreParsed(const QByteArray& data) override;
+
    protected:
     mutable QMutex m_data_lock;
 
@@ -66,4 +69,10 @@ class TexturePack : public Resource {
         QPixmapCache::Key key;
         bool was_ever_used = false;
     } mutable m_pack_image_cache_key;
+    // the image as it went into the pixmap cache, as PNG
+    mutable QByteArray m_image_thumbnail;
+
+   private:
+    /** Puts an already scaled image into the pixmap cache. Expects m_data_lock to be held. */
+    QPixmap cacheImage(const QImage& scaled) const;
 };
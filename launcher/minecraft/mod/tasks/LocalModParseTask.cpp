@@ -1,9 +1,8 @@
 #include "LocalModParseTask.h"
 
 #include <qdcss.h>
-#include <quazip/quazip.h>
-#include <quazip/quazipfile.h>
 #include <toml++/toml.h>
+#include <QImage>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -13,6 +12,7 @@
 
 #include "FileSystem.h"
 #include "Json.h"
+#include "ZipReader.h"
 #include "minecraft/mod/ModDetails.h"
 #include "settings/INIFile.h"
 
@@ -20,6 +20,9 @@ static QRegularExpression newlineRegex("\r\n|\n|\r");
 
 namespace ModUtils {
 
+// metadata and icons are small, anything bigger is a broken jar that isn't worth inflating
+static const qint64 s_maxEntrySize = 8 * 1024 * 1024;
+
 // NEW format
 // https://github.com/MinecraftForge/FML/wiki/FML-mod-information-file/c8d8f1929aff9979e322af79a59ce81f3e02db6a
 
@@ -447,128 +450,55 @@ ModDetails ReadNilModInfo(QByteArray contents, QString fname)
     return details;
 }
 
-bool process(Mod& mod, ProcessingLevel level)
+static RawModInfo readZIP(const QFileInfo& file)
 {
-    switch (mod.type()) {
-        case ResourceType::FOLDER:
-            return processFolder(mod, level);
-        case ResourceType::ZIPFILE:
-            return processZIP(mod, level);
-        case ResourceType::LITEMOD:
-            return processLitemod(mod);
-        default:
-            qWarning() << "Invalid type for mod parse task!";
-            return false;
-    }
-}
+    RawModInfo raw;
 
-bool processZIP(Mod& mod, [[maybe_unused]] ProcessingLevel level)
-{
-    ModDetails details;
+    ZipReader zip(file.filePath());
+    if (!zip.open())
+        return raw;
 
-    QuaZip zip(mod.fileinfo().filePath());
-    if (!zip.open(QuaZip::mdUnzip))
-        return false;
-
-    QuaZipFile file(&zip);
-
-    if (zip.setCurrentFile("META-INF/mods.toml") || zip.setCurrentFile("META-INF/neoforge.mods.toml")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
-        }
-
-        details = ReadMCModTOML(file.readAll());
-        file.close();
+    auto toml = zip.findFirst({ "META-INF/mods.toml", "META-INF/neoforge.mods.toml" });
+    if (!toml.isEmpty()) {
+        if (!zip.read(toml, raw.contents, s_maxEntrySize))
+            return {};
 
         // to replace ${file.jarVersion} with the actual version, as needed
-        if (details.version == "${file.jarVersion}") {
-            if (zip.setCurrentFile("META-INF/MANIFEST.MF")) {
-                if (!file.open(QIODevice::ReadOnly)) {
-                    zip.close();
-                    return false;
-                }
-
-                // quick and dirty line-by-line parser
-                auto manifestLines = QString(file.readAll()).split(newlineRegex);
-                QString manifestVersion = "";
-                for (auto& line : manifestLines) {
-                    if (line.startsWith("Implementation-Version: ", Qt::CaseInsensitive)) {
-                        manifestVersion = line.remove("Implementation-Version: ", Qt::CaseInsensitive);
-                        break;
-                    }
-                }
-
-                // some mods use ${projectversion} in their build.gradle, causing this mess to show up in MANIFEST.MF
-                // also keep with forge's behavior of setting the version to "NONE" if none is found
-                if (manifestVersion.contains("task ':jar' property 'archiveVersion'") || manifestVersion == "") {
-                    manifestVersion = "NONE";
-                }
-
-                details.version = manifestVersion;
-
-                file.close();
-            }
-        }
-
-        zip.close();
-        mod.setDetails(details);
-
-        return true;
-    } else if (zip.setCurrentFile("mcmod.info")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
-        }
-
-        details = ReadMCModInfo(file.readAll());
-        file.close();
-        zip.close();
-
-        mod.setDetails(details);
-        return true;
-    } else if (zip.setCurrentFile("quilt.mod.json")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
-        }
-
-        details = ReadQuiltModInfo(file.readAll());
-        file.close();
-        zip.close();
-
-        mod.setDetails(details);
-        return true;
-    } else if (zip.setCurrentFile("fabric.mod.json")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
+        if (raw.contents.contains("${file.jarVersion}") && zip.contains("META-INF/MANIFEST.MF")) {
+            raw.manifest = zip.read("META-INF/MANIFEST.MF", s_maxEntrySize);
+            if (raw.manifest.isNull())
+                return {};
         }
 
-        details = ReadFabricModInfo(file.readAll());
-        file.close();
-        zip.close();
+        raw.format = RawModInfo::Format::ModsToml;
+        raw.file_name = toml;
+        return raw;
+    }
 
-        mod.setDetails(details);
-        return true;
-    } else if (zip.setCurrentFile("forgeversion.properties")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
-        }
+    // the other kinds of metadata, in the order we look for them
+    static const QList<std::pair<QString, RawModInfo::Format>> formats = {
+        { "mcmod.info", RawModInfo::Format::MCModInfo },
+        { "quilt.mod.json", RawModInfo::Format::QuiltModJson },
+        { "fabric.mod.json", RawModInfo::Format::FabricModJson },
+        { "forgeversion.properties", RawModInfo::Format::ForgeVersion },
+    };
+    for (auto const& [name, format] : formats) {
+        if (!zip.contains(name))
+            continue;
+        if (!zip.read(name, raw.contents, s_maxEntrySize))
+            return {};
 
-        details = ReadForgeInfo(file.readAll());
-        file.close();
-        zip.close();
+        raw.format = format;
+        raw.file_name = name;
+        return raw;
+    }
 
-        mod.setDetails(details);
-        return true;
-    } else if (zip.setCurrentFile("META-INF/nil/mappings.json")) {
+    if (zip.contains("META-INF/nil/mappings.json")) {
         // nilloader uses the filename of the metadata file for the modid, so we can't know the exact filename
         // thankfully, there is a good file to use as a canary so we don't look for nil meta all the time
 
         QString foundNilMeta;
-        for (auto& fname : zip.getFileNameList()) {
+        for (auto& fname : zip.fileNames()) {
             // nilmods can shade nilloader to be able to run as a standalone agent - which includes nilloader's own meta file
             if (fname.endsWith(".nilmod.css") && fname != "nilloader.nilmod.css") {
                 foundNilMeta = fname;
@@ -576,71 +506,151 @@ bool processZIP(Mod& mod, [[maybe_unused]] ProcessingLevel level)
             }
         }
 
-        if (zip.setCurrentFile(foundNilMeta)) {
-            if (!file.open(QIODevice::ReadOnly)) {
-                zip.close();
-                return false;
-            }
-
-            details = ReadNilModInfo(file.readAll(), foundNilMeta);
-            file.close();
-            zip.close();
+        if (zip.contains(foundNilMeta)) {
+            if (!zip.read(foundNilMeta, raw.contents, s_maxEntrySize))
+                return {};
 
-            mod.setDetails(details);
-            return true;
+            raw.format = RawModInfo::Format::NilMod;
+            raw.file_name = foundNilMeta;
+            return raw;
         }
     }
 
-    zip.close();
-    return false;  // no valid mod found in archive
+    return raw;  // no valid mod found in archive
 }
 
-bool processFolder(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+static RawModInfo readFolder(const QFileInfo& file)
 {
-    ModDetails details;
+    RawModInfo raw;
 
-    QFileInfo mcmod_info(FS::PathCombine(mod.fileinfo().filePath(), "mcmod.info"));
+    QFileInfo mcmod_info(FS::PathCombine(file.filePath(), "mcmod.info"));
     if (mcmod_info.exists() && mcmod_info.isFile()) {
         QFile mcmod(mcmod_info.filePath());
         if (!mcmod.open(QIODevice::ReadOnly))
-            return false;
-        auto data = mcmod.readAll();
-        if (data.isEmpty() || data.isNull())
-            return false;
-        details = ReadMCModInfo(data);
+            return raw;
+        raw.contents = mcmod.readAll();
+        if (raw.contents.isEmpty())
+            return raw;
 
-        mod.setDetails(details);
-        return true;
+        raw.format = RawModInfo::Format::MCModInfo;
+        raw.file_name = "mcmod.info";
     }
 
-    return false;  // no valid mcmod.info file found
+    return raw;  // no valid mcmod.info file found
 }
 
-bool processLitemod(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+static RawModInfo readLitemod(const QFileInfo& file)
 {
-    ModDetails details;
+    RawModInfo raw;
 
-    QuaZip zip(mod.fileinfo().filePath());
-    if (!zip.open(QuaZip::mdUnzip))
-        return false;
+    ZipReader zip(file.filePath());
+    if (!zip.open())
+        return raw;
 
-    QuaZipFile file(&zip);
+    if (zip.contains("litemod.json")) {
+        if (!zip.read("litemod.json", raw.contents, s_maxEntrySize))
+            return raw;
 
-    if (zip.setCurrentFile("litemod.json")) {
-        if (!file.open(QIODevice::ReadOnly)) {
-            zip.close();
-            return false;
-        }
+        raw.format = RawModInfo::Format::LiteModJson;
+        raw.file_name = "litemod.json";
+    }
 
-        details = ReadLiteModInfo(file.readAll());
-        file.close();
+    return raw;  // no valid litemod.json found in archive
+}
 
-        mod.setDetails(details);
-        return true;
+RawModInfo readModInfo(ResourceType type, const QFileInfo& file)
+{
+    switch (type) {
+        case ResourceType::FOLDER:
+            return readFolder(file);
+        case ResourceType::ZIPFILE:
+            return readZIP(file);
+        case ResourceType::LITEMOD:
+            return readLitemod(file);
+        default:
+            qWarning() << "Invalid type for mod parse task!";
+            return {};
     }
-    zip.close();
+}
+
+bool parseModInfo(const RawModInfo& raw, ModDetails& details)
+{
+    switch (raw.format) {
+        case RawModInfo::Format::ModsToml:
+            details = ReadMCModTOML(raw.contents);
 
-    return false;  // no valid litemod.json found in archive
+            if (details.version == "${file.jarVersion}" && !raw.manifest.isNull()) {
+                // quick and dirty line-by-line parser
+                auto manifestLines = QString(raw.manifest).split(newlineRegex);
+                QString manifestVersion = "";
+                for (auto& line : manifestLines) {
+                    if (line.startsWith("Implementation-Version: ", Qt::CaseInsensitive)) {
+                        manifestVersion = line.remove("Implementation-Version: ", Qt::CaseInsensitive);
+                        break;
+                    }
+                }
+
+                // some mods use ${projectversion} in their build.gradle, causing this mess to show up in MANIFEST.MF
+                // also keep with forge's behavior of setting the version to "NONE" if none is found
+                if (manifestVersion.contains("task ':jar' property 'archiveVersion'") || manifestVersion == "") {
+                    manifestVersion = "NONE";
+                }
+
+                details.version = manifestVersion;
+            }
+            return true;
+        case RawModInfo::Format::MCModInfo:
+            details = ReadMCModInfo(raw.contents);
+            return true;
+        case RawModInfo::Format::QuiltModJson:
+            details = ReadQuiltModInfo(raw.contents);
+            return true;
+        case RawModInfo::Format::FabricModJson:
+            details = ReadFabricModInfo(raw.contents);
+            return true;
+        case RawModInfo::Format::ForgeVersion:
+            details = ReadForgeInfo(raw.contents);
+            return true;
+        case RawModInfo::Format::NilMod:
+            details = ReadNilModInfo(raw.contents, raw.file_name);
+            return true;
+        case RawModInfo::Format::LiteModJson:
+            details = ReadLiteModInfo(raw.contents);
+            return true;
+        case RawModInfo::Format::None:
+            break;
+    }
+    return false;
+}
+
+static bool processAs(Mod& mod, ResourceType type)
+{
+    ModDetails details;
+    if (!parseModInfo(readModInfo(type, mod.fileinfo()), details))
+        return false;
+
+    mod.setDetails(details);
+    return true;
+}
+
+bool process(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+{
+    return processAs(mod, mod.type());
+}
+
+bool processZIP(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+{
+    return processAs(mod, ResourceType::ZIPFILE);
+}
+
+bool processFolder(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+{
+    return processAs(mod, ResourceType::FOLDER);
+}
+
+bool processLitemod(Mod& mod, [[maybe_unused]] ProcessingLevel level)
+{
+    return processAs(mod, ResourceType::LITEMOD);
 }
 
 /** Checks whether a file is valid as a mod or not. */
@@ -650,6 +660,44 @@ bool validate(QFileInfo file)
     return ModUtils::process(mod, ProcessingLevel::BasicInfoOnly) && mod.valid();
 }
 
+bool readIconFile(ResourceType type, const QFileInfo& file, const QString& icon_path, QByteArray& data, QString* error)
+{
+    auto fail = [error](const QString& reason) {
+        if (error)
+            *error = reason;
+        return false;
+    };
+
+    switch (type) {
+        case ResourceType::FOLDER: {
+            QFileInfo icon_info(FS::PathCombine(file.filePath(), icon_path));
+            if (!icon_info.exists() || !icon_info.isFile())
+                return fail("file '" + icon_info.filePath() + "' does not exists or is not a file");
+
+            QFile icon(icon_info.filePath());
+            if (!icon.open(QIODevice::ReadOnly))
+                return fail("failed  to open file " + icon_info.filePath());
+            data = icon.readAll();
+            return true;
+        }
+        case ResourceType::ZIPFILE: {
+            ZipReader zip(file.filePath());
+            if (!zip.open())
+                return fail("failed to open '" + file.filePath() + "' as a zip archive");
+
+            if (!zip.contains(icon_path))
+                return fail("Failed to set '" + icon_path + "' as current file in zip archive");  // could not set icon as current file.
+            if (!zip.read(icon_path, data, s_maxEntrySize))
+                return fail("Failed to open '" + icon_path + "' in zip archive");
+            return true;
+        }
+        case ResourceType::LITEMOD:
+            return fail("litemods do not have icons");  // can lightmods even have icons?
+        default:
+            return fail("Invalid type for mod, can not load icon.");
+    }
+}
+
 bool processIconPNG(const Mod& mod, QByteArray&& raw_data, QPixmap* pixmap)
 {
     auto img = QImage::fromData(raw_data);
@@ -674,60 +722,14 @@ bool loadIconFile(const Mod& mod, QPixmap* pixmap)
         return false;
     };
 
-    switch (mod.type()) {
-        case ResourceType::FOLDER: {
-            QFileInfo icon_info(FS::PathCombine(mod.fileinfo().filePath(), mod.iconPath()));
-            if (icon_info.exists() && icon_info.isFile()) {
-                QFile icon(icon_info.filePath());
-                if (!icon.open(QIODevice::ReadOnly)) {
-                    return png_invalid("failed  to open file " + icon_info.filePath());
-                }
-                auto data = icon.readAll();
-
-                bool icon_result = ModUtils::processIconPNG(mod, std::move(data), pixmap);
-
-                icon.close();
-
-                if (!icon_result) {
-                    return png_invalid("invalid png image");  // icon invalid
-                }
-                return true;
-            }
-            return png_invalid("file '" + icon_info.filePath() + "' does not exists or is not a file");
-        }
-        case ResourceType::ZIPFILE: {
-            QuaZip zip(mod.fileinfo().filePath());
-            if (!zip.open(QuaZip::mdUnzip))
-                return png_invalid("failed to open '" + mod.fileinfo().filePath() + "' as a zip archive");
-
-            QuaZipFile file(&zip);
-
-            if (zip.setCurrentFile(mod.iconPath())) {
-                if (!file.open(QIODevice::ReadOnly)) {
-                    qCritical() << "Failed to open file in zip.";
-                    zip.close();
-                    return png_invalid("Failed to open '" + mod.iconPath() + "' in zip archive");
-                }
-
-                auto data = file.readAll();
+    QByteArray data;
+    QString error;
+    if (!readIconFile(mod.type(), mod.fileinfo(), mod.iconPath(), data, &error))
+        return png_invalid(error);
 
-                bool icon_result = ModUtils::processIconPNG(mod, std::move(data), pixmap);
-
-                file.close();
-                if (!icon_result) {
-                    return png_invalid("invalid png image");  // icon png invalid
-                }
-                return true;
-            }
-            return png_invalid("Failed to set '" + mod.iconPath() +
-                               "' as current file in zip archive");  // could not set icon as current file.
-        }
-        case ResourceType::LITEMOD: {
-            return png_invalid("litemods do not have icons");  // can lightmods even have icons?
-        }
-        default:
-            return png_invalid("Invalid type for mod, can not load icon.");
-    }
+    if (!ModUtils::processIconPNG(mod, std::move(data), pixmap))
+        return png_invalid("invalid png image");  // icon png invalid
+    return true;
 }
 
 }  // namespace ModUtils
@@ -742,15 +744,34 @@ bool LocalModParseTask::abort()
     return true;
 }
 
-void LocalModParseTask::executeTask()
+void LocalModParseTask::readInfo()
+{
+    m_raw = ModUtils::readModInfo(m_type, m_modFile);
+}
+
+void LocalModParseTask::parseInfo()
 {
-    Mod mod{ m_modFile };
-    ModUtils::process(mod, ModUtils::ProcessingLevel::Full);
+    ModUtils::parseModInfo(m_raw, m_result->details);
+    m_raw = {};
+}
 
-    m_result->details = mod.details();
+void LocalModParseTask::begin()
+{
+    m_state = State::Running;
+    emit started();
+}
 
+void LocalModParseTask::finish()
+{
     if (m_aborted)
         emitAborted();
     else
         emitSucceeded();
 }
+
+void LocalModParseTask::executeTask()
+{
+    readInfo();
+    parseInfo();
+    finish();
+}
@@ -17,6 +17,22 @@ ModDetails ReadLiteModInfo(QByteArray contents);
 
 enum class ProcessingLevel { Full, BasicInfoOnly };
 
+/** What describes a mod, as it was read from the file and before any parsing. */
+struct RawModInfo {
+    enum class Format { None, ModsToml, MCModInfo, QuiltModJson, FabricModJson, ForgeVersion, NilMod, LiteModJson };
+    Format format = Format::None;
+    // where in the mod it came from
+    QString file_name;
+    QByteArray contents;
+    // only read when mods.toml wants the version from it
+    QByteArray manifest;
+};
+
+/** Reads the metadata out of the mod, without making sense of it yet. This is all the I/O there is to a parse. */
+RawModInfo readModInfo(ResourceType type, const QFileInfo& file);
+/** Parses what readModInfo() found. Returns false if there wasn't anything to parse. */
+bool parseModInfo(const RawModInfo& raw, ModDetails& details);
+
 bool process(Mod& mod, ProcessingLevel level = ProcessingLevel::Full);
 
 bool processZIP(Mod& mod, ProcessingLevel level = ProcessingLevel::Full);
@@ -26,6 +42,8 @@ bool processLitemod(Mod& mod, ProcessingLevel level = ProcessingLevel::Full);
 /** Checks whether a file is valid as a mod or not. */
 bool validate(QFileInfo file);
 
+/** Reads the icon at `icon_path` out of the mod. On failure, `error` says why. */
+bool readIconFile(ResourceType type, const QFileInfo& file, const QString& icon_path, QByteArray& data, QString* error = nullptr);
 bool processIconPNG(const Mod& mod, QByteArray&& raw_data, QPixmap* pixmap);
 bool loadIconFile(const Mod& mod, QPixmap* pixmap);
 }  // namespace ModUtils
@@ -33,6 +51,8 @@ bool loadIconFile(const Mod& mod, QPixmap* pixmap);
 class LocalModParseTask : public Task {
     Q_OBJECT
    public:
+    using Ptr = shared_qobject_ptr<LocalModParseTask>;
+
     struct Result {
         ModDetails details;
     };
@@ -46,6 +66,19 @@ class LocalModParseTask : public Task {
     void executeTask() override;
 
     [[nodiscard]] int token() const { return m_token; }
+    [[nodiscard]] bool isAborted() const { return m_aborted; }
+
+    /* The steps of a parse, so that ModParsePipeline can run them on the threads that suit them.
+     * executeTask() runs them one after the other. The icon isn't part of it, it only gets loaded once it's shown. */
+    // I/O
+    void readInfo();
+    // CPU
+    void parseInfo();
+
+    /* For running the steps without start(): the task counts as running from begin() on, and finish() reports how it
+     * went (succeeded, or aborted), like executeTask() does. Both on the task's own thread. */
+    void begin();
+    void finish();
 
    private:
     void processAsZip();
@@ -58,5 +91,7 @@ class LocalModParseTask : public Task {
     QFileInfo m_modFile;
     ResultPtr m_result;
 
+    ModUtils::RawModInfo m_raw;
+
     std::atomic<bool> m_aborted = false;
 };
@@ -20,15 +20,15 @@
 
 #include "FileSystem.h"
 #include "Json.h"
-
-#include <quazip/quazip.h>
-#include <quazip/quazipdir.h>
-#include <quazip/quazipfile.h>
+#include "ZipReader.h"
 
 #include <QCryptographicHash>
 
 namespace ResourcePackUtils {
 
+// pack.mcmeta and pack.png are small, anything bigger is a broken pack that isn't worth inflating
+static const qint64 s_maxEntrySize = 8 * 1024 * 1024;
+
 bool process(ResourcePack& pack, ProcessingLevel level)
 {
     switch (pack.type()) {
@@ -108,29 +108,24 @@ bool processZIP(ResourcePack& pack, ProcessingLevel level)
 {
     Q_ASSERT(pack.type() == ResourceType::ZIPFILE);
 
-    QuaZip zip(pack.fileinfo().filePath());
-    if (!zip.open(QuaZip::mdUnzip))
+    ZipReader zip(pack.fileinfo().filePath());
+    if (!zip.open())
         return false;  // can't open zip file
 
-    QuaZipFile file(&zip);
-
     auto mcmeta_invalid = [&pack]() {
         qWarning() << "Resource pack at" << pack.fileinfo().filePath() << "does not have a valid pack.mcmeta";
         return false;  // the mcmeta is not optional
     };
 
-    if (zip.setCurrentFile("pack.mcmeta")) {
-        if (!file.open(QIODevice::ReadOnly)) {
+    if (zip.contains("pack.mcmeta")) {
+        QByteArray data;
+        if (!zip.read("pack.mcmeta", data, s_maxEntrySize)) {
             qCritical() << "Failed to open file in zip.";
-            zip.close();
             return mcmeta_invalid();
         }
 
-        auto data = file.readAll();
-
         bool mcmeta_result = ResourcePackUtils::processMCMeta(pack, std::move(data));
 
-        file.close();
         if (!mcmeta_result) {
             return mcmeta_invalid();  // mcmeta invalid
         }
@@ -138,13 +133,11 @@ bool processZIP(ResourcePack& pack, ProcessingLevel level)
         return mcmeta_invalid();  // could not set pack.mcmeta as current file.
     }
 
-    QuaZipDir zipDir(&zip);
-    if (!zipDir.exists("/assets")) {
+    if (!zip.containsDirectory("assets")) {
         return false;  // assets dir does not exists at zip root
     }
 
     if (level == ProcessingLevel::BasicInfoOnly) {
-        zip.close();
         return true;  // only need basic info already checked
     }
 
@@ -153,28 +146,22 @@ bool processZIP(ResourcePack& pack, ProcessingLevel level)
         return true;  // the png is optional
     };
 
-    if (zip.setCurrentFile("pack.png")) {
-        if (!file.open(QIODevice::ReadOnly)) {
+    if (zip.contains("pack.png")) {
+        QByteArray data;
+        if (!zip.read("pack.png", data, s_maxEntrySize)) {
             qCritical() << "Failed to open file in zip.";
-            zip.close();
             return png_invalid();
         }
 
-        auto data = file.readAll();
-
         bool pack_png_result = ResourcePackUtils::processPackPNG(pack, std::move(data));
 
-        file.close();
-        zip.close();
         if (!pack_png_result) {
             return png_invalid();  // pack.png invalid
         }
     } else {
-        zip.close();
         return png_invalid();  // could not set pack.mcmeta as current file.
     }
 
-    zip.close();
     return true;
 }
 
@@ -319,23 +306,19 @@ bool processPackPNG(const ResourcePack& pack)
             return false;  // not processed correctly; https://github.com/PrismLauncher/PrismLauncher/issues/1740
         }
         case ResourceType::ZIPFILE: {
-            QuaZip zip(pack.fileinfo().filePath());
-            if (!zip.open(QuaZip::mdUnzip))
+            ZipReader zip(pack.fileinfo().filePath());
+            if (!zip.open())
                 return false;  // can't open zip file
 
-            QuaZipFile file(&zip);
-            if (zip.setCurrentFile("pack.png")) {
-                if (!file.open(QIODevice::ReadOnly)) {
+            if (zip.contains("pack.png")) {
+                QByteArray data;
+                if (!zip.read("pack.png", data, s_maxEntrySize)) {
                     qCritical() << "Failed to open file in zip.";
-                    zip.close();
                     return png_invalid();
                 }
 
-                auto data = file.readAll();
-
                 bool pack_png_result = ResourcePackUtils::processPackPNG(pack, std::move(data));
 
-                file.close();
                 if (!pack_png_result) {
                     return png_invalid();  // pack.png invalid
                 }
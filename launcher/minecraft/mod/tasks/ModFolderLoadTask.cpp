@@ -40,40 +40,52 @@
 #include "FileSystem.h"
 #include "minecraft/mod/MetadataHandler.h"
 
+#include <QDateTime>
 #include <QThread>
 
-ModFolderLoadTask::ModFolderLoadTask(QDir mods_dir, QDir index_dir, bool is_indexed, bool clean_orphan)
+ModFolderLoadTask::ModFolderLoadTask(QDir mods_dir, QDir index_dir, bool is_indexed, bool clean_orphan, SnapshotPtr previous)
     : Task(false)
     , m_mods_dir(mods_dir)
     , m_index_dir(index_dir)
     , m_is_indexed(is_indexed)
     , m_clean_orphan(clean_orphan)
+    , m_previous(clean_orphan ? nullptr : std::move(previous))
     , m_result(new Result())
     , m_thread_to_spawn_into(thread())
 {}
 
+static ModFolderLoadTask::FileState fileState(const QFileInfo& file)
+{
+    return { file.size(), file.lastModified().toMSecsSinceEpoch() };
+}
+
 void ModFolderLoadTask::executeTask()
 {
     if (thread() != m_thread_to_spawn_into)
         connect(this, &Task::finished, this->thread(), &QThread::quit);
 
+    auto snapshot = std::make_shared<Snapshot>();
+    QStringList index_files;
+    if (m_is_indexed)
+        index_files = snapshotIndex(*snapshot);
+    auto entries = snapshotMods(*snapshot);
+
+    // everything else is already in the model just like it is on disk
+    QSet<QString> changed;
+    if (m_previous)
+        changed = changedSince(*snapshot);
+    const QSet<QString>* only = m_previous ? &changed : nullptr;
+
     if (m_is_indexed) {
         // Read metadata first
-        getFromMetadata();
+        getFromMetadata(*snapshot, index_files, only);
     }
 
     // Read JAR files that don't have metadata
-    m_mods_dir.refresh();
-    for (auto entry : m_mods_dir.entryInfoList()) {
-        auto filePath = entry.absoluteFilePath();
-        if (auto app = APPLICATION_DYN; app && app->checkQSavePath(filePath)) {
+    for (auto const& entry : entries) {
+        if (only && !only->contains(entry.fileName()))
             continue;
-        }
-        auto newFilePath = FS::getUniqueResourceName(filePath);
-        if (newFilePath != filePath) {
-            FS::move(filePath, newFilePath);
-            entry = QFileInfo(newFilePath);
-        }
+
         Mod* mod(new Mod(entry));
 
         if (mod->enabled()) {
@@ -117,6 +129,15 @@ void ModFolderLoadTask::executeTask()
         }
     }
 
+    if (only) {
+        m_result->incremental = true;
+        for (auto const& id : changed) {
+            if (!m_result->mods.contains(id))
+                m_result->removed.insert(id);
+        }
+    }
+    m_result->snapshot = snapshot;
+
     for (auto mod : m_result->mods)
         mod->moveToThread(m_thread_to_spawn_into);
 
@@ -126,15 +147,105 @@ void ModFolderLoadTask::executeTask()
         emitSucceeded();
 }
 
-void ModFolderLoadTask::getFromMetadata()
+QStringList ModFolderLoadTask::snapshotIndex(Snapshot& snapshot)
 {
+    QStringList names;
     m_index_dir.refresh();
-    for (auto entry : m_index_dir.entryList(QDir::Files)) {
-        auto metadata = Metadata::get(m_index_dir, entry);
+    for (auto const& entry : m_index_dir.entryInfoList(QDir::Files)) {
+        auto name = entry.fileName();
+        auto state = fileState(entry);
+        names.append(name);
+        snapshot.index_files.insert(name, state);
+
+        // parsing the index files is what takes the longest, so only do that for the ones that changed
+        if (m_previous) {
+            auto before = m_previous->index_files.constFind(name);
+            auto metadata = m_previous->metadata.constFind(name);
+            if (before != m_previous->index_files.constEnd() && *before == state && metadata != m_previous->metadata.constEnd()) {
+                snapshot.metadata.insert(name, *metadata);
+                continue;
+            }
+        }
+        snapshot.metadata.insert(name, Metadata::get(m_index_dir, name));
+    }
+    return names;
+}
+
+QFileInfoList ModFolderLoadTask::snapshotMods(Snapshot& snapshot)
+{
+    QFileInfoList entries;
+    m_mods_dir.refresh();
+    for (auto entry : m_mods_dir.entryInfoList()) {
+        auto filePath = entry.absoluteFilePath();
+        if (auto app = APPLICATION_DYN; app && app->checkQSavePath(filePath)) {
+            continue;
+        }
+        auto newFilePath = FS::getUniqueResourceName(filePath);
+        if (newFilePath != filePath) {
+            FS::move(filePath, newFilePath);
+            entry = QFileInfo(newFilePath);
+        }
+        entries.append(entry);
+        snapshot.mod_files.insert(entry.fileName(), fileState(entry));
+    }
+    return entries;
+}
+
+// the mod an index file is about, if any
+static QString metadataTarget(const ModFolderLoadTask::Snapshot& snapshot, const QString& index_file)
+{
+    auto metadata = snapshot.metadata.constFind(index_file);
+    if (metadata == snapshot.metadata.constEnd() || !metadata->isValid())
+        return {};
+    return QFileInfo(metadata->filename).fileName();
+}
+
+QSet<QString> ModFolderLoadTask::changedSince(const Snapshot& snapshot) const
+{
+    QSet<QString> names;
+
+    for (auto it = snapshot.mod_files.constBegin(); it != snapshot.mod_files.constEnd(); ++it) {
+        auto before = m_previous->mod_files.constFind(it.key());
+        if (before == m_previous->mod_files.constEnd() || *before != it.value())
+            names.insert(it.key());
+    }
+    for (auto it = m_previous->mod_files.constBegin(); it != m_previous->mod_files.constEnd(); ++it) {
+        if (!snapshot.mod_files.contains(it.key()))
+            names.insert(it.key());
+    }
+
+    // a changed index file affects the mod it used to be about, and the one it is about now
+    for (auto it = snapshot.index_files.constBegin(); it != snapshot.index_files.constEnd(); ++it) {
+        auto before = m_previous->index_files.constFind(it.key());
+        if (before == m_previous->index_files.constEnd() || *before != it.value())
+            names << metadataTarget(snapshot, it.key()) << metadataTarget(*m_previous, it.key());
+    }
+    for (auto it = m_previous->index_files.constBegin(); it != m_previous->index_files.constEnd(); ++it) {
+        if (!snapshot.index_files.contains(it.key()))
+            names << metadataTarget(*m_previous, it.key());
+    }
+    names.remove(QString());
+
+    // a mod and its disabled counterpart get merged with each other, so they are always looked at together
+    QSet<QString> changed;
+    for (auto const& name : names) {
+        auto enabled = name.endsWith(".disabled") ? name.chopped(9) : name;
+        changed << enabled << enabled + ".disabled";
+    }
+    return changed;
+}
+
+void ModFolderLoadTask::getFromMetadata(const Snapshot& snapshot, const QStringList& index_files, const QSet<QString>* only)
+{
+    for (auto const& entry : index_files) {
+        auto const& metadata = snapshot.metadata[entry];
 
         if (!metadata.isValid()) {
             continue;
         }
+        if (only && !only->contains(QFileInfo(metadata.filename).fileName())) {
+            continue;
+        }
 
         auto* mod = new Mod(m_mods_dir, metadata);
         mod->setStatus(ModStatus::NotInstalled);
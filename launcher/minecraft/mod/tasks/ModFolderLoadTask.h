@@ -37,24 +37,49 @@
 #pragma once
 
 #include <QDir>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QRunnable>
+#include <QSet>
 #include <memory>
+#include "minecraft/mod/MetadataHandler.h"
 #include "minecraft/mod/Mod.h"
 #include "tasks/Task.h"
 
 class ModFolderLoadTask : public Task {
     Q_OBJECT
    public:
+    struct FileState {
+        qint64 size = 0;
+        qint64 modified = 0;
+
+        bool operator==(const FileState& other) const { return size == other.size && modified == other.modified; }
+        bool operator!=(const FileState& other) const { return !(*this == other); }
+    };
+    /* What the mods and index folders looked like after a load, so the next one only has to look at what changed. */
+    struct Snapshot {
+        // by file name
+        QHash<QString, FileState> mod_files;
+        QHash<QString, FileState> index_files;
+        // what each index file said, by index file name
+        QHash<QString, Metadata::ModStruct> metadata;
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
     struct Result {
         QMap<QString, Mod::Ptr> mods;
+        // if set, `mods` only has the mods that changed since the previous snapshot, and `removed` the ones that are gone
+        bool incremental = false;
+        QSet<QString> removed;
+        SnapshotPtr snapshot;
     };
     using ResultPtr = std::shared_ptr<Result>;
     ResultPtr result() const { return m_result; }
 
    public:
-    ModFolderLoadTask(QDir mods_dir, QDir index_dir, bool is_indexed, bool clean_orphan = false);
+    /* With a `previous` snapshot (and no orphans to clean), only the mods whose files changed since are looked at. */
+    ModFolderLoadTask(QDir mods_dir, QDir index_dir, bool is_indexed, bool clean_orphan = false, SnapshotPtr previous = nullptr);
 
     [[nodiscard]] bool canAbort() const override { return true; }
     bool abort() override
@@ -66,12 +91,16 @@ class ModFolderLoadTask : public Task {
     void executeTask() override;
 
    private:
-    void getFromMetadata();
+    QStringList snapshotIndex(Snapshot& snapshot);
+    QFileInfoList snapshotMods(Snapshot& snapshot);
+    QSet<QString> changedSince(const Snapshot& snapshot) const;
+    void getFromMetadata(const Snapshot& snapshot, const QStringList& index_files, const QSet<QString>* only);
 
    private:
     QDir m_mods_dir, m_index_dir;
     bool m_is_indexed;
     bool m_clean_orphan;
+    SnapshotPtr m_previous;
     ResultPtr m_result;
 
     std::atomic<bool> m_aborted = false;
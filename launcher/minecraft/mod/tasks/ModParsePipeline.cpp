@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ModParsePipeline.h"
+
+#include <QMutex>
+#include <QQueue>
+#include <utility>
+
+#include "tasks/WorkerPool.h"
+
+struct ModParsePipeline::State {
+    QMutex lock;
+    // waiting for a slot
+    QQueue<LocalModParseTask::Ptr> queue;
+    // waiting to go out with the next batch
+    QList<LocalModParseTask::Ptr> batch;
+    int in_flight = 0;
+    // read and not yet handed out
+    int max_in_flight = 64;
+    // null once the pipeline is gone
+    ModParsePipeline* pipeline = nullptr;
+};
+
+ModParsePipeline::ModParsePipeline(QObject* parent) : QObject(parent), m_state(std::make_shared<State>()), m_batch_timer(this)
+{
+    m_state->pipeline = this;
+
+    m_batch_timer.setSingleShot(true);
+    m_batch_timer.setInterval(s_batchInterval);
+    connect(&m_batch_timer, &QTimer::timeout, this, &ModParsePipeline::flushBatch);
+}
+
+ModParsePipeline::~ModParsePipeline()
+{
+    {
+        QMutexLocker locker(&m_state->lock);
+        m_state->pipeline = nullptr;
+        m_state->queue.clear();
+    }
+    for (auto const& task : qAsConst(m_tasks)) {
+        task->abort();
+        task->finish();
+    }
+}
+
+void ModParsePipeline::setMaxInFlight(int max)
+{
+    QMutexLocker locker(&m_state->lock);
+    m_state->max_in_flight = qMax(1, max);
+}
+
+void ModParsePipeline::add(LocalModParseTask::Ptr task)
+{
+    m_tasks.insert(task.get(), task);
+    task->begin();
+
+    QMutexLocker locker(&m_state->lock);
+    if (m_state->in_flight >= m_state->max_in_flight) {
+        m_state->queue.enqueue(task);
+        return;
+    }
+    m_state->in_flight++;
+    read(m_state, task);
+}
+
+void ModParsePipeline::read(std::shared_ptr<State> state, LocalModParseTask::Ptr task)
+{
+    WorkerPool::io().start([state, task] {
+        if (task->isAborted())
+            return done(state, task);
+        task->readInfo();
+        parse(state, task);
+    });
+}
+
+void ModParsePipeline::parse(std::shared_ptr<State> state, LocalModParseTask::Ptr task)
+{
+    WorkerPool::instance().start([state, task] {
+        if (!task->isAborted())
+            task->parseInfo();
+        done(state, task);
+    });
+}
+
+void ModParsePipeline::done(std::shared_ptr<State> state, LocalModParseTask::Ptr task)
+{
+    QMutexLocker locker(&state->lock);
+
+    state->batch.append(task);
+    // the first one of a batch starts the clock on it
+    if (state->batch.size() == 1 && state->pipeline)
+        QMetaObject::invokeMethod(state->pipeline, &ModParsePipeline::batchReady, Qt::QueuedConnection);
+
+    if (state->queue.isEmpty() || !state->pipeline)
+        state->in_flight--;
+    else
+        read(state, state->queue.dequeue());
+}
+
+void ModParsePipeline::batchReady()
+{
+    if (!m_batch_timer.isActive())
+        m_batch_timer.start();
+}
+
+void ModParsePipeline::flushBatch()
+{
+    QList<LocalModParseTask::Ptr> batch;
+    {
+        QMutexLocker locker(&m_state->lock);
+        batch = std::exchange(m_state->batch, {});
+    }
+    if (batch.isEmpty())
+        return;
+
+    for (auto const& task : batch) {
+        m_tasks.remove(task.get());
+        task->finish();
+    }
+    emit finished(batch);
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <chrono>
+#include <memory>
+
+#include "minecraft/mod/tasks/LocalModParseTask.h"
+
+/**
+ * Parses mods with the disk and the cores kept busy at the same time.
+ *
+ * Every parse goes through the steps of LocalModParseTask: reading the metadata runs on WorkerPool::io(), and parsing it
+ * runs on WorkerPool::instance(). Only so many mods are in flight at once (see setMaxInFlight()), so a folder with
+ * thousands of them isn't all read into memory before any of it gets parsed.
+ *
+ * Finished parses come out of finished() in batches, at most once per s_batchInterval, so whoever listens (the model,
+ * and the view on it) updates a few times per second rather than once per mod. Every task that goes in comes out,
+ * aborted ones included, and has finished (with Task's signals) by then.
+ */
+class ModParsePipeline : public QObject {
+    Q_OBJECT
+   public:
+    static constexpr std::chrono::milliseconds s_batchInterval{ 250 };
+
+    explicit ModParsePipeline(QObject* parent = nullptr);
+    // aborts the parses that didn't come out yet. the jobs of those already on the pools don't touch the pipeline
+    ~ModParsePipeline() override;
+
+    /** How many mods are read or parsed at once, at most. */
+    void setMaxInFlight(int max);
+
+    void add(LocalModParseTask::Ptr task);
+    /** Whether any of the tasks added didn't come out of finished() yet. */
+    [[nodiscard]] bool isBusy() const { return !m_tasks.isEmpty(); }
+
+   signals:
+    /** The tasks that went through all of their steps, or were aborted, since the last batch. */
+    void finished(QList<LocalModParseTask::Ptr> tasks);
+
+   private:
+    struct State;
+
+    static void read(std::shared_ptr<State> state, LocalModParseTask::Ptr task);
+    static void parse(std::shared_ptr<State> state, LocalModParseTask::Ptr task);
+    static void done(std::shared_ptr<State> state, LocalModParseTask::Ptr task);
+
+    void batchReady();
+    void flushBatch();
+
+   private:
+    // shared with the jobs on the pools, which can outlive us
+    std::shared_ptr<State> m_state;
+    QTimer m_batch_timer;
+    // added and not out of finished() yet
+    QHash<LocalModParseTask*, LocalModParseTask::Ptr> m_tasks;
+};
@@ -53,7 +53,6 @@ bool AssetUpdateTask::canAbort() const
 
 void AssetUpdateTask::assetIndexFinished()
 {
-    AssetsIndex index;
     qDebug() << m_inst->name() << ": Finished asset index download";
 
     auto components = m_inst->getPackProfile();
@@ -62,18 +61,20 @@ void AssetUpdateTask::assetIndexFinished()
 
     QString asset_fname = "assets/indexes/" + assets->id + ".json";
     // FIXME: this looks like a job for a generic validator based on json schema?
-    if (!AssetsUtils::loadAssetsIndexJson(assets->id, asset_fname, index)) {
+    if (!AssetsUtils::loadAssetsIndexJson(assets->id, asset_fname, m_index)) {
         auto metacache = APPLICATION->metacache();
         auto entry = metacache->resolveEntry("asset_indexes", assets->id + ".json");
         metacache->evictEntry(entry);
         emitFailed(tr("Failed to read the assets index!"));
+        return;
     }
 
-    auto job = index.getDownloadJob();
+    // only a stat for every object, hashing them all would hold up the launch
+    auto job = m_index.getDownloadJob();
     if (job) {
         setStatus(tr("Getting the assets files from Mojang..."));
         downloadJob = job;
-        connect(downloadJob.get(), &NetJob::succeeded, this, &AssetUpdateTask::emitSucceeded);
+        connect(downloadJob.get(), &NetJob::succeeded, this, &AssetUpdateTask::assetsFinished);
         connect(downloadJob.get(), &NetJob::failed, this, &AssetUpdateTask::assetsFailed);
         connect(downloadJob.get(), &NetJob::aborted, this, [this] { emitFailed(tr("Aborted")); });
         connect(downloadJob.get(), &NetJob::progress, this, &AssetUpdateTask::progress);
@@ -81,6 +82,13 @@ void AssetUpdateTask::assetIndexFinished()
         downloadJob->start();
         return;
     }
+    assetsFinished();
+}
+
+void AssetUpdateTask::assetsFinished()
+{
+    // whatever turns out to be corrupted gets downloaded again, without holding up the launch
+    AssetsUtils::verifyObjectsInBackground(m_index.objectChecks());
     emitSucceeded();
 }
 
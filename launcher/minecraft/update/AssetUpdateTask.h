@@ -1,4 +1,5 @@
 #pragma once
+#include "minecraft/AssetsUtils.h"
 #include "net/NetJob.h"
 #include "tasks/Task.h"
 class MinecraftInstance;
@@ -16,6 +17,7 @@ class AssetUpdateTask : public Task {
    private slots:
     void assetIndexFinished();
     void assetIndexFailed(QString reason);
+    void assetsFinished();
     void assetsFailed(QString reason);
 
    public slots:
@@ -24,4 +26,5 @@ class AssetUpdateTask : public Task {
    private:
     MinecraftInstance* m_inst;
     NetJob::Ptr downloadJob;
+    AssetsIndex m_index;
 };
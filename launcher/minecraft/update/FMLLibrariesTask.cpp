@@ -59,6 +59,7 @@ void FMLLibrariesTask::executeTask()
     // download missing libs to our place
     setStatus(tr("Downloading FML libraries..."));
     NetJob::Ptr dljob{ new NetJob("FML libraries", APPLICATION->network()) };
+    dljob->setPriority(Net::Scheduler::Priority::Bulk);
     auto metacache = APPLICATION->metacache();
     Net::Download::Options options = Net::Download::Option::MakeEternal;
     for (auto& lib : fmlLibsToProcess) {
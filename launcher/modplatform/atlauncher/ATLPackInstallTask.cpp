@@ -717,6 +717,7 @@ void PackInstallTask::downloadMods()
 
     jarmods.clear();
     jobPtr.reset(new NetJob(tr("Mod download"), APPLICATION->network()));
+    jobPtr->setPriority(Net::Scheduler::Priority::Bulk);
 
     QList<VersionMod> blocked_mods;
     for (const auto& mod : m_version.mods) {
@@ -519,6 +519,7 @@ void FlameCreationTask::idResolverSucceeded(QEventLoop& loop)
 void FlameCreationTask::setupDownloadJob(QEventLoop& loop)
 {
     m_files_job.reset(new NetJob(tr("Mod Download Flame"), APPLICATION->network()));
+    m_files_job->setPriority(Net::Scheduler::Priority::Bulk);
     auto results = m_mod_id_resolver->getResults().files;
 
     QStringList optionalFiles;
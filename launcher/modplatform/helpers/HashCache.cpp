@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HashCache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include "FileSystem.h"
+
+#if defined(Q_OS_UNIX)
+#include <sys/stat.h>
+#endif
+
+namespace Hashing {
+
+// bump this when the on-disk layout changes, old indexes are then simply discarded
+static const quint32 s_index_magic = 0x48434958;  // "HCIX"
+static const quint32 s_index_version = 3;
+
+// entries not looked at for this long are dropped on save
+static const qint64 s_max_unused_age = 60 * 60 * 24 * 30;
+
+FileIdentity FileIdentity::of(const QString& file_path)
+{
+    FileIdentity identity;
+    // before looking, so a change made while we do can't look older than it is
+    identity.taken = QDateTime::currentMSecsSinceEpoch();
+
+    QFileInfo info(file_path);
+    auto canonical = info.canonicalFilePath();
+    if (canonical.isEmpty() || !info.isFile())
+        return identity;
+
+    identity.path = canonical;
+    identity.size = info.size();
+    identity.mtime = info.lastModified().toMSecsSinceEpoch();
+#if defined(Q_OS_UNIX)
+    QT_STATBUF st;
+    if (QT_STAT(QFile::encodeName(canonical).constData(), &st) == 0)
+        identity.inode = st.st_ino;
+#endif
+
+    return identity;
+}
+
+HashCache::HashCache(QString path) : QObject(), m_index_file(path)
+{
+    m_saveBatchingTimer.setSingleShot(true);
+    m_saveBatchingTimer.setTimerType(Qt::VeryCoarseTimer);
+
+    connect(&m_saveBatchingTimer, &QTimer::timeout, this, &HashCache::SaveNow);
+}
+
+HashCache::~HashCache()
+{
+    m_saveBatchingTimer.stop();
+    SaveNow();
+}
+
+QString HashCache::get(const FileIdentity& file, Algorithm alg)
+{
+    if (!file.isValid())
+        return {};
+
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_entries.find(file.path);
+    if (it == m_entries.end())
+        return {};
+
+    // the file changed under us, so nothing we know about it is valid anymore
+    if (it->identity != file) {
+        m_entries.erase(it);
+        m_dirty = true;
+        return {};
+    }
+    // it may have changed right after it was hashed, without anything to show for it
+    if (!it->identity.isSettled())
+        return {};
+
+    it->last_used = QDateTime::currentSecsSinceEpoch();
+    return it->hashes.value(static_cast<int>(alg));
+}
+
+void HashCache::put(const FileIdentity& file, Algorithm alg, const QString& hash)
+{
+    if (!file.isValid() || hash.isEmpty() || alg == Algorithm::Unknown)
+        return;
+    // it's hashed again next time, once it can be told apart from what comes after it
+    if (!file.isSettled())
+        return;
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        auto& entry = m_entries[file.path];
+        if (entry.identity != file) {
+            entry.identity = file;
+            entry.hashes.clear();
+        }
+        entry.last_used = QDateTime::currentSecsSinceEpoch();
+        entry.verified = entry.last_used;
+        entry.hashes.insert(static_cast<int>(alg), hash);
+        m_dirty = true;
+    }
+
+    SaveEventually();
+}
+
+qint64 HashCache::verifiedAt(const FileIdentity& file)
+{
+    if (!file.isValid())
+        return 0;
+
+    QMutexLocker locker(&m_lock);
+    auto it = m_entries.find(file.path);
+    if (it == m_entries.end() || it->identity != file || !it->identity.isSettled())
+        return 0;
+    return it->verified;
+}
+
+void HashCache::SaveEventually()
+{
+    // the timer lives on our thread, and hashes are usually computed elsewhere
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            // reset the save timer
+            m_saveBatchingTimer.stop();
+            m_saveBatchingTimer.start(30000);
+        },
+        Qt::AutoConnection);
+}
+
+void HashCache::Load()
+{
+    if (m_index_file.isNull())
+        return;
+
+    QFile index(m_index_file);
+    if (!index.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&index);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != s_index_magic || version != s_index_version) {
+        qWarning() << "[HashCache]" << "Ignoring hash cache with unknown format";
+        return;
+    }
+
+    quint32 count;
+    in >> count;
+
+    QMutexLocker locker(&m_lock);
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        Entry entry;
+        quint32 hash_count;
+        in >> entry.identity.path >> entry.identity.size >> entry.identity.mtime >> entry.identity.inode >> entry.identity.taken >>
+            entry.last_used >> entry.verified >> hash_count;
+        for (quint32 j = 0; j < hash_count && in.status() == QDataStream::Ok; j++) {
+            qint32 alg;
+            QString hash;
+            in >> alg >> hash;
+            entry.hashes.insert(alg, hash);
+        }
+        m_entries.insert(entry.identity.path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "[HashCache]" << "Hash cache is truncated, starting over";
+        m_entries.clear();
+    }
+}
+
+void HashCache::SaveNow()
+{
+    if (m_index_file.isNull())
+        return;
+
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_dirty)
+            return;
+
+        auto oldest = QDateTime::currentSecsSinceEpoch() - s_max_unused_age;
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->last_used < oldest)
+                it = m_entries.erase(it);
+            else
+                ++it;
+        }
+
+        qDebug() << "[HashCache]" << "Saving hash cache with" << m_entries.size() << "entries";
+
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << s_index_magic << s_index_version << static_cast<quint32>(m_entries.size());
+        for (auto& entry : m_entries) {
+            out << entry.identity.path << entry.identity.size << entry.identity.mtime << entry.identity.inode << entry.identity.taken
+                << entry.last_used << entry.verified << static_cast<quint32>(entry.hashes.size());
+            for (auto it = entry.hashes.constBegin(); it != entry.hashes.constEnd(); ++it)
+                out << static_cast<qint32>(it.key()) << it.value();
+        }
+        m_dirty = false;
+    }
+
+    try {
+        FS::write(m_index_file, data);
+    } catch (const Exception& e) {
+        qWarning() << "[HashCache]" << "Error writing hash cache:" << e.what();
+    }
+}
+
+}  // namespace Hashing
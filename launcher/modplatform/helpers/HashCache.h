@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "modplatform/helpers/HashUtils.h"
+
+namespace Hashing {
+
+/** What we know about a file on disk without reading it. If any of these change, the cached hashes are gone. */
+struct FileIdentity {
+    // some file systems only keep the modification time to a second or two
+    static constexpr qint64 s_mtimeGranularity = 2000;
+
+    QString path;  // canonical path
+    qint64 size = -1;
+    qint64 mtime = 0;  // msecs since epoch
+    quint64 inode = 0;  // always 0 on Windows
+    qint64 taken = 0;  // msecs since epoch, when the rest was looked at. not part of the identity
+
+    bool isValid() const { return !path.isEmpty(); }
+    /* A file changed in the same tick of the clock as it was looked at keeps its mtime (and, on Windows, everything
+     * else), so only a file that was already older than that is known to be the one that got read. */
+    bool isSettled() const { return mtime < taken - s_mtimeGranularity; }
+    bool operator==(const FileIdentity& other) const
+    {
+        return path == other.path && size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+    bool operator!=(const FileIdentity& other) const { return !(*this == other); }
+
+    static FileIdentity of(const QString& file_path);
+};
+
+/** Launcher-wide persistent index of file hashes, shared by every hashing user.
+ *
+ *  Entries are keyed by canonical path and validated against the file's size, mtime and inode,
+ *  so a changed file only invalidates its own entry. Files modified right before they were hashed aren't cached at all,
+ *  see FileIdentity::isSettled(). Entries of files that went away age out. This is thread-safe, since hashing happens on
+ *  the thread pool.
+ */
+class HashCache : public QObject {
+    Q_OBJECT
+   public:
+    // supply path to the cache index file
+    HashCache(QString path = QString());
+    ~HashCache() override;
+
+    // returns the cached hash, or an empty string if we don't have a valid one
+    QString get(const FileIdentity& file, Algorithm alg);
+    QString get(const QString& file_path, Algorithm alg) { return get(FileIdentity::of(file_path), alg); }
+
+    // store a hash computed from the file as it was when `file` was taken
+    void put(const FileIdentity& file, Algorithm alg, const QString& hash);
+
+    // when a hash was last put() for the file as it is now (secs since epoch), or 0 if we don't have a valid one
+    qint64 verifiedAt(const FileIdentity& file);
+
+    // (re)start a timer that calls SaveNow later. Safe to call from any thread.
+    void SaveEventually();
+    void Load();
+
+   public slots:
+    void SaveNow();
+
+   private:
+    struct Entry {
+        FileIdentity identity;
+        qint64 last_used = 0;  // secs since epoch
+        qint64 verified = 0;   // secs since epoch, when a hash was last computed from the file
+        QHash<int, QString> hashes;
+    };
+
+    QMutex m_lock;
+    QHash<QString, Entry> m_entries;
+    QString m_index_file;
+    QTimer m_saveBatchingTimer;
+    bool m_dirty = false;
+};
+
+}  // namespace Hashing
@@ -3,12 +3,21 @@
 #include <QBuffer>
 #include <QDebug>
 #include <QFile>
-#include <QtConcurrentRun>
+
+#include <memory>
+#include <vector>
 
 #include <MurmurHash2.h>
 
+#include "Application.h"
+#include "modplatform/helpers/HashCache.h"
+#include "tasks/WorkerPool.h"
+
 namespace Hashing {
 
+// how much we read at once when hashing a file in a streaming fashion
+static const qint64 s_chunk_size = 1024 * 1024;
+
 Hasher::Ptr createHasher(QString file_path, ModPlatform::ResourceProvider provider)
 {
     switch (provider) {
@@ -28,18 +37,37 @@ Hasher::Ptr createHasher(QString file_path, QString type)
     return makeShared<Hasher>(file_path, type);
 }
 
-class QIODeviceReader : public Murmur2::Reader {
-   public:
-    QIODeviceReader(QIODevice* device) : m_device(device) {}
-    virtual ~QIODeviceReader() = default;
-    virtual int read(char* s, int n) { return m_device->read(s, n); }
-    virtual bool eof() { return m_device->atEnd(); }
-    virtual void goToBeginning() { m_device->seek(0); }
-    virtual void close() { m_device->close(); }
+// CurseForge fingerprint of an open device.
+// Files are memory-mapped so the whitespace stripping and hashing happen without extra copies. Anything else is
+// streamed through a fixed buffer, twice, since the seed depends on the stripped length.
+static uint32_t murmur2(QIODevice* device)
+{
+    if (auto* file = qobject_cast<QFile*>(device); file && file->size() > 0) {
+        if (auto* data = file->map(0, file->size())) {
+            auto result = Murmur2::fingerprint(reinterpret_cast<const char*>(data), file->size());
+            file->unmap(data);
+            return result;
+        }
+    }
+
+    if (device->isSequential()) {
+        auto data = device->readAll();
+        return Murmur2::fingerprintInPlace(data.data(), data.size());
+    }
 
-   private:
-    QIODevice* m_device;
-};
+    auto start = device->pos();
+    QByteArray buffer(s_chunk_size, Qt::Uninitialized);
+    qint64 read;
+    uint64_t packed_len = 0;
+    while ((read = device->read(buffer.data(), buffer.size())) > 0)
+        packed_len += Murmur2::countNonWhitespace(buffer.constData(), read);
+
+    device->seek(start);
+    Murmur2::Fingerprinter fingerprinter(packed_len);
+    while ((read = device->read(buffer.data(), buffer.size())) > 0)
+        fingerprinter.update(buffer.constData(), read);
+    return fingerprinter.finish();
+}
 
 QString algorithmToString(Algorithm type)
 {
@@ -80,39 +108,41 @@ Algorithm algorithmFromString(QString type)
     return Algorithm::Unknown;
 }
 
-QString hash(QIODevice* device, Algorithm type)
+static QCryptographicHash::Algorithm cryptoAlgorithm(Algorithm type)
 {
-    if (!device->isOpen() && !device->open(QFile::ReadOnly))
-        return "";
-    QCryptographicHash::Algorithm alg = QCryptographicHash::Sha1;
     switch (type) {
         case Algorithm::Md4:
-            alg = QCryptographicHash::Algorithm::Md4;
-            break;
+            return QCryptographicHash::Algorithm::Md4;
         case Algorithm::Md5:
-            alg = QCryptographicHash::Algorithm::Md5;
-            break;
-        case Algorithm::Sha1:
-            alg = QCryptographicHash::Algorithm::Sha1;
-            break;
+            return QCryptographicHash::Algorithm::Md5;
         case Algorithm::Sha256:
-            alg = QCryptographicHash::Algorithm::Sha256;
-            break;
+            return QCryptographicHash::Algorithm::Sha256;
         case Algorithm::Sha512:
-            alg = QCryptographicHash::Algorithm::Sha512;
-            break;
+            return QCryptographicHash::Algorithm::Sha512;
+        case Algorithm::Sha1:
+        default:
+            return QCryptographicHash::Algorithm::Sha1;
+    }
+}
+
+QString hash(QIODevice* device, Algorithm type)
+{
+    if (!device->isOpen() && !device->open(QFile::ReadOnly))
+        return "";
+    switch (type) {
         case Algorithm::Murmur2: {  // CF-specific
-            auto should_filter_out = [](char c) { return (c == 9 || c == 10 || c == 13 || c == 32); };
-            auto reader = std::make_unique<QIODeviceReader>(device);
-            auto result = QString::number(Murmur2::hash(reader.get(), 4 * MiB, should_filter_out));
+            auto result = QString::number(murmur2(device));
             device->close();
             return result;
         }
         case Algorithm::Unknown:
             device->close();
             return "";
+        default:
+            break;
     }
 
+    auto alg = cryptoAlgorithm(type);
     QCryptographicHash hash(alg);
     if (!hash.addData(device))
         qCritical() << "Failed to read JAR to create hash!";
@@ -123,22 +153,129 @@ QString hash(QIODevice* device, Algorithm type)
     return result;
 }
 
+Digests hashes(QIODevice* device, QList<Algorithm> types)
+{
+    if (!device->isOpen() && !device->open(QFile::ReadOnly))
+        return {};
+
+    // we need to rewind for murmur2, so just buffer anything we can't seek in
+    if (device->isSequential() && types.contains(Algorithm::Murmur2)) {
+        auto data = device->readAll();
+        device->close();
+        QBuffer buff(&data);
+        return hashes(&buff, types);
+    }
+
+    std::vector<std::pair<Algorithm, std::unique_ptr<QCryptographicHash>>> crypto;
+    bool murmur2 = false;
+    for (auto type : types) {
+        if (type == Algorithm::Murmur2)
+            murmur2 = true;
+        else if (type != Algorithm::Unknown)
+            crypto.emplace_back(type, std::make_unique<QCryptographicHash>(cryptoAlgorithm(type)));
+    }
+
+    QByteArray buffer(s_chunk_size, Qt::Uninitialized);
+    qint64 read;
+
+    // MurmurHash2 is seeded with the whitespace-stripped length, which costs us a (cheap) counting pass first.
+    std::unique_ptr<Murmur2::Fingerprinter> fingerprinter;
+    if (murmur2) {
+        uint64_t packed_len = 0;
+        while ((read = device->read(buffer.data(), buffer.size())) > 0)
+            packed_len += Murmur2::countNonWhitespace(buffer.constData(), read);
+        device->seek(0);
+        fingerprinter = std::make_unique<Murmur2::Fingerprinter>(packed_len);
+    }
+
+    while ((read = device->read(buffer.data(), buffer.size())) > 0) {
+        auto chunk = QByteArray::fromRawData(buffer.constData(), read);
+        for (auto& [type, hasher] : crypto)
+            hasher->addData(chunk);
+        if (fingerprinter)
+            fingerprinter->update(buffer.constData(), read);
+    }
+    device->close();
+
+    if (read < 0) {
+        qCritical() << "Failed to read JAR to create hashes!";
+        return {};
+    }
+
+    Digests result;
+    for (auto& [type, hasher] : crypto)
+        result.insert(type, hasher->result().toHex());
+    if (fingerprinter)
+        result.insert(Algorithm::Murmur2, QString::number(fingerprinter->finish()));
+    return result;
+}
+
 QString hash(QString fileName, Algorithm type)
 {
+    shared_qobject_ptr<HashCache> cache;
+    if (auto app = APPLICATION_DYN)
+        cache = app->hashCache();
+
+    if (!cache) {
+        QFile file(fileName);
+        return hash(&file, type);
+    }
+
+    // take the identity before reading, so a file changed while we hash it doesn't get a stale entry
+    auto identity = FileIdentity::of(fileName);
+    if (auto cached = cache->get(identity, type); !cached.isEmpty())
+        return cached;
+
+    QFile file(fileName);
+    auto result = hash(&file, type);
+    cache->put(identity, type, result);
+    return result;
+}
+
+Digests hashes(QString fileName, QList<Algorithm> types)
+{
+    shared_qobject_ptr<HashCache> cache;
+    if (auto app = APPLICATION_DYN)
+        cache = app->hashCache();
+
+    if (!cache) {
+        QFile file(fileName);
+        return hashes(&file, types);
+    }
+
+    auto identity = FileIdentity::of(fileName);
+
+    Digests result;
+    QList<Algorithm> missing;
+    for (auto type : types) {
+        if (auto cached = cache->get(identity, type); !cached.isEmpty())
+            result.insert(type, cached);
+        else
+            missing.append(type);
+    }
+    if (missing.isEmpty())
+        return result;
+
     QFile file(fileName);
-    return hash(&file, type);
+    auto computed = hashes(&file, missing);
+    for (auto it = computed.constBegin(); it != computed.constEnd(); ++it) {
+        cache->put(identity, it.key(), it.value());
+        result.insert(it.key(), it.value());
+    }
+    return result;
 }
 
 QString hash(QByteArray data, Algorithm type)
 {
+    if (type == Algorithm::Murmur2)
+        return QString::number(Murmur2::fingerprintInPlace(data.data(), data.size()));
     QBuffer buff(&data);
     return hash(&buff, type);
 }
 
 void Hasher::executeTask()
 {
-    m_future = QtConcurrent::run(
-        QThreadPool::globalInstance(), [](QString fileName, Algorithm type) { return hash(fileName, type); }, m_path, m_alg);
+    m_future = WorkerPool::instance().run([fileName = m_path, type = m_alg] { return hash(fileName, type); });
     connect(&m_watcher, &QFutureWatcher<QString>::finished, this, [this] {
         if (m_future.isCanceled()) {
             emitAborted();
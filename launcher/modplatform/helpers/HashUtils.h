@@ -3,6 +3,8 @@
 #include <QCryptographicHash>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QList>
+#include <QMap>
 #include <QString>
 
 #include "modplatform/ModIndex.h"
@@ -18,6 +20,13 @@ QString hash(QIODevice* device, Algorithm type);
 QString hash(QString fileName, Algorithm type);
 QString hash(QByteArray data, Algorithm type);
 
+using Digests = QMap<Algorithm, QString>;
+
+// Computes every requested digest in a single streaming read of the data, with bounded memory.
+// Note that murmur2 needs an extra counting pass, since it is seeded with the (whitespace-stripped) length.
+Digests hashes(QIODevice* device, QList<Algorithm> types);
+Digests hashes(QString fileName, QList<Algorithm> types);
+
 class Hasher : public Task {
     Q_OBJECT
    public:
@@ -81,7 +81,7 @@ void PackInstallTask::downloadPack()
     } else {
         url = QString(BuildConfig.LEGACY_FTB_CDN_BASE_URL + "modpacks/%1").arg(path);
     }
-    netJobContainer->addNetAction(Net::ApiDownload::makeCached(url, entry));
+    netJobContainer->addNetAction(Net::ApiDownload::makeCached(url, entry, Net::Download::Option::Resumable));
 
     connect(netJobContainer.get(), &NetJob::succeeded, this, &PackInstallTask::unzip);
     connect(netJobContainer.get(), &NetJob::failed, this, &PackInstallTask::emitFailed);
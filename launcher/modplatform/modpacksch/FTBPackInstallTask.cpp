@@ -293,6 +293,7 @@ void PackInstallTask::downloadPack()
     setAbortable(false);
 
     auto jobPtr = makeShared<NetJob>(tr("Mod download"), APPLICATION->network());
+    jobPtr->setPriority(Net::Scheduler::Priority::Bulk);
     for (auto const& file : m_version.files) {
         if (file.serverOnly || file.url.isEmpty())
             continue;
@@ -308,7 +309,8 @@ void PackInstallTask::downloadPack()
             dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, rawSha1));
         }
 
-        jobPtr->addNetAction(dl);
+        // the big ones first, so they don't end up as the last few downloads running on their own
+        jobPtr->addNetAction(dl, file.size > 4 * 1024 * 1024 ? NetJob::Priority::High : NetJob::Priority::Normal);
     }
 
     connect(jobPtr.get(), &NetJob::succeeded, this, &PackInstallTask::onModDownloadSucceeded);
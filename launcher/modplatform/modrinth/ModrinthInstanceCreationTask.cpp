@@ -240,6 +240,7 @@ bool ModrinthCreationTask::createInstance()
     instance.saveNow();
 
     auto downloadMods = makeShared<NetJob>(tr("Mod Download Modrinth"), APPLICATION->network());
+    downloadMods->setPriority(Net::Scheduler::Priority::Bulk);
 
     auto root_modpack_path = FS::PathCombine(m_stagingPath, m_root_path);
     auto root_modpack_url = QUrl::fromLocalFile(root_modpack_path);
@@ -22,6 +22,7 @@
 #include <QCryptographicHash>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include "Json.h"
 #include "MMCZip.h"
@@ -50,7 +51,41 @@ ModrinthPackExportTask::ModrinthPackExportTask(const QString& name,
     , gameRoot(instance->gameRoot())
     , output(output)
     , filter(filter)
-{}
+{
+    connect(&hashWatcher, &QFutureWatcher<HashedFile>::progressValueChanged, this,
+            [this](int value) { setProgress(value, hashWatcher.progressMaximum()); });
+    connect(&hashWatcher, &QFutureWatcher<HashedFile>::finished, this, [this] {
+        if (hashFuture.isCanceled()) {
+            emitAborted();
+            return;
+        }
+
+        for (const HashedFile& file : hashFuture.results()) {
+            auto sha512 = file.digests.value(Hashing::Algorithm::Sha512);
+            if (sha512.isEmpty()) {
+                qWarning() << "Could not read" << file.path << "for hashing";
+                continue;
+            }
+
+            if (!file.url.isEmpty()) {
+                qDebug() << "Resolving" << file.relative << "from index";
+
+                auto sha1 = file.digests.value(Hashing::Algorithm::Sha1);
+                resolvedFiles[file.relative] = ResolvedFile{ sha1, sha512, file.url, file.size, file.side };
+
+                // nice! we've managed to resolve based on local metadata!
+                // no need to enqueue it
+                continue;
+            }
+
+            qDebug() << "Enqueueing" << file.relative << "for Modrinth query";
+            pendingHashes[file.relative] = sha512;
+        }
+
+        setAbortable(true);
+        makeApiRequest();
+    });
+}
 
 void ModrinthPackExportTask::executeTask()
 {
@@ -61,6 +96,11 @@ void ModrinthPackExportTask::executeTask()
 
 bool ModrinthPackExportTask::abort()
 {
+    if (hashFuture.isRunning()) {
+        // NOTE: emitAborted() happens once the future actually finishes cancelling
+        hashFuture.cancel();
+        return true;
+    }
     if (task) {
         task->abort();
         emitAborted();
@@ -93,9 +133,13 @@ void ModrinthPackExportTask::collectFiles()
 void ModrinthPackExportTask::collectHashes()
 {
     setStatus(tr("Finding file hashes..."));
-    for (const QFileInfo& file : files) {
-        QCoreApplication::processEvents();
 
+    QList<Mod*> allMods;
+    if (mcInstance)
+        allMods = mcInstance->loaderModList()->allMods();
+
+    QList<HashedFile> toHash;
+    for (const QFileInfo& file : files) {
         const QString relative = gameRoot.relativeFilePath(file.absoluteFilePath());
         // require sensible file types
         if (!std::any_of(PREFIXES.begin(), PREFIXES.end(), [&relative](const QString& prefix) { return relative.startsWith(prefix); }))
@@ -105,20 +149,8 @@ void ModrinthPackExportTask::collectHashes()
             }))
             continue;
 
-        QFile openFile(file.absoluteFilePath());
-        if (!openFile.open(QFile::ReadOnly)) {
-            qWarning() << "Could not open" << file << "for hashing";
-            continue;
-        }
+        HashedFile hashed{ relative, file.absoluteFilePath(), file.size() };
 
-        const QByteArray data = openFile.readAll();
-        if (openFile.error() != QFileDevice::NoError) {
-            qWarning() << "Could not read" << file;
-            continue;
-        }
-        auto sha512 = Hashing::hash(data, Hashing::Algorithm::Sha512);
-
-        auto allMods = mcInstance->loaderModList()->allMods();
         if (auto modIter = std::find_if(allMods.begin(), allMods.end(), [&file](Mod* mod) { return mod->fileinfo() == file; });
             modIter != allMods.end()) {
             const Mod* mod = *modIter;
@@ -126,26 +158,27 @@ void ModrinthPackExportTask::collectHashes()
                 QUrl& url = mod->metadata()->url;
                 // ensure the url is permitted on modrinth.com
                 if (!url.isEmpty() && BuildConfig.MODRINTH_MRPACK_HOSTS.contains(url.host())) {
-                    qDebug() << "Resolving" << relative << "from index";
-
-                    auto sha1 = Hashing::hash(data, Hashing::Algorithm::Sha1);
-
-                    ResolvedFile resolvedFile{ sha1, sha512, url.toEncoded(), openFile.size(), mod->metadata()->side };
-                    resolvedFiles[relative] = resolvedFile;
-
-                    // nice! we've managed to resolve based on local metadata!
-                    // no need to enqueue it
-                    continue;
+                    hashed.url = url.toEncoded();
+                    hashed.side = mod->metadata()->side;
                 }
             }
         }
 
-        qDebug() << "Enqueueing" << relative << "for Modrinth query";
-        pendingHashes[relative] = sha512;
+        toHash.append(hashed);
     }
 
+    // hash everything on the thread pool, each file in a single streaming read
+    hashFuture = QtConcurrent::mapped(toHash, [](HashedFile file) {
+        QList<Hashing::Algorithm> algorithms{ Hashing::Algorithm::Sha512 };
+        // files resolved from local metadata also need their sha1 in the index
+        if (!file.url.isEmpty())
+            algorithms.append(Hashing::Algorithm::Sha1);
+        file.digests = Hashing::hashes(file.path, algorithms);
+        return file;
+    });
+
+    hashWatcher.setFuture(hashFuture);
     setAbortable(true);
-    makeApiRequest();
 }
 
 void ModrinthPackExportTask::makeApiRequest()
@@ -23,6 +23,7 @@
 #include "BaseInstance.h"
 #include "MMCZip.h"
 #include "minecraft/MinecraftInstance.h"
+#include "modplatform/helpers/HashUtils.h"
 #include "modplatform/modrinth/ModrinthAPI.h"
 #include "tasks/Task.h"
 
@@ -48,6 +49,15 @@ class ModrinthPackExportTask : public Task {
         Metadata::ModSide side;
     };
 
+    struct HashedFile {
+        QString relative, path;
+        qint64 size;
+        // set if the file can be resolved from local metadata
+        QString url;
+        Metadata::ModSide side = Metadata::ModSide::UniversalSide;
+        Hashing::Digests digests;
+    };
+
     static const QStringList PREFIXES;
     static const QStringList FILE_EXTENSIONS;
 
@@ -65,6 +75,8 @@ class ModrinthPackExportTask : public Task {
     QMap<QString, QString> pendingHashes;
     QMap<QString, ResolvedFile> resolvedFiles;
     Task::Ptr task;
+    QFuture<HashedFile> hashFuture;
+    QFutureWatcher<HashedFile> hashWatcher;
 
     void collectFiles();
     void collectHashes();
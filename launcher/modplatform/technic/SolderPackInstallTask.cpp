@@ -107,6 +107,7 @@ void Technic::SolderPackInstallTask::fileListSucceeded()
         m_minecraftVersion = build.minecraft;
 
     m_filesNetJob.reset(new NetJob(tr("Downloading modpack"), m_network));
+    m_filesNetJob->setPriority(Net::Scheduler::Priority::Bulk);
 
     int i = 0;
     for (const auto& mod : build.mods) {
@@ -45,7 +45,9 @@
 
 #include "ByteArraySink.h"
 #include "ChecksumValidator.h"
+#include "LzmaFileSink.h"
 #include "MetaCacheSink.h"
+#include "TarSink.h"
 
 namespace Net {
 
@@ -58,9 +60,32 @@ auto Download::makeCached(QUrl url, MetaEntryPtr entry, Options options) -> Down
     dl->m_options = options;
     auto md5Node = new ChecksumValidator(QCryptographicHash::Md5);
     auto cachedNode = new MetaCacheSink(entry, md5Node, options.testFlag(Option::MakeEternal));
+    cachedNode->setResumable(options.testFlag(Option::Resumable));
     dl->m_sink.reset(cachedNode);
     return dl;
 }
+
+auto Download::makeTarArchive(QUrl url, QString destination, bool gzipped, Options options) -> Download::Ptr
+{
+    auto dl = makeShared<Download>();
+    dl->m_url = url;
+    dl->setObjectName(QString("TAR:") + url.toString());
+    dl->m_options = options;
+    auto tarNode = new TarSink(destination, gzipped);
+    tarNode->setResumable(options.testFlag(Option::Resumable));
+    dl->m_sink.reset(tarNode);
+    return dl;
+}
+
+auto Download::makeLzmaFile(QUrl url, QString path, Options options) -> Download::Ptr
+{
+    auto dl = makeShared<Download>();
+    dl->m_url = url;
+    dl->setObjectName(QString("LZMA:") + url.toString());
+    dl->m_options = options;
+    dl->m_sink.reset(new LzmaFileSink(path));
+    return dl;
+}
 #endif
 
 auto Download::makeByteArray(QUrl url, std::shared_ptr<QByteArray> output, Options options) -> Download::Ptr
@@ -79,7 +104,9 @@ auto Download::makeFile(QUrl url, QString path, Options options) -> Download::Pt
     dl->m_url = url;
     dl->setObjectName(QString("FILE:") + url.toString());
     dl->m_options = options;
-    dl->m_sink.reset(new FileSink(path));
+    auto fileNode = new FileSink(path);
+    fileNode->setResumable(options.testFlag(Option::Resumable));
+    dl->m_sink.reset(fileNode);
     return dl;
 }
 
@@ -52,6 +52,10 @@ class Download : public NetRequest {
 
 #if defined(LAUNCHER_APPLICATION)
     static auto makeCached(QUrl url, MetaEntryPtr entry, Options options = Option::NoOptions) -> Download::Ptr;
+    // extracts the (gzipped) tar archive at `url` into `destination` as it downloads
+    static auto makeTarArchive(QUrl url, QString destination, bool gzipped, Options options = Option::NoOptions) -> Download::Ptr;
+    // downloads an .lzma file into `path`, decompressed. see LzmaFileSink::isSupported()
+    static auto makeLzmaFile(QUrl url, QString path, Options options = Option::NoOptions) -> Download::Ptr;
 #endif
 
     static auto makeByteArray(QUrl url, std::shared_ptr<QByteArray> output, Options options = Option::NoOptions) -> Download::Ptr;
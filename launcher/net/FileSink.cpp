@@ -35,12 +35,42 @@
 
 #include "FileSink.h"
 
+#include <QDateTime>
+#include <QDir>
+
 #include "FileSystem.h"
 
 #include "net/Logging.h"
 
 namespace Net {
 
+namespace {
+// "bytes <first>-<last>/<length>"
+qint64 contentRangeStart(QNetworkReply& reply)
+{
+    auto range = reply.rawHeader("Content-Range");
+    if (!range.startsWith("bytes "))
+        return -1;
+    bool ok;
+    auto start = range.mid(6, range.indexOf('-') - 6).trimmed().toLongLong(&ok);
+    return ok ? start : -1;
+}
+
+// partial downloads nobody came back for
+const qint64 s_partial_max_age = 60 * 60 * 24 * 7;
+
+void prunePartials(const QString& dir)
+{
+    auto cutoff = QDateTime::currentDateTime().addSecs(-s_partial_max_age);
+    for (const auto& file : QDir(dir).entryInfoList({ "*.part", "*.part.validator" }, QDir::Files | QDir::Hidden)) {
+        if (file.lastModified() < cutoff) {
+            qCDebug(taskNetLogC) << "Removing abandoned partial download" << file.filePath();
+            QFile::remove(file.filePath());
+        }
+    }
+}
+}  // namespace
+
 Task::State FileSink::init(QNetworkRequest& request)
 {
     auto result = initCache(request);
@@ -55,6 +85,9 @@ Task::State FileSink::init(QNetworkRequest& request)
     }
 
     wroteAnyData = false;
+    if (m_resumable)
+        return initPartial(request);
+
     m_output_file.reset(new PSaveFile(m_filename));
     if (!m_output_file->open(QIODevice::WriteOnly)) {
         qCCritical(taskNetLogC) << "Could not open " + m_filename + " for writing";
@@ -66,12 +99,148 @@ Task::State FileSink::init(QNetworkRequest& request)
     return Task::State::Failed;
 }
 
+Task::State FileSink::initPartial(QNetworkRequest& request)
+{
+    m_resume_offset = 0;
+    m_replay_pending = false;
+    m_partial_file.reset(new QFile(partialPath()));
+    prunePartials(QFileInfo(m_filename).absolutePath());
+
+    QFile validatorFile(partialValidatorPath());
+    QByteArray validator;
+    if (validatorFile.open(QIODevice::ReadOnly))
+        validator = validatorFile.readAll().trimmed();
+
+    if (!validator.isEmpty() && m_partial_file->size() > 0 && m_partial_file->open(QIODevice::ReadWrite)) {
+        // the validators need to see the whole file. reading back the part we already have waits for the first write,
+        // which happens off this thread, see replayPartial()
+        m_resume_offset = m_partial_file->size();
+        if (initAllValidators(request) && m_partial_file->seek(m_resume_offset)) {
+            m_replay_pending = true;
+            request.setRawHeader("Range", "bytes=" + QByteArray::number(m_resume_offset) + "-");
+            request.setRawHeader("If-Range", validator);
+            qCDebug(taskNetLogC) << "Resuming" << m_filename << "at" << m_resume_offset << "bytes";
+            return Task::State::Running;
+        }
+        m_resume_offset = 0;
+        m_partial_file->close();
+    }
+
+    // nothing to continue from
+    QFile::remove(partialValidatorPath());
+    if (!m_partial_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCCritical(taskNetLogC) << "Could not open " + partialPath() + " for writing";
+        return Task::State::Failed;
+    }
+
+    if (initAllValidators(request))
+        return Task::State::Running;
+    return Task::State::Failed;
+}
+
+Task::State FileSink::headersReceived(QNetworkReply& reply)
+{
+    if (!m_partial_file)
+        return Task::State::Running;
+
+    auto statusCode = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode == 206) {
+        if (m_resume_offset > 0 && contentRangeStart(reply) == m_resume_offset) {
+            wroteAnyData = true;
+            return Task::State::Running;
+        }
+        qCWarning(taskNetLogC) << "Got a range we didn't ask for, dropping partial download of" << m_filename;
+        discardPartial();
+        return Task::State::Failed;
+    }
+    if (statusCode == 416) {
+        // what we have doesn't fit the file on the server. the next attempt starts over
+        qCWarning(taskNetLogC) << "Server rejected the range, dropping partial download of" << m_filename;
+        discardPartial();
+        return Task::State::Failed;
+    }
+    if (statusCode != 200 && statusCode != 203)
+        return Task::State::Running;
+
+    // the whole file: the server ignored the range, or the file changed since the partial download
+    if (m_resume_offset > 0) {
+        qCDebug(taskNetLogC) << "Server sent all of" << m_filename << "instead of resuming, starting over";
+        m_resume_offset = 0;
+        m_replay_pending = false;
+        QNetworkRequest request = reply.request();
+        if (!m_partial_file->resize(0) || !m_partial_file->seek(0) || !initAllValidators(request))
+            return Task::State::Failed;
+    }
+    savePartialValidator(reply);
+    return Task::State::Running;
+}
+
+void FileSink::savePartialValidator(QNetworkReply& reply)
+{
+    // If-Range only works with strong validators
+    auto validator = reply.rawHeader("ETag");
+    if (validator.isEmpty() || validator.startsWith("W/"))
+        validator = reply.rawHeader("Last-Modified");
+
+    QFile file(partialValidatorPath());
+    if (validator.isEmpty()) {
+        // can't be resumed, so it goes away when the request fails
+        file.remove();
+        return;
+    }
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(validator) != validator.size())
+        qCWarning(taskNetLogC) << "Could not write" << partialValidatorPath();
+}
+
+bool FileSink::commitPartial()
+{
+    bool flushed = m_partial_file->flush();
+    m_partial_file->close();
+    m_partial_file.reset();
+    QFile::remove(partialValidatorPath());
+    if (!flushed || !FS::move(partialPath(), m_filename)) {
+        qCCritical(taskNetLogC) << "Failed to move" << partialPath() << "to" << m_filename;
+        QFile::remove(partialPath());
+        return false;
+    }
+    return true;
+}
+
+bool FileSink::replayPartial()
+{
+    m_replay_pending = false;
+    if (!m_partial_file->seek(0))
+        return false;
+    for (qint64 left = m_resume_offset; left > 0;) {
+        auto chunk = m_partial_file->read(qMin(left, qint64(1024 * 1024)));
+        if (chunk.isEmpty() || !writeAllValidators(chunk) || !consume(chunk))
+            return false;
+        left -= chunk.size();
+    }
+    return m_partial_file->seek(m_resume_offset);
+}
+
+void FileSink::discardPartial()
+{
+    m_partial_file.reset();
+    m_resume_offset = 0;
+    m_replay_pending = false;
+    QFile::remove(partialPath());
+    QFile::remove(partialValidatorPath());
+}
+
 Task::State FileSink::write(QByteArray& data)
 {
-    if (!writeAllValidators(data) || m_output_file->write(data) != data.size()) {
+    QFileDevice* output = m_partial_file ? static_cast<QFileDevice*>(m_partial_file.get()) : m_output_file.get();
+    bool replayed = !m_replay_pending || replayPartial();
+    if (!replayed || !writeAllValidators(data) || !consume(data) || output->write(data) != data.size()) {
         qCCritical(taskNetLogC) << "Failed writing into " + m_filename;
-        m_output_file->cancelWriting();
-        m_output_file.reset();
+        if (m_partial_file) {
+            discardPartial();
+        } else {
+            m_output_file->cancelWriting();
+            m_output_file.reset();
+        }
         wroteAnyData = false;
         return Task::State::Failed;
     }
@@ -82,7 +251,16 @@ Task::State FileSink::write(QByteArray& data)
 
 Task::State FileSink::abort()
 {
-    m_output_file->cancelWriting();
+    // a failed write already got rid of it
+    if (m_output_file)
+        m_output_file->cancelWriting();
+    if (m_partial_file) {
+        // kept for the next attempt, if there is a way to resume it
+        bool resumable = m_partial_file->flush() && m_partial_file->size() > 0 && QFile::exists(partialValidatorPath());
+        m_partial_file.reset();
+        if (!resumable)
+            discardPartial();
+    }
     failAllValidators();
     return Task::State::Failed;
 }
@@ -95,7 +273,7 @@ Task::State FileSink::finalize(QNetworkReply& reply)
     int statusCode = statusCodeV.toInt(&validStatus);
     if (validStatus) {
         // this leaves out 304 Not Modified
-        gotFile = statusCode == 200 || statusCode == 203;
+        gotFile = statusCode == 200 || statusCode == 203 || (statusCode == 206 && m_resume_offset > 0);
     }
 
     // if we wrote any data to the save file, we try to commit the data to the real file.
@@ -103,11 +281,19 @@ Task::State FileSink::finalize(QNetworkReply& reply)
     if (gotFile || wroteAnyData) {
         // ask validators for data consistency
         // we only do this for actual downloads, not 'your data is still the same' cache hits
-        if (!finalizeAllValidators(reply))
+        bool replayed = !m_replay_pending || replayPartial();
+        if (!replayed || !finalizeAllValidators(reply)) {
+            // no point in continuing a broken file
+            if (m_partial_file)
+                discardPartial();
             return Task::State::Failed;
+        }
 
         // nothing went wrong...
-        if (!m_output_file->commit()) {
+        if (m_partial_file) {
+            if (!commitPartial())
+                return Task::State::Failed;
+        } else if (!m_output_file->commit()) {
             qCCritical(taskNetLogC) << "Failed to commit changes to " << m_filename;
             m_output_file->cancelWriting();
             return Task::State::Failed;
@@ -116,7 +302,40 @@ Task::State FileSink::finalize(QNetworkReply& reply)
 
     // then get rid of the save file
     m_output_file.reset();
+    // the file we already have is current
+    if (m_partial_file)
+        discardPartial();
+
+    return finalizeCache(reply);
+}
 
+Task::State FileSink::readAdopted()
+{
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return Task::State::Inactive;
+
+    QNetworkRequest request;
+    if (!initAllValidators(request))
+        return Task::State::Failed;
+    while (!file.atEnd()) {
+        auto chunk = file.read(1024 * 1024);
+        if (chunk.isEmpty() || !writeAllValidators(chunk)) {
+            failAllValidators();
+            return Task::State::Failed;
+        }
+    }
+    return Task::State::Running;
+}
+
+Task::State FileSink::adopt(QNetworkReply& reply)
+{
+    if (!finalizeAllValidators(reply)) {
+        qCWarning(taskNetLogC) << m_filename << "doesn't match what this request expected";
+        return Task::State::Failed;
+    }
+
+    wroteAnyData = true;
     return finalizeCache(reply);
 }
 
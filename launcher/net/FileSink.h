@@ -35,6 +35,8 @@
 
 #pragma once
 
+#include <QFile>
+
 #include "PSaveFile.h"
 #include "Sink.h"
 
@@ -51,14 +53,45 @@ class FileSink : public Sink {
     auto finalize(QNetworkReply& reply) -> Task::State override;
 
     auto hasLocalData() -> bool override;
+    auto canWriteOffThread() -> bool override { return true; }
+    auto target() const -> QString override { return m_filename; }
+    auto headersReceived(QNetworkReply& reply) -> Task::State override;
+    auto readAdopted() -> Task::State override;
+    auto adopt(QNetworkReply& reply) -> Task::State override;
+
+    /* Download into `<file>.part` and keep it when the request fails, so the next attempt (like a NetJob retry)
+     * continues where this one stopped, as long as the server still has the same file.
+     * Partial downloads left alone for a week are cleaned up by the next resumable download into the same folder. */
+    void setResumable(bool resumable) { m_resumable = resumable; }
 
    protected:
     virtual auto initCache(QNetworkRequest&) -> Task::State;
     virtual auto finalizeCache(QNetworkReply& reply) -> Task::State;
+    // sees every chunk of the file in order, including the part already on disk when a download is resumed
+    virtual auto consume(QByteArray&) -> bool { return true; }
+
+   private:
+    auto initPartial(QNetworkRequest& request) -> Task::State;
+    void savePartialValidator(QNetworkReply& reply);
+    // feeds the part we already had to the validators
+    auto replayPartial() -> bool;
+    auto commitPartial() -> bool;
+    void discardPartial();
+    QString partialPath() const { return m_filename + ".part"; }
+    // holds the If-Range value for the partial download
+    QString partialValidatorPath() const { return m_filename + ".part.validator"; }
 
    protected:
     QString m_filename;
     bool wroteAnyData = false;
     std::unique_ptr<PSaveFile> m_output_file;
+
+    bool m_resumable = false;
+    // used instead of m_output_file when resumable
+    std::unique_ptr<QFile> m_partial_file;
+    // how much of the file we already had when the request was made
+    qint64 m_resume_offset = 0;
+    // the validators haven't seen that part yet
+    bool m_replay_pending = false;
 };
 }  // namespace Net
@@ -38,14 +38,32 @@
 #include "Json.h"
 
 #include <QCryptographicHash>
+#include <QDataStream>
 #include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QtEndian>
 
 #include <QDebug>
 
 #include "net/Logging.h"
 
+static const quint32 s_index_magic = 0x484d4332;  // "HMC2"
+static const quint32 s_index_version = 2;
+// don't bother compacting small logs
+static const qint64 s_min_compaction_records = 1024;
+
+enum class Record : quint8 { Put = 1, Remove = 2 };
+
+void MetaEntry::setStale(bool stale)
+{
+    if (m_stale == stale)
+        return;
+    m_stale = stale;
+    if (m_cache)
+        m_cache->staleChanged(*this);
+}
+
 auto MetaEntry::getFullPath() -> QString
 {
     // FIXME: make local?
@@ -99,12 +117,14 @@ auto HttpMetaCache::resolveEntry(QString base, QString resource_path, QString ex
     if (!finfo.isFile() || !finfo.isReadable()) {
         // if the file doesn't exist, we disown the entry
         selected_base.entry_list.remove(resource_path);
+        markChanged(base, resource_path);
         return staleEntry(base, resource_path);
     }
 
     if (!expected_etag.isEmpty() && expected_etag != entry->m_etag) {
         // if the etag doesn't match expected, we disown the entry
         selected_base.entry_list.remove(resource_path);
+        markChanged(base, resource_path);
         return staleEntry(base, resource_path);
     }
 
@@ -116,11 +136,13 @@ auto HttpMetaCache::resolveEntry(QString base, QString resource_path, QString ex
         QString md5sum = QCryptographicHash::hash(input.readAll(), QCryptographicHash::Md5).toHex().constData();
         if (entry->m_md5sum != md5sum) {
             selected_base.entry_list.remove(resource_path);
+            markChanged(base, resource_path);
             return staleEntry(base, resource_path);
         }
 
         // md5sums matched... keep entry and save the new state to file
         entry->m_local_changed_timestamp = file_last_changed;
+        markChanged(base, resource_path);
         SaveEventually();
     }
 
@@ -130,6 +152,7 @@ auto HttpMetaCache::resolveEntry(QString base, QString resource_path, QString ex
         qCWarning(taskNetLogC) << "[HttpMetaCache]"
                                << "Removing cache entry because of old age!";
         selected_base.entry_list.remove(resource_path);
+        markChanged(base, resource_path);
         return staleEntry(base, resource_path);
     }
 
@@ -151,6 +174,7 @@ auto HttpMetaCache::updateEntry(MetaEntryPtr stale_entry) -> bool
     }
 
     m_entries[stale_entry->m_baseId].entry_list[stale_entry->m_relativePath] = stale_entry;
+    markChanged(stale_entry->m_baseId, stale_entry->m_relativePath);
     SaveEventually();
 
     return true;
@@ -162,6 +186,7 @@ auto HttpMetaCache::evictEntry(MetaEntryPtr entry) -> bool
         return false;
 
     entry->m_stale = true;
+    markChanged(entry->m_baseId, entry->m_relativePath);
     SaveEventually();
     return true;
 }
@@ -178,11 +203,13 @@ void HttpMetaCache::evictAll()
         map.entry_list.clear();
         FS::deletePath(map.base_path);
     }
+    m_changed.clear();
+    m_needs_compaction = true;
 }
 
 auto HttpMetaCache::staleEntry(QString base, QString resource_path) -> MetaEntryPtr
 {
-    auto foo = new MetaEntry();
+    auto foo = new MetaEntry(this);
     foo->m_baseId = base;
     foo->m_basePath = getBasePath(base);
     foo->m_relativePath = resource_path;
@@ -212,6 +239,21 @@ auto HttpMetaCache::getBasePath(QString base) -> QString
     return {};
 }
 
+void HttpMetaCache::markChanged(const QString& base, const QString& resource_path)
+{
+    m_changed.insert({ base, resource_path });
+}
+
+void HttpMetaCache::staleChanged(const MetaEntry& entry)
+{
+    // fresh entries are only saved once they're handed to updateEntry()
+    auto group = m_entries.constFind(entry.m_baseId);
+    if (group == m_entries.constEnd() || group->entry_list.value(entry.m_relativePath).get() != &entry)
+        return;
+    markChanged(entry.m_baseId, entry.m_relativePath);
+    SaveEventually();
+}
+
 void HttpMetaCache::Load()
 {
     if (m_index_file.isNull())
@@ -221,21 +263,91 @@ void HttpMetaCache::Load()
     if (!index.open(QIODevice::ReadOnly))
         return;
 
+    quint32 magic = 0;
+    if (index.peek(reinterpret_cast<char*>(&magic), sizeof(magic)) == sizeof(magic) && qFromBigEndian(magic) == s_index_magic) {
+        m_needs_compaction = !loadLog(&index);
+    } else {
+        // the old JSON index, it gets replaced by a snapshot with the next save
+        m_needs_compaction = true;
+        if (loadJson(index.readAll()))
+            qCDebug(taskHttpMetaCacheLogC) << "Migrating metacache from the JSON format";
+    }
+}
+
+bool HttpMetaCache::loadLog(QIODevice* index)
+{
+    QDataStream in(index);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (version != s_index_version) {
+        qCWarning(taskHttpMetaCacheLogC) << "Unsupported metacache version" << version;
+        return false;
+    }
+
+    qint64 records = 0;
+    while (!in.atEnd()) {
+        quint8 type;
+        QString base, path;
+        in >> type >> base >> path;
+
+        if (type == quint8(Record::Put)) {
+            auto entry = new MetaEntry(this);
+            in >> entry->m_md5sum >> entry->m_etag >> entry->m_local_changed_timestamp >> entry->m_remote_changed_timestamp >>
+                entry->m_is_eternal >> entry->m_current_age >> entry->m_max_age;
+            MetaEntryPtr ptr(entry);
+            if (in.status() != QDataStream::Ok)
+                break;
+
+            // entries of bases we don't know anymore get dropped with the next compaction
+            auto it = m_entries.find(base);
+            if (it != m_entries.end()) {
+                entry->m_baseId = base;
+                entry->m_relativePath = path;
+                // presumed innocent until closer examination
+                entry->m_stale = false;
+                it->entry_list.insert(path, ptr);
+            }
+        } else if (type == quint8(Record::Remove)) {
+            if (in.status() != QDataStream::Ok)
+                break;
+            auto it = m_entries.find(base);
+            if (it != m_entries.end())
+                it->entry_list.remove(path);
+        } else {
+            in.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        records++;
+    }
+    m_log_records = records;
+
+    if (in.status() != QDataStream::Ok) {
+        // most likely we got interrupted while appending. everything before that is fine
+        qCWarning(taskHttpMetaCacheLogC) << "The metacache index is damaged after" << records << "records";
+        return false;
+    }
+    return true;
+}
+
+bool HttpMetaCache::loadJson(const QByteArray& data)
+{
     QJsonParseError parseError;
-    QJsonDocument json = QJsonDocument::fromJson(index.readAll(), &parseError);
+    QJsonDocument json = QJsonDocument::fromJson(data, &parseError);
 
     // Fail if the JSON is invalid.
     if (parseError.error != QJsonParseError::NoError) {
         qCritical() << QString("Failed to parse HttpMetaCache file: %1 at offset %2")
                            .arg(parseError.errorString(), QString::number(parseError.offset))
                            .toUtf8();
-        return;
+        return false;
     }
 
     // Make sure the root is an object.
     if (!json.isObject()) {
         qCritical() << "HttpMetaCache root should be an object.";
-        return;
+        return false;
     }
 
     auto root = json.object();
@@ -243,7 +355,7 @@ void HttpMetaCache::Load()
     // check file version first
     auto version_val = Json::ensureString(root, "version");
     if (version_val != "1")
-        return;
+        return false;
 
     // read the entry array
     auto array = Json::ensureArray(root, "entries");
@@ -255,7 +367,7 @@ void HttpMetaCache::Load()
 
         auto& entrymap = m_entries[base];
 
-        auto foo = new MetaEntry();
+        auto foo = new MetaEntry(this);
         foo->m_baseId = base;
         foo->m_relativePath = Json::ensureString(element_obj, "path");
         foo->m_md5sum = Json::ensureString(element_obj, "md5sum");
@@ -274,6 +386,7 @@ void HttpMetaCache::Load()
 
         entrymap.entry_list[foo->m_relativePath] = MetaEntryPtr(foo);
     }
+    return true;
 }
 
 void HttpMetaCache::SaveEventually()
@@ -288,41 +401,87 @@ void HttpMetaCache::SaveNow()
     if (m_index_file.isNull())
         return;
 
-    qCDebug(taskHttpMetaCacheLogC) << "Saving metacache with" << m_entries.size() << "entries";
+    qint64 live = 0;
+    for (auto& group : m_entries)
+        live += group.entry_list.size();
 
-    QJsonObject toplevel;
-    Json::writeString(toplevel, "version", "1");
+    // once most of the log is superseded records, start over from a snapshot
+    if (m_needs_compaction || m_log_records + m_changed.size() > qMax(2 * live, s_min_compaction_records)) {
+        compact();
+    } else if (!m_changed.isEmpty()) {
+        appendChanges();
+    }
+}
 
-    QJsonArray entriesArr;
-    for (auto group : m_entries) {
-        for (auto entry : group.entry_list) {
-            // do not save stale entries. they are dead.
-            if (entry->m_stale) {
-                continue;
-            }
+void HttpMetaCache::writeRecord(QDataStream& out, const QString& base, const QString& resource_path)
+{
+    MetaEntryPtr entry;
+    auto group = m_entries.constFind(base);
+    if (group != m_entries.constEnd())
+        entry = group->entry_list.value(resource_path);
+
+    // do not save stale entries. they are dead.
+    if (!entry || entry->m_stale) {
+        out << quint8(Record::Remove) << base << resource_path;
+        return;
+    }
 
-            QJsonObject entryObj;
-            Json::writeString(entryObj, "base", entry->m_baseId);
-            Json::writeString(entryObj, "path", entry->m_relativePath);
-            Json::writeString(entryObj, "md5sum", entry->m_md5sum);
-            Json::writeString(entryObj, "etag", entry->m_etag);
-            entryObj.insert("last_changed_timestamp", QJsonValue(double(entry->m_local_changed_timestamp)));
-            if (!entry->m_remote_changed_timestamp.isEmpty())
-                entryObj.insert("remote_changed_timestamp", QJsonValue(entry->m_remote_changed_timestamp));
-            if (entry->isEternal()) {
-                entryObj.insert("eternal", true);
-            } else {
-                entryObj.insert("current_age", QJsonValue(double(entry->m_current_age)));
-                entryObj.insert("max_age", QJsonValue(double(entry->m_max_age)));
+    out << quint8(Record::Put) << base << resource_path << entry->m_md5sum << entry->m_etag << entry->m_local_changed_timestamp
+        << entry->m_remote_changed_timestamp << entry->m_is_eternal << entry->m_current_age << entry->m_max_age;
+}
+
+void HttpMetaCache::appendChanges()
+{
+    qCDebug(taskHttpMetaCacheLogC) << "Saving" << m_changed.size() << "changed metacache entries";
+
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        for (const auto& [base, path] : m_changed)
+            writeRecord(out, base, path);
+    }
+
+    QFile index(m_index_file);
+    if (!index.open(QIODevice::WriteOnly | QIODevice::Append) || index.write(data) != data.size()) {
+        qCWarning(taskHttpMetaCacheLogC) << "Error appending to cache:" << index.errorString();
+        // whatever made it to the disk can't be trusted now
+        m_needs_compaction = true;
+        return;
+    }
+
+    m_log_records += m_changed.size();
+    m_changed.clear();
+}
+
+void HttpMetaCache::compact()
+{
+    QByteArray data;
+    qint64 records = 0;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << s_index_magic << s_index_version;
+        for (auto group = m_entries.cbegin(); group != m_entries.cend(); ++group) {
+            for (auto entry = group->entry_list.cbegin(); entry != group->entry_list.cend(); ++entry) {
+                if ((*entry)->m_stale)
+                    continue;
+                writeRecord(out, group.key(), entry.key());
+                records++;
             }
-            entriesArr.append(entryObj);
         }
     }
-    toplevel.insert("entries", entriesArr);
+
+    qCDebug(taskHttpMetaCacheLogC) << "Saving metacache with" << records << "entries";
 
     try {
-        Json::write(toplevel, m_index_file);
+        FS::write(m_index_file, data);
     } catch (const Exception& e) {
         qCWarning(taskHttpMetaCacheLogC) << "Error writing cache:" << e.what();
+        return;
     }
+
+    m_log_records = records;
+    m_changed.clear();
+    m_needs_compaction = false;
 }
@@ -35,7 +35,9 @@
 
 #pragma once
 
+#include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QString>
 #include <QTimer>
 #include <memory>
@@ -46,11 +48,15 @@ class MetaEntry {
     friend class HttpMetaCache;
 
    protected:
-    MetaEntry() = default;
+    explicit MetaEntry(HttpMetaCache* cache) : m_cache(cache) {}
 
    public:
+    /* The cache this entry belongs to, which has to be told when the entry changes. */
+    HttpMetaCache* cache() const { return m_cache; }
+
     auto isStale() -> bool { return m_stale; }
-    void setStale(bool stale) { m_stale = stale; }
+    /* Entries that go stale are dropped from the cache with its next save, no need for an updateEntry(). */
+    void setStale(bool stale);
 
     auto getFullPath() -> QString;
 
@@ -77,6 +83,7 @@ class MetaEntry {
     bool isExpired(qint64 offset) { return !m_is_eternal && (m_current_age >= m_max_age - offset); }
 
    protected:
+    HttpMetaCache* m_cache;
     QString m_baseId;
     QString m_basePath;
     QString m_relativePath;
@@ -94,8 +101,16 @@ class MetaEntry {
 
 using MetaEntryPtr = std::shared_ptr<MetaEntry>;
 
+/** Remembers where downloads came from (etag, md5sum, ages), so they can be revalidated instead of downloaded again.
+ *
+ *  The index is an append-only binary log: a snapshot of all entries, followed by the entries that changed since.
+ *  Saving only appends the changed entries, and the log gets compacted into a fresh snapshot once it has grown
+ *  to about twice the number of entries. Indexes in the old JSON format (version 1) are migrated on load.
+ */
 class HttpMetaCache : public QObject {
     Q_OBJECT
+    friend class MetaEntry;
+
    public:
     // supply path to the cache index file
     HttpMetaCache(QString path = QString());
@@ -130,12 +145,31 @@ class HttpMetaCache : public QObject {
     // create a new stale entry, given the parameters
     auto staleEntry(QString base, QString resource_path) -> MetaEntryPtr;
 
+    // remember that an entry has to be written out with the next save
+    void markChanged(const QString& base, const QString& resource_path);
+    // an entry went stale, save it if it's one of ours
+    void staleChanged(const MetaEntry& entry);
+
+    bool loadLog(QIODevice* index);
+    bool loadJson(const QByteArray& data);
+    // writes the current state of the entry to the log, or its removal if it's gone
+    void writeRecord(QDataStream& out, const QString& base, const QString& resource_path);
+    void appendChanges();
+    void compact();
+
     struct EntryMap {
         QString base_path;
-        QMap<QString, MetaEntryPtr> entry_list;
+        QHash<QString, MetaEntryPtr> entry_list;
     };
 
-    QMap<QString, EntryMap> m_entries;
+    QHash<QString, EntryMap> m_entries;
     QString m_index_file;
     QTimer saveBatchingTimer;
+
+    // (base, path) of the entries that changed since the last save
+    QSet<QPair<QString, QString>> m_changed;
+    // records in the log on disk, including superseded ones
+    qint64 m_log_records = 0;
+    // the log on disk can't be appended to, write a new snapshot next time
+    bool m_needs_compaction = true;
 };
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LzmaFileSink.h"
+
+#if defined(LAUNCHER_LZMA)
+#include <lzma.h>
+#endif
+
+#include "net/Logging.h"
+
+namespace Net {
+
+#if defined(LAUNCHER_LZMA)
+struct LzmaFileSink::Decoder {
+    Decoder() { stream = LZMA_STREAM_INIT; }
+    ~Decoder() { lzma_end(&stream); }
+
+    lzma_stream stream;
+    bool finished = false;
+};
+#else
+struct LzmaFileSink::Decoder {};
+#endif
+
+LzmaFileSink::LzmaFileSink(QString filename) : FileSink(filename) {}
+
+LzmaFileSink::~LzmaFileSink() = default;
+
+bool LzmaFileSink::isSupported()
+{
+#if defined(LAUNCHER_LZMA)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Task::State LzmaFileSink::init(QNetworkRequest& request)
+{
+#if defined(LAUNCHER_LZMA)
+    m_decoder.reset(new Decoder);
+    if (lzma_alone_decoder(&m_decoder->stream, UINT64_MAX) != LZMA_OK) {
+        qCCritical(taskNetLogC) << "Could not set up the LZMA decoder for" << m_filename;
+        m_decoder.reset();
+        return Task::State::Failed;
+    }
+    return FileSink::init(request);
+#else
+    Q_UNUSED(request)
+    qCCritical(taskNetLogC) << "Can't download" << m_filename << "compressed, built without LZMA support";
+    return Task::State::Failed;
+#endif
+}
+
+Task::State LzmaFileSink::write(QByteArray& data)
+{
+#if defined(LAUNCHER_LZMA)
+    auto& stream = m_decoder->stream;
+    if (m_decoder->finished)
+        return Task::State::Running;  // trailing garbage
+
+    QByteArray out(256 * 1024, Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<const uint8_t*>(data.constData());
+    stream.avail_in = data.size();
+    // a full output buffer can mean there's more to come out, even without input left
+    do {
+        stream.next_out = reinterpret_cast<uint8_t*>(out.data());
+        stream.avail_out = out.size();
+        auto ret = lzma_code(&stream, LZMA_RUN);
+        if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+            qCCritical(taskNetLogC) << "Failed to decompress" << m_filename << "error" << ret;
+            return Task::State::Failed;
+        }
+
+        QByteArray chunk = out.left(out.size() - stream.avail_out);
+        if (!chunk.isEmpty()) {
+            auto state = FileSink::write(chunk);
+            if (state != Task::State::Running)
+                return state;
+        }
+        if (ret == LZMA_STREAM_END) {
+            m_decoder->finished = true;
+            break;
+        }
+    } while (stream.avail_in > 0 || stream.avail_out == 0);
+    return Task::State::Running;
+#else
+    Q_UNUSED(data)
+    return Task::State::Failed;
+#endif
+}
+
+Task::State LzmaFileSink::abort()
+{
+    m_decoder.reset();
+    return FileSink::abort();
+}
+
+Task::State LzmaFileSink::finalize(QNetworkReply& reply)
+{
+#if defined(LAUNCHER_LZMA)
+    auto statusCode = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if ((statusCode == 200 || statusCode == 203) && !(m_decoder && m_decoder->finished)) {
+        qCCritical(taskNetLogC) << "Compressed data for" << m_filename << "ended early";
+        return Task::State::Failed;
+    }
+#endif
+    m_decoder.reset();
+    return FileSink::finalize(reply);
+}
+}  // namespace Net
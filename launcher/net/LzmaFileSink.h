@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FileSink.h"
+
+namespace Net {
+
+/*
+ * FileSink for files served as .lzma (the legacy LZMA "alone" format), decompressing them as they download.
+ * Validators see the decompressed data, so they check the same hashes as for the uncompressed file.
+ */
+class LzmaFileSink : public FileSink {
+   public:
+    LzmaFileSink(QString filename);
+    virtual ~LzmaFileSink();
+
+    // false if the launcher was built without liblzma. init() fails then
+    static bool isSupported();
+
+   public:
+    auto init(QNetworkRequest& request) -> Task::State override;
+    auto write(QByteArray& data) -> Task::State override;
+    auto abort() -> Task::State override;
+    auto finalize(QNetworkReply& reply) -> Task::State override;
+
+   private:
+    struct Decoder;
+    std::unique_ptr<Decoder> m_decoder;
+};
+}  // namespace Net
@@ -37,7 +37,6 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QRegularExpression>
-#include "Application.h"
 
 #include "net/Logging.h"
 
@@ -124,7 +123,7 @@ Task::State MetaCacheSink::finalizeCache(QNetworkReply& reply)
     }
 
     m_entry->setStale(false);
-    APPLICATION->metacache()->updateEntry(m_entry);
+    m_entry->cache()->updateEntry(m_entry);
 
     return Task::State::Succeeded;
 }
@@ -37,6 +37,7 @@
 
 #include "NetJob.h"
 #include <QNetworkReply>
+#include <utility>
 #include "net/NetRequest.h"
 #include "tasks/ConcurrentTask.h"
 #if defined(LAUNCHER_APPLICATION)
@@ -55,11 +56,12 @@ NetJob::NetJob(QString job_name, shared_qobject_ptr<QNetworkAccessManager> netwo
         setMaxConcurrent(max_concurrent);
 }
 
-auto NetJob::addNetAction(Net::NetRequest::Ptr action) -> bool
+auto NetJob::addNetAction(Net::NetRequest::Ptr action, Priority order) -> bool
 {
     action->setNetwork(m_network);
+    action->setPriority(m_priority);
 
-    addTask(action);
+    addTask(action, order);
 
     return true;
 }
@@ -67,20 +69,17 @@ auto NetJob::addNetAction(Net::NetRequest::Ptr action) -> bool
 void NetJob::executeNextSubTask()
 {
     // We're finished, check for failures and retry if we can (up to m_auto_retry_limit times)
-    if (isRunning() && m_queue.isEmpty() && m_doing.isEmpty() && !m_failed.isEmpty() && m_try < m_auto_retry_limit) {
+    if (isRunning() && m_queue.isEmpty() && doingCount() == 0 && !m_failed.isEmpty() && m_try < m_auto_retry_limit) {
         m_try += 1;
-        while (!m_failed.isEmpty()) {
-            auto task = m_failed.take(*m_failed.keyBegin());
-            m_done.remove(task.get());
+        for (auto& task : std::exchange(m_failed, {}))
             m_queue.enqueue(task);
-        }
     }
     ConcurrentTask::executeNextSubTask();
 }
 
 auto NetJob::size() const -> int
 {
-    return m_queue.size() + m_doing.size() + m_done.size();
+    return m_queue.size() + doingCount() + doneCount();
 }
 
 auto NetJob::canAbort() const -> bool
@@ -88,11 +87,11 @@ auto NetJob::canAbort() const -> bool
     bool canFullyAbort = true;
 
     // can abort the downloads on the queue?
-    for (auto part : m_queue)
+    for (auto part : m_queue.tasks())
         canFullyAbort &= part->canAbort();
 
     // can abort the active downloads?
-    for (auto part : m_doing)
+    for (auto part : runningTasks())
         canFullyAbort &= part->canAbort();
 
     return canFullyAbort;
@@ -103,12 +102,12 @@ auto NetJob::abort() -> bool
     bool fullyAborted = true;
 
     // fail all downloads on the queue
-    for (auto task : m_queue)
-        m_failed.insert(task.get(), task);
+    for (auto task : m_queue.tasks())
+        m_failed.append(task);
     m_queue.clear();
 
     // abort active downloads
-    auto toKill = m_doing.values();
+    auto toKill = runningTasks();
     for (auto part : toKill) {
         fullyAborted &= part->abort();
     }
@@ -141,9 +140,9 @@ auto NetJob::getFailedFiles() -> QList<QString>
 
 void NetJob::updateState()
 {
-    emit progress(m_done.count(), totalSize());
+    emit progress(doneCount(), totalSize());
     setStatus(tr("Executing %1 task(s) (%2 out of %3 are done)")
-                  .arg(QString::number(m_doing.count()), QString::number(m_done.count()), QString::number(totalSize())));
+                  .arg(QString::number(doingCount()), QString::number(doneCount()), QString::number(totalSize())));
 }
 
 bool NetJob::isOnline()
@@ -58,12 +58,15 @@ class NetJob : public ConcurrentTask {
     auto size() const -> int;
 
     auto canAbort() const -> bool override;
-    auto addNetAction(Net::NetRequest::Ptr action) -> bool;
+    /* `order` is when it starts among the other requests of this job, see ConcurrentTask::Priority. */
+    auto addNetAction(Net::NetRequest::Ptr action, Priority order = Priority::Normal) -> bool;
 
     auto getFailedActions() -> QList<Net::NetRequest*>;
     auto getFailedFiles() -> QList<QString>;
     void setAskRetry(bool askRetry);
     void setAutoRetryLimit(int autoRetryLimit);
+    // for the requests added after this
+    void setPriority(Net::Scheduler::Priority priority) { m_priority = priority; }
 
    public slots:
     // Qt can't handle auto at the start for some reason?
@@ -84,4 +87,5 @@ class NetJob : public ConcurrentTask {
     bool m_ask_retry = true;
     int m_auto_retry_limit = 3;
     int m_manual_try = 0;
+    Net::Scheduler::Priority m_priority = Net::Scheduler::Priority::Normal;
 };
@@ -39,9 +39,11 @@
 
 #include "NetRequest.h"
 
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
 #include <QNetworkReply>
+#include <QThread>
 #include <QUrl>
 #include <memory>
 
@@ -52,9 +54,43 @@
 
 #include "MMCTime.h"
 #include "StringUtils.h"
+#include "tasks/WorkerPool.h"
 
 namespace Net {
 
+// the requests transferring something right now, by URL and target. not locked, requests only live on the main thread
+static QHash<QString, NetRequest*> s_transfers;
+static int s_shared_transfers = 0;
+
+static bool onMainThread()
+{
+    auto app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+NetRequest::NetRequest() : Task()
+{
+    connect(this, &Task::finished, this, &NetRequest::requestFinished);
+    connect(&m_adopt_watcher, &QFutureWatcher<Task::State>::finished, this, [this] {
+        // aborted in the meantime
+        if (!m_adopt_watcher.isCanceled())
+            adoptFinished(m_adopt_watcher.result());
+    });
+}
+
+NetRequest::~NetRequest()
+{
+    // the worker reads into the sink
+    m_adopt_watcher.cancel();
+    m_adopt_watcher.waitForFinished();
+    requestFinished();
+}
+
+int NetRequest::sharedTransfers()
+{
+    return s_shared_transfers;
+}
+
 void NetRequest::addValidator(Validator* v)
 {
     m_sink->addValidator(v);
@@ -71,6 +107,25 @@ void NetRequest::executeTask()
         return;
     }
 
+    // the same thing going to the same place twice (say, a library two instances need) only gets transferred once.
+    // the second request must not even touch the sink, the file is busy. it checks the result once it's there
+    if (m_transfer_key.isEmpty() && !m_sink->target().isEmpty()) {
+        Q_ASSERT(onMainThread());
+        auto key = m_url.toString() + '\n' + m_sink->target();
+        if (auto leader = s_transfers.value(key); leader && leader != this) {
+            follow(leader);
+            return;
+        }
+        m_transfer_key = key;
+        s_transfers.insert(key, this);
+    }
+
+    // a redirect starts over, with the same sink
+    m_finish_pending = false;
+    m_response_started = false;
+    if (m_pipeline)
+        m_pipeline->reset();
+
     QNetworkRequest request(m_url);
     m_state = m_sink->init(request);
     switch (m_state) {
@@ -94,7 +149,7 @@ void NetRequest::executeTask()
     }
 
 #if defined(LAUNCHER_APPLICATION)
-    auto user_agent = APPLICATION->getUserAgent();
+    auto user_agent = APPLICATION_DYN ? APPLICATION->getUserAgent() : BuildConfig.USER_AGENT;
 #else
     auto user_agent = BuildConfig.USER_AGENT;
 #endif
@@ -106,19 +161,52 @@ void NetRequest::executeTask()
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
 #if defined(LAUNCHER_APPLICATION)
-    request.setTransferTimeout(APPLICATION->settings()->get("RequestTimeout").toInt() * 1000);
+    if (APPLICATION_DYN)
+        request.setTransferTimeout(APPLICATION->settings()->get("RequestTimeout").toInt() * 1000);
+    else
+        request.setTransferTimeout();
 #else
     request.setTransferTimeout();
 #endif
 #endif
 
+    // local files don't take a connection. redirects keep the slot they got
+    auto scheme = m_url.scheme();
+    if (m_ticket || (scheme != "http" && scheme != "https")) {
+        sendRequest(request);
+        return;
+    }
+    m_waiting_for_slot = true;
+    m_ticket = Scheduler::instance().submit(this, m_url.host(), m_priority, [this, request] {
+        m_waiting_for_slot = false;
+        sendRequest(request);
+    });
+}
+
+void NetRequest::sendRequest(QNetworkRequest request)
+{
     m_last_progress_time = m_clock.now();
     m_last_progress_bytes = 0;
+    m_last_report_time = {};
+    m_progress_pending = false;
+    m_bytes_received = 0;
+    m_bytes_total = -1;
 
     auto rep = getReply(request);
     if (rep == nullptr)  // it failed
         return;
     m_reply.reset(rep);
+
+    // hashing and writing to disk happen on the thread pool, keeping this thread free for the network (and the UI)
+    if (m_sink->canWriteOffThread()) {
+        if (!m_pipeline) {
+            m_pipeline.reset(new SinkPipeline(m_sink.get()));
+            connect(m_pipeline.get(), &SinkPipeline::drained, this, &NetRequest::pipelineDrained, Qt::QueuedConnection);
+        }
+        // when the pipeline falls behind we stop reading, and this makes the reply stop reading from the socket
+        rep->setReadBufferSize(SinkPipeline::s_high_water);
+    }
+
     connect(rep, &QNetworkReply::uploadProgress, this, &NetRequest::onProgress);
     connect(rep, &QNetworkReply::downloadProgress, this, &NetRequest::onProgress);
     connect(rep, &QNetworkReply::finished, this, &NetRequest::downloadFinished);
@@ -133,22 +221,39 @@ void NetRequest::executeTask()
 
 void NetRequest::onProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
+    m_bytes_received = bytesReceived;
+    m_bytes_total = bytesTotal;
     auto now = m_clock.now();
-    auto elapsed = now - m_last_progress_time;
+
+    // this gets called for every chunk that arrives. only the last one before the UI looks again matters, and whatever
+    // is left over gets reported when the transfer is done, see downloadFinished()
+    m_progress_pending = now - m_last_report_time < s_progressInterval && bytesReceived != bytesTotal;
+    if (m_progress_pending)
+        return;
+    m_last_report_time = now;
+    setProgress(bytesReceived, bytesTotal);
+}
+
+QString NetRequest::getDetails() const
+{
+    if (!m_reply)
+        return Task::getDetails();
+
+    auto elapsed = m_clock.now() - m_last_progress_time;
 
     // use milliseconds for speed precision
     auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
-    auto bytes_received_since = bytesReceived - m_last_progress_bytes;
+    auto bytes_received_since = m_bytes_received - m_last_progress_bytes;
     auto dl_speed_bps = (double)bytes_received_since / elapsed_ms.count() * 1000;
-    auto remaining_time_s = (bytesTotal - bytesReceived) / dl_speed_bps;
+    auto remaining_time_s = (m_bytes_total - m_bytes_received) / dl_speed_bps;
 
     //: Current amount of bytes downloaded, out of the total amount of bytes in the download
     QString dl_progress =
-        tr("%1 / %2").arg(StringUtils::humanReadableFileSize(bytesReceived)).arg(StringUtils::humanReadableFileSize(bytesTotal));
+        tr("%1 / %2").arg(StringUtils::humanReadableFileSize(m_bytes_received)).arg(StringUtils::humanReadableFileSize(m_bytes_total));
 
     QString dl_speed_str;
     if (elapsed_ms.count() > 0) {
-        auto str_eta = bytesTotal > 0 ? Time::humanReadableDuration(remaining_time_s) : tr("unknown");
+        auto str_eta = m_bytes_total > 0 ? Time::humanReadableDuration(remaining_time_s) : tr("unknown");
         //: Download speed, in bytes per second (remaining download time in parenthesis)
         dl_speed_str = tr("%1 /s (%2)").arg(StringUtils::humanReadableFileSize(dl_speed_bps)).arg(str_eta);
     } else {
@@ -156,9 +261,7 @@ void NetRequest::onProgress(qint64 bytesReceived, qint64 bytesTotal)
         dl_speed_str = tr("0 B/s");
     }
 
-    setDetails(dl_progress + "\n" + dl_speed_str);
-
-    setProgress(bytesReceived, bytesTotal);
+    return dl_progress + "\n" + dl_speed_str;
 }
 
 void NetRequest::downloadError(QNetworkReply::NetworkError error)
@@ -254,6 +357,45 @@ void NetRequest::downloadFinished()
         return;
     }
 
+    // the last chunks came in too quickly to be reported, or the size was never known
+    if (m_progress_pending) {
+        m_progress_pending = false;
+        setProgress(m_bytes_received, m_bytes_total);
+    }
+
+    // a response without a body never got to downloadReadyRead(). failed responses go to the sink too, it may care why
+    if (m_state != State::AbortedByUser)
+        startResponse();
+
+    if (m_pipeline && m_state == State::Running) {
+        // whatever we left in the reply while the pipeline was busy
+        m_pipeline->write(m_reply->readAll());
+        if (!m_pipeline->isIdle()) {
+            m_finish_pending = true;
+            return;
+        }
+    }
+    finishDownload();
+}
+
+void NetRequest::finishDownload()
+{
+    m_finish_pending = false;
+    if (m_pipeline) {
+        // the sink is ours again. a failed download keeps what already arrived, a resumable sink can continue from there
+        if (m_state == State::AbortedByUser)
+            m_pipeline->cancel();
+        else
+            m_pipeline->waitForIdle();
+        if (m_state == State::Running && m_pipeline->state() != State::Running) {
+            qCDebug(logCat) << getUid().toString() << "Request failed to write:" << m_url.toString();
+            m_sink->abort();
+            emit failed("failed to write in sink");
+            emit finished();
+            return;
+        }
+    }
+
     // if the download failed before this point ...
     if (m_state == State::Succeeded)  // pretend to succeed so we continue processing :)
     {
@@ -305,9 +447,40 @@ void NetRequest::downloadFinished()
     emit finished();
 }
 
+auto NetRequest::isRedirect() const -> bool
+{
+    auto status = replyStatusCode();
+    return status >= 300 && status < 400 && status != 304 && m_reply->hasRawHeader("Location");
+}
+
+auto NetRequest::startResponse() -> bool
+{
+    if (!m_response_started) {
+        m_response_started = true;
+        auto state = m_sink->headersReceived(*m_reply);
+        if (m_state == State::Running && state != State::Running) {
+            qCCritical(logCat) << getUid().toString() << "Sink rejected the response:" << m_url.toString();
+            m_state = state;
+        }
+    }
+    return m_state == State::Running;
+}
+
 void NetRequest::downloadReadyRead()
 {
-    if (m_state == State::Running) {
+    if (m_state == State::Running && isRedirect()) {
+        // the sink starts over with the request that follows the redirect anyway
+        m_reply->readAll();
+        return;
+    }
+    if (m_state == State::Running && !startResponse())
+        return;
+
+    if (m_state == State::Running && m_pipeline) {
+        // leave it in the reply until the pipeline catches up, see pipelineDrained()
+        if (m_pipeline->pendingBytes() < SinkPipeline::s_high_water)
+            m_pipeline->write(m_reply->readAll());
+    } else if (m_state == State::Running) {
         auto data = m_reply->readAll();
         m_state = m_sink->write(data);
         if (m_state == State::Failed) {
@@ -319,8 +492,145 @@ void NetRequest::downloadReadyRead()
     }
 }
 
+void NetRequest::pipelineDrained()
+{
+    if (!m_reply)
+        return;
+
+    if (m_state == State::Running && m_pipeline->state() != State::Running)
+        qCCritical(logCat) << getUid().toString() << "Failed to process response chunk";
+
+    if (m_finish_pending) {
+        if (m_pipeline->isIdle())
+            finishDownload();
+        return;
+    }
+
+    // catch up with what piled up in the reply while the pipeline was full
+    if (m_state == State::Running && m_reply->bytesAvailable() > 0)
+        downloadReadyRead();
+}
+
+void NetRequest::follow(NetRequest* leader)
+{
+    qCDebug(logCat) << getUid().toString() << "Waiting for" << leader->getUid().toString() << "to transfer" << m_url.toString();
+    setStatus(tr("Waiting for another download of %1").arg(StringUtils::truncateUrlHumanFriendly(m_url, 80)));
+    m_leader = leader;
+
+    // whatever is waiting on the transfer must not wait longer because the other request was less urgent
+    if (int(m_priority) < int(leader->m_priority)) {
+        leader->m_priority = m_priority;
+        if (leader->m_waiting_for_slot)
+            Scheduler::instance().raise(leader->m_ticket, m_priority);
+    }
+
+    connect(leader, &Task::progress, this, &NetRequest::setProgress);
+    connect(leader, &Task::succeeded, this, [this] {
+        m_adopted = m_leader;
+        stopFollowing();
+        // hashing the whole file takes a while for the big ones
+        auto sink = m_sink.get();
+        if (!sink->canWriteOffThread()) {
+            adoptFinished(sink->readAdopted());
+            return;
+        }
+        m_adopt_watcher.setFuture(WorkerPool::io().run([sink] { return sink->readAdopted(); }));
+    });
+    connect(leader, &Task::failed, this, [this](QString reason) {
+        stopFollowing();
+        m_state = State::Failed;
+        emit failed(reason);
+        emit finished();
+    });
+    // somebody didn't want the other request anymore, but this one still wants the data. it gets its turn after the
+    // other one is completely done
+    auto restart = [this] {
+        stopFollowing();
+        QMetaObject::invokeMethod(this, &NetRequest::executeTask, Qt::QueuedConnection);
+    };
+    connect(leader, &Task::aborted, this, restart);
+    connect(leader, &QObject::destroyed, this, restart);
+}
+
+void NetRequest::adoptFinished(State state)
+{
+    auto leader = m_adopted;
+    m_adopted = nullptr;
+    // the other request may have expected something else, or not have written anything
+    if (state == State::Running)
+        state = leader && leader->m_reply ? m_sink->adopt(*leader->m_reply) : State::Inactive;
+    if (state == State::Inactive) {
+        qCDebug(logCat) << getUid().toString() << "Can't use what another request got, transferring" << m_url.toString();
+        QMetaObject::invokeMethod(this, &NetRequest::executeTask, Qt::QueuedConnection);
+        return;
+    }
+    if (state != State::Succeeded) {
+        qCDebug(logCat) << getUid().toString() << "Another request got" << m_url.toString() << "but it failed to validate";
+        m_state = State::Failed;
+        emit failed("failed to validate the shared transfer");
+        emit finished();
+        return;
+    }
+    s_shared_transfers++;
+    qCDebug(logCat) << getUid().toString() << "Got" << m_url.toString() << "from another request," << s_shared_transfers
+                    << "transfers saved so far";
+    m_state = State::Succeeded;
+    emit succeeded();
+    emit finished();
+}
+
+void NetRequest::stopFollowing()
+{
+    if (m_leader)
+        disconnect(m_leader, nullptr, this, nullptr);
+    m_leader = nullptr;
+}
+
+void NetRequest::requestFinished()
+{
+    if (!m_transfer_key.isEmpty()) {
+        Q_ASSERT(onMainThread());
+        if (s_transfers.value(m_transfer_key) == this)
+            s_transfers.remove(m_transfer_key);
+        m_transfer_key.clear();
+    }
+
+    if (!m_ticket)
+        return;
+    Scheduler::Outcome outcome;
+    if (m_reply && m_state != State::AbortedByUser) {
+        outcome.status = replyStatusCode();
+        auto error = m_reply->error();
+        // a transfer timeout looks like a cancellation
+        outcome.timedOut = error == QNetworkReply::TimeoutError || error == QNetworkReply::OperationCanceledError ||
+                           error == QNetworkReply::RemoteHostClosedError;
+        outcome.bytes = m_bytes_received;
+        outcome.retryAfter = Scheduler::parseRetryAfter(m_reply->rawHeader("Retry-After"));
+    }
+    Scheduler::instance().finish(m_ticket, outcome);
+    m_ticket = 0;
+    m_waiting_for_slot = false;
+}
+
 auto NetRequest::abort() -> bool
 {
+    // nothing went out yet, finished() gives the slot back
+    if (m_leader) {
+        stopFollowing();
+        emitAborted();
+        return true;
+    }
+    if (m_waiting_for_slot) {
+        emitAborted();
+        return true;
+    }
+    if (m_adopt_watcher.isRunning()) {
+        m_adopt_watcher.cancel();
+        m_adopt_watcher.waitForFinished();
+        m_adopted = nullptr;
+        emitAborted();
+        return true;
+    }
     m_state = State::AbortedByUser;
     if (m_reply) {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)  // QNetworkReply::errorOccurred added in 5.15
@@ -40,12 +40,16 @@
 #pragma once
 
 #include <qloggingcategory.h>
+#include <QFutureWatcher>
 #include <QNetworkReply>
+#include <QPointer>
 #include <QUrl>
 #include <chrono>
 
 #include "HeaderProxy.h"
+#include "Scheduler.h"
 #include "Sink.h"
+#include "SinkPipeline.h"
 #include "Validator.h"
 
 #include "QObjectPtr.h"
@@ -56,21 +60,25 @@ namespace Net {
 class NetRequest : public Task {
     Q_OBJECT
    protected:
-    explicit NetRequest() : Task() {}
+    explicit NetRequest();
 
    public:
     using Ptr = shared_qobject_ptr<class NetRequest>;
-    enum class Option { NoOptions = 0, AcceptLocalFiles = 1, MakeEternal = 2 };
+    enum class Option { NoOptions = 0, AcceptLocalFiles = 1, MakeEternal = 2, Resumable = 4 };
     Q_DECLARE_FLAGS(Options, Option)
 
    public:
-    ~NetRequest() override = default;
+    ~NetRequest() override;
     void addValidator(Validator* v);
     auto abort() -> bool override;
     auto canAbort() const -> bool override { return true; }
+    // how far along the transfer is and how fast it goes, put together when asked instead of for every chunk
+    QString getDetails() const override;
 
     void setNetwork(shared_qobject_ptr<QNetworkAccessManager> network) { m_network = network; }
     void addHeaderProxy(Net::HeaderProxy* proxy) { m_headerProxies.push_back(std::shared_ptr<Net::HeaderProxy>(proxy)); }
+    // when this goes out compared to the other requests waiting in the Scheduler. only matters before it starts
+    void setPriority(Scheduler::Priority priority) { m_priority = priority; }
 
     QUrl url() const;
     void setUrl(QUrl url) { m_url = url; }
@@ -78,8 +86,23 @@ class NetRequest : public Task {
     QNetworkReply::NetworkError error() const;
     QString errorString() const;
 
+    /* Transfers that didn't happen, because an identical request was running already. */
+    static int sharedTransfers();
+
    private:
     auto handleRedirect() -> bool;
+    auto isRedirect() const -> bool;
+    // hands the response headers to the sink, once per response. false if the sink doesn't want the body
+    auto startResponse() -> bool;
+    // everything after the reply finished and the sink got all the data
+    void finishDownload();
+    // actually sends the request, once the Scheduler lets it
+    void sendRequest(QNetworkRequest request);
+    // waits for `leader`, which transfers the same URL to the same target, and finishes with it
+    void follow(NetRequest* leader);
+    void stopFollowing();
+    // the leader's data went through the validators, see follow()
+    void adoptFinished(State state);
     virtual QNetworkReply* getReply(QNetworkRequest&) = 0;
 
    protected slots:
@@ -88,18 +111,45 @@ class NetRequest : public Task {
     void sslErrors(const QList<QSslError>& errors);
     void downloadFinished();
     void downloadReadyRead();
+    void pipelineDrained();
+    // gives back the Scheduler slot, and lets requests for the same thing transfer it again
+    void requestFinished();
     void executeTask() override;
 
    protected:
     std::unique_ptr<Sink> m_sink;
+    // writes into m_sink on the thread pool, if the sink allows that
+    std::unique_ptr<SinkPipeline> m_pipeline;
+    // the reply finished, but the pipeline is still writing
+    bool m_finish_pending = false;
+    // the sink has seen the headers of the current response
+    bool m_response_started = false;
     Options m_options;
 
     using logCatFunc = const QLoggingCategory& (*)();
     logCatFunc logCat = taskUploadLogC;
 
+    Scheduler::Priority m_priority = Scheduler::Priority::Normal;
+    // the Scheduler ticket, from the first attempt until the request finishes. redirects keep the slot
+    quint64 m_ticket = 0;
+    bool m_waiting_for_slot = false;
+    // the request doing the transfer for this one, see follow()
+    QPointer<NetRequest> m_leader;
+    // checks what the leader got on a worker, once it's done. the leader stays around for its response
+    QFutureWatcher<Task::State> m_adopt_watcher;
+    QPointer<NetRequest> m_adopted;
+    // set while this request is the one transferring its URL to its target
+    QString m_transfer_key;
+    qint64 m_bytes_received = 0;
+    qint64 m_bytes_total = -1;
+
     std::chrono::steady_clock m_clock;
     std::chrono::time_point<std::chrono::steady_clock> m_last_progress_time;
     qint64 m_last_progress_bytes;
+    // when the progress was last updated, see onProgress()
+    std::chrono::time_point<std::chrono::steady_clock> m_last_report_time;
+    // there's progress that didn't get reported yet
+    bool m_progress_pending = false;
 
     shared_qobject_ptr<QNetworkAccessManager> m_network;
 
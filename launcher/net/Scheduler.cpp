@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Scheduler.h"
+
+#include <QDateTime>
+#include <QTimer>
+
+#include "net/Logging.h"
+
+namespace Net {
+
+// longest a host gets left alone for, whatever its Retry-After says
+static const int s_maxPauseSeconds = 60;
+
+Scheduler::Scheduler(QObject* parent) : QObject(parent) {}
+
+Scheduler& Scheduler::instance()
+{
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+int Scheduler::parseRetryAfter(const QByteArray& value)
+{
+    auto trimmed = value.trimmed();
+    bool ok = false;
+    auto seconds = trimmed.toInt(&ok);
+    if (ok)
+        return qMax(0, seconds);
+
+    // HTTP dates are RFC 2822 dates, in GMT
+    auto date = QDateTime::fromString(QString::fromLatin1(trimmed).replace(" GMT", " +0000"), Qt::RFC2822Date);
+    if (!date.isValid())
+        return 0;
+    return int(qBound<qint64>(0, QDateTime::currentDateTimeUtc().secsTo(date), s_maxPauseSeconds));
+}
+
+void Scheduler::setLimits(int global, int perHost)
+{
+    m_globalLimit = qMax(1, global);
+    m_hostLimit = qMax(1, perHost);
+    for (auto& host : m_hosts)
+        host.limit = qMin(host.limit, m_hostLimit);
+    scheduleDispatch();
+}
+
+void Scheduler::resetHosts()
+{
+    for (auto& host : m_hosts) {
+        Host fresh;
+        fresh.active = host.active;
+        fresh.limit = m_hostLimit;
+        host = fresh;
+    }
+    scheduleDispatch();
+}
+
+int Scheduler::hostLimit(const QString& host) const
+{
+    auto it = m_hosts.constFind(host);
+    return it == m_hosts.constEnd() ? m_hostLimit : it->limit;
+}
+
+quint64 Scheduler::submit(QObject* context, const QString& host, Priority priority, std::function<void()> start)
+{
+    auto ticket = m_nextTicket++;
+    m_waiting.insert(ticket, { context, std::move(start), priority, host });
+    m_queues[int(priority)][host].enqueue(ticket);
+    scheduleDispatch();
+    return ticket;
+}
+
+void Scheduler::finish(quint64 ticket, const Outcome& outcome)
+{
+    auto it = m_running.find(ticket);
+    if (it == m_running.end()) {
+        m_waiting.remove(ticket);
+        return;
+    }
+    auto& host = this->host(*it);
+    m_running.erase(it);
+
+    host.active--;
+    m_active--;
+    adapt(host, outcome);
+    scheduleDispatch();
+}
+
+void Scheduler::raise(quint64 ticket, Priority priority)
+{
+    auto waiting = m_waiting.find(ticket);
+    // lower is more urgent
+    if (waiting == m_waiting.end() || int(priority) >= int(waiting->priority))
+        return;
+    // the entry in the old queue gets skipped once it comes up
+    waiting->priority = priority;
+    m_queues[int(priority)][waiting->host].enqueue(ticket);
+    scheduleDispatch();
+}
+
+void Scheduler::scheduleDispatch()
+{
+    if (m_dispatchPending)
+        return;
+    m_dispatchPending = true;
+    QMetaObject::invokeMethod(this, &Scheduler::dispatch, Qt::QueuedConnection);
+}
+
+void Scheduler::dispatch()
+{
+    m_dispatchPending = false;
+
+    // bulk downloads leave a quarter of the budget to everything else, or at least one request
+    const int bulkLimit = qMax(1, m_globalLimit - qMax(1, m_globalLimit / 4));
+
+    // started once the bookkeeping is done, in case starting one finishes it right away
+    QList<std::function<void()>> starting;
+    for (auto priority : { Priority::Interactive, Priority::Normal, Priority::Bulk }) {
+        const int limit = priority == Priority::Bulk ? bulkLimit : m_globalLimit;
+        auto& queues = m_queues[int(priority)];
+
+        // one request per host and round, so the first host doesn't take the whole budget
+        bool started = true;
+        while (started && m_active < limit) {
+            started = false;
+            for (auto queue = queues.begin(); queue != queues.end() && m_active < limit;) {
+                auto& host = this->host(queue.key());
+                if (host.active >= host.limit || isPaused(host)) {
+                    ++queue;
+                    continue;
+                }
+
+                auto& tickets = queue.value();
+                while (!tickets.isEmpty()) {
+                    auto ticket = tickets.dequeue();
+                    auto waiting = m_waiting.find(ticket);
+                    // gone, or raised to another queue
+                    if (waiting == m_waiting.end() || waiting->priority != priority)
+                        continue;
+                    if (!waiting->context) {
+                        m_waiting.erase(waiting);
+                        continue;
+                    }
+
+                    if (!host.window.isValid())
+                        host.window.start();
+                    host.active++;
+                    m_active++;
+                    m_running.insert(ticket, queue.key());
+                    starting.append(std::move(waiting->start));
+                    m_waiting.erase(waiting);
+                    started = true;
+                    break;
+                }
+
+                if (tickets.isEmpty())
+                    queue = queues.erase(queue);
+                else
+                    ++queue;
+            }
+        }
+    }
+
+    for (auto& start : starting)
+        start();
+}
+
+Scheduler::Host& Scheduler::host(const QString& name)
+{
+    auto it = m_hosts.find(name);
+    if (it == m_hosts.end()) {
+        Host host;
+        host.limit = m_hostLimit;
+        it = m_hosts.insert(name, host);
+    }
+    return *it;
+}
+
+bool Scheduler::isPaused(const Host& host) const
+{
+    return host.pauseMs > 0 && host.pause.isValid() && host.pause.elapsed() < host.pauseMs;
+}
+
+void Scheduler::adapt(Host& host, const Outcome& outcome)
+{
+    if (outcome.status == 429 || outcome.status >= 500 || outcome.timedOut) {
+        host.limit = qMax(1, host.limit / 2);
+        host.completed = 0;
+        host.bytes = 0;
+        host.throughput = 0;
+        host.grew = false;
+        host.window.start();
+        qCDebug(taskNetLogC) << "Host is struggling (HTTP" << outcome.status << "), allowing" << host.limit << "requests to it";
+
+        if (outcome.retryAfter > 0) {
+            host.pauseMs = qMin(outcome.retryAfter, s_maxPauseSeconds) * 1000;
+            host.pause.start();
+            QTimer::singleShot(host.pauseMs, this, &Scheduler::scheduleDispatch);
+        }
+        return;
+    }
+
+    // every `limit` completed requests, see whether the last change helped
+    host.completed++;
+    host.bytes += outcome.bytes;
+    if (host.completed < host.limit || !host.window.isValid())
+        return;
+
+    double throughput = double(host.bytes) / qMax<qint64>(1, host.window.elapsed());
+    if (host.grew && throughput < host.throughput * 0.9) {
+        // the extra request only slowed things down
+        host.limit--;
+        host.grew = false;
+    } else if (host.limit < m_hostLimit && throughput >= host.throughput) {
+        host.limit++;
+        host.grew = true;
+    } else {
+        host.grew = false;
+    }
+    host.throughput = throughput;
+    host.completed = 0;
+    host.bytes = 0;
+    host.window.start();
+}
+
+}  // namespace Net
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <array>
+#include <functional>
+
+namespace Net {
+
+/** Decides when requests get to go out, for the whole launcher.
+ *
+ *  Every NetJob only limits its own requests, so a few jobs running at once (an asset update, some mod downloads and a
+ *  meta refresh) used to multiply the connections, often to the same host. Every request now waits here for a slot:
+ *  there is a global budget, and a budget per host.
+ *
+ *  Waiting requests go out by priority, and bulk downloads always leave part of the global budget to the others, so
+ *  the UI doesn't wait for a few thousand assets.
+ *
+ *  The budget of a host adapts to how it behaves: it gets halved when the host answers with 429 or a 5xx (and the
+ *  host is left alone for as long as its Retry-After asks), and grows back one request at a time while the throughput
+ *  keeps up, up to the per host limit.
+ *
+ *  Lives on the main thread, like the requests.
+ */
+class Scheduler : public QObject {
+    Q_OBJECT
+   public:
+    enum class Priority { Interactive, Normal, Bulk };
+
+    struct Outcome {
+        int status = 0;
+        // the connection timed out or got dropped, which overloaded hosts like to do
+        bool timedOut = false;
+        qint64 bytes = 0;
+        // seconds, as sent by the server
+        int retryAfter = 0;
+    };
+
+    static Scheduler& instance();
+
+    /* Seconds to wait for, from a Retry-After header: either a number of seconds or an HTTP date. */
+    static int parseRetryAfter(const QByteArray& value);
+
+    void setLimits(int global, int perHost);
+    /* Forgets how the hosts behaved so far: their limits go back to the per host limit, and nobody is paused. */
+    void resetHosts();
+    int globalLimit() const { return m_globalLimit; }
+    int hostLimit(const QString& host) const;
+
+    /* Queues a request to `host`, `start` gets called once it can go. `context` going away cancels it.
+     * Returns a ticket for finish(). */
+    quint64 submit(QObject* context, const QString& host, Priority priority, std::function<void()> start);
+    /* Gives the slot of a started request back, or drops it from the queue if it didn't start yet. */
+    void finish(quint64 ticket, const Outcome& outcome = {});
+    /* Moves a request that didn't start yet up to `priority`, if that's higher than the one it has. For requests that
+     * something more urgent ends up waiting for. */
+    void raise(quint64 ticket, Priority priority);
+
+    int active() const { return m_active; }
+    int waiting() const { return m_waiting.size(); }
+
+   private:
+    struct Waiting {
+        QPointer<QObject> context;
+        std::function<void()> start;
+        Priority priority;
+        QString host;
+    };
+    struct Host {
+        int active = 0;
+        int limit = 0;
+        // completed requests and their bytes since the limit last changed
+        int completed = 0;
+        qint64 bytes = 0;
+        QElapsedTimer window;
+        // bytes per millisecond in the last window
+        double throughput = 0;
+        bool grew = false;
+        QElapsedTimer pause;
+        qint64 pauseMs = 0;
+    };
+
+    explicit Scheduler(QObject* parent = nullptr);
+
+    void dispatch();
+    void scheduleDispatch();
+    Host& host(const QString& name);
+    bool isPaused(const Host& host) const;
+    void adapt(Host& host, const Outcome& outcome);
+
+   private:
+    int m_globalLimit = 6;
+    int m_hostLimit = 6;
+    int m_active = 0;
+    quint64 m_nextTicket = 1;
+    bool m_dispatchPending = false;
+
+    QHash<quint64, Waiting> m_waiting;
+    // tickets in order of submission, by priority and host. Cancelled ones only get dropped once they come up
+    std::array<QHash<QString, QQueue<quint64>>, 3> m_queues;
+    // host of each started request
+    QHash<quint64, QString> m_running;
+    QHash<QString, Host> m_hosts;
+};
+
+}  // namespace Net
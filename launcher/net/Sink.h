@@ -52,6 +52,25 @@ class Sink {
 
     virtual auto hasLocalData() -> bool = 0;
 
+    /* Called once per response with its headers, before the first write(). Redirects are not passed on. */
+    virtual auto headersReceived(QNetworkReply&) -> Task::State { return Task::State::Running; }
+
+    /* Whether write() (and the validators' write()) may run on a worker thread, see SinkPipeline, and readAdopted() too.
+     * Everything else is still called on the thread the request lives on. */
+    virtual auto canWriteOffThread() -> bool { return false; }
+
+    /* Where the data ends up. Requests for the same URL and target share one transfer, see NetRequest.
+     * Empty if the output is only of use to this sink. */
+    virtual auto target() const -> QString { return {}; }
+
+    /* Another request for the same URL and target() just did the transfer. Feeds what it left there to this sink's
+     * validators, which is the slow half of adopt(). Running if adopt() can go on, Inactive if there is no way to tell
+     * (the data then gets transferred again), Failed if the validators gave up already. */
+    virtual auto readAdopted() -> Task::State { return Task::State::Inactive; }
+    /* After readAdopted(), with `reply` being the response of the other request. Checks the result with this sink's
+     * validators, and does what finalize() would have done besides writing it. */
+    virtual auto adopt(QNetworkReply&) -> Task::State { return Task::State::Inactive; }
+
     void addValidator(Validator* validator)
     {
         if (validator) {
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SinkPipeline.h"
+
+#include <QMutexLocker>
+
+#include "tasks/WorkerPool.h"
+
+namespace Net {
+
+SinkPipeline::SinkPipeline(Sink* sink, QObject* parent) : QObject(parent), m_sink(sink) {}
+
+SinkPipeline::~SinkPipeline()
+{
+    // the job holds a pointer to us
+    cancel();
+}
+
+void SinkPipeline::write(QByteArray data)
+{
+    if (data.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_lock);
+    if (m_state != Task::State::Running)
+        return;
+
+    m_pending += data.size();
+    m_queue.enqueue(std::move(data));
+    if (!m_running) {
+        m_running = true;
+        m_job = WorkerPool::io().run([this] { run(); });
+    }
+}
+
+void SinkPipeline::run()
+{
+    for (;;) {
+        QByteArray chunk;
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_queue.isEmpty()) {
+                // still under the lock, so we can't be destroyed while emitting. receivers are queued
+                emit drained();
+                m_running = false;
+                return;
+            }
+            chunk = m_queue.dequeue();
+        }
+
+        auto state = m_sink->write(chunk);
+
+        QMutexLocker locker(&m_lock);
+        m_pending -= chunk.size();
+        if (state != Task::State::Running) {
+            m_state = state;
+            m_queue.clear();
+            m_pending = 0;
+        }
+    }
+}
+
+qint64 SinkPipeline::pendingBytes()
+{
+    QMutexLocker locker(&m_lock);
+    return m_pending;
+}
+
+bool SinkPipeline::isIdle()
+{
+    QMutexLocker locker(&m_lock);
+    return !m_running;
+}
+
+Task::State SinkPipeline::state()
+{
+    QMutexLocker locker(&m_lock);
+    return m_state;
+}
+
+void SinkPipeline::cancel()
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_queue.clear();
+        m_pending = 0;
+    }
+    waitForJob();
+}
+
+void SinkPipeline::waitForIdle()
+{
+    waitForJob();
+}
+
+void SinkPipeline::waitForJob()
+{
+    m_job.waitForFinished();
+    QMutexLocker locker(&m_lock);
+    if (!m_running)
+        return;
+    // the pool is shutting down and dropped the job, so whatever was queued never got written
+    m_running = false;
+    m_queue.clear();
+    m_pending = 0;
+    m_state = Task::State::Failed;
+}
+
+void SinkPipeline::reset()
+{
+    cancel();
+    QMutexLocker locker(&m_lock);
+    m_state = Task::State::Running;
+}
+
+}  // namespace Net
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QFuture>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+
+#include "Sink.h"
+
+namespace Net {
+
+/** Feeds response chunks to a Sink on WorkerPool::io() instead of the thread the request lives on.
+ *
+ *  Chunks are written in order, one at a time, so the sink and its validators never run concurrently.
+ *  The owner is expected to stop reading from the network while pendingBytes() is above s_high_water
+ *  and pick up again when drained() is emitted, which keeps memory use bounded.
+ *  The sink must only be touched by the owner again (finalize, abort, init) once the pipeline is idle.
+ */
+class SinkPipeline : public QObject {
+    Q_OBJECT
+   public:
+    // stop reading from the reply once this much data is waiting to be written
+    static const qint64 s_high_water = 4 * 1024 * 1024;
+
+    explicit SinkPipeline(Sink* sink, QObject* parent = nullptr);
+    ~SinkPipeline() override;
+
+    void write(QByteArray data);
+
+    qint64 pendingBytes();
+    bool isIdle();
+
+    // Failed once a write failed, Running otherwise. Writes after a failure are dropped.
+    Task::State state();
+
+    // drops whatever is still queued and waits for the chunk being written, so the sink can be used again
+    void cancel();
+    // waits until everything queued so far is written
+    void waitForIdle();
+
+    // resets the state for the next request
+    void reset();
+
+   signals:
+    // the queue ran empty (or a write failed). Emitted from the worker thread, only connect with Qt::QueuedConnection.
+    void drained();
+
+   private:
+    void run();
+    // waits for the job writing the queue, if there is one. only called by the owner
+    void waitForJob();
+
+    Sink* m_sink;
+    // the job writing the queue, only touched by the owner. it's canceled if the pool dropped it
+    QFuture<void> m_job;
+    QMutex m_lock;
+    QQueue<QByteArray> m_queue;
+    qint64 m_pending = 0;
+    bool m_running = false;
+    Task::State m_state = Task::State::Running;
+};
+
+}  // namespace Net
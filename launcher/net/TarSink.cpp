@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TarSink.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "FileSystem.h"
+
+#include "net/Logging.h"
+
+namespace Net {
+
+Task::State TarSink::init(QNetworkRequest& request)
+{
+    if (!initStaging())
+        return Task::State::Failed;
+    // the archive itself is only kept if it may have to be resumed
+    if (m_resumable)
+        return FileSink::init(request);
+    if (initAllValidators(request))
+        return Task::State::Running;
+    return Task::State::Failed;
+}
+
+bool TarSink::initStaging()
+{
+    // whatever an earlier attempt left behind
+    discardStaging();
+    if (!FS::ensureFolderPathExists(stagingPath())) {
+        qCCritical(taskNetLogC) << "Could not create folder" << stagingPath();
+        return false;
+    }
+
+    auto staging = QDir(stagingPath()).absolutePath();
+    if (m_gzipped)
+        m_gztar.reset(new GZTar::Extractor(staging));
+    else
+        m_tar.reset(new Tar::Extractor(staging));
+    return true;
+}
+
+Task::State TarSink::headersReceived(QNetworkReply& reply)
+{
+    bool resuming = m_resume_offset > 0;
+    auto state = FileSink::headersReceived(reply);
+    // the server sent the whole archive after all, so the extraction starts over too
+    if (state == Task::State::Running && resuming && m_resume_offset == 0 && !initStaging())
+        return Task::State::Failed;
+    return state;
+}
+
+Task::State TarSink::write(QByteArray& data)
+{
+    if (m_resumable)
+        return FileSink::write(data);
+
+    if (!writeAllValidators(data)) {
+        qCCritical(taskNetLogC) << "Failed to validate data for" << m_destination;
+        return Task::State::Failed;
+    }
+    if (!consume(data))
+        return Task::State::Failed;
+    return Task::State::Running;
+}
+
+bool TarSink::consume(QByteArray& data)
+{
+    bool ok = m_gztar ? m_gztar->write(data) : m_tar->write(data.constData(), data.size());
+    if (!ok)
+        qCCritical(taskNetLogC) << "Failed to extract archive into" << stagingPath();
+    return ok;
+}
+
+Task::State TarSink::abort()
+{
+    discardStaging();
+    if (m_resumable)
+        return FileSink::abort();
+    failAllValidators();
+    return Task::State::Failed;
+}
+
+Task::State TarSink::finalize(QNetworkReply& reply)
+{
+    if (m_resumable) {
+        // validates, and puts the complete archive where the partial one was. it's not needed anymore after this
+        auto state = FileSink::finalize(reply);
+        QFile::remove(m_filename);
+        if (state != Task::State::Succeeded) {
+            discardStaging();
+            return state;
+        }
+    } else if (!finalizeAllValidators(reply)) {
+        discardStaging();
+        return Task::State::Failed;
+    }
+
+    bool finished = m_gztar ? m_gztar->isFinished() : m_tar && m_tar->isFinished();
+    if (!finished) {
+        qCCritical(taskNetLogC) << "The archive for" << m_destination << "ended early";
+        discardStaging();
+        return Task::State::Failed;
+    }
+    m_gztar.reset();
+    m_tar.reset();
+
+    if (QFileInfo::exists(m_destination) && !FS::deletePath(m_destination)) {
+        qCCritical(taskNetLogC) << "Could not replace" << m_destination;
+        discardStaging();
+        return Task::State::Failed;
+    }
+    if (!FS::move(stagingPath(), m_destination)) {
+        qCCritical(taskNetLogC) << "Could not move" << stagingPath() << "to" << m_destination;
+        discardStaging();
+        return Task::State::Failed;
+    }
+    return Task::State::Succeeded;
+}
+
+void TarSink::discardStaging()
+{
+    // closes whatever file is still open in there
+    m_gztar.reset();
+    m_tar.reset();
+    if (QFileInfo::exists(stagingPath()))
+        FS::deletePath(stagingPath());
+}
+}  // namespace Net
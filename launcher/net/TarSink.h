@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FileSink.h"
+#include "Untar.h"
+
+namespace Net {
+
+/*
+ * Sink that extracts a (gzipped) tar archive into a folder while it downloads, instead of storing the archive.
+ *
+ * Everything goes into a staging folder next to the destination first, which only replaces the destination
+ * once the archive is complete and all validators agree. A failed download leaves the destination untouched.
+ *
+ * A resumable one does keep the archive while it downloads, in `<destination>.archive.part` (see FileSink).
+ * That costs the disk space of the archive until it's done, but an interrupted download continues where it stopped:
+ * the part that's already there gets extracted again, and the rest is extracted as it comes in.
+ */
+class TarSink : public FileSink {
+   public:
+    TarSink(QString destination, bool gzipped) : FileSink(destination + ".archive"), m_destination(destination), m_gzipped(gzipped) {}
+    virtual ~TarSink() = default;
+
+   public:
+    auto init(QNetworkRequest& request) -> Task::State override;
+    auto write(QByteArray& data) -> Task::State override;
+    auto abort() -> Task::State override;
+    auto finalize(QNetworkReply& reply) -> Task::State override;
+    auto headersReceived(QNetworkReply& reply) -> Task::State override;
+
+    auto hasLocalData() -> bool override { return false; }
+    auto target() const -> QString override { return m_destination; }
+    // the archive is gone once it's extracted
+    auto readAdopted() -> Task::State override { return Task::State::Inactive; }
+
+   protected:
+    auto consume(QByteArray& data) -> bool override;
+
+   private:
+    QString stagingPath() const { return m_destination + ".part"; }
+    bool initStaging();
+    void discardStaging();
+
+   private:
+    QString m_destination;
+    bool m_gzipped;
+    // one of these, depending on m_gzipped
+    std::unique_ptr<Tar::Extractor> m_tar;
+    std::unique_ptr<GZTar::Extractor> m_gztar;
+};
+}  // namespace Net
@@ -44,6 +44,7 @@ class Validator {
 
    public: /* methods */
     virtual bool init(QNetworkRequest& request) = 0;
+    /* May be called on a worker thread (never concurrently), if the sink writes off thread. */
     virtual bool write(QByteArray& data) = 0;
     virtual bool abort() = 0;
     virtual bool validate(QNetworkReply& reply) = 0;
@@ -44,13 +44,35 @@ INISettingsObject::INISettingsObject(QString path, QObject* parent) : SettingsOb
     m_ini.loadFile(path);
 }
 
+INISettingsObject::INISettingsObject(QString path, INIFile contents, QSet<QString> known_keys, QObject* parent)
+    : SettingsObject(parent), m_ini(std::move(contents)), m_filePath(std::move(path))
+{
+    m_loaded = known_keys.isEmpty();
+    m_known_keys = std::move(known_keys);
+}
+
+void INISettingsObject::ensureLoaded()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+    m_known_keys.clear();
+
+    m_ini.clear();
+    m_ini.loadFile(m_filePath);
+}
+
 void INISettingsObject::setFilePath(const QString& filePath)
 {
+    // what we didn't read yet is still at the old path
+    ensureLoaded();
     m_filePath = filePath;
 }
 
 bool INISettingsObject::reload()
 {
+    m_loaded = true;
+    m_known_keys.clear();
     return m_ini.loadFile(m_filePath) && SettingsObject::reload();
 }
 
@@ -70,6 +92,8 @@ void INISettingsObject::resumeSave()
 void INISettingsObject::changeSetting(const Setting& setting, QVariant value)
 {
     if (contains(setting.id())) {
+        // the whole file gets written back
+        ensureLoaded();
         // valid value -> set the main config, remove all the sysnonyms
         if (value.isValid()) {
             auto list = setting.configKeys();
@@ -99,6 +123,7 @@ void INISettingsObject::resetSetting(const Setting& setting)
 {
     // if we have the setting, remove all the synonyms. ALL OF THEM
     if (contains(setting.id())) {
+        ensureLoaded();
         for (auto iter : setting.configKeys())
             m_ini.remove(iter);
         doSave();
@@ -109,6 +134,12 @@ QVariant INISettingsObject::retrieveValue(const Setting& setting)
 {
     // if we have the setting, return value of the first matching synonym
     if (contains(setting.id())) {
+        for (auto iter : setting.configKeys()) {
+            if (!m_loaded && !m_known_keys.contains(iter)) {
+                ensureLoaded();
+                break;
+            }
+        }
         for (auto iter : setting.configKeys()) {
             if (m_ini.contains(iter))
                 return m_ini[iter];
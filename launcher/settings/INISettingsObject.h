@@ -16,6 +16,7 @@
 #pragma once
 
 #include <QObject>
+#include <QSet>
 
 #include "settings/INIFile.h"
 
@@ -32,6 +33,14 @@ class INISettingsObject : public SettingsObject {
 
     explicit INISettingsObject(QString path, QObject* parent = nullptr);
 
+    /** Takes the contents of the INI file at 'path' from whoever already read it.
+     *  If 'known_keys' isn't empty, 'contents' is only part of the file: whichever of those keys the file has. The rest
+     *  of it is read once a setting outside of them is needed, or anything gets changed. */
+    INISettingsObject(QString path, INIFile contents, QSet<QString> known_keys = {}, QObject* parent = nullptr);
+
+    /** Whether all of the file has been read. */
+    bool isLoaded() const { return m_loaded; }
+
     /*!
      * \brief Gets the path to the INI file.
      * \return The path to the INI file.
@@ -56,8 +65,13 @@ class INISettingsObject : public SettingsObject {
    protected:
     virtual QVariant retrieveValue(const Setting& setting) override;
     void doSave();
+    void ensureLoaded();
 
    protected:
     INIFile m_ini;
     QString m_filePath;
+
+    bool m_loaded = true;
+    // until the file is loaded, the keys m_ini can answer for
+    QSet<QString> m_known_keys;
 };
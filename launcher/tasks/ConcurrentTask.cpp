@@ -36,42 +36,117 @@
 #include "ConcurrentTask.h"
 
 #include <QDebug>
+#include <QMetaMethod>
+#include <utility>
+
 #include "tasks/Task.h"
 
-ConcurrentTask::ConcurrentTask(QString task_name, int max_concurrent) : Task(), m_total_max_size(max_concurrent)
+Task::Ptr ConcurrentTask::TaskQueue::dequeue()
+{
+    for (auto& queue : m_queues) {
+        if (!queue.isEmpty()) {
+            m_size--;
+            return queue.dequeue();
+        }
+    }
+    return nullptr;
+}
+
+void ConcurrentTask::TaskQueue::clear()
+{
+    for (auto& queue : m_queues)
+        queue.clear();
+    m_size = 0;
+}
+
+QList<Task::Ptr> ConcurrentTask::TaskQueue::tasks() const
+{
+    QList<Task::Ptr> tasks;
+    tasks.reserve(m_size);
+    for (const auto& queue : m_queues)
+        tasks.append(queue);
+    return tasks;
+}
+
+ConcurrentTask::ConcurrentTask(QString task_name, int max_concurrent) : Task(), m_total_max_size(max_concurrent), m_step_timer(this)
 {
     setObjectName(task_name);
+
+    m_step_timer.setSingleShot(true);
+    m_step_timer.setInterval(s_progressInterval);
+    connect(&m_step_timer, &QTimer::timeout, this, &ConcurrentTask::flushStepProgress);
 }
 
 ConcurrentTask::~ConcurrentTask()
 {
-    for (auto task : m_doing) {
-        if (task)
-            task->disconnect(this);
+    for (const auto& running : m_doing) {
+        if (running.task)
+            running.task->disconnect(this);
     }
 }
 
 auto ConcurrentTask::getStepProgress() const -> TaskStepProgressList
 {
-    return m_task_progress.values();
+    TaskStepProgressList steps;
+    for (const auto& running : m_doing) {
+        if (running.task) {
+            running.progress->details = running.task->getDetails();
+            steps.append(running.progress);
+        }
+    }
+    return steps;
+}
+
+QList<Task::Ptr> ConcurrentTask::runningTasks() const
+{
+    QList<Task::Ptr> tasks;
+    for (const auto& running : m_doing) {
+        if (running.task)
+            tasks.append(running.task);
+    }
+    return tasks;
 }
 
-void ConcurrentTask::addTask(Task::Ptr task)
+void ConcurrentTask::addTask(Task::Ptr task, Priority priority)
 {
-    m_queue.append(task);
+    m_queue.enqueue(task, priority);
 }
 
 void ConcurrentTask::executeTask()
 {
-    for (auto i = 0; i < m_total_max_size; i++)
-        QMetaObject::invokeMethod(this, &ConcurrentTask::executeNextSubTask, Qt::QueuedConnection);
+    scheduleDispatch();
+}
+
+void ConcurrentTask::scheduleDispatch()
+{
+    // however many subtasks finish in one go, a single dispatch takes care of all of them
+    if (m_dispatch_pending)
+        return;
+    m_dispatch_pending = true;
+    QMetaObject::invokeMethod(this, &ConcurrentTask::dispatch, Qt::QueuedConnection);
+}
+
+void ConcurrentTask::dispatch()
+{
+    m_dispatch_pending = false;
+    updateState();
+
+    // always through the event loop, so subtasks finishing right away can't pile up on the stack
+    int doing;
+    do {
+        doing = m_doing_count;
+        executeNextSubTask();
+    } while (isRunning() && m_doing_count > doing && m_doing_count < m_total_max_size && !m_queue.isEmpty());
+
+    if (isRunning())
+        updateState();
 }
 
 bool ConcurrentTask::abort()
 {
     m_queue.clear();
 
-    if (m_doing.isEmpty()) {
+    if (m_doing_count == 0) {
         // Don't call emitAborted() here, we want to bypass the 'is the task running' check
         emit aborted();
         emit finished();
@@ -81,11 +156,9 @@ bool ConcurrentTask::abort()
 
     bool suceedeed = true;
 
-    QMutableHashIterator<Task*, Task::Ptr> doing_iter(m_doing);
-    while (doing_iter.hasNext()) {
-        auto task = doing_iter.next();
-        disconnect(task->get(), &Task::aborted, this, 0);
-        suceedeed &= (task.value())->abort();
+    for (const auto& task : runningTasks()) {
+        disconnect(task.get(), &Task::aborted, this, 0);
+        suceedeed &= task->abort();
     }
 
     if (suceedeed)
@@ -100,10 +173,12 @@ void ConcurrentTask::clear()
 {
     Q_ASSERT(!isRunning());
 
-    m_done.clear();
+    m_succeeded.clear();
     m_failed.clear();
     m_queue.clear();
-    m_task_progress.clear();
+    m_doing.clear();
+    m_free_slots.clear();
+    m_changed_slots.clear();
 
     m_progress = 0;
 }
@@ -113,11 +188,11 @@ void ConcurrentTask::executeNextSubTask()
     if (!isRunning()) {
         return;
     }
-    if (m_doing.count() >= m_total_max_size) {
+    if (m_doing_count >= m_total_max_size) {
         return;
     }
     if (m_queue.isEmpty()) {
-        if (m_doing.isEmpty()) {
+        if (m_doing_count == 0) {
             if (m_failed.isEmpty())
                 emitSucceeded();
             else
@@ -131,108 +206,141 @@ void ConcurrentTask::executeNextSubTask()
 
 void ConcurrentTask::startSubTask(Task::Ptr next)
 {
-    connect(next.get(), &Task::succeeded, this, [this, next]() { subTaskSucceeded(next); });
-    connect(next.get(), &Task::failed, this, [this, next](QString msg) { subTaskFailed(next, msg); });
+    int slot;
+    if (m_free_slots.empty()) {
+        slot = static_cast<int>(m_doing.size());
+        m_doing.emplace_back();
+    } else {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    m_doing[slot] = { next, std::make_shared<TaskStepProgress>(next->getUid()) };
+    m_doing_count++;
+
+    connect(next.get(), &Task::succeeded, this, [this, slot]() { subTaskSucceeded(slot); });
+    connect(next.get(), &Task::failed, this, [this, slot](QString msg) { subTaskFailed(slot, msg); });
     // this should never happen but if it does, it's better to fail the task than get stuck
-    connect(next.get(), &Task::aborted, this, [this, next] { subTaskFailed(next, "Aborted"); });
+    connect(next.get(), &Task::aborted, this, [this, slot] { subTaskFailed(slot, "Aborted"); });
 
-    connect(next.get(), &Task::status, this, [this, next](QString msg) { subTaskStatus(next, msg); });
-    connect(next.get(), &Task::details, this, [this, next](QString msg) { subTaskDetails(next, msg); });
+    connect(next.get(), &Task::status, this, [this, slot](QString msg) { subTaskStatus(slot, msg); });
+    connect(next.get(), &Task::details, this, [this, slot](QString msg) { subTaskDetails(slot, msg); });
     connect(next.get(), &Task::stepProgress, this, &ConcurrentTask::stepProgress);
 
-    connect(next.get(), &Task::progress, this, [this, next](qint64 current, qint64 total) { subTaskProgress(next, current, total); });
-
-    m_doing.insert(next.get(), next);
-
-    auto task_progress = std::make_shared<TaskStepProgress>(next->getUid());
-    m_task_progress.insert(next->getUid(), task_progress);
-
-    updateState();
+    connect(next.get(), &Task::progress, this, [this, slot](qint64 current, qint64 total) { subTaskProgress(slot, current, total); });
 
     QMetaObject::invokeMethod(next.get(), &Task::start, Qt::QueuedConnection);
 }
 
-void ConcurrentTask::subTaskFinished(Task::Ptr task, TaskStepState state)
+void ConcurrentTask::subTaskFinished(int slot, TaskStepState state)
 {
-    m_done.insert(task.get(), task);
-    (state == TaskStepState::Succeeded ? m_succeeded : m_failed).insert(task.get(), task);
+    auto running = std::exchange(m_doing[slot], {});
+    m_free_slots.push_back(slot);
+    m_doing_count--;
+    (state == TaskStepState::Succeeded ? m_succeeded : m_failed).append(running.task);
 
-    m_doing.remove(task.get());
-
-    auto task_progress = *m_task_progress.value(task->getUid());
+    auto task_progress = *running.progress;
     task_progress.state = state;
-    m_task_progress.remove(task->getUid());
 
-    disconnect(task.get(), 0, this, 0);
+    disconnect(running.task.get(), 0, this, 0);
 
     emit stepProgress(task_progress);
-    updateState();
-    QMetaObject::invokeMethod(this, &ConcurrentTask::executeNextSubTask, Qt::QueuedConnection);
+    scheduleDispatch();
 }
 
-void ConcurrentTask::subTaskSucceeded(Task::Ptr task)
+void ConcurrentTask::subTaskSucceeded(int slot)
 {
-    subTaskFinished(task, TaskStepState::Succeeded);
+    subTaskFinished(slot, TaskStepState::Succeeded);
 }
 
-void ConcurrentTask::subTaskFailed(Task::Ptr task, [[maybe_unused]] const QString& msg)
+void ConcurrentTask::subTaskFailed(int slot, [[maybe_unused]] const QString& msg)
 {
-    subTaskFinished(task, TaskStepState::Failed);
+    subTaskFinished(slot, TaskStepState::Failed);
 }
 
-void ConcurrentTask::subTaskStatus(Task::Ptr task, const QString& msg)
+void ConcurrentTask::subTaskStatus(int slot, const QString& msg)
 {
-    auto task_progress = m_task_progress.value(task->getUid());
+    auto task_progress = m_doing[slot].progress;
     task_progress->status = msg;
     task_progress->state = TaskStepState::Running;
 
-    emit stepProgress(*task_progress);
+    stepChanged(slot);
 
     if (totalSize() == 1) {
         setStatus(msg);
     }
 }
 
-void ConcurrentTask::subTaskDetails(Task::Ptr task, const QString& msg)
+void ConcurrentTask::subTaskDetails(int slot, const QString& msg)
 {
-    auto task_progress = m_task_progress.value(task->getUid());
+    auto task_progress = m_doing[slot].progress;
     task_progress->details = msg;
     task_progress->state = TaskStepState::Running;
 
-    emit stepProgress(*task_progress);
+    stepChanged(slot);
 
     if (totalSize() == 1) {
         setDetails(msg);
     }
 }
 
-void ConcurrentTask::subTaskProgress(Task::Ptr task, qint64 current, qint64 total)
+void ConcurrentTask::subTaskProgress(int slot, qint64 current, qint64 total)
 {
-    auto task_progress = m_task_progress.value(task->getUid());
+    auto task_progress = m_doing[slot].progress;
 
     task_progress->update(current, total);
 
-    emit stepProgress(*task_progress);
-    updateState();
+    stepChanged(slot);
 
     if (totalSize() == 1) {
         setProgress(task_progress->current, task_progress->total);
     }
 }
 
+void ConcurrentTask::stepChanged(int slot)
+{
+    // subtasks can report many times a second each. collect all of that and pass it on at a steady pace
+    auto& running = m_doing[slot];
+    if (!running.changed) {
+        running.changed = true;
+        m_changed_slots.push_back(slot);
+    }
+    if (!m_step_timer.isActive())
+        m_step_timer.start();
+}
+
+void ConcurrentTask::flushStepProgress()
+{
+    // a slot that changed hands since is only reported if its new subtask changed too
+    auto changed = std::exchange(m_changed_slots, {});
+    const bool shown = totalSize() == 1 || isSignalConnected(QMetaMethod::fromSignal(&Task::stepProgress));
+    for (auto slot : changed) {
+        auto& running = m_doing[slot];
+        if (running.task && running.changed) {
+            running.changed = false;
+            if (!shown)
+                continue;
+            // some subtasks (like downloads) only put their details together when asked
+            running.progress->details = running.task->getDetails();
+            if (totalSize() == 1)
+                setDetails(running.progress->details);
+            emit stepProgress(*running.progress);
+        }
+    }
+}
+
 void ConcurrentTask::updateState()
 {
     if (totalSize() > 1) {
-        setProgress(m_done.count(), totalSize());
+        setProgress(doneCount(), totalSize());
         setStatus(tr("Executing %1 task(s) (%2 out of %3 are done)")
-                      .arg(QString::number(m_doing.count()), QString::number(m_done.count()), QString::number(totalSize())));
+                      .arg(QString::number(m_doing_count), QString::number(doneCount()), QString::number(totalSize())));
     } else {
         QString status = tr("Please wait...");
         if (m_queue.size() > 0) {
             status = tr("Waiting for a task to start...");
-        } else if (m_doing.size() > 0) {
+        } else if (m_doing_count > 0) {
             status = tr("Executing 1 task:");
-        } else if (m_done.size() > 0) {
+        } else if (doneCount() > 0) {
             status = tr("Task finished.");
         }
         setStatus(status);
@@ -36,10 +36,13 @@
 #pragma once
 
 #include <QHash>
+#include <QList>
 #include <QQueue>
 #include <QSet>
+#include <QTimer>
 #include <QUuid>
 #include <memory>
+#include <vector>
 
 #include "tasks/Task.h"
 
@@ -48,6 +51,31 @@ class ConcurrentTask : public Task {
    public:
     using Ptr = shared_qobject_ptr<ConcurrentTask>;
 
+    /* Queued subtasks start in priority order, and in the order they were added within the same priority. */
+    enum class Priority { High, Normal, Low };
+
+    /* The subtasks that didn't start yet, one FIFO per priority. */
+    class TaskQueue {
+       public:
+        void enqueue(Task::Ptr task, Priority priority = Priority::Normal)
+        {
+            m_queues[static_cast<int>(priority)].enqueue(task);
+            m_size++;
+        }
+        Task::Ptr dequeue();
+
+        bool isEmpty() const { return m_size == 0; }
+        int size() const { return m_size; }
+        void clear();
+
+        // all of them, in the order they would start
+        QList<Task::Ptr> tasks() const;
+
+       private:
+        QQueue<Task::Ptr> m_queues[3];
+        int m_size = 0;
+    };
+
     explicit ConcurrentTask(QString task_name = "", int max_concurrent = 6);
     ~ConcurrentTask() override;
 
@@ -59,7 +87,7 @@ class ConcurrentTask : public Task {
     inline auto isMultiStep() const -> bool override { return totalSize() > 1; }
     auto getStepProgress() const -> TaskStepProgressList override;
 
-    void addTask(Task::Ptr task);
+    void addTask(Task::Ptr task, Priority priority = Priority::Normal);
 
    public slots:
     bool abort() override;
@@ -72,32 +100,63 @@ class ConcurrentTask : public Task {
    protected slots:
     void executeTask() override;
 
+    /* Starts the next subtask, if there's a free slot for it, and finishes the task once there's nothing left to do. */
     virtual void executeNextSubTask();
 
-    void subTaskSucceeded(Task::Ptr);
-    virtual void subTaskFailed(Task::Ptr, const QString& msg);
-    void subTaskFinished(Task::Ptr, TaskStepState);
-    void subTaskStatus(Task::Ptr task, const QString& msg);
-    void subTaskDetails(Task::Ptr task, const QString& msg);
-    void subTaskProgress(Task::Ptr task, qint64 current, qint64 total);
+    void subTaskSucceeded(int slot);
+    virtual void subTaskFailed(int slot, const QString& msg);
+    void subTaskFinished(int slot, TaskStepState);
+    void subTaskStatus(int slot, const QString& msg);
+    void subTaskDetails(int slot, const QString& msg);
+    void subTaskProgress(int slot, qint64 current, qint64 total);
 
    protected:
     // NOTE: This is not thread-safe.
-    [[nodiscard]] unsigned int totalSize() const { return static_cast<unsigned int>(m_queue.size() + m_doing.size() + m_done.size()); }
+    [[nodiscard]] unsigned int totalSize() const { return static_cast<unsigned int>(m_queue.size() + doingCount() + doneCount()); }
+    int doingCount() const { return m_doing_count; }
+    int doneCount() const { return m_succeeded.size() + m_failed.size(); }
+    QList<Task::Ptr> runningTasks() const;
 
     virtual void updateState();
 
     void startSubTask(Task::Ptr task);
 
-   protected:
-    QQueue<Task::Ptr> m_queue;
+   private slots:
+    // fills all the free slots at once, instead of one event loop round trip per slot
+    void dispatch();
+    // reports the subtasks that changed since the last time, see s_progressInterval
+    void flushStepProgress();
+
+   private:
+    void scheduleDispatch();
+    void stepChanged(int slot);
 
-    QHash<Task*, Task::Ptr> m_doing;
-    QHash<Task*, Task::Ptr> m_done;
-    QHash<Task*, Task::Ptr> m_failed;
-    QHash<Task*, Task::Ptr> m_succeeded;
+   protected:
+    TaskQueue m_queue;
 
-    QHash<QUuid, std::shared_ptr<TaskStepProgress>> m_task_progress;
+    // the finished subtasks. the failed ones can go back on the queue, see NetJob
+    QList<Task::Ptr> m_succeeded;
+    QList<Task::Ptr> m_failed;
 
     int m_total_max_size;
+
+   private:
+    struct Running {
+        Task::Ptr task;
+        std::shared_ptr<TaskStepProgress> progress;
+        // reported something that wasn't passed on yet
+        bool changed = false;
+    };
+
+    /* The running subtasks, by slot. A subtask keeps its slot until it finishes, then the slot goes to the next one:
+     * its signals carry the slot, so there is nothing to look up. */
+    std::vector<Running> m_doing;
+    std::vector<int> m_free_slots;
+    int m_doing_count = 0;
+
+    bool m_dispatch_pending = false;
+
+    // slots with progress nobody was told about yet
+    std::vector<int> m_changed_slots;
+    QTimer m_step_timer;
 };
@@ -40,7 +40,7 @@ MultipleOptionsTask::MultipleOptionsTask(const QString& task_name) : ConcurrentT
 
 void MultipleOptionsTask::executeNextSubTask()
 {
-    if (m_done.size() != m_failed.size()) {
+    if (!m_succeeded.isEmpty()) {
         emitSucceeded();
         return;
     }
@@ -56,6 +56,6 @@ void MultipleOptionsTask::executeNextSubTask()
 
 void MultipleOptionsTask::updateState()
 {
-    setProgress(m_done.count(), totalSize());
-    setStatus(tr("Attempting task %1 out of %2").arg(QString::number(m_doing.count() + m_done.count()), QString::number(totalSize())));
+    setProgress(doneCount(), totalSize());
+    setStatus(tr("Attempting task %1 out of %2").arg(QString::number(doingCount() + doneCount()), QString::number(totalSize())));
 }
@@ -40,15 +40,15 @@
 
 SequentialTask::SequentialTask(QString task_name) : ConcurrentTask(task_name, 1) {}
 
-void SequentialTask::subTaskFailed(Task::Ptr task, const QString& msg)
+void SequentialTask::subTaskFailed(int slot, const QString& msg)
 {
     emitFailed(msg);
     qWarning() << msg;
-    ConcurrentTask::subTaskFailed(task, msg);
+    ConcurrentTask::subTaskFailed(slot, msg);
 }
 
 void SequentialTask::updateState()
 {
-    setProgress(m_done.count(), totalSize());
-    setStatus(tr("Executing task %1 out of %2").arg(QString::number(m_doing.count() + m_done.count()), QString::number(totalSize())));
+    setProgress(doneCount(), totalSize());
+    setStatus(tr("Executing task %1 out of %2").arg(QString::number(doingCount() + doneCount()), QString::number(totalSize())));
 }
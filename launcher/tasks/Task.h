@@ -39,6 +39,7 @@
 #include <QLoggingCategory>
 #include <QRunnable>
 #include <QUuid>
+#include <chrono>
 
 #include "QObjectPtr.h"
 
@@ -86,6 +87,10 @@ class Task : public QObject, public QRunnable {
 
     enum class State { Inactive, Running, Succeeded, Failed, AbortedByUser };
 
+    /* How often fast moving progress (bytes downloaded, subtask steps) gets reported further up.
+     * Faster than that nobody can read it anyway, it only keeps the UI busy. */
+    static constexpr std::chrono::milliseconds s_progressInterval{ 100 };
+
    public:
     explicit Task(bool show_debug_log = true);
     virtual ~Task() = default;
@@ -113,7 +118,7 @@ class Task : public QObject, public QRunnable {
     auto getState() const -> State { return m_state; }
 
     QString getStatus() { return m_status; }
-    QString getDetails() { return m_details; }
+    virtual QString getDetails() const { return m_details; }
 
     qint64 getProgress() { return m_progress; }
     qint64 getTotalProgress() { return m_progressTotal; }
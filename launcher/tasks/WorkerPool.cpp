@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WorkerPool.h"
+
+#include <QThread>
+
+// the pool and worker the current thread belongs to, if any
+static thread_local WorkerPool* t_pool = nullptr;
+static thread_local int t_worker = -1;
+
+// the shared pools, see setShared()
+static WorkerPool* s_instance = nullptr;
+static WorkerPool* s_io = nullptr;
+
+WorkerPool& WorkerPool::instance()
+{
+    if (s_instance)
+        return *s_instance;
+    static WorkerPool pool(defaultThreads());
+    return pool;
+}
+
+WorkerPool& WorkerPool::io()
+{
+    if (s_io)
+        return *s_io;
+    static WorkerPool pool(s_ioThreads);
+    return pool;
+}
+
+void WorkerPool::setShared(WorkerPool* instance, WorkerPool* io)
+{
+    s_instance = instance;
+    s_io = io;
+}
+
+int WorkerPool::defaultThreads()
+{
+    return qMax(1, QThread::idealThreadCount());
+}
+
+WorkerPool::WorkerPool(int threads)
+{
+    for (int i = 0; i < qMax(1, threads); i++)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < size(); i++) {
+        auto thread = QThread::create([this, i] { work(i); });
+        thread->setObjectName(QString("Worker %1").arg(i));
+        m_workers[i]->thread = thread;
+        thread->start();
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    if (s_instance == this)
+        s_instance = nullptr;
+    if (s_io == this)
+        s_io = nullptr;
+    shutdown();
+    for (auto& worker : m_workers)
+        delete worker->thread;
+}
+
+void WorkerPool::shutdown()
+{
+    {
+        QMutexLocker locker(&m_sleep_lock);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    for (auto& worker : m_workers)
+        worker->thread->wait();
+
+    for (auto& worker : m_workers) {
+        QMutexLocker locker(&worker->lock);
+        for (auto& queue : worker->queues)
+            queue.clear();
+    }
+}
+
+void WorkerPool::start(std::function<void()> job, Priority priority)
+{
+    if (m_stopping)
+        return;
+    int index = t_pool == this ? t_worker : static_cast<int>(m_next++ % m_workers.size());
+    {
+        auto& worker = *m_workers[index];
+        QMutexLocker locker(&worker.lock);
+        worker.queues[static_cast<int>(priority)].push_back(std::move(job));
+    }
+    QMutexLocker locker(&m_sleep_lock);
+    m_queued++;
+    m_wake.wakeOne();
+}
+
+bool WorkerPool::take(int self, Job& job)
+{
+    const int count = size();
+    for (int priority = 0; priority < s_priorities; priority++) {
+        // our own newest job first, whatever it needs is most likely still in the cache
+        {
+            auto& own = *m_workers[self];
+            QMutexLocker locker(&own.lock);
+            auto& queue = own.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.back());
+                queue.pop_back();
+                return true;
+            }
+        }
+        // then the oldest job of someone else
+        for (int i = 1; i < count; i++) {
+            auto& victim = *m_workers[(self + i) % count];
+            QMutexLocker locker(&victim.lock);
+            auto& queue = victim.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkerPool::work(int self)
+{
+    t_pool = this;
+    t_worker = self;
+    while (!m_stopping) {
+        // everything queued up to here is visible to take(), a job queued later bumps this before it wakes anyone
+        auto queued = m_queued.load();
+        Job job;
+        if (take(self, job)) {
+            job();
+            continue;
+        }
+
+        QMutexLocker locker(&m_sleep_lock);
+        if (m_stopping)
+            return;
+        // the jobs take() missed went to other workers. only a new one is worth looking again for
+        if (m_queued.load() == queued)
+            m_wake.wait(&m_sleep_lock);
+    }
+}
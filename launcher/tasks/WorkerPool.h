@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/*
+ *  Prism Launcher - Minecraft Launcher
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class QThread;
+
+/** A fixed set of threads for CPU bound work, like hashing, parsing and extracting files.
+ *
+ *  Every worker has its own queues. Work submitted from outside the pool is spread over the workers, work submitted
+ *  from a job running on the pool stays with that worker. A worker runs its own newest job first and, once it runs out,
+ *  steals the oldest one from another worker, so nobody sits idle while there's work and the workers hardly ever
+ *  contend on the same queue.
+ *
+ *  Higher priorities always go first, on every worker.
+ */
+class WorkerPool {
+   public:
+    enum class Priority { High, Normal, Low };
+
+    /* The shared pools. They belong to the application, which sets them up with setShared() and shuts them down
+     * before anything their jobs use goes away. Without an application (in tests) they're made on first use. */
+    // one thread per core
+    static WorkerPool& instance();
+    // a few threads for jobs that mostly wait on the disk (or the network), like reading lots of small files
+    static WorkerPool& io();
+    static void setShared(WorkerPool* instance, WorkerPool* io);
+
+    // one per core, for instance()
+    static int defaultThreads();
+    // more than that and local disks start seeking all over, but it's enough to hide the latency of network shares
+    static constexpr int s_ioThreads = 4;
+
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    /* Waits for the running jobs. The ones that didn't start yet are dropped, and so is anything started from now on. */
+    void shutdown();
+
+    int size() const { return static_cast<int>(m_workers.size()); }
+
+    void start(std::function<void()> job, Priority priority = Priority::Normal);
+
+    /* Like QtConcurrent::run(), for a QFuture (and QFutureWatcher). Cancelling the future before the job starts skips it.
+     * A job that gets dropped (see shutdown()) leaves the future canceled. */
+    template <typename Function>
+    auto run(Function job, Priority priority = Priority::Normal) -> QFuture<std::invoke_result_t<Function>>
+    {
+        using Result = std::invoke_result_t<Function>;
+        auto promise = std::make_shared<Promise<Result>>();
+        promise->reportStarted();
+        auto future = promise->future();
+        start(
+            [promise, job = std::move(job)]() mutable {
+                if (!promise->isCanceled()) {
+                    if constexpr (std::is_void_v<Result>)
+                        job();
+                    else
+                        promise->reportResult(job());
+                }
+                promise->reportFinished();
+            },
+            priority);
+        return future;
+    }
+
+    /* Like QtConcurrent::blockingMap(): calls `job` on every item of `items` (a container with random access iterators)
+     * and returns once all of them are done. The calling thread takes items too, so it never waits on a job that didn't
+     * start, and this works from a job on the pool (and after shutdown()) as well. */
+    template <typename Container, typename Function>
+    void blockingMap(Container& items, Function job, Priority priority = Priority::Normal)
+    {
+        using Iterator = decltype(items.begin());
+        struct State {
+            State(Iterator first, qint64 count, Function job) : first(first), count(count), job(std::move(job)) {}
+            Iterator first;
+            qint64 count;
+            Function job;
+            std::atomic<qint64> next{ 0 };
+            QMutex lock;
+            QWaitCondition idle;
+            qint64 finished = 0;
+        };
+        // begin() here, so the workers don't all detach the container at once
+        auto state = std::make_shared<State>(items.begin(), static_cast<qint64>(items.size()), std::move(job));
+        // a worker that only gets to this after everything is done finds nothing left, and doesn't touch the items
+        auto work = [state] {
+            qint64 finished = 0;
+            for (qint64 index; (index = state->next++) < state->count; finished++)
+                state->job(*(state->first + index));
+            if (finished == 0)
+                return;
+            QMutexLocker locker(&state->lock);
+            state->finished += finished;
+            if (state->finished == state->count)
+                state->idle.wakeAll();
+        };
+        for (qint64 i = 1; i < qMin<qint64>(size(), state->count); i++)
+            start(work, priority);
+        work();
+
+        QMutexLocker locker(&state->lock);
+        while (state->finished < state->count)
+            state->idle.wait(&state->lock);
+    }
+
+   private:
+    using Job = std::function<void()>;
+
+    // finishes the future of a job that never ran, so nobody waits on it forever
+    template <typename Result>
+    struct Promise : QFutureInterface<Result> {
+        ~Promise()
+        {
+            if (!this->isFinished()) {
+                this->reportCanceled();
+                this->reportFinished();
+            }
+        }
+    };
+    static const int s_priorities = 3;
+
+    struct Worker {
+        QMutex lock;
+        std::deque<Job> queues[s_priorities];
+        QThread* thread = nullptr;
+    };
+
+    void work(int self);
+    bool take(int self, Job& job);
+
+   private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    // bumped (under m_sleep_lock) after every job that got queued, see work()
+    std::atomic<quint64> m_queued{ 0 };
+    std::atomic<unsigned> m_next{ 0 };
+
+    // idle workers wait here
+    QMutex m_sleep_lock;
+    QWaitCondition m_wake;
+    std::atomic<bool> m_stopping{ false };
+
+    Q_DISABLE_COPY(WorkerPool)
+};
@@ -548,6 +548,7 @@ void TranslationsModel::downloadIndex()
     }
     qDebug() << "Downloading Translations Index...";
     d->m_index_job.reset(new NetJob("Translations Index", APPLICATION->network()));
+    d->m_index_job->setPriority(Net::Scheduler::Priority::Interactive);
     MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry("translations", "index_v2.json");
     entry->setStale(true);
     auto task = Net::Download::makeCached(QUrl(BuildConfig.TRANSLATION_FILES_URL + "index_v2.json"), entry);
@@ -596,6 +597,7 @@ void TranslationsModel::downloadTranslation(QString key)
     dl->setProgress(dl->getProgress(), lang->file_size);
 
     d->m_dl_job.reset(new NetJob("Translation for " + key, APPLICATION->network()));
+    d->m_dl_job->setPriority(Net::Scheduler::Priority::Interactive);
     d->m_dl_job->addNetAction(dl);
     d->m_dl_job->setAskRetry(false);
 
@@ -378,6 +378,11 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(ui->actionUndoTrashInstance, &QAction::triggered, this, &MainWindow::undoTrashInstance);
 
     setSelectedInstanceById(APPLICATION->settings()->get("SelectedInstance").toString());
+    // the instances show up once they've been found, select the last one again then
+    connect(APPLICATION->instances().get(), &InstanceList::listLoaded, this, [this] {
+        if (!m_selectedInstance)
+            setSelectedInstanceById(APPLICATION->settings()->get("SelectedInstance").toString());
+    });
 
     // removing this looks stupid
     view->setFocus();
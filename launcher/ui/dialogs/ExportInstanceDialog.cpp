@@ -73,6 +73,8 @@ ExportInstanceDialog::ExportInstanceDialog(InstancePtr instance, QWidget* parent
     proxyModel->ignoreFilesWithName().append({ ".DS_Store", "thumbs.db", "Thumbs.db" });
     proxyModel->ignoreFilesWithPath().insert(
         { FS::PathCombine(prefix, ".cache"), FS::PathCombine(prefix, ".fabric"), FS::PathCombine(prefix, ".quilt") });
+    // the complete logs of the last launches, see LogArchive
+    proxyModel->ignoreFilesWithPath().insert("launcher_logs");
     loadPackIgnore();
 
     ui->treeView->setModel(proxyModel);
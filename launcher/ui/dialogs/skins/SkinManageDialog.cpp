@@ -173,6 +173,7 @@ void SkinManageDialog::setupCapes()
 
     auto capesDir = FS::PathCombine(m_list.getDir(), "capes");
     NetJob::Ptr job{ new NetJob(tr("Download capes"), APPLICATION->network()) };
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     bool needsToDownload = false;
     for (auto& cape : accountData.minecraftProfile.capes) {
         auto path = FS::PathCombine(capesDir, cape.id + ".png");
@@ -356,6 +357,7 @@ void SkinManageDialog::on_urlBtn_clicked()
     }
 
     NetJob::Ptr job{ new NetJob(tr("Download skin"), APPLICATION->network()) };
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
 
     auto path = FS::PathCombine(m_list.getDir(), url.fileName());
@@ -413,6 +415,7 @@ void SkinManageDialog::on_userBtn_clicked()
     auto path = FS::PathCombine(m_list.getDir(), user + ".png");
 
     NetJob::Ptr job{ new NetJob(tr("Download user skin"), APPLICATION->network(), 1) };
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
 
     auto uuidOut = std::make_shared<QByteArray>();
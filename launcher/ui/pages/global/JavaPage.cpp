@@ -48,11 +48,13 @@
 #include <QMessageBox>
 #include <QStringListModel>
 #include <QTabBar>
+#include <QtConcurrent>
 
 #include "ui/dialogs/VersionSelectDialog.h"
 
 #include "java/JavaInstallList.h"
 #include "java/JavaUtils.h"
+#include "java/download/RuntimeStore.h"
 
 #include <FileSystem.h>
 #include <sys.h>
@@ -272,6 +274,8 @@ void JavaPage::on_removeJavaButton_clicked()
 
             if (response == QMessageBox::Yes) {
                 FS::deletePath(entry.canonicalFilePath());
+                QtConcurrent::run(QThreadPool::globalInstance(),
+                                  [javaPath = APPLICATION->javaPath()] { Java::RuntimeStore(javaPath).collectGarbage(); });
                 ui->managedJavaList->loadList();
             }
             break;
@@ -40,18 +40,36 @@
 
 #include "Application.h"
 
+#include <QBuffer>
+#include <QFileDialog>
 #include <QIdentityProxyModel>
+#include <QSaveFile>
 #include <QScrollBar>
 #include <QShortcut>
 
+#include "FileSystem.h"
 #include "launch/LaunchTask.h"
 #include "settings/Setting.h"
+#include "tasks/WorkerPool.h"
 
 #include "ui/GuiUtil.h"
 #include "ui/themes/ThemeManager.h"
 
 #include <BuildConfig.h>
 
+// lines of the complete log paged in at a time, the archive view holds two pages
+static const int s_archivePageLines = 2000;
+
+// reads all of the archive on a worker
+static QByteArray completeLog(LogArchive::Reader& reader)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    reader.writeTo(&buffer);
+    return data;
+}
+
 class LogFormatProxyModel : public QIdentityProxyModel {
    public:
     LogFormatProxyModel(QObject* parent = nullptr) : QIdentityProxyModel(parent) {}
@@ -156,6 +174,8 @@ LogPage::LogPage(InstancePtr instance, QWidget* parent) : QWidget(parent), ui(ne
     }
 
     ui->text->setModel(m_proxy);
+    ui->archiveLabel->hide();
+    connect(ui->text->verticalScrollBar(), &QScrollBar::actionTriggered, this, &LogPage::onScrollAction);
 
     // set up instance and launch process recognition
     {
@@ -173,6 +193,11 @@ LogPage::LogPage(InstancePtr instance, QWidget* parent) : QWidget(parent), ui(ne
     connect(ui->searchBar, SIGNAL(returnPressed()), SLOT(on_findButton_clicked()));
     auto findPreviousShortcut = new QShortcut(QKeySequence(QKeySequence::FindPrevious), this);
     connect(findPreviousShortcut, SIGNAL(activated()), SLOT(findPreviousActivated()));
+
+    connect(&m_pageWatcher, &QFutureWatcher<ArchivePage>::finished, this, &LogPage::archivePageRead);
+    connect(&m_findWatcher, &QFutureWatcher<ArchiveMatch>::finished, this, &LogPage::archiveSearched);
+    connect(&m_saveWatcher, &QFutureWatcher<bool>::finished, this, &LogPage::logSaved);
+    connect(&m_exportWatcher, &QFutureWatcher<QByteArray>::finished, this, &LogPage::logExported);
 }
 
 LogPage::~LogPage()
@@ -208,6 +233,10 @@ void LogPage::UIToModelState()
 void LogPage::setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc, bool initial)
 {
     m_process = proc;
+    m_archiveFirst = -1;
+    m_archiveGeneration++;
+    m_nextPage.reset();
+    ui->archiveLabel->hide();
     if (m_process) {
         m_model = proc->getLogModel();
         m_proxy->setSourceModel(m_model.get());
@@ -220,6 +249,7 @@ void LogPage::setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc,
         m_proxy->setSourceModel(nullptr);
         m_model.reset();
     }
+    m_archiveModel.reset();
 }
 
 void LogPage::onInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc)
@@ -239,13 +269,42 @@ bool LogPage::shouldDisplay() const
 
 void LogPage::on_btnPaste_clicked()
 {
-    if (!m_model)
+    if (!m_model || !m_process || m_exportWatcher.isRunning())
         return;
 
     // FIXME: turn this into a proper task and move the upload logic out of GuiUtil!
     m_model->append(MessageLevel::Launcher,
                     QString("Log upload triggered at: %1").arg(QDateTime::currentDateTime().toString(Qt::RFC2822Date)));
-    auto url = GuiUtil::uploadPaste(tr("Minecraft Log"), m_model->toPlainText(), this);
+    // the complete log, put together from the archive on a worker thread. it has to be in memory in one piece all the
+    // same, every paste service wants it as a single (JSON or form encoded) body
+    m_export = Export::Paste;
+    m_exportWatcher.setFuture(
+        WorkerPool::instance().run([reader = m_process->getLogArchive()->reader()]() mutable { return completeLog(reader); }));
+}
+
+void LogPage::on_btnCopy_clicked()
+{
+    if (!m_model || !m_process || m_exportWatcher.isRunning())
+        return;
+    m_model->append(MessageLevel::Launcher, QString("Clipboard copy at: %1").arg(QDateTime::currentDateTime().toString(Qt::RFC2822Date)));
+    m_export = Export::Copy;
+    m_exportWatcher.setFuture(
+        WorkerPool::instance().run([reader = m_process->getLogArchive()->reader()]() mutable { return completeLog(reader); }));
+}
+
+void LogPage::logExported()
+{
+    if (m_exportWatcher.isCanceled() || !m_model)
+        return;
+    auto text = QString::fromUtf8(m_exportWatcher.result());
+
+    if (m_export == Export::Copy) {
+        GuiUtil::setClipboardText(text);
+        return;
+    }
+    auto url = GuiUtil::uploadPaste(tr("Minecraft Log"), text, this);
+    if (!m_model)
+        return;
     if (!url.has_value()) {
         m_model->append(MessageLevel::Error, QString("Log upload canceled"));
     } else if (url->isNull()) {
@@ -255,24 +314,58 @@ void LogPage::on_btnPaste_clicked()
     }
 }
 
-void LogPage::on_btnCopy_clicked()
+void LogPage::on_btnSave_clicked()
+{
+    if (!m_model || !m_process || m_saveWatcher.isRunning())
+        return;
+
+    auto name = FS::RemoveInvalidFilenameChars(m_instance->name());
+    auto fileName = QFileDialog::getSaveFileName(this, tr("Save Log"), FS::PathCombine(QDir::homePath(), name + ".log"),
+                                                 tr("Log files") + " (*.log *.txt)");
+    if (fileName.isEmpty() || !m_model || !m_process)
+        return;
+
+    // the complete log can be much larger than what is shown, so it goes straight from the archive to the file
+    m_saveFileName = fileName;
+    m_saveWatcher.setFuture(WorkerPool::instance().run([reader = m_process->getLogArchive()->reader(), fileName]() mutable {
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly) && reader.writeTo(&file) && file.commit())
+            return true;
+        qCritical() << "Failed to save log to" << fileName << ":" << file.errorString();
+        return false;
+    }));
+}
+
+void LogPage::logSaved()
 {
     if (!m_model)
         return;
-    m_model->append(MessageLevel::Launcher, QString("Clipboard copy at: %1").arg(QDateTime::currentDateTime().toString(Qt::RFC2822Date)));
-    GuiUtil::setClipboardText(m_model->toPlainText());
+    if (m_saveWatcher.isCanceled() || !m_saveWatcher.result()) {
+        m_model->append(MessageLevel::Error, QString("Failed to save log to: %1").arg(m_saveFileName));
+        return;
+    }
+    m_model->append(MessageLevel::Launcher, QString("Log saved to: %1").arg(m_saveFileName));
 }
 
 void LogPage::on_btnClear_clicked()
 {
     if (!m_model)
         return;
+    if (m_archiveFirst >= 0)
+        showLive(false);
     m_model->clear();
     m_container->refreshContainer();
 }
 
 void LogPage::on_btnBottom_clicked()
 {
+    if (m_archiveFirst >= 0) {
+        showLive(false);
+        return;
+    }
+    // a page that is still being read would take the view away again
+    m_archiveGeneration++;
+    m_nextPage.reset();
     ui->text->scrollToBottom();
 }
 
@@ -291,21 +384,257 @@ void LogPage::on_wrapCheckbox_clicked(bool checked)
     m_model->setLineWrap(checked);
 }
 
+bool LogPage::hiddenLines(qint64& beforeEnd, qint64& afterFirst, qint64& total)
+{
+    if (!m_process || !m_model)
+        return false;
+    // the lines waiting for the next update are about to be shown
+    m_model->flush();
+    total = m_process->getLogArchive()->lineCount();
+
+    // the live log misses whatever scrolled out of it or got cleared before its first row, and whatever came after it
+    // stopped at the line limit (or stopped following the game) after its last one
+    m_model->archiveRange(beforeEnd, afterFirst);
+    if (beforeEnd < 0)
+        beforeEnd = afterFirst = total;
+    return beforeEnd > 0 || afterFirst < total;
+}
+
+void LogPage::showArchive(bool after, qint64 first, qint64 line, const QString& highlight)
+{
+    qint64 beforeEnd, afterFirst, total;
+    if (!hiddenLines(beforeEnd, afterFirst, total))
+        return;
+    qint64 rangeFirst = after ? afterFirst : 0;
+    qint64 rangeEnd = after ? total : beforeEnd;
+    if (rangeFirst >= rangeEnd)
+        return;
+
+    first = qBound(rangeFirst, first, qMax(rangeFirst, rangeEnd - 2 * s_archivePageLines));
+    ArchivePage page{ m_archiveGeneration, after, first, static_cast<int>(qMin<qint64>(2 * s_archivePageLines, rangeEnd - first)), line,
+                      highlight };
+    if (m_pageWatcher.isRunning()) {
+        m_nextPage = page;
+        return;
+    }
+    // only reads the segments these are in
+    m_pageWatcher.setFuture(WorkerPool::instance().run([page, reader = m_process->getLogArchive()->reader()]() mutable {
+        page.lines = reader.lines(page.first, page.count);
+        page.total = reader.lineCount();
+        return page;
+    }));
+}
+
+void LogPage::archivePageRead()
+{
+    // whatever got asked for last wins
+    if (m_nextPage) {
+        auto next = *m_nextPage;
+        m_nextPage.reset();
+        showArchive(next.after, next.first, next.line, next.highlight);
+        return;
+    }
+    if (m_pageWatcher.isCanceled())
+        return;
+    auto page = m_pageWatcher.result();
+    if (page.generation != m_archiveGeneration || !m_model)
+        return;
+
+    if (!m_archiveModel) {
+        m_archiveModel = makeShared<LogModel>();
+        m_archiveModel->setMaxLines(2 * s_archivePageLines);
+    }
+    m_archiveModel->clear();
+    m_archiveModel->append(page.lines, page.first);
+    m_archiveModel->flush();
+    m_archiveFirst = page.first;
+    m_archiveAfter = page.after;
+    if (m_proxy->sourceModel() != m_archiveModel.get())
+        m_proxy->setSourceModel(m_archiveModel.get());
+
+    ui->archiveLabel->setText(tr("Showing lines %1 to %2 of %3 from the complete log, which aren't in the live log. "
+                                 "Scroll past them or use Bottom to go back.")
+                                  .arg(page.first + 1)
+                                  .arg(page.first + page.lines.size())
+                                  .arg(page.total));
+    ui->archiveLabel->show();
+
+    // after the view is done filling itself (and scrolling to the bottom)
+    QMetaObject::invokeMethod(
+        this,
+        [this, row = static_cast<int>(page.line - page.first), highlight = page.highlight] {
+            ui->text->scrollToLine(row);
+            if (!highlight.isEmpty())
+                ui->text->findNext(highlight, false);
+        },
+        Qt::QueuedConnection);
+}
+
+void LogPage::showLive(bool atTop, const QString& highlight, bool reverse)
+{
+    // pages still being read are of no use anymore
+    m_archiveGeneration++;
+    m_nextPage.reset();
+    if (m_archiveFirst < 0)
+        return;
+    m_archiveFirst = -1;
+    m_proxy->setSourceModel(m_model.get());
+    m_archiveModel.reset();
+    ui->archiveLabel->hide();
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, atTop, highlight, reverse] {
+            if (atTop)
+                ui->text->scrollToLine(0);
+            else
+                ui->text->scrollToBottom();
+            ui->text->moveCursor(atTop ? QTextCursor::Start : QTextCursor::End);
+            if (!highlight.isEmpty())
+                ui->text->findNext(highlight, reverse);
+        },
+        Qt::QueuedConnection);
+}
+
+void LogPage::onScrollAction(int action)
+{
+    auto* bar = ui->text->verticalScrollBar();
+    bool up = false, down = false;
+    switch (action) {
+        case QAbstractSlider::SliderSingleStepSub:
+        case QAbstractSlider::SliderPageStepSub:
+        case QAbstractSlider::SliderToMinimum:
+            up = true;
+            break;
+        case QAbstractSlider::SliderSingleStepAdd:
+        case QAbstractSlider::SliderPageStepAdd:
+        case QAbstractSlider::SliderToMaximum:
+            down = true;
+            break;
+        case QAbstractSlider::SliderMove:
+            // the mouse wheel, which has no direction once it's at either end
+            up = bar->maximum() > bar->minimum() && bar->sliderPosition() <= bar->minimum();
+            down = bar->maximum() > bar->minimum() && bar->sliderPosition() >= bar->maximum();
+            break;
+        default:
+            return;
+    }
+    // only once there's nothing more to scroll to
+    up = up && bar->sliderPosition() <= bar->minimum();
+    down = down && bar->sliderPosition() >= bar->maximum();
+    if (!up && !down)
+        return;
+
+    // not while the scroll bar is busy with this action
+    QMetaObject::invokeMethod(
+        this,
+        [this, up] {
+            qint64 beforeEnd, afterFirst, total;
+            if (!hiddenLines(beforeEnd, afterFirst, total))
+                return;
+
+            if (m_archiveFirst < 0) {
+                if (up && beforeEnd > 0)
+                    showArchive(false, beforeEnd - 2 * s_archivePageLines, beforeEnd - 1);
+                else if (!up && afterFirst < total)
+                    showArchive(true, afterFirst, afterFirst);
+                return;
+            }
+
+            qint64 rangeFirst = m_archiveAfter ? afterFirst : 0;
+            qint64 rangeEnd = m_archiveAfter ? total : beforeEnd;
+            qint64 shownEnd = m_archiveFirst + m_archiveModel->rowCount();
+            if (up && m_archiveFirst > rangeFirst)
+                showArchive(m_archiveAfter, m_archiveFirst - s_archivePageLines, m_archiveFirst - 1);
+            else if (!up && shownEnd < rangeEnd)
+                showArchive(m_archiveAfter, m_archiveFirst + s_archivePageLines, shownEnd);
+            else if (up == m_archiveAfter)
+                // ran into the live log
+                showLive(!up);
+        },
+        Qt::QueuedConnection);
+}
+
+void LogPage::findNext(bool reverse)
+{
+    auto text = ui->searchBar->text();
+    if (ui->text->findNext(text, reverse) || text.isEmpty() || m_findWatcher.isRunning())
+        return;
+
+    // not in what is shown, but it could be in the lines that aren't in the live log
+    qint64 beforeEnd, afterFirst, total;
+    if (!hiddenLines(beforeEnd, afterFirst, total))
+        return;
+
+    // where to look, in turn: [from, first, end)
+    struct Search {
+        qint64 from, first, end;
+        bool after;
+    };
+    QVector<Search> searches;
+    if (m_archiveFirst >= 0) {
+        qint64 rangeFirst = m_archiveAfter ? afterFirst : 0;
+        qint64 rangeEnd = m_archiveAfter ? total : beforeEnd;
+        qint64 from = reverse ? m_archiveFirst - 1 : m_archiveFirst + m_archiveModel->rowCount();
+        searches.append({ from, rangeFirst, rangeEnd, m_archiveAfter });
+    } else if (reverse) {
+        // backwards from the live log, and around from the end
+        searches.append({ beforeEnd - 1, 0, beforeEnd, false });
+        searches.append({ total - 1, afterFirst, total, true });
+    } else {
+        searches.append({ afterFirst, afterFirst, total, true });
+        searches.append({ 0, 0, beforeEnd, false });
+    }
+
+    // this goes through every segment of the complete log in the worst case
+    ArchiveMatch match{ m_archiveGeneration, text, reverse };
+    m_findWatcher.setFuture(WorkerPool::instance().run([match, searches, reader = m_process->getLogArchive()->reader()]() mutable {
+        for (const auto& search : searches) {
+            if (search.from < search.first || search.from >= search.end)
+                continue;
+            // the first match in the direction of the search, so one outside of the range means there's none in it
+            auto line = reader.find(match.text, search.from, match.reverse);
+            if (line >= search.first && line < search.end) {
+                match.line = line;
+                match.after = search.after;
+                break;
+            }
+        }
+        return match;
+    }));
+}
+
+void LogPage::archiveSearched()
+{
+    if (m_findWatcher.isCanceled())
+        return;
+    auto match = m_findWatcher.result();
+    if (match.generation != m_archiveGeneration || !m_model)
+        return;
+
+    if (match.line >= 0) {
+        showArchive(match.after, match.line - s_archivePageLines, match.line, match.text);
+    } else {
+        // on to the live log then, from the start or the end of it
+        showLive(!match.reverse, match.text, match.reverse);
+    }
+}
+
 void LogPage::on_findButton_clicked()
 {
     auto modifiers = QApplication::keyboardModifiers();
     bool reverse = modifiers & Qt::ShiftModifier;
-    ui->text->findNext(ui->searchBar->text(), reverse);
+    findNext(reverse);
 }
 
 void LogPage::findNextActivated()
 {
-    ui->text->findNext(ui->searchBar->text(), false);
+    findNext(false);
 }
 
 void LogPage::findPreviousActivated()
 {
-    ui->text->findNext(ui->searchBar->text(), true);
+    findNext(true);
 }
 
 void LogPage::findActivated()
@@ -35,7 +35,9 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QWidget>
+#include <optional>
 
 #include <Application.h>
 #include "BaseInstance.h"
@@ -65,6 +67,7 @@ class LogPage : public QWidget, public BasePage {
    private slots:
     void on_btnPaste_clicked();
     void on_btnCopy_clicked();
+    void on_btnSave_clicked();
     void on_btnClear_clicked();
     void on_btnBottom_clicked();
 
@@ -82,6 +85,44 @@ class LogPage : public QWidget, public BasePage {
     void modelStateToUI();
     void UIToModelState();
     void setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc, bool initial);
+    void findNext(bool reverse);
+
+    /* The lines of the complete log that aren't in the live log model: [0, beforeEnd) and [afterFirst, total).
+     * False if there are none. */
+    bool hiddenLines(qint64& beforeEnd, qint64& afterFirst, qint64& total);
+    /* Shows a page of the hidden lines before (or after) the live log starting at `first`, with `line` scrolled into
+     * view (and `highlight` found in it). The page is read on a worker thread, and shown once it's there. */
+    void showArchive(bool after, qint64 first, qint64 line, const QString& highlight = QString());
+    /* Goes back to the live log, with the cursor at the top or the bottom of it. */
+    void showLive(bool atTop, const QString& highlight = QString(), bool reverse = false);
+    void onScrollAction(int action);
+
+    void archivePageRead();
+    void archiveSearched();
+    void logSaved();
+    void logExported();
+
+   private /* types */:
+    struct ArchivePage {
+        int generation;
+        bool after;
+        qint64 first;
+        int count;
+        qint64 line;
+        QString highlight;
+        // filled in by the worker
+        QVector<LogModel::Line> lines;
+        qint64 total = 0;
+    };
+    struct ArchiveMatch {
+        int generation;
+        QString text;
+        bool reverse;
+        // filled in by the worker, -1 if there's none
+        qint64 line = -1;
+        bool after = false;
+    };
+    enum class Export { Copy, Paste };
 
    private:
     Ui::LogPage* ui;
@@ -90,4 +131,23 @@ class LogPage : public QWidget, public BasePage {
 
     LogFormatProxyModel* m_proxy;
     shared_qobject_ptr<LogModel> m_model;
+
+    // a page of the complete log, for looking at the lines the live log model doesn't have
+    shared_qobject_ptr<LogModel> m_archiveModel;
+    // first line of the complete log in m_archiveModel, -1 while showing the live log
+    qint64 m_archiveFirst = -1;
+    // whether m_archiveModel has lines from after the live log, or from before it
+    bool m_archiveAfter = false;
+    // bumped whenever what's shown changes in a way that makes pages and matches still being read useless
+    int m_archiveGeneration = 0;
+
+    // the complete log is read on worker threads, see LogArchive::Reader
+    QFutureWatcher<ArchivePage> m_pageWatcher;
+    // the page to read once the one being read is done
+    std::optional<ArchivePage> m_nextPage;
+    QFutureWatcher<ArchiveMatch> m_findWatcher;
+    QFutureWatcher<bool> m_saveWatcher;
+    QString m_saveFileName;
+    QFutureWatcher<QByteArray> m_exportWatcher;
+    Export m_export = Export::Copy;
 };
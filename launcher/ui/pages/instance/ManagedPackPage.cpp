@@ -258,6 +258,7 @@ void ModrinthManagedPackPage::parseManagedPack()
         m_fetch_job->abort();
 
     m_fetch_job.reset(new NetJob(QString("Modrinth::PackVersions(%1)").arg(m_inst->getManagedPackName()), APPLICATION->network()));
+    m_fetch_job->setPriority(Net::Scheduler::Priority::Interactive);
     auto response = std::make_shared<QByteArray>();
 
     QString id = m_inst->getManagedPackID();
@@ -433,6 +434,7 @@ void FlameManagedPackPage::parseManagedPack()
         m_fetch_job->abort();
 
     m_fetch_job.reset(new NetJob(QString("Flame::PackVersions(%1)").arg(m_inst->getManagedPackName()), APPLICATION->network()));
+    m_fetch_job->setPriority(Net::Scheduler::Priority::Interactive);
     auto response = std::make_shared<QByteArray>();
 
     QString id = m_inst->getManagedPackID();
@@ -323,6 +323,7 @@ std::optional<QIcon> ResourceModel::getIcon(QModelIndex& index, const QUrl& url)
 
     if (!m_current_icon_job) {
         m_current_icon_job.reset(new NetJob("IconJob", APPLICATION->network()));
+        m_current_icon_job->setPriority(Net::Scheduler::Priority::Interactive);
         m_current_icon_job->setAskRetry(false);
     }
 
@@ -111,6 +111,7 @@ void ListModel::requestLogo(QString logo, QString url)
 
     MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry("FlamePacks", QString("logos/%1").arg(logo));
     auto job = new NetJob(QString("Flame Icon Download %1").arg(logo), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
     job->addNetAction(Net::ApiDownload::makeCached(QUrl(url), entry));
 
@@ -188,6 +189,7 @@ void ListModel::performPaginatedSearch()
     sort.index = currentSort + 1;
 
     auto netJob = makeShared<NetJob>("Flame::Search", APPLICATION->network());
+    netJob->setPriority(Net::Scheduler::Priority::Interactive);
     auto searchUrl = FlameAPI().getSearchURL({ ModPlatform::ResourceType::MODPACK, nextSearchOffset, currentSearchTerm, sort,
                                                m_filter->loaders, m_filter->versions, "", m_filter->categoryIds });
 
@@ -171,6 +171,7 @@ void FlamePage::onSelectionChanged(QModelIndex curr, [[maybe_unused]] QModelInde
     if (!current.versionsLoaded || m_filterWidget->changed()) {
         qDebug() << "Loading flame modpack versions";
         auto netJob = new NetJob(QString("Flame::PackVersions(%1)").arg(current.name), APPLICATION->network());
+        netJob->setPriority(Net::Scheduler::Priority::Interactive);
         auto response = std::make_shared<QByteArray>();
         int addonId = current.addonId;
         netJob->addNetAction(
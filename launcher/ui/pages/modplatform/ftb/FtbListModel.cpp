@@ -146,6 +146,7 @@ void ListModel::requestFailed(QString reason)
 void ListModel::requestPack()
 {
     auto netJob = makeShared<NetJob>("Ftb::Search", APPLICATION->network());
+    netJob->setPriority(Net::Scheduler::Priority::Interactive);
     auto searchUrl = QString(BuildConfig.MODPACKSCH_API_BASE_URL + "public/modpack/%1").arg(currentPack);
     netJob->addNetAction(Net::Download::makeByteArray(QUrl(searchUrl), response));
     jobPtr = netJob;
@@ -262,6 +263,7 @@ void ListModel::requestLogo(QString logo, QString url)
     bool stale = entry->isStale();
 
     auto job = makeShared<NetJob>(QString("ModpacksCH Icon Download %1").arg(logo), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->addNetAction(Net::Download::makeCached(QUrl(url), entry));
 
     auto fullPath = entry->getFullPath();
@@ -158,6 +158,7 @@ void ModpackListModel::performPaginatedSearch()
                                                   m_filter->loaders, m_filter->versions, "", m_filter->categoryIds });
 
     auto netJob = makeShared<NetJob>("Modrinth::SearchModpack", APPLICATION->network());
+    netJob->setPriority(Net::Scheduler::Priority::Interactive);
     netJob->addNetAction(Net::ApiDownload::makeByteArray(QUrl(searchUrl.value()), m_allResponse));
 
     QObject::connect(netJob.get(), &NetJob::succeeded, this, [this] {
@@ -251,6 +252,7 @@ void ModpackListModel::requestLogo(QString logo, QString url)
 
     MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry(m_parent->metaEntryBase(), QString("logos/%1").arg(logo));
     auto job = new NetJob(QString("%1 Icon Download %2").arg(m_parent->debugName()).arg(logo), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
     job->addNetAction(Net::ApiDownload::makeCached(QUrl(url), entry));
 
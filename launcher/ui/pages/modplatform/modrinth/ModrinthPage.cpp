@@ -157,6 +157,7 @@ void ModrinthPage::onSelectionChanged(QModelIndex curr, [[maybe_unused]] QModelI
         qDebug() << "Loading modrinth modpack information";
 
         auto netJob = new NetJob(QString("Modrinth::PackInformation(%1)").arg(current.name), APPLICATION->network());
+        netJob->setPriority(Net::Scheduler::Priority::Interactive);
         auto response = std::make_shared<QByteArray>();
 
         QString id = current.id;
@@ -207,6 +208,7 @@ void ModrinthPage::onSelectionChanged(QModelIndex curr, [[maybe_unused]] QModelI
         qDebug() << "Loading modrinth modpack versions";
 
         auto netJob = new NetJob(QString("Modrinth::PackVersions(%1)").arg(current.name), APPLICATION->network());
+        netJob->setPriority(Net::Scheduler::Priority::Interactive);
         auto response = std::make_shared<QByteArray>();
 
         QString id = current.id;
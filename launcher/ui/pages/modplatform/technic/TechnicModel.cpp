@@ -136,6 +136,7 @@ void Technic::ListModel::performSearch()
         return;
 
     auto netJob = makeShared<NetJob>("Technic::Search", APPLICATION->network());
+    netJob->setPriority(Net::Scheduler::Priority::Interactive);
     QString searchUrl = "";
     if (currentSearchTerm.isEmpty()) {
         searchUrl = QString("%1trending?build=%2").arg(BuildConfig.TECHNIC_API_BASE_URL, BuildConfig.TECHNIC_API_BUILD);
@@ -296,6 +297,7 @@ void Technic::ListModel::requestLogo(QString logo, QString url)
 
     MetaEntryPtr entry = APPLICATION->metacache()->resolveEntry("TechnicPacks", QString("logos/%1").arg(logo));
     auto job = new NetJob(QString("Technic Icon Download %1").arg(logo), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
     job->addNetAction(Net::ApiDownload::makeCached(QUrl(url), entry));
 
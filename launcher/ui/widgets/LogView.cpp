@@ -167,7 +167,14 @@ void LogView::scrollToBottom()
     verticalScrollBar()->setSliderPosition(verticalScrollBar()->maximum());
 }
 
-void LogView::findNext(const QString& what, bool reverse)
+void LogView::scrollToLine(int line)
 {
-    find(what, reverse ? QTextDocument::FindFlag::FindBackward : QTextDocument::FindFlag(0));
+    auto block = document()->findBlockByNumber(qBound(0, line, document()->blockCount() - 1));
+    setTextCursor(QTextCursor(block));
+    centerCursor();
+}
+
+bool LogView::findNext(const QString& what, bool reverse)
+{
+    return find(what, reverse ? QTextDocument::FindFlag::FindBackward : QTextDocument::FindFlag(0));
 }
@@ -15,8 +15,10 @@ class LogView : public QPlainTextEdit {
 
    public slots:
     void setWordWrap(bool wrapping);
-    void findNext(const QString& what, bool reverse);
+    bool findNext(const QString& what, bool reverse);
     void scrollToBottom();
+    /* Puts the cursor at the start of the given line and scrolls it into the middle of the view. */
+    void scrollToLine(int line);
 
    protected slots:
     void repopulate();
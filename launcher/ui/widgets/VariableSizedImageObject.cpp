@@ -140,6 +140,7 @@ void VariableSizedImageObject::loadImage(QTextDocument* doc, std::shared_ptr<Ima
         QString("images/%1").arg(QString(QCryptographicHash::hash(meta->url.toEncoded(), QCryptographicHash::Algorithm::Sha1).toHex())));
 
     auto job = new NetJob(QString("Load Image: %1").arg(meta->url.fileName()), APPLICATION->network());
+    job->setPriority(Net::Scheduler::Priority::Interactive);
     job->setAskRetry(false);
     job->addNetAction(Net::ApiDownload::makeCached(meta->url, entry));
 
@@ -2,12 +2,24 @@
 // MurmurHash2 was written by Austin Appleby, and is placed in the public
 // domain. The author hereby disclaims copyright to this source code.
 //
-// This was modified as to possibilitate it's usage incrementally.
+// This was modified to compute CurseForge fingerprints in a single pass over
+// an in-memory (usually memory-mapped) buffer.
 // Those modifications are also placed in the public domain, and the author of
 // such modifications hereby disclaims copyright to this source code.
 
 #include "MurmurHash2.h"
 
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MURMUR2_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define MURMUR2_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Murmur2 {
 
 // 'm' and 'r' are mixing constants generated offline.
@@ -15,94 +27,198 @@ namespace Murmur2 {
 const uint32_t m = 0x5bd1e995;
 const int r = 24;
 
-uint32_t hash(Reader* file_stream, std::size_t buffer_size, std::function<bool(char)> filter_out)
+static inline uint32_t mixBlock(uint32_t h, const unsigned char* bytes)
 {
-    auto* buffer = new char[buffer_size];
-    char data[4];
-
-    int read = 0;
-    uint32_t size = 0;
-
-    // We need the size without the filtered out characters before actually calculating the hash,
-    // to setup the initial value for the hash.
-    do {
-        read = file_stream->read(buffer, buffer_size);
-        for (int i = 0; i < read; i++) {
-            if (!filter_out(buffer[i]))
-                size += 1;
-        }
-    } while (!file_stream->eof());
+    uint32_t k;
+    std::memcpy(&k, bytes, sizeof(k));
+
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+
+    h *= m;
+    h ^= k;
+
+    return h;
+}
+
+static inline uint32_t mixTail(uint32_t h, const unsigned char* bytes, std::size_t len)
+{
+    // Handle the last few bytes of the input array
+    switch (len) {
+        case 3:
+            h ^= bytes[2] << 16;
+            /* fall through */
+        case 2:
+            h ^= bytes[1] << 8;
+            /* fall through */
+        case 1:
+            h ^= bytes[0];
+            h *= m;
+    };
+
+    // Do a few final mixes of the hash to ensure the last few
+    // bytes are well-incorporated.
+    h ^= h >> 13;
+    h *= m;
+    h ^= h >> 15;
+
+    return h;
+}
+
+uint32_t hash(const char* data, std::size_t len, uint32_t seed)
+{
+    // Initialize the hash to a 'random' value
+    uint32_t h = seed ^ static_cast<uint32_t>(len);
 
-    file_stream->goToBeginning();
+    auto* bytes = reinterpret_cast<const unsigned char*>(data);
 
-    int index = 0;
+    // Mix 4 bytes at a time into the hash
+    for (; len >= 4; bytes += 4, len -= 4)
+        h = mixBlock(h, bytes);
 
-    // This forces a seed of 1.
-    IncrementalHashInfo info{ (uint32_t)1 ^ size, (uint32_t)size };
-    do {
-        read = file_stream->read(buffer, buffer_size);
-        for (int i = 0; i < read; i++) {
-            char c = buffer[i];
+    return mixTail(h, bytes, len);
+}
 
-            if (filter_out(c))
-                continue;
+static inline bool isWhitespace(unsigned char c)
+{
+    return c == 9 || c == 10 || c == 13 || c == 32;
+}
 
-            data[index] = c;
-            index = (index + 1) % 4;
+// Branchless compaction of a short run of bytes. Every byte is written, but the output cursor only
+// advances past the ones we keep, so whitespace gets overwritten by whatever comes next.
+// Since `o <= i` at all times this is also safe when `in == out`.
+static inline std::size_t stripScalar(const unsigned char* in, std::size_t len, unsigned char* out)
+{
+    std::size_t o = 0;
+    for (std::size_t i = 0; i < len; i++) {
+        auto c = in[i];
+        out[o] = c;
+        o += !isWhitespace(c);
+    }
+    return o;
+}
 
-            // Mix 4 bytes at a time into the hash
-            if (index == 0)
-                FourBytes_MurmurHash2(reinterpret_cast<unsigned char*>(&data), info);
+std::size_t stripWhitespace(const char* in_chars, std::size_t len, char* out_chars)
+{
+    auto* in = reinterpret_cast<const unsigned char*>(in_chars);
+    auto* out = reinterpret_cast<unsigned char*>(out_chars);
+
+    std::size_t i = 0;
+    std::size_t o = 0;
+
+#if defined(MURMUR2_SSE2)
+    const __m128i tab = _mm_set1_epi8(9);
+    const __m128i lf = _mm_set1_epi8(10);
+    const __m128i cr = _mm_set1_epi8(13);
+    const __m128i space = _mm_set1_epi8(32);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, lf)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, space)));
+
+        // Jars are mostly deflated data, so most blocks don't contain any whitespace at all.
+        // The store only touches bytes at or before the block we just loaded, so this works in place too.
+        if (_mm_movemask_epi8(ws) == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), v);
+            o += 16;
+        } else {
+            o += stripScalar(in + i, 16, out + o);
         }
-    } while (!file_stream->eof());
+    }
+#elif defined(MURMUR2_NEON)
+    const uint8x16_t tab = vdupq_n_u8(9);
+    const uint8x16_t lf = vdupq_n_u8(10);
+    const uint8x16_t cr = vdupq_n_u8(13);
+    const uint8x16_t space = vdupq_n_u8(32);
+
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8(in + i);
+        uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(v, tab), vceqq_u8(v, lf)), vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, space)));
+
+        if (vmaxvq_u8(ws) == 0) {
+            vst1q_u8(out + o, v);
+            o += 16;
+        } else {
+            o += stripScalar(in + i, 16, out + o);
+        }
+    }
+#endif
 
-    // Do one last bit shuffle in the hash
-    FourBytes_MurmurHash2(reinterpret_cast<unsigned char*>(&data), info);
+    o += stripScalar(in + i, len - i, out + o);
+    return o;
+}
+
+uint32_t fingerprint(const char* data, std::size_t len)
+{
+    // the seed needs the stripped length, and a count is cheaper than compacting everything into a copy of `data`.
+    // the actual hashing then goes through the fixed scratch buffer of the Fingerprinter
+    Fingerprinter fingerprinter(countNonWhitespace(data, len));
+    fingerprinter.update(data, len);
+    return fingerprinter.finish();
+}
+
+uint32_t fingerprintInPlace(char* data, std::size_t len)
+{
+    auto packed_len = stripWhitespace(data, len, data);
+    return hash(data, packed_len);
+}
+
+std::size_t countNonWhitespace(const char* data, std::size_t len)
+{
+    auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    // simple enough for the compiler to vectorize on its own
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < len; i++)
+        count += !isWhitespace(bytes[i]);
+    return count;
+}
 
-    delete[] buffer;
+static const std::size_t s_scratch_size = 64 * 1024;
 
-    return info.h;
+Fingerprinter::Fingerprinter(uint64_t packed_len, uint32_t seed)
+    : m_h(seed ^ static_cast<uint32_t>(packed_len)), m_scratch(new char[s_scratch_size])
+{}
+
+void Fingerprinter::update(const char* data, std::size_t len)
+{
+    while (len > 0) {
+        auto chunk = len < s_scratch_size ? len : s_scratch_size;
+        auto packed_len = stripWhitespace(data, chunk, m_scratch.get());
+        mix(reinterpret_cast<const unsigned char*>(m_scratch.get()), packed_len);
+
+        data += chunk;
+        len -= chunk;
+    }
 }
 
-void FourBytes_MurmurHash2(const unsigned char* data, IncrementalHashInfo& prev)
+void Fingerprinter::mix(const unsigned char* bytes, std::size_t len)
 {
-    if (prev.len >= 4) {
-        // Not the final mix
-        uint32_t k = *reinterpret_cast<const uint32_t*>(data);
-
-        k *= m;
-        k ^= k >> r;
-        k *= m;
-
-        prev.h *= m;
-        prev.h ^= k;
-
-        prev.len -= 4;
-    } else {
-        // The final mix
-
-        // Handle the last few bytes of the input array
-        switch (prev.len) {
-            case 3:
-                prev.h ^= data[2] << 16;
-                /* fall through */
-            case 2:
-                prev.h ^= data[1] << 8;
-                /* fall through */
-            case 1:
-                prev.h ^= data[0];
-                prev.h *= m;
-        };
-
-        // Do a few final mixes of the hash to ensure the last few
-        // bytes are well-incorporated.
-
-        prev.h ^= prev.h >> 13;
-        prev.h *= m;
-        prev.h ^= prev.h >> 15;
-
-        prev.len = 0;
+    // complete a block left over from the previous chunk first
+    if (m_tail_len > 0) {
+        while (m_tail_len < 4 && len > 0) {
+            m_tail[m_tail_len++] = *bytes++;
+            len--;
+        }
+        if (m_tail_len < 4)
+            return;
+
+        m_h = mixBlock(m_h, m_tail);
+        m_tail_len = 0;
     }
+
+    for (; len >= 4; bytes += 4, len -= 4)
+        m_h = mixBlock(m_h, bytes);
+
+    std::memcpy(m_tail, bytes, len);
+    m_tail_len = len;
+}
+
+uint32_t Fingerprinter::finish()
+{
+    return mixTail(m_h, m_tail, m_tail_len);
 }
 
-}  // namespace Murmur2
\ No newline at end of file
+}  // namespace Murmur2
@@ -2,34 +2,54 @@
 // The original MurmurHash2 was written by Austin Appleby, and is placed in the
 // public domain. The author hereby disclaims copyright to this source code.
 //
-// This was modified as to possibilitate it's usage incrementally.
+// This was modified to compute CurseForge fingerprints in a single pass over
+// an in-memory (usually memory-mapped) buffer.
 // Those modifications are also placed in the public domain, and the author of
 // such modifications hereby disclaims copyright to this source code.
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <functional>
+#include <memory>
 
 namespace Murmur2 {
 
-#define KiB 1024
-#define MiB 1024 * KiB
+// Plain MurmurHash2 (32-bit) over a contiguous buffer.
+uint32_t hash(const char* data, std::size_t len, uint32_t seed = 1);
 
-class Reader {
+// Copies every byte of `in` that is not CurseForge whitespace (\t, \n, \r, space) to `out`,
+// returning the number of bytes written. `out` must hold at least `len` bytes, and may be equal to `in`.
+// Uses SSE2 / NEON when the build targets them, with a scalar fallback otherwise.
+std::size_t stripWhitespace(const char* in, std::size_t len, char* out);
+
+// The CurseForge fingerprint: MurmurHash2 with a seed of 1 over the data with whitespace removed.
+// `data` is left untouched, and only a small fixed-size scratch buffer is allocated.
+uint32_t fingerprint(const char* data, std::size_t len);
+
+// Same as fingerprint(), but compacts `data` in place instead of allocating a scratch buffer.
+uint32_t fingerprintInPlace(char* data, std::size_t len);
+
+// Number of bytes of `data` that are not CurseForge whitespace, i.e. what stripWhitespace() would return.
+std::size_t countNonWhitespace(const char* data, std::size_t len);
+
+// Streaming CurseForge fingerprint, for when the data doesn't fit in memory at once.
+// MurmurHash2 is seeded with the data length, so the whitespace-stripped length has to be known up front
+// (see countNonWhitespace()). Chunks can be of any size.
+class Fingerprinter {
    public:
-    virtual ~Reader() = default;
-    virtual int read(char* s, int n) = 0;
-    virtual bool eof() = 0;
-    virtual void goToBeginning() = 0;
-};
+    explicit Fingerprinter(uint64_t packed_len, uint32_t seed = 1);
+
+    void update(const char* data, std::size_t len);
+    uint32_t finish();
 
-uint32_t hash(Reader* file_stream, std::size_t buffer_size = 4 * MiB, std::function<bool(char)> filter_out = [](char) { return false; });
+   private:
+    void mix(const unsigned char* data, std::size_t len);
 
-struct IncrementalHashInfo {
-    uint32_t h;
-    uint32_t len;
+    uint32_t m_h;
+    unsigned char m_tail[4];
+    std::size_t m_tail_len = 0;
+    std::unique_ptr<char[]> m_scratch;
 };
 
-void FourBytes_MurmurHash2(const unsigned char* data, IncrementalHashInfo& prev);
 }  // namespace Murmur2
@@ -15,6 +15,7 @@
   self,
   stripJavaArchivesHook,
   tomlplusplus,
+  xz,
   zlib,
   msaClientID ? null,
   gamemodeSupport ? stdenv.hostPlatform.isLinux,
@@ -61,6 +62,7 @@ stdenv.mkDerivation {
       kdePackages.qtnetworkauth
       kdePackages.quazip
       tomlplusplus
+      xz
       zlib
     ]
     ++ lib.optionals stdenv.hostPlatform.isDarwin [ apple-sdk_11 ]
@@ -0,0 +1,114 @@
+#include <QDateTime>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <minecraft/AssetsUtils.h>
+#include <modplatform/helpers/HashCache.h>
+
+class AssetsUtilsTest : public QObject {
+    Q_OBJECT
+
+    AssetObjectCheck makeObject(const QString& dir, const QByteArray& data)
+    {
+        auto hash = Hashing::hash(data, Hashing::Algorithm::Sha1);
+        return { FS::PathCombine(dir, hash.left(2), hash), hash, data.size() };
+    }
+
+    // like a download does it, through a temporary file that replaces the object
+    void download(const AssetObjectCheck& object, const QByteArray& data)
+    {
+        QSaveFile file(object.path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        QVERIFY(file.commit());
+        age(object.path, 600);
+    }
+
+    // as if it was written a while ago, the journal doesn't trust files that were changed right before it looked
+    static void age(const QString& path, qint64 secs = 3600)
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(-secs), QFileDevice::FileModificationTime));
+    }
+
+    static void write(const QString& path, const QByteArray& data)
+    {
+        FS::write(path, data);
+        age(path);
+    }
+
+   private slots:
+    void test_Verify()
+    {
+        QTemporaryDir tempDir;
+        Hashing::HashCache journal;
+        auto object = makeObject(tempDir.path(), "a sound");
+
+        // not there yet
+        QVERIFY(AssetsUtils::needsDownload(object, journal));
+        QVERIFY(!AssetsUtils::verifyObject(object, journal));
+
+        QVERIFY(FS::ensureFilePathExists(object.path));
+        write(object.path, "a sound");
+        QVERIFY(!AssetsUtils::needsDownload(object, journal));
+        QVERIFY(AssetsUtils::verifyObject(object, journal));
+        QCOMPARE(journal.get(object.path, Hashing::Algorithm::Sha1), object.hash);
+        // hashed just now, so it's only stat'ed for a good while
+        QVERIFY(journal.verifiedAt(Hashing::FileIdentity::of(object.path)) >= QDateTime::currentSecsSinceEpoch() - 60);
+
+        // the wrong size is caught without hashing
+        write(object.path, "a longer sound");
+        QVERIFY(AssetsUtils::needsDownload(object, journal));
+        QVERIFY(!AssetsUtils::verifyObject(object, journal));
+    }
+
+    void test_Journal()
+    {
+        QTemporaryDir tempDir;
+        Hashing::HashCache journal;
+        auto object = makeObject(tempDir.path(), "a sound");
+        QVERIFY(FS::ensureFilePathExists(object.path));
+        write(object.path, "a noise");
+
+        // same size, so only hashing it tells it apart
+        QVERIFY(!AssetsUtils::needsDownload(object, journal));
+        QVERIFY(!AssetsUtils::verifyObject(object, journal));
+        // but it's recorded, so the next update downloads it
+        QVERIFY(!journal.get(object.path, Hashing::Algorithm::Sha1).isEmpty());
+        QVERIFY(AssetsUtils::needsDownload(object, journal));
+        // and it's left in place, the store is shared
+        QVERIFY(QFile::exists(object.path));
+    }
+
+    void test_Redownload()
+    {
+        QTemporaryDir tempDir;
+        Hashing::HashCache journal;
+        auto object = makeObject(tempDir.path(), "a sound");
+        QVERIFY(FS::ensureFilePathExists(object.path));
+        write(object.path, "a noise");
+        QVERIFY(!AssetsUtils::verifyObject(object, journal));
+        QVERIFY(AssetsUtils::needsDownload(object, journal));
+
+        download(object, "a sound");
+        AssetsUtils::recordDownloadedObject(object, journal);
+        QCOMPARE(journal.get(object.path, Hashing::Algorithm::Sha1), object.hash);
+        QVERIFY(!AssetsUtils::needsDownload(object, journal));
+        QVERIFY(AssetsUtils::verifyObject(object, journal));
+
+        // a broken download isn't recorded as good
+        auto other = makeObject(tempDir.path(), "another sound");
+        QVERIFY(FS::ensureFilePathExists(other.path));
+        write(other.path, "short");
+        AssetsUtils::recordDownloadedObject(other, journal);
+        QVERIFY(journal.get(other.path, Hashing::Algorithm::Sha1).isEmpty());
+        QVERIFY(AssetsUtils::needsDownload(other, journal));
+    }
+};
+
+QTEST_GUILESS_MAIN(AssetsUtilsTest)
+
+#include "AssetsUtils_test.moc"
@@ -0,0 +1,287 @@
+#include <QEventLoop>
+#include <QSemaphore>
+#include <QTest>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <tasks/ConcurrentTask.h>
+#include <tasks/Task.h>
+#include <tasks/WorkerPool.h>
+
+#include <atomic>
+#include <functional>
+#include <numeric>
+
+/* Succeeds right away, after calling back whoever wants to know it ran. */
+class CallbackTask : public Task {
+    Q_OBJECT
+   public:
+    explicit CallbackTask(std::function<void()> callback = {}) : Task(false), m_callback(std::move(callback)) {}
+
+   private:
+    void executeTask() override
+    {
+        if (m_callback)
+            m_callback();
+        emitSucceeded();
+    }
+
+    std::function<void()> m_callback;
+};
+
+/* Reports a lot of progress at once, then takes a while to finish. */
+class ChattyTask : public Task {
+    Q_OBJECT
+   public:
+    ChattyTask() : Task(false) {}
+
+   private:
+    void executeTask() override
+    {
+        for (int i = 1; i <= 1000; i++) {
+            setProgress(i, 1000);
+            setDetails(QString::number(i));
+        }
+        QTimer::singleShot(3 * s_progressInterval, this, &ChattyTask::emitSucceeded);
+    }
+};
+
+class CallbackRunnable : public QRunnable {
+   public:
+    explicit CallbackRunnable(QSemaphore* done) : m_done(done) {}
+    void run() override { m_done->release(); }
+
+   private:
+    QSemaphore* m_done;
+};
+
+static const int s_benchmark_tasks = 100000;
+
+static bool runToCompletion(Task& task)
+{
+    QEventLoop loop;
+    QObject::connect(&task, &Task::finished, &loop, &QEventLoop::quit);
+    task.start();
+    if (task.isRunning())
+        loop.exec();
+    return task.wasSuccessful();
+}
+
+class ConcurrentTaskTest : public QObject {
+    Q_OBJECT
+   private slots:
+
+    void test_Priorities()
+    {
+        QStringList log;
+        auto logged = [&log](QString name) { return makeShared<CallbackTask>([&log, name] { log.append(name); }); };
+
+        ConcurrentTask task("", 1);
+        task.addTask(logged("low"), ConcurrentTask::Priority::Low);
+        task.addTask(logged("normal 1"));
+        task.addTask(logged("high"), ConcurrentTask::Priority::High);
+        task.addTask(logged("normal 2"), ConcurrentTask::Priority::Normal);
+
+        QVERIFY(runToCompletion(task));
+        QCOMPARE(log, QStringList({ "high", "normal 1", "normal 2", "low" }));
+    }
+
+    void test_FillsAllSlots()
+    {
+        ConcurrentTask task("", 8);
+        int most = 0;
+        for (int i = 0; i < 100; i++)
+            task.addTask(makeShared<CallbackTask>([&task, &most] { most = qMax(most, int(task.getStepProgress().size())); }));
+
+        QVERIFY(runToCompletion(task));
+        QCOMPARE(most, 8);
+        QCOMPARE(task.getProgress(), qint64(100));
+    }
+
+    void test_CoalescedStepProgress()
+    {
+        ConcurrentTask task;
+        task.addTask(makeShared<ChattyTask>());
+        task.addTask(makeShared<ChattyTask>());
+
+        QList<TaskStepProgress> reported;
+        connect(&task, &Task::stepProgress, this, [&reported](const TaskStepProgress& step) { reported.append(step); });
+
+        QVERIFY(runToCompletion(task));
+
+        // one report with the latest progress for each of them, and one when they finish
+        QCOMPARE(reported.size(), 4);
+        for (int i = 0; i < 2; i++) {
+            QCOMPARE(reported[i].state, TaskStepState::Running);
+            QCOMPARE(reported[i].current, qint64(1000));
+            QCOMPARE(reported[i].details, QString("1000"));
+        }
+        QCOMPARE(reported[2].state, TaskStepState::Succeeded);
+        QCOMPARE(reported[3].state, TaskStepState::Succeeded);
+    }
+
+    void test_Pool()
+    {
+        WorkerPool pool(4);
+        std::atomic<int> count{ 0 };
+        QSemaphore done;
+
+        // jobs that queue more jobs, which stay on the worker that queued them unless someone steals them
+        for (int i = 0; i < 64; i++) {
+            pool.start([&] {
+                for (int j = 0; j < 16; j++) {
+                    pool.start([&] {
+                        count++;
+                        done.release();
+                    });
+                }
+            });
+        }
+        QVERIFY(done.tryAcquire(64 * 16, 10000));
+        QCOMPARE(count.load(), 64 * 16);
+    }
+
+    void test_PoolPriorities()
+    {
+        WorkerPool pool(1);
+        QSemaphore blocked, done;
+        QStringList log;
+
+        // keep the only worker busy until everything is queued
+        pool.start([&] { blocked.acquire(); });
+        for (auto [name, priority] : { std::pair("low", WorkerPool::Priority::Low), std::pair("normal", WorkerPool::Priority::Normal),
+                                       std::pair("high", WorkerPool::Priority::High) }) {
+            pool.start(
+                [&log, &done, name = QString(name)] {
+                    log.append(name);
+                    done.release();
+                },
+                priority);
+        }
+        blocked.release();
+
+        QVERIFY(done.tryAcquire(3, 10000));
+        QCOMPARE(log, QStringList({ "high", "normal", "low" }));
+    }
+
+    void test_PoolFuture()
+    {
+        WorkerPool pool(1);
+        QSemaphore blocked;
+        bool ran = false;
+
+        auto answer = pool.run([] { return 42; });
+        answer.waitForFinished();
+        QCOMPARE(answer.result(), 42);
+
+        pool.start([&] { blocked.acquire(); });
+        auto skipped = pool.run([&ran] { ran = true; });
+        skipped.cancel();
+        blocked.release();
+        skipped.waitForFinished();
+
+        QVERIFY(skipped.isCanceled());
+        QVERIFY(!ran);
+    }
+
+    void test_PoolShutdown()
+    {
+        WorkerPool pool(1);
+        QSemaphore started;
+        std::atomic<bool> finished{ false };
+        std::atomic<int> ran{ 0 };
+
+        pool.start([&] {
+            started.release();
+            QThread::msleep(100);
+            finished = true;
+        });
+        pool.start([&] { ran++; });
+        auto dropped = pool.run([&] { ran++; });
+        started.acquire();
+
+        // the running job gets to finish, the others don't start anymore
+        pool.shutdown();
+        QVERIFY(finished);
+        pool.start([&] { ran++; });
+        QCOMPARE(ran.load(), 0);
+        QVERIFY(dropped.isFinished());
+        QVERIFY(dropped.isCanceled());
+
+        // the caller does the work itself then
+        QVector<int> items(100, 1);
+        pool.blockingMap(items, [](int& item) { item *= 2; });
+        QCOMPARE(items, QVector<int>(100, 2));
+    }
+
+    void test_PoolBlockingMap()
+    {
+        WorkerPool pool(2);
+        QVector<int> items(10000);
+        std::iota(items.begin(), items.end(), 0);
+        auto copy = items;
+
+        pool.blockingMap(items, [](int& item) { item *= 2; });
+        for (int i = 0; i < items.size(); i++)
+            QCOMPARE(items[i], 2 * i);
+        // the copy shares nothing with it anymore
+        QCOMPARE(copy[1], 1);
+
+        // from jobs on the pool, which would all wait on each other if they only waited
+        QSemaphore done;
+        std::atomic<int> sum{ 0 };
+        for (int i = 0; i < 4; i++) {
+            pool.start([&] {
+                QVector<int> nested(100, 1);
+                pool.blockingMap(nested, [&](int& item) { sum += item; });
+                done.release();
+            });
+        }
+        QVERIFY(done.tryAcquire(4, 10000));
+        QCOMPARE(sum.load(), 400);
+    }
+
+    // 100k subtasks that do nothing, so this is all scheduling and bookkeeping. to compare with another build (like the
+    // one before the coalesced dispatch), run `ConcurrentTask_test test_Benchmark` in both
+    void test_Benchmark()
+    {
+        QBENCHMARK_ONCE
+        {
+            ConcurrentTask task;
+            for (int i = 0; i < s_benchmark_tasks; i++)
+                task.addTask(makeShared<CallbackTask>());
+            QVERIFY(runToCompletion(task));
+        }
+    }
+
+    void test_PoolBenchmark_data()
+    {
+        QTest::addColumn<bool>("qt");
+        QTest::newRow("WorkerPool") << false;
+        QTest::newRow("QThreadPool") << true;
+    }
+
+    void test_PoolBenchmark()
+    {
+        QFETCH(bool, qt);
+        WorkerPool pool(QThread::idealThreadCount());
+        QThreadPool qtPool;
+        qtPool.setMaxThreadCount(QThread::idealThreadCount());
+
+        QBENCHMARK
+        {
+            QSemaphore done;
+            for (int i = 0; i < s_benchmark_tasks; i++) {
+                if (qt)
+                    qtPool.start(new CallbackRunnable(&done));
+                else
+                    pool.start([&done] { done.release(); });
+            }
+            done.acquire(s_benchmark_tasks);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(ConcurrentTaskTest)
+
+#include "ConcurrentTask_test.moc"
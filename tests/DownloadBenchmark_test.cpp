@@ -0,0 +1,218 @@
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+#include <random>
+
+#include <FileSystem.h>
+#include <net/ChecksumValidator.h>
+#include <net/Download.h>
+#include <net/HttpMetaCache.h>
+#include <net/NetJob.h>
+#include <net/Scheduler.h>
+
+#include "HttpTestServer.h"
+
+/*
+ * End to end download benchmarks against HttpTestServer, shaped like what the launcher fetches:
+ * thousands of small assets, a few dozen libraries, meta documents going through the HttpMetaCache,
+ * and a handful of large modpack files. Each row reports time to complete (as the benchmark result),
+ * throughput and how much the resident memory grew at its peak while downloading (Linux only).
+ *
+ * Slow, so only built with Launcher_BUILD_BENCHMARKS. CI runs them in the benchmark job of build.yml.
+ */
+class DownloadBenchmarkTest : public QObject {
+    Q_OBJECT
+
+    struct Fixture {
+        QString path;
+        QByteArray data;
+    };
+
+    static QByteArray randomData(qsizetype size, std::mt19937& eng)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (auto& c : data)
+            c = static_cast<char>(eng());
+        return data;
+    }
+
+    static QString sha1(const QByteArray& data) { return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex(); }
+
+    // a field of /proc/self/status in KiB, like VmRSS (resident now) or VmHWM (resident at the peak). -1 if we can't tell
+    static qint64 memoryKiB(const QByteArray& field)
+    {
+        QFile status("/proc/self/status");
+        if (!status.open(QIODevice::ReadOnly))
+            return -1;
+        for (const auto& line : status.readAll().split('\n')) {
+            if (line.startsWith(field + ':'))
+                return line.mid(field.size() + 1).trimmed().split(' ').value(0).toLongLong();
+        }
+        return -1;
+    }
+
+    // so VmHWM starts over from what is resident now, see proc(5)
+    static void resetPeakMemory()
+    {
+        QFile clearRefs("/proc/self/clear_refs");
+        if (clearRefs.open(QIODevice::WriteOnly))
+            clearRefs.write("5");
+    }
+
+    static QList<Fixture> fixtures(const QString& kind)
+    {
+        std::mt19937 eng(1234);
+        QList<Fixture> files;
+        if (kind == "assets") {
+            // like the objects of an asset index: lots of small files named after their hash
+            std::uniform_int_distribution<int> size(512, 16 * 1024);
+            for (int i = 0; i < 3000; i++) {
+                auto data = randomData(size(eng), eng);
+                auto hash = sha1(data);
+                files.append({ "assets/objects/" + hash.left(2) + "/" + hash, data });
+            }
+        } else if (kind == "libraries") {
+            std::uniform_int_distribution<int> size(256 * 1024, 3 * 1024 * 1024);
+            for (int i = 0; i < 24; i++)
+                files.append({ QString("libraries/org/example/lib%1/1.0/lib%1-1.0.jar").arg(i), randomData(size(eng), eng) });
+        } else if (kind.startsWith("meta")) {
+            for (int i = 0; i < 200; i++) {
+                QByteArray json = "{\"formatVersion\": 1, \"uid\": \"net.example." + QByteArray::number(i) + "\", \"versions\": [";
+                for (int v = 0; v < 50; v++)
+                    json += (v ? ", " : "") + QByteArray("{\"version\": \"1.") + QByteArray::number(v) + "\", \"sha256\": \"" +
+                            QCryptographicHash::hash(QByteArray::number(i * 100 + v), QCryptographicHash::Sha256).toHex() + "\"}";
+                json += "]}";
+                files.append({ QString("meta/net.example.%1/index.json").arg(i), json });
+            }
+        } else if (kind == "modpack") {
+            for (int i = 0; i < 4; i++)
+                files.append({ QString("packs/pack/files/%1.zip").arg(i), randomData(8 * 1024 * 1024, eng) });
+        }
+        return files;
+    }
+
+    static bool run(NetJob& job)
+    {
+        QSignalSpy finished(&job, &Task::finished);
+        QSignalSpy succeeded(&job, &Task::succeeded);
+        job.start();
+        if (finished.isEmpty() && !finished.wait(300000))
+            return false;
+        return !succeeded.isEmpty();
+    }
+
+    // `memory` in KiB, -1 if unknown
+    static void report(const QString& kind, qint64 ms, qint64 bytes, int files, qint64 memory)
+    {
+        QTest::setBenchmarkResult(ms, QTest::WalltimeMilliseconds);
+        auto seconds = qMax<qint64>(ms, 1) / 1000.0;
+        qInfo().noquote() << QString("%1: %2 files, %3 MiB in %4 ms, %5 MiB/s, %6 MiB more resident at the peak")
+                                 .arg(kind)
+                                 .arg(files)
+                                 .arg(bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                 .arg(ms)
+                                 .arg(bytes / (1024.0 * 1024.0) / seconds, 0, 'f', 1)
+                                 .arg(memory < 0 ? QString("?") : QString::number(memory / 1024.0, 'f', 1));
+    }
+
+    shared_qobject_ptr<QNetworkAccessManager> m_network{ new QNetworkAccessManager() };
+
+   private slots:
+    // every row starts with a Scheduler that knows nothing about the test server
+    void init() { Net::Scheduler::instance().resetHosts(); }
+
+    void test_Download_data()
+    {
+        QTest::addColumn<QString>("kind");
+        QTest::addColumn<int>("latency");
+        QTest::addColumn<qint64>("bandwidth");
+        // every n-th file fails once with a 503, 0 for none
+        QTest::addColumn<int>("failEvery");
+
+        QTest::newRow("assets") << QString("assets") << 0 << qint64(0) << 0;
+        QTest::newRow("assets, 20ms latency") << QString("assets") << 20 << qint64(0) << 0;
+        QTest::newRow("libraries") << QString("libraries") << 0 << qint64(0) << 0;
+        QTest::newRow("meta") << QString("meta") << 5 << qint64(0) << 0;
+        QTest::newRow("meta revalidation") << QString("meta revalidation") << 5 << qint64(0) << 0;
+        QTest::newRow("modpack, 32 MiB/s") << QString("modpack") << 0 << qint64(32 * 1024 * 1024) << 0;
+        QTest::newRow("assets, flaky") << QString("assets") << 0 << qint64(0) << 10;
+    }
+
+    void test_Download()
+    {
+        QFETCH(QString, kind);
+        QFETCH(int, latency);
+        QFETCH(qint64, bandwidth);
+        QFETCH(int, failEvery);
+
+        HttpTestServer server;
+        server.setLatency(latency);
+        server.setBandwidth(bandwidth);
+
+        auto files = fixtures(kind);
+        qint64 bytes = 0;
+        for (int i = 0; i < files.size(); i++) {
+            server.serve(files[i].path, files[i].data);
+            if (failEvery && i % failEvery == 0)
+                server.failNext(files[i].path, 503);
+            bytes += files[i].data.size();
+        }
+
+        QTemporaryDir dir;
+        HttpMetaCache cache(dir.filePath("metacache"));
+        cache.addBase("meta", dir.filePath("meta"));
+
+        auto makeJob = [&] {
+            auto job = makeShared<NetJob>(kind, m_network, 6);
+            job->setAskRetry(false);
+            job->setPriority(kind.startsWith("meta") ? Net::Scheduler::Priority::Interactive : Net::Scheduler::Priority::Bulk);
+            for (const auto& file : files) {
+                Net::Download::Ptr dl;
+                if (kind.startsWith("meta")) {
+                    auto entry = cache.resolveEntry("meta", file.path.mid(5));
+                    // a stale entry that is on disk gets revalidated, which the server answers with a 304
+                    entry->setStale(true);
+                    dl = Net::Download::makeCached(server.url(file.path), entry);
+                } else {
+                    dl = Net::Download::makeFile(server.url(file.path), dir.filePath(file.path));
+                    dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(file.data)));
+                }
+                job->addNetAction(dl);
+            }
+            return job;
+        };
+
+        if (kind == "meta revalidation") {
+            auto warmup = makeJob();
+            QVERIFY(run(*warmup));
+        }
+
+        auto requests = server.requestCount();
+        auto job = makeJob();
+        // the fixtures (and the warmup) are resident already, only what the download adds counts
+        auto residentBefore = memoryKiB("VmRSS");
+        resetPeakMemory();
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(run(*job));
+        auto ms = timer.elapsed();
+        auto peak = memoryKiB("VmHWM");
+        auto memory = residentBefore < 0 || peak < 0 ? -1 : qMax<qint64>(0, peak - residentBefore);
+
+        int failures = failEvery ? (files.size() + failEvery - 1) / failEvery : 0;
+        QCOMPARE(server.requestCount() - requests, int(files.size()) + failures);
+        for (const auto& file : files) {
+            auto path = kind.startsWith("meta") ? FS::PathCombine(dir.filePath("meta"), file.path.mid(5)) : dir.filePath(file.path);
+            QCOMPARE(QFileInfo(path).size(), qint64(file.data.size()));
+        }
+
+        report(kind, ms, kind == "meta revalidation" ? 0 : bytes, files.size(), memory);
+    }
+};
+
+QTEST_GUILESS_MAIN(DownloadBenchmarkTest)
+
+#include "DownloadBenchmark_test.moc"
@@ -0,0 +1,94 @@
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <modplatform/helpers/HashCache.h>
+
+class HashCacheTest : public QObject {
+    Q_OBJECT
+
+    // as if it was written a while ago
+    static void age(const QString& path, qint64 secs = 3600)
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(-secs), QFileDevice::FileModificationTime));
+    }
+
+   private slots:
+
+    void test_Invalidation()
+    {
+        QTemporaryDir tempDir;
+        auto path = FS::PathCombine(tempDir.path(), "mod.jar");
+        FS::write(path, "some jar");
+        age(path);
+
+        Hashing::HashCache cache;
+        auto hash = Hashing::hash(path, Hashing::Algorithm::Sha1);
+        cache.put(Hashing::FileIdentity::of(path), Hashing::Algorithm::Sha1, hash);
+
+        QCOMPARE(cache.get(path, Hashing::Algorithm::Sha1), hash);
+        QVERIFY(cache.get(path, Hashing::Algorithm::Sha512).isEmpty());
+
+        // a different size means a different file
+        FS::write(path, "some other jar");
+        QVERIFY(cache.get(path, Hashing::Algorithm::Sha1).isEmpty());
+        QCOMPARE(cache.verifiedAt(Hashing::FileIdentity::of(path)), qint64(0));
+    }
+
+    void test_Unsettled()
+    {
+        QTemporaryDir tempDir;
+        auto path = FS::PathCombine(tempDir.path(), "mod.jar");
+        FS::write(path, "some jar");
+
+        // written just now, it could still change without its size, mtime or inode showing it
+        Hashing::HashCache cache;
+        auto identity = Hashing::FileIdentity::of(path);
+        QVERIFY(!identity.isSettled());
+        cache.put(identity, Hashing::Algorithm::Sha1, Hashing::hash(path, Hashing::Algorithm::Sha1));
+        QVERIFY(cache.get(path, Hashing::Algorithm::Sha1).isEmpty());
+
+        age(path);
+        identity = Hashing::FileIdentity::of(path);
+        QVERIFY(identity.isSettled());
+        cache.put(identity, Hashing::Algorithm::Sha1, "1234");
+        QCOMPARE(cache.get(path, Hashing::Algorithm::Sha1), QString("1234"));
+    }
+
+    void test_Persistence()
+    {
+        QTemporaryDir tempDir;
+        auto path = FS::PathCombine(tempDir.path(), "mod.jar");
+        auto index = FS::PathCombine(tempDir.path(), "hashcache");
+        FS::write(path, "some jar");
+        age(path);
+
+        auto identity = Hashing::FileIdentity::of(path);
+        QVERIFY(identity.isValid());
+
+        auto before = QDateTime::currentSecsSinceEpoch();
+        {
+            Hashing::HashCache cache(index);
+            cache.put(identity, Hashing::Algorithm::Murmur2, "1234");
+            cache.put(identity, Hashing::Algorithm::Sha512, "abcd");
+            cache.SaveNow();
+        }
+
+        Hashing::HashCache cache(index);
+        cache.Load();
+        QCOMPARE(cache.get(path, Hashing::Algorithm::Murmur2), QString("1234"));
+        QCOMPARE(cache.get(path, Hashing::Algorithm::Sha512), QString("abcd"));
+        // and when they were computed
+        auto verified = cache.verifiedAt(identity);
+        QVERIFY(verified >= before);
+        QVERIFY(verified <= QDateTime::currentSecsSinceEpoch());
+    }
+};
+
+QTEST_GUILESS_MAIN(HashCacheTest)
+
+#include "HashCache_test.moc"
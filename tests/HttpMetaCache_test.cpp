@@ -0,0 +1,233 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <net/HttpMetaCache.h>
+
+class HttpMetaCacheTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+
+    QString indexPath() const { return m_dir.filePath("metacache"); }
+
+    std::unique_ptr<HttpMetaCache> makeCache()
+    {
+        auto cache = std::make_unique<HttpMetaCache>(indexPath());
+        cache->addBase("libraries", m_dir.filePath("libraries"));
+        cache->addBase("assets", m_dir.filePath("assets"));
+        cache->Load();
+        return cache;
+    }
+
+    static void addEntry(HttpMetaCache& cache, const QString& base, const QString& path, const QString& etag)
+    {
+        auto entry = cache.resolveEntry(base, path);
+        entry->setETag(etag);
+        entry->setMD5Sum("d41d8cd98f00b204e9800998ecf8427e");
+        entry->setLocalChangedTimestamp(1700000000000);
+        entry->setCurrentAge(10);
+        entry->setMaximumAge(3600);
+        entry->setStale(false);
+        cache.updateEntry(entry);
+    }
+
+   private slots:
+    void init()
+    {
+        QFile::remove(indexPath());
+    }
+
+    void test_MigrateFromJson()
+    {
+        FS::write(indexPath(), R"({
+            "version": "1",
+            "entries": [
+                { "base": "libraries", "path": "a/b.jar", "md5sum": "abc", "etag": "\"1\"", "last_changed_timestamp": 1700000000000,
+                  "current_age": 5, "max_age": 100 },
+                { "base": "assets", "path": "index.json", "md5sum": "def", "etag": "\"2\"", "last_changed_timestamp": 1700000000001,
+                  "eternal": true },
+                { "base": "gone", "path": "x", "md5sum": "", "etag": "", "last_changed_timestamp": 0 }
+            ]
+        })");
+
+        {
+            auto cache = makeCache();
+            auto entry = cache->getEntry("libraries", "a/b.jar");
+            QVERIFY(entry);
+            QCOMPARE(entry->getETag(), QString("\"1\""));
+            QCOMPARE(entry->getMaximumAge(), qint64(100));
+            QVERIFY(cache->getEntry("assets", "index.json")->isEternal());
+            cache->SaveNow();
+        }
+
+        QFile index(indexPath());
+        QVERIFY(index.open(QIODevice::ReadOnly));
+        QCOMPARE(index.read(4), QByteArray("HMC2"));
+        index.close();
+
+        auto cache = makeCache();
+        auto entry = cache->getEntry("libraries", "a/b.jar");
+        QVERIFY(entry);
+        QCOMPARE(entry->getMD5Sum(), QString("abc"));
+        QCOMPARE(entry->getCurrentAge(), qint64(5));
+        QVERIFY(!entry->isStale());
+        QVERIFY(cache->getEntry("assets", "index.json")->isEternal());
+    }
+
+    void test_IncrementalSave()
+    {
+        {
+            auto cache = makeCache();
+            for (int i = 0; i < 1000; i++)
+                addEntry(*cache, "libraries", QString("lib/%1.jar").arg(i), "v1");
+            cache->SaveNow();
+        }
+        auto snapshotSize = QFileInfo(indexPath()).size();
+
+        {
+            auto cache = makeCache();
+            addEntry(*cache, "libraries", "lib/7.jar", "v2");
+            cache->evictEntry(cache->getEntry("libraries", "lib/8.jar"));
+            cache->SaveNow();
+        }
+        // only the two changes got appended
+        auto size = QFileInfo(indexPath()).size();
+        QVERIFY(size > snapshotSize);
+        QVERIFY(size - snapshotSize < snapshotSize / 100);
+
+        auto cache = makeCache();
+        QCOMPARE(cache->getEntry("libraries", "lib/7.jar")->getETag(), QString("v2"));
+        QVERIFY(!cache->getEntry("libraries", "lib/8.jar"));
+        QCOMPARE(cache->getEntry("libraries", "lib/999.jar")->getETag(), QString("v1"));
+    }
+
+    void test_SetStale()
+    {
+        {
+            auto cache = makeCache();
+            addEntry(*cache, "libraries", "kept.jar", "1");
+            addEntry(*cache, "libraries", "stale.jar", "1");
+            cache->SaveNow();
+        }
+        {
+            // like forcing a redownload, without ever calling updateEntry()
+            auto cache = makeCache();
+            cache->getEntry("libraries", "stale.jar")->setStale(true);
+            cache->SaveNow();
+        }
+
+        auto cache = makeCache();
+        QVERIFY(cache->getEntry("libraries", "kept.jar"));
+        QVERIFY(!cache->getEntry("libraries", "stale.jar"));
+    }
+
+    void test_Compaction()
+    {
+        {
+            auto cache = makeCache();
+            for (int i = 0; i < 100; i++)
+                addEntry(*cache, "assets", QString("object/%1").arg(i), "0");
+            cache->SaveNow();
+            for (int i = 0; i < 5000; i++) {
+                addEntry(*cache, "assets", "object/0", QString::number(i));
+                cache->SaveNow();
+            }
+        }
+
+        // 5100 records would be way bigger than this
+        QVERIFY(QFileInfo(indexPath()).size() < 200 * 1024);
+        auto cache = makeCache();
+        QCOMPARE(cache->getEntry("assets", "object/0")->getETag(), QString("4999"));
+        QCOMPARE(cache->getEntry("assets", "object/99")->getETag(), QString("0"));
+    }
+
+    void test_TruncatedLog()
+    {
+        {
+            auto cache = makeCache();
+            addEntry(*cache, "assets", "first", "1");
+            cache->SaveNow();
+            addEntry(*cache, "assets", "second", "2");
+            cache->SaveNow();
+        }
+
+        // cut the last record in half, like a crash while appending would
+        auto data = FS::read(indexPath());
+        FS::write(indexPath(), data.left(data.size() - 10));
+
+        {
+            auto cache = makeCache();
+            QVERIFY(cache->getEntry("assets", "first"));
+            QVERIFY(!cache->getEntry("assets", "second"));
+            addEntry(*cache, "assets", "third", "3");
+        }
+
+        // the damaged log got rewritten
+        auto cache = makeCache();
+        QVERIFY(cache->getEntry("assets", "first"));
+        QVERIFY(cache->getEntry("assets", "third"));
+    }
+
+    void test_Benchmark_Load()
+    {
+        const int count = 50000;
+        {
+            auto cache = makeCache();
+            for (int i = 0; i < count; i++)
+                addEntry(*cache, "libraries", QString("org/example/lib%1/1.0/lib%1-1.0.jar").arg(i), QString("\"%1\"").arg(i));
+            cache->SaveNow();
+        }
+
+        QBENCHMARK
+        {
+            auto cache = makeCache();
+            QVERIFY(cache->getEntry("libraries", "org/example/lib49999/1.0/lib49999-1.0.jar"));
+        }
+    }
+
+    void test_Benchmark_Save()
+    {
+        const int count = 50000;
+        auto cache = makeCache();
+        for (int i = 0; i < count; i++)
+            addEntry(*cache, "libraries", QString("org/example/lib%1/1.0/lib%1-1.0.jar").arg(i), QString("\"%1\"").arg(i));
+        cache->SaveNow();
+
+        int i = 0;
+        QBENCHMARK
+        {
+            addEntry(*cache, "libraries", QString("org/example/lib%1/1.0/lib%1-1.0.jar").arg(i++ % count), "changed");
+            cache->SaveNow();
+        }
+    }
+
+    void test_Benchmark_MigrateFromJson()
+    {
+        const int count = 50000;
+        QByteArray data = R"({"version":"1","entries":[)";
+        for (int i = 0; i < count; i++) {
+            if (i)
+                data += ',';
+            data += QString(R"({"base":"libraries","path":"org/example/lib%1/1.0/lib%1-1.0.jar","md5sum":"d41d8cd98f00b204e9800998ecf8427e",)"
+                            R"("etag":"\"%1\"","last_changed_timestamp":1700000000000,"current_age":10,"max_age":3600})")
+                        .arg(i)
+                        .toUtf8();
+        }
+        data += "]}";
+        FS::write(indexPath(), data);
+
+        QBENCHMARK_ONCE
+        {
+            auto cache = makeCache();
+            QVERIFY(cache->getEntry("libraries", "org/example/lib49999/1.0/lib49999-1.0.jar"));
+            cache->SaveNow();
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(HttpMetaCacheTest)
+
+#include "HttpMetaCache_test.moc"
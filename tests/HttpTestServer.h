@@ -0,0 +1,187 @@
+#pragma once
+
+#include <QCryptographicHash>
+#include <QHash>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <memory>
+
+/*
+ * A tiny HTTP/1.1 server on localhost, standing in for the real download servers in tests and benchmarks.
+ * It serves whatever was registered with serve(), with keep-alive, ETags (`If-None-Match` gets a 304) and
+ * `Range: bytes=<start>-` requests, and 404s anything else. Responses can be made to break off halfway with dropAfter(),
+ * to fail with failNext(), and to take their time with setLatency() and setBandwidth().
+ */
+class HttpTestServer : public QTcpServer {
+   public:
+    HttpTestServer()
+    {
+        connect(this, &QTcpServer::newConnection, this, [this] {
+            while (hasPendingConnections())
+                handleConnection(nextPendingConnection());
+        });
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url(const QString& path) const { return QUrl(QString("http://127.0.0.1:%1/%2").arg(serverPort()).arg(path)); }
+
+    void serve(const QString& path, const QByteArray& data)
+    {
+        auto& file = m_files["/" + path];
+        file.data = data;
+        file.etag = '"' + QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex().left(16) + '"';
+    }
+
+    // the next `times` responses for `path` close the connection after `bytes` bytes of the body
+    void dropAfter(const QString& path, qint64 bytes, int times = 1)
+    {
+        auto& file = m_files["/" + path];
+        file.dropAfter = bytes;
+        file.drops = times;
+    }
+
+    // the next `times` requests for `path` get an empty response with `status`
+    void failNext(const QString& path, int status, int times = 1)
+    {
+        auto& file = m_files["/" + path];
+        file.failStatus = status;
+        file.failures = times;
+    }
+
+    // responses for `path` don't say how long they are, they end by closing the connection
+    void hideLength(const QString& path) { m_files["/" + path].hideLength = true; }
+
+    // every response waits this long before it starts
+    void setLatency(int ms) { m_latency = ms; }
+    // bytes per second for each response body, 0 for as fast as possible
+    void setBandwidth(qint64 bytesPerSecond) { m_bandwidth = bytesPerSecond; }
+
+    // the Range header of every request for `path` so far, empty for requests without one
+    QList<QByteArray> ranges(const QString& path) const { return m_files.value("/" + path).ranges; }
+
+    int requestCount() const { return m_requests; }
+
+   private:
+    struct File {
+        QByteArray data;
+        QByteArray etag;
+        qint64 dropAfter = 0;
+        int drops = 0;
+        int failStatus = 0;
+        int failures = 0;
+        bool hideLength = false;
+        QList<QByteArray> ranges;
+    };
+
+    void handleConnection(QTcpSocket* socket)
+    {
+        auto buffer = std::make_shared<QByteArray>();
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer] {
+            buffer->append(socket->readAll());
+            int end;
+            while (socket->state() == QAbstractSocket::ConnectedState && (end = buffer->indexOf("\r\n\r\n")) != -1) {
+                auto head = buffer->left(end);
+                buffer->remove(0, end + 4);
+                if (m_latency > 0)
+                    QTimer::singleShot(m_latency, socket, [this, socket, head] { respond(socket, head); });
+                else
+                    respond(socket, head);
+            }
+        });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+
+    void respond(QTcpSocket* socket, const QByteArray& head)
+    {
+        m_requests++;
+
+        // "GET /path HTTP/1.1", then the headers
+        auto lines = head.split('\n');
+        auto requestLine = lines.takeFirst().trimmed().split(' ');
+        QHash<QByteArray, QByteArray> headers;
+        for (const auto& line : lines) {
+            auto colon = line.indexOf(':');
+            if (colon > 0)
+                headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+        }
+
+        auto file = m_files.find(QString::fromUtf8(requestLine.value(1)));
+        if (file == m_files.end() || file->data.isNull()) {
+            socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+        file->ranges.append(headers.value("range"));
+
+        if (file->failures > 0) {
+            file->failures--;
+            socket->write("HTTP/1.1 " + QByteArray::number(file->failStatus) + " Failed\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+        if (headers.value("if-none-match") == file->etag) {
+            socket->write("HTTP/1.1 304 Not Modified\r\nETag: " + file->etag + "\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        qint64 size = file->data.size();
+        qint64 start = 0;
+        auto range = headers.value("range");
+        auto ifRange = headers.value("if-range");
+        if (range.startsWith("bytes=") && range.endsWith('-') && (ifRange.isEmpty() || ifRange == file->etag)) {
+            start = range.mid(6, range.size() - 7).toLongLong();
+            if (start >= size) {
+                socket->write("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n\r\n");
+                return;
+            }
+        }
+
+        QByteArray response;
+        if (start > 0) {
+            response = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + QByteArray::number(start) + "-" + QByteArray::number(size - 1) +
+                       "/" + QByteArray::number(size) + "\r\n";
+        } else {
+            response = "HTTP/1.1 200 OK\r\n";
+        }
+        response += "Content-Type: application/octet-stream\r\nAccept-Ranges: bytes\r\nETag: " + file->etag + "\r\n";
+        if (file->hideLength) {
+            socket->write(response + "Connection: close\r\n\r\n");
+            socket->write(file->data.mid(start));
+            socket->disconnectFromHost();
+            return;
+        }
+        response += "Content-Length: " + QByteArray::number(size - start) + "\r\n\r\n";
+        socket->write(response);
+
+        if (file->drops > 0) {
+            file->drops--;
+            socket->write(file->data.mid(start, file->dropAfter));
+            socket->disconnectFromHost();
+            return;
+        }
+        if (m_bandwidth <= 0) {
+            socket->write(file->data.mid(start));
+            return;
+        }
+        send(socket, file->data.mid(start));
+    }
+
+    // writes `body` a slice at a time, so it arrives at about m_bandwidth bytes per second
+    void send(QPointer<QTcpSocket> socket, QByteArray body)
+    {
+        static const int s_tick = 10;
+        if (!socket || socket->state() != QAbstractSocket::ConnectedState)
+            return;
+        auto slice = qMax<qint64>(1, m_bandwidth * s_tick / 1000);
+        socket->write(body.left(slice));
+        body.remove(0, slice);
+        if (!body.isEmpty())
+            QTimer::singleShot(s_tick, socket, [this, socket, body] { send(socket, body); });
+    }
+
+    QHash<QString, File> m_files;
+    int m_requests = 0;
+    int m_latency = 0;
+    qint64 m_bandwidth = 0;
+};
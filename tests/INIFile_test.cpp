@@ -1,6 +1,7 @@
 #include <QTest>
 
 #include <settings/INIFile.h>
+#include <settings/INISettingsObject.h>
 #include <QList>
 #include <QSettings>
 #include <QTemporaryFile>
@@ -190,6 +191,46 @@ PreLaunchCommand=)";
         FS::deletePath(fileName);
 #endif
     }
+
+    void test_LazySettingsObject()
+    {
+        QTemporaryFile file;
+        QCOMPARE(file.open(), true);
+        QString fileName = file.fileName();
+        file.close();
+
+        INIFile contents;
+        contents.set("name", "On disk");
+        contents.set("JavaPath", "/usr/bin/java");
+        QVERIFY(contents.saveFile(fileName));
+
+        // what's known about the file doesn't need it read, even when it's out of date
+        INIFile summary;
+        summary.set("name", "Summary");
+        INISettingsObject settings(fileName, summary, { "name", "iconKey" });
+        settings.registerSetting("name", "");
+        settings.registerSetting("iconKey", "default");
+        settings.registerSetting("JavaPath", "");
+        QCOMPARE(settings.get("name").toString(), QString("Summary"));
+        QCOMPARE(settings.get("iconKey").toString(), QString("default"));
+        QVERIFY(!settings.isLoaded());
+
+        // anything else gets the whole file
+        QCOMPARE(settings.get("JavaPath").toString(), QString("/usr/bin/java"));
+        QVERIFY(settings.isLoaded());
+        QCOMPARE(settings.get("name").toString(), QString("On disk"));
+
+        // and so does changing anything, which writes back all of it
+        INISettingsObject changed(fileName, summary, { "name" });
+        changed.registerSetting("name", "");
+        QVERIFY(changed.set("name", "Changed"));
+        QVERIFY(changed.isLoaded());
+
+        INIFile saved;
+        QVERIFY(saved.loadFile(fileName));
+        QCOMPARE(saved.get("name", "NOT SET").toString(), QString("Changed"));
+        QCOMPARE(saved.get("JavaPath", "NOT SET").toString(), QString("/usr/bin/java"));
+    }
 };
 
 QTEST_GUILESS_MAIN(IniFileTest)
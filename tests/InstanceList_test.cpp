@@ -0,0 +1,153 @@
+#include <QTest>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <FileSystem.h>
+#include <InstanceList.h>
+#include <settings/INIFile.h>
+#include <settings/INISettingsObject.h>
+
+class InstanceListTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+    QString m_oldCurrent;
+
+    // what BaseInstance takes from the launcher's settings
+    SettingsObjectPtr globalSettings()
+    {
+        auto settings = std::make_shared<INISettingsObject>(m_dir.filePath("launcher.cfg"));
+        for (auto id : { "ShowGameTime", "RecordGameTime", "ShowConsole", "AutoCloseConsole", "ShowConsoleOnError", "LogPrePostOutput",
+                         "ConsoleOverflowStop" })
+            settings->registerSetting(id, true);
+        for (auto id : { "PreLaunchCommand", "WrapperCommand", "PostExitCommand" })
+            settings->registerSetting(id, "");
+        settings->registerSetting("ConsoleMaxLines", 100000);
+        return settings;
+    }
+
+    QString writeInstance(const QString& id, const QString& name)
+    {
+        auto root = QDir(m_dir.filePath("instances")).absoluteFilePath(id);
+        QDir().mkpath(root);
+        INIFile config;
+        config.set("InstanceType", "Test");
+        config.set("name", name);
+        config.set("notes", "Some notes");
+        config.set("ManagedPack", true);
+        config.set("ManagedPackName", "Some pack");
+        config.set("JvmArgs", "-Xmx1G");
+        auto path = FS::PathCombine(root, "instance.cfg");
+        config.saveFile(path);
+        return path;
+    }
+
+    static void setModified(const QString& path, const QDateTime& time)
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(time, QFileDevice::FileModificationTime));
+    }
+
+    static void load(InstanceList& list)
+    {
+        QSignalSpy loaded(&list, &InstanceList::listLoaded);
+        QCOMPARE(list.loadList(), InstanceList::NoError);
+        QVERIFY(loaded.wait());
+        QVERIFY(list.isListLoaded());
+    }
+
+   private slots:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+        // the instance cache goes to cache/ in the current directory
+        m_oldCurrent = QDir::currentPath();
+        QDir::setCurrent(m_dir.path());
+    }
+
+    void cleanup()
+    {
+        QDir::setCurrent(m_oldCurrent);
+        FS::deletePath(m_dir.filePath("instances"));
+        FS::deletePath(m_dir.filePath("cache"));
+    }
+
+    void test_startupKeepsSettingsUnread()
+    {
+        auto old = QDateTime::currentDateTime().addSecs(-3600);
+        for (auto id : { "one", "two", "three" })
+            setModified(writeInstance(id, id), old);
+
+        auto settings = globalSettings();
+        {
+            InstanceList list(settings, "instances");
+            load(list);
+            QCOMPARE(list.count(), 3);
+        }
+        QVERIFY(QFile::exists("cache/instances.dat"));
+
+        InstanceList list(settings, "instances");
+        load(list);
+        QCOMPARE(list.count(), 3);
+        for (int i = 0; i < list.count(); i++) {
+            auto inst = list.at(i);
+            // what gets read of every instance without opening it
+            QCOMPARE(inst->name(), inst->id());
+            QCOMPARE(inst->iconKey(), QString("default"));
+            QCOMPARE(inst->notes(), QString("Some notes"));
+            QVERIFY(inst->isManagedPack());
+            QCOMPARE(inst->getManagedPackName(), QString("Some pack"));
+            QVERIFY(inst->getLinkedInstances().isEmpty());
+            QCOMPARE(inst->getConsoleMaxLines(), 100000);
+            QVERIFY(inst->settings()->get("RecordGameTime").toBool());
+            inst->lastLaunch();
+            inst->totalTimePlayed();
+
+            auto instanceSettings = std::dynamic_pointer_cast<INISettingsObject>(inst->settings());
+            QVERIFY(instanceSettings);
+            QVERIFY(!instanceSettings->isLoaded());
+        }
+
+        // anything else reads the rest
+        auto inst = list.getInstanceById("one");
+        QVERIFY(inst);
+        inst->settings()->registerSetting("JvmArgs", "");
+        QCOMPARE(inst->settings()->get("JvmArgs").toString(), QString("-Xmx1G"));
+        QVERIFY(std::dynamic_pointer_cast<INISettingsObject>(inst->settings())->isLoaded());
+    }
+
+    void test_changedInstanceIsReread()
+    {
+        auto path = writeInstance("one", "Before");
+        auto modified = QFileInfo(path).lastModified();
+
+        auto settings = globalSettings();
+        {
+            InstanceList list(settings, "instances");
+            load(list);
+            QCOMPARE(list.count(), 1);
+        }
+
+        // changed in place right after it was looked at, with the same size and a clock too coarse to tell
+        INIFile config;
+        QVERIFY(config.loadFile(path));
+        config.set("name", "Behind");
+        QVERIFY(config.saveFile(path));
+        setModified(path, modified);
+
+        InstanceList list(settings, "instances");
+        load(list);
+        QCOMPARE(list.count(), 1);
+        QCOMPARE(list.at(0)->name(), QString("Behind"));
+    }
+};
+
+QTEST_GUILESS_MAIN(InstanceListTest)
+
+#include "InstanceList_test.moc"
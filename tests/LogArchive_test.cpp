@@ -0,0 +1,171 @@
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <launch/LogArchive.h>
+
+class LogArchiveTest : public QObject {
+    Q_OBJECT
+
+    static QString lineText(qint64 i) { return QString("[12:00:00] [Render thread/INFO]: line %1 é").arg(i); }
+
+    static MessageLevel::Enum lineLevel(qint64 i) { return i % 7 == 0 ? MessageLevel::Warning : MessageLevel::Message; }
+
+    static void fill(LogArchive& archive, qint64 first, qint64 count)
+    {
+        QVector<LogModel::Line> batch;
+        for (qint64 i = first; i < first + count; i++) {
+            batch.append({ lineLevel(i), lineText(i) });
+            if (batch.size() == 1000) {
+                archive.append(batch);
+                batch.clear();
+            }
+        }
+        archive.append(batch);
+    }
+
+   private slots:
+    void test_Lines()
+    {
+        QTemporaryDir dir;
+        LogArchive archive(dir.path());
+        const qint64 count = 3 * LogArchive::s_segmentLines + 123;
+        fill(archive, 0, count);
+        QCOMPARE(archive.lineCount(), count);
+        auto reader = archive.reader();
+
+        // sealed segments, the segments being written and the open one
+        const qint64 segment = LogArchive::s_segmentLines;
+        for (qint64 i : { qint64(0), segment - 1, segment, 2 * segment + 5, count - 1 }) {
+            auto line = reader.line(i);
+            QCOMPARE(line.text, lineText(i));
+            QCOMPARE(line.level, lineLevel(i));
+        }
+        QCOMPARE(reader.line(count).text, QString());
+
+        // a page spanning two segments
+        auto page = reader.lines(LogArchive::s_segmentLines - 10, 20);
+        QCOMPARE(page.size(), 20);
+        for (int i = 0; i < page.size(); i++)
+            QCOMPARE(page[i].text, lineText(LogArchive::s_segmentLines - 10 + i));
+
+        QCOMPARE(reader.lines(count - 5, 100).size(), 5);
+
+        // a reader keeps what was there when it was made, once the writes are done too
+        fill(archive, count, LogArchive::s_segmentLines);
+        archive.waitForWrites();
+        QCOMPARE(reader.lineCount(), count);
+        QCOMPARE(reader.line(count - 1).text, lineText(count - 1));
+        QCOMPARE(reader.line(count).text, QString());
+        QCOMPARE(archive.reader().line(count + LogArchive::s_segmentLines - 1).text, lineText(count + LogArchive::s_segmentLines - 1));
+    }
+
+    void test_Find()
+    {
+        QTemporaryDir dir;
+        LogArchive archive(dir.path());
+        const qint64 count = 2 * LogArchive::s_segmentLines + 10;
+        fill(archive, 0, count);
+        archive.append(MessageLevel::Error, "java.lang.NullPointerException: oops");
+        fill(archive, count + 1, 10);
+
+        auto reader = archive.reader();
+        QCOMPARE(reader.find("nullpointerexception", 0, false), count);
+        QCOMPARE(reader.find("nullpointerexception", 0, false, Qt::CaseSensitive), qint64(-1));
+        QCOMPARE(reader.find("NullPointerException", archive.lineCount() - 1, true), count);
+        QCOMPARE(reader.find("NullPointerException", count + 1, false), qint64(-1));
+        QCOMPARE(reader.find("line 5 é", 0, false), qint64(5));
+        QCOMPARE(reader.find("line 5 é", archive.lineCount() - 1, true), qint64(5));
+        QCOMPARE(reader.find("line 20000 é", 0, false), qint64(20000));
+        QCOMPARE(reader.find("not there", 0, false), qint64(-1));
+    }
+
+    void test_WriteTo()
+    {
+        QTemporaryDir dir;
+        LogArchive archive(dir.path());
+        const qint64 count = LogArchive::s_segmentLines + 42;
+        fill(archive, 0, count);
+
+        QByteArray expected;
+        for (qint64 i = 0; i < count; i++)
+            expected += lineText(i).toUtf8() + '\n';
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(archive.reader().writeTo(&buffer));
+        QCOMPARE(data, expected);
+    }
+
+    void test_Reopen()
+    {
+        QTemporaryDir dir;
+        const qint64 count = LogArchive::s_segmentLines + 42;
+        {
+            LogArchive archive(dir.path());
+            fill(archive, 0, count);
+            archive.flush();
+            archive.waitForWrites();
+        }
+
+        LogArchive archive(dir.path());
+        QCOMPARE(archive.lineCount(), count);
+        QCOMPARE(archive.reader().line(count - 1).text, lineText(count - 1));
+
+        // keeps filling the partial segment
+        fill(archive, count, LogArchive::s_segmentLines);
+        QCOMPARE(archive.lineCount(), count + LogArchive::s_segmentLines);
+        QCOMPARE(archive.reader().line(count).text, lineText(count));
+        QCOMPARE(archive.reader().line(count + LogArchive::s_segmentLines - 1).text, lineText(count + LogArchive::s_segmentLines - 1));
+    }
+
+    void test_Flush()
+    {
+        QTemporaryDir dir;
+        const qint64 count = LogArchive::s_segmentLines + 42;
+        {
+            LogArchive archive(dir.path());
+            // the open segment is written again every time, the last of those writes has to win
+            for (qint64 i = 0; i < count; i += 1000) {
+                fill(archive, i, qMin<qint64>(1000, count - i));
+                archive.flush();
+            }
+            archive.waitForWrites();
+        }
+
+        LogArchive archive(dir.path());
+        QCOMPARE(archive.lineCount(), count);
+        QCOMPARE(archive.reader().line(count - 1).text, lineText(count - 1));
+    }
+
+    void test_Prune()
+    {
+        QTemporaryDir dir;
+        for (auto name : { "2024-01-01_00-00-00-000", "2024-01-02_00-00-00-000", "2024-01-03_00-00-00-000" }) {
+            LogArchive archive(dir.filePath(name));
+            archive.append(MessageLevel::Message, "hello");
+            archive.flush();
+            archive.waitForWrites();
+        }
+
+        LogArchive::prune(dir.path(), 1);
+        QCOMPARE(QDir(dir.path()).entryList(QDir::Dirs | QDir::NoDotAndDotDot), QStringList{ "2024-01-03_00-00-00-000" });
+    }
+
+    void test_Benchmark()
+    {
+        QTemporaryDir dir;
+        QBENCHMARK_ONCE
+        {
+            LogArchive archive(dir.filePath("bench"));
+            fill(archive, 0, 1000000);
+            archive.flush();
+            archive.waitForWrites();
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogArchiveTest)
+
+#include "LogArchive_test.moc"
@@ -0,0 +1,147 @@
+#include <QRegularExpression>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <minecraft/LogClassifier.h>
+
+// what MinecraftInstance::guessLevel() did before the scanner, only with the expressions compiled once.
+// the scanner has to agree with it on every line
+static MessageLevel::Enum referenceLevel(const QString& line, MessageLevel::Enum level)
+{
+    // NOTE: this diverges from the real regexp. no unicode, the first section is + instead of *
+    static const QString javaSymbol = "([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$][a-zA-Z\\d_$]*";
+    static const QRegularExpression log4j("\\[(?<timestamp>[0-9:]+)\\] \\[[^/]+/(?<level>[^\\]]+)\\]");
+    static const QRegularExpression stackFrame("\\s+at " + javaSymbol);
+    static const QRegularExpression causedBy("Caused by: " + javaSymbol);
+    static const QRegularExpression throwable("([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$]?[a-zA-Z\\d_$]*(Exception|Error|Throwable)");
+    static const QRegularExpression moreFrames("... \\d+ more$");
+
+    auto match = log4j.match(line);
+    if (match.hasMatch()) {
+        // New style logs from log4j
+        QString levelStr = match.captured("level");
+        if (levelStr == "INFO")
+            level = MessageLevel::Message;
+        if (levelStr == "WARN")
+            level = MessageLevel::Warning;
+        if (levelStr == "ERROR")
+            level = MessageLevel::Error;
+        if (levelStr == "FATAL")
+            level = MessageLevel::Fatal;
+        if (levelStr == "TRACE" || levelStr == "DEBUG")
+            level = MessageLevel::Debug;
+    } else {
+        // Old style forge logs
+        if (line.contains("[INFO]") || line.contains("[CONFIG]") || line.contains("[FINE]") || line.contains("[FINER]") ||
+            line.contains("[FINEST]"))
+            level = MessageLevel::Message;
+        if (line.contains("[SEVERE]") || line.contains("[STDERR]"))
+            level = MessageLevel::Error;
+        if (line.contains("[WARNING]"))
+            level = MessageLevel::Warning;
+        if (line.contains("[DEBUG]"))
+            level = MessageLevel::Debug;
+    }
+    if (line.contains("overwriting existing"))
+        return MessageLevel::Fatal;
+    if (line.contains("Exception in thread") || line.contains(stackFrame) || line.contains(causedBy) || line.contains(throwable) ||
+        line.contains(moreFrames))
+        return MessageLevel::Error;
+    return level;
+}
+
+class LogClassifierTest : public QObject {
+    Q_OBJECT
+
+    QStringList loadLog()
+    {
+        QString path = QFINDTESTDATA("testdata/LogClassifier/modded.log");
+        return QString::fromUtf8(FS::read(path)).split('\n');
+    }
+
+    // roughly what a modded instance prints on startup
+    QStringList loadLargeLog()
+    {
+        auto sample = loadLog();
+        QStringList lines;
+        lines.reserve(100000);
+        while (lines.size() < 100000)
+            lines.append(sample);
+        return lines;
+    }
+
+   private slots:
+    void test_Levels_data()
+    {
+        QTest::addColumn<QString>("line");
+        QTest::addColumn<int>("expected");
+
+        QTest::newRow("log4j info") << "[12:01:02] [main/INFO]: Loading" << int(MessageLevel::Message);
+        QTest::newRow("log4j warn") << "[12:01:02] [Render thread/WARN]: Hmm" << int(MessageLevel::Warning);
+        QTest::newRow("log4j fatal") << "[12:01:02] [main/FATAL]: Oh no" << int(MessageLevel::Fatal);
+        QTest::newRow("log4j trace") << "[12:01:02] [main/TRACE]: ..." << int(MessageLevel::Debug);
+        QTest::newRow("log4j unknown level") << "[12:01:02] [main/VERBOSE]: ..." << int(MessageLevel::StdOut);
+        QTest::newRow("forge later tag wins") << "[INFO] [STDERR] [WARNING] [DEBUG]" << int(MessageLevel::Debug);
+        QTest::newRow("forge severe") << "2013-07-13 18:21:03 [SEVERE] [ForgeModLoader] bad" << int(MessageLevel::Error);
+        QTest::newRow("overwriting") << "[12:01:02] [main/INFO]: overwriting existing entry" << int(MessageLevel::Fatal);
+        QTest::newRow("stack frame") << "\tat net.minecraft.client.Main.main(Main.java:1)" << int(MessageLevel::Error);
+        QTest::newRow("caused by") << "Caused by: java.lang.RuntimeException: x" << int(MessageLevel::Error);
+        QTest::newRow("caused by number") << "Caused by: 123.456" << int(MessageLevel::StdOut);
+        QTest::newRow("throwable name") << "java.lang.OutOfMemoryError: Java heap space" << int(MessageLevel::Error);
+        QTest::newRow("numeric package") << "1.2Exception" << int(MessageLevel::StdOut);
+        QTest::newRow("more frames") << "\t... 42 more" << int(MessageLevel::Error);
+        QTest::newRow("not enough before more") << " 7 more" << int(MessageLevel::StdOut);
+        QTest::newRow("plain") << "hello world" << int(MessageLevel::StdOut);
+    }
+
+    void test_Levels()
+    {
+        QFETCH(QString, line);
+        QFETCH(int, expected);
+
+        QCOMPARE(int(LogClassifier::guessLevel(line, MessageLevel::StdOut)), expected);
+        QCOMPARE(int(referenceLevel(line, MessageLevel::StdOut)), expected);
+    }
+
+    // every line of the sample log, next to the level it should get (Unknown for the ones left as they were)
+    void test_ModdedLog()
+    {
+        auto lines = loadLog();
+        auto levels = QString::fromUtf8(FS::read(QFINDTESTDATA("testdata/LogClassifier/modded.levels"))).split('\n');
+        QCOMPARE(levels.size(), lines.size());
+        for (int i = 0; i < lines.size(); i++) {
+            auto level = LogClassifier::guessLevel(lines[i], MessageLevel::Unknown);
+            if (level != MessageLevel::getLevel(levels[i]))
+                qWarning() << "Wrong level for line" << lines[i];
+            QCOMPARE(level, MessageLevel::getLevel(levels[i]));
+        }
+    }
+
+    void test_MatchesReference()
+    {
+        auto lines = loadLargeLog();
+        for (auto level : { MessageLevel::Unknown, MessageLevel::StdOut, MessageLevel::StdErr }) {
+            for (const auto& line : lines) {
+                auto fast = LogClassifier::guessLevel(line, level);
+                auto reference = referenceLevel(line, level);
+                if (fast != reference)
+                    qWarning() << "Mismatch for line" << line;
+                QCOMPARE(fast, reference);
+            }
+        }
+    }
+
+    void test_Benchmark()
+    {
+        auto lines = loadLargeLog();
+        QBENCHMARK
+        {
+            for (const auto& line : lines)
+                LogClassifier::guessLevel(line, MessageLevel::StdOut);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogClassifierTest)
+
+#include "LogClassifier_test.moc"
@@ -0,0 +1,136 @@
+#include <QSignalSpy>
+#include <QTest>
+
+#include <launch/LogModel.h>
+
+class LogModelTest : public QObject {
+    Q_OBJECT
+
+    static QVector<LogModel::Line> makeLines(int first, int count)
+    {
+        QVector<LogModel::Line> lines;
+        for (int i = first; i < first + count; i++)
+            lines.append({ MessageLevel::Message, QString("line %1 é").arg(i) });
+        return lines;
+    }
+
+   private slots:
+    void test_BatchSignals()
+    {
+        LogModel model;
+        model.setMaxLines(100000);
+        QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+        model.append(makeLines(0, 5000));
+        model.append(makeLines(5000, 5000));
+        // nothing is visible until the coalesced update
+        QCOMPARE(model.rowCount(), 0);
+
+        model.flush();
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(model.rowCount(), 10000);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), QString("line 0 é"));
+        QCOMPARE(model.data(model.index(9999), Qt::DisplayRole).toString(), QString("line 9999 é"));
+        QCOMPARE(model.data(model.index(4096), LogModel::LevelRole).toInt(), int(MessageLevel::Message));
+
+        // and the timer does the same
+        model.append(MessageLevel::Error, "boom");
+        QTRY_COMPARE(model.rowCount(), 10001);
+        QCOMPARE(model.data(model.index(10000), LogModel::LevelRole).toInt(), int(MessageLevel::Error));
+    }
+
+    void test_Overflow()
+    {
+        LogModel model;
+        model.setMaxLines(10000);
+        QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+
+        model.append(makeLines(0, 8000));
+        model.flush();
+        model.append(makeLines(8000, 8000));
+        model.flush();
+
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(model.rowCount(), 10000);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), QString("line 6000 é"));
+        QCOMPARE(model.data(model.index(9999), Qt::DisplayRole).toString(), QString("line 15999 é"));
+
+        // a batch bigger than the whole log only keeps its tail
+        model.append(makeLines(20000, 25000));
+        model.flush();
+        QCOMPARE(model.rowCount(), 10000);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), QString("line 35000 é"));
+
+        model.setMaxLines(100);
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), QString("line 44900 é"));
+        QVERIFY(model.toPlainText().startsWith("line 44900 é\nline 44901"));
+    }
+
+    void test_StopOnOverflow()
+    {
+        LogModel model;
+        model.setMaxLines(100);
+        model.setStopOnOverflow(true);
+        model.setOverflowMessage("full");
+
+        model.append(makeLines(0, 500));
+        model.flush();
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(model.data(model.index(98), Qt::DisplayRole).toString(), QString("line 98 é"));
+        QCOMPARE(model.data(model.index(99), Qt::DisplayRole).toString(), QString("full"));
+        QCOMPARE(model.data(model.index(99), LogModel::LevelRole).toInt(), int(MessageLevel::Fatal));
+
+        // the overflow notice isn't from the archive
+        qint64 first, end;
+        model.archiveRange(first, end);
+        QCOMPARE(first, 0);
+        QCOMPARE(end, 99);
+    }
+
+    void test_ArchiveRange()
+    {
+        LogModel model;
+        model.setMaxLines(100);
+        qint64 first, end;
+
+        model.archiveRange(first, end);
+        QCOMPARE(first, -1);
+        QCOMPARE(end, -1);
+
+        // lines of the launcher's own around the ones from the archive
+        model.append(MessageLevel::Launcher, "launching");
+        model.append(makeLines(0, 150), 1000);
+        model.append(MessageLevel::Launcher, "exited");
+        model.flush();
+        QCOMPARE(model.rowCount(), 100);
+        model.archiveRange(first, end);
+        QCOMPARE(first, 1051);
+        QCOMPARE(end, 1150);
+
+        // cleared, then more from further on
+        model.clear();
+        model.append(makeLines(0, 10), 5000);
+        model.flush();
+        model.archiveRange(first, end);
+        QCOMPARE(first, 5000);
+        QCOMPARE(end, 5010);
+    }
+
+    void test_Benchmark()
+    {
+        auto lines = makeLines(0, 100000);
+        QBENCHMARK
+        {
+            LogModel model;
+            model.setMaxLines(1000000);
+            for (int i = 0; i < lines.size(); i += 500)
+                model.append(lines.mid(i, 500));
+            model.flush();
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogModelTest)
+
+#include "LogModel_test.moc"
@@ -0,0 +1,100 @@
+#include <QDir>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <java/download/ManifestDownloadTask.h>
+#include <java/download/RuntimeStore.h>
+#include <net/LzmaFileSink.h>
+
+#include "HttpTestServer.h"
+
+class ManifestDownloadTaskTest : public QObject {
+    Q_OBJECT
+
+    HttpTestServer m_server;
+    QString m_fixture;
+
+   private slots:
+    void initTestCase()
+    {
+        m_fixture = QFINDTESTDATA("testdata/JavaManifest");
+        auto manifest = FS::read(FS::PathCombine(m_fixture, "manifest.json"));
+        manifest.replace("@BASE@", m_server.url("").toString().chopped(1).toUtf8());
+        m_server.serve("manifest.json", manifest);
+
+        for (auto folder : { "raw", "lzma" }) {
+            QDir dir(FS::PathCombine(m_fixture, folder));
+            for (auto file : dir.entryList(QDir::Files))
+                m_server.serve(QString("%1/%2").arg(folder, file), FS::read(dir.absoluteFilePath(file)));
+        }
+    }
+
+    void test_Download()
+    {
+        QTemporaryDir dir;
+        auto javaPath = dir.filePath("java");
+        Java::ManifestDownloadTask task(m_server.url("manifest.json"), javaPath);
+        task.setNetwork(shared_qobject_ptr<QNetworkAccessManager>(new QNetworkAccessManager()));
+
+        QSignalSpy finished(&task, &Task::finished);
+        QSignalSpy succeeded(&task, &Task::succeeded);
+        task.start();
+        QVERIFY(finished.wait(30000));
+        QCOMPARE(succeeded.count(), 1);
+
+        // the same files, whichever way they came in
+        for (auto file : { "bin/java", "lib/modules", "release" }) {
+            auto raw = FS::read(FS::PathCombine(m_fixture, "raw", QString(file).replace('/', '_')));
+            QCOMPARE(FS::read(FS::PathCombine(javaPath, file)), raw);
+        }
+        QVERIFY(QDir(FS::PathCombine(javaPath, "legal")).exists());
+        QVERIFY(QFileInfo(FS::PathCombine(javaPath, "bin/java")).isExecutable());
+
+        if (Net::LzmaFileSink::isSupported()) {
+            QCOMPARE(m_server.ranges("lzma/bin_java").size(), 1);
+            QVERIFY(m_server.ranges("raw/bin_java").isEmpty());
+            // there is no compressed copy of this one on the server
+            QCOMPARE(m_server.ranges("raw/lib_modules").size(), 1);
+        } else {
+            QVERIFY(m_server.ranges("lzma/bin_java").isEmpty());
+            QCOMPARE(m_server.ranges("raw/bin_java").size(), 1);
+        }
+        QCOMPARE(m_server.ranges("raw/release").size(), 1);
+    }
+
+    void test_ReuseStored()
+    {
+        QTemporaryDir dir;
+        auto first = dir.filePath("first");
+        auto second = dir.filePath("second");
+        FS::ensureFolderPathExists(dir.path());
+        if (!Java::RuntimeStore(dir.path()).isUsable())
+            QSKIP("Files can't be linked here");
+
+        auto install = [this](const QString& path) {
+            Java::ManifestDownloadTask task(m_server.url("manifest.json"), path);
+            task.setNetwork(shared_qobject_ptr<QNetworkAccessManager>(new QNetworkAccessManager()));
+            QSignalSpy finished(&task, &Task::finished);
+            QSignalSpy succeeded(&task, &Task::succeeded);
+            task.start();
+            return finished.wait(30000) && succeeded.count() == 1;
+        };
+        QVERIFY(install(first));
+        auto requests = m_server.requestCount();
+        QVERIFY(install(second));
+        // only the manifest itself
+        QCOMPARE(m_server.requestCount(), requests + 1);
+
+        for (auto file : { "bin/java", "lib/modules", "release" }) {
+            auto raw = FS::read(FS::PathCombine(m_fixture, "raw", QString(file).replace('/', '_')));
+            QCOMPARE(FS::read(FS::PathCombine(second, file)), raw);
+        }
+        QVERIFY(QFileInfo(FS::PathCombine(second, "bin/java")).isExecutable());
+    }
+};
+
+QTEST_GUILESS_MAIN(ManifestDownloadTaskTest)
+
+#include "ManifestDownloadTask_test.moc"
@@ -0,0 +1,163 @@
+#include <QBuffer>
+#include <QTest>
+
+#include <MurmurHash2.h>
+#include <modplatform/helpers/HashUtils.h>
+#include <random>
+
+// The byte-at-a-time incremental implementation we used before the single-pass engine.
+// Kept here verbatim (minus the Reader indirection) so we can prove the fingerprints didn't change.
+static uint32_t referenceFingerprint(const QByteArray& data)
+{
+    const uint32_t m = 0x5bd1e995;
+    const int r = 24;
+    auto filter_out = [](char c) { return (c == 9 || c == 10 || c == 13 || c == 32); };
+
+    uint32_t size = 0;
+    for (char c : data)
+        if (!filter_out(c))
+            size += 1;
+
+    uint32_t h = 1 ^ size;
+    uint32_t len = size;
+    unsigned char block[4];
+    int index = 0;
+
+    auto mix = [&] {
+        if (len >= 4) {
+            uint32_t k = block[0] | (block[1] << 8) | (block[2] << 16) | (uint32_t(block[3]) << 24);
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h *= m;
+            h ^= k;
+            len -= 4;
+        } else {
+            switch (len) {
+                case 3:
+                    h ^= block[2] << 16;
+                    /* fall through */
+                case 2:
+                    h ^= block[1] << 8;
+                    /* fall through */
+                case 1:
+                    h ^= block[0];
+                    h *= m;
+            };
+            h ^= h >> 13;
+            h *= m;
+            h ^= h >> 15;
+            len = 0;
+        }
+    };
+
+    for (char c : data) {
+        if (filter_out(c))
+            continue;
+        block[index] = c;
+        index = (index + 1) % 4;
+        if (index == 0)
+            mix();
+    }
+    mix();
+
+    return h;
+}
+
+class Murmur2Test : public QObject {
+    Q_OBJECT
+   private slots:
+
+    void test_KnownFingerprints_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+        QTest::addColumn<uint32_t>("expected");
+
+        QTest::newRow("empty") << QByteArray() << uint32_t(1540447798);
+        QTest::newRow("text") << QByteArray("Hello, World!") << uint32_t(1961219979);
+        QTest::newRow("text with whitespace") << QByteArray(" \t\r\nHello,\n World! \r\n") << uint32_t(1961219979);
+    }
+
+    void test_KnownFingerprints()
+    {
+        QFETCH(QByteArray, data);
+        QFETCH(uint32_t, expected);
+
+        QCOMPARE(Murmur2::fingerprint(data.constData(), data.size()), expected);
+        QCOMPARE(Murmur2::fingerprintInPlace(data.data(), data.size()), expected);
+        QCOMPARE(referenceFingerprint(data), expected);
+    }
+
+    void test_Parity()
+    {
+        std::mt19937 eng(1337);
+        std::uniform_int_distribution<int> byte(0, 255);
+        static const char whitespace[] = { 9, 10, 13, 32 };
+
+        // cover every tail length around the 16-byte SIMD blocks, then some larger buffers
+        QList<int> sizes;
+        for (int i = 0; i < 100; i++)
+            sizes << i;
+        sizes << 1023 << 4096 << 65537 << 1024 * 1024 + 3;
+
+        for (int size : sizes) {
+            for (int density : { 0, 2, 16, 256 }) {
+                QByteArray data(size, Qt::Uninitialized);
+                for (auto& c : data) {
+                    c = static_cast<char>(byte(eng));
+                    if (density && byte(eng) % density == 0)
+                        c = whitespace[byte(eng) % 4];
+                }
+
+                auto expected = referenceFingerprint(data);
+                QCOMPARE(Murmur2::fingerprint(data.constData(), data.size()), expected);
+                QCOMPARE(Hashing::hash(data, Hashing::Algorithm::Murmur2), QString::number(expected));
+                QCOMPARE(Murmur2::fingerprintInPlace(data.data(), data.size()), expected);
+            }
+        }
+    }
+
+    void test_File()
+    {
+        QString path = QFINDTESTDATA("testdata/MojangVersionFormat/1.9.json");
+        QCOMPARE(Hashing::hash(path, Hashing::Algorithm::Murmur2), QString("3152754878"));
+    }
+
+    void test_Digests()
+    {
+        std::mt19937 eng(7);
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        // larger than the streaming chunk size, so murmur2 has to carry state across chunks
+        QByteArray data(3 * 1024 * 1024 + 17, Qt::Uninitialized);
+        for (auto& c : data)
+            c = static_cast<char>(byte(eng) % 3 == 0 ? ' ' : byte(eng));
+
+        QList<Hashing::Algorithm> algorithms{ Hashing::Algorithm::Md5, Hashing::Algorithm::Sha1, Hashing::Algorithm::Sha512,
+                                              Hashing::Algorithm::Murmur2 };
+
+        QBuffer buffer(&data);
+        auto digests = Hashing::hashes(&buffer, algorithms);
+        QCOMPARE(digests.size(), algorithms.size());
+        for (auto alg : algorithms)
+            QCOMPARE(digests.value(alg), Hashing::hash(data, alg));
+    }
+
+    void test_Benchmark()
+    {
+        std::mt19937 eng(42);
+        std::uniform_int_distribution<int> byte(0, 255);
+        QByteArray data(32 * 1024 * 1024, Qt::Uninitialized);
+        for (auto& c : data)
+            c = static_cast<char>(byte(eng));
+
+        QBENCHMARK
+        {
+            Murmur2::fingerprint(data.constData(), data.size());
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(Murmur2Test)
+
+#include "Murmur2_test.moc"
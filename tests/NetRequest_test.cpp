@@ -0,0 +1,360 @@
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+#include <random>
+
+#include <FileSystem.h>
+#include <GZip.h>
+#include <net/ChecksumValidator.h>
+#include <net/Download.h>
+#include <net/NetJob.h>
+
+#include "HttpTestServer.h"
+
+class NetRequestTest : public QObject {
+    Q_OBJECT
+
+    static QByteArray randomData(qsizetype size, unsigned seed)
+    {
+        std::mt19937 eng(seed);
+        QByteArray data(size, Qt::Uninitialized);
+        for (auto& c : data)
+            c = static_cast<char>(eng());
+        return data;
+    }
+
+    // a gzipped tar archive with a top level folder and `content` in `jdk/release`
+    static QByteArray tarGz(const QByteArray& content)
+    {
+        auto header = [](const QByteArray& name, qint64 size, char type) {
+            QByteArray block(512, '\0');
+            memcpy(block.data(), name.constData(), name.size());
+            memcpy(block.data() + 100, "0000644", 7);
+            auto octalSize = QByteArray::number(size, 8).rightJustified(11, '0');
+            memcpy(block.data() + 124, octalSize.constData(), octalSize.size());
+            block[156] = type;
+            return block;
+        };
+        auto tar = header("jdk/", 0, '5') + header("jdk/release", content.size(), '0') + content;
+        tar.append(512 - content.size() % 512, '\0');
+        tar.append(1024, '\0');
+
+        QByteArray gz;
+        GZip::zip(tar, gz);
+        return gz;
+    }
+
+    static QString sha1(const QByteArray& data) { return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex(); }
+
+    // runs the job to completion, returns whether it succeeded
+    static bool run(NetJob& job)
+    {
+        QSignalSpy finished(&job, &Task::finished);
+        QSignalSpy succeeded(&job, &Task::succeeded);
+        job.start();
+        if (finished.isEmpty() && !finished.wait(60000))
+            return false;
+        return !succeeded.isEmpty();
+    }
+
+    HttpTestServer m_server;
+    shared_qobject_ptr<QNetworkAccessManager> m_network{ new QNetworkAccessManager() };
+
+   private slots:
+    void test_LargeFile()
+    {
+        // much larger than what the pipeline may hold, so reading has to pause and resume
+        auto data = randomData(32 * 1024 * 1024 + 123, 1);
+        m_server.serve("large.bin", data);
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("large.bin");
+        NetJob job("large", m_network, 6);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeFile(m_server.url("large.bin"), path);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(data)));
+        job.addNetAction(dl);
+
+        QVERIFY(run(job));
+        QCOMPARE(FS::read(path), data);
+    }
+
+    void test_ChecksumMismatch()
+    {
+        m_server.serve("bad.bin", randomData(100000, 2));
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("bad.bin");
+        NetJob job("bad", m_network, 6);
+        job.setAskRetry(false);
+        job.setAutoRetryLimit(0);
+        auto dl = Net::Download::makeFile(m_server.url("bad.bin"), path);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1("something else")));
+        job.addNetAction(dl);
+
+        QVERIFY(!run(job));
+        QVERIFY(!QFile::exists(path));
+    }
+
+    void test_ResumeAfterDrop()
+    {
+        auto data = randomData(6 * 1024 * 1024, 3);
+        m_server.serve("resume.bin", data);
+        // the first two attempts break off, the retries have to pick up where those stopped
+        m_server.dropAfter("resume.bin", 1024 * 1024, 2);
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("resume.bin");
+        NetJob job("resume", m_network, 6);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeFile(m_server.url("resume.bin"), path, Net::Download::Option::Resumable);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(data)));
+        job.addNetAction(dl);
+
+        QVERIFY(run(job));
+        QCOMPARE(FS::read(path), data);
+        QVERIFY(!QFile::exists(path + ".part"));
+        QVERIFY(!QFile::exists(path + ".part.validator"));
+
+        auto ranges = m_server.ranges("resume.bin");
+        QCOMPARE(ranges.size(), 3);
+        QVERIFY(ranges[0].isEmpty());
+        auto first = ranges[1].mid(6).chopped(1).toLongLong();
+        auto second = ranges[2].mid(6).chopped(1).toLongLong();
+        QVERIFY(first > 0);
+        QVERIFY(second > first);
+    }
+
+    void test_RestartWhenChanged()
+    {
+        m_server.serve("changed.bin", randomData(3 * 1024 * 1024, 4));
+        m_server.dropAfter("changed.bin", 1024 * 1024);
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("changed.bin");
+        {
+            NetJob job("changed", m_network, 6);
+            job.setAskRetry(false);
+            job.setAutoRetryLimit(0);
+            job.addNetAction(Net::Download::makeFile(m_server.url("changed.bin"), path, Net::Download::Option::Resumable));
+            QVERIFY(!run(job));
+        }
+        QVERIFY(QFile::exists(path + ".part"));
+        QVERIFY(QFile::exists(path + ".part.validator"));
+
+        // the ETag doesn't match anymore, so the server sends all of the new file
+        auto data = randomData(3 * 1024 * 1024, 5);
+        m_server.serve("changed.bin", data);
+
+        NetJob job("changed", m_network, 6);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeFile(m_server.url("changed.bin"), path, Net::Download::Option::Resumable);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(data)));
+        job.addNetAction(dl);
+
+        QVERIFY(run(job));
+        QCOMPARE(FS::read(path), data);
+        QVERIFY(!m_server.ranges("changed.bin").last().isEmpty());
+        QVERIFY(!QFile::exists(path + ".part"));
+    }
+
+    void test_PruneAbandonedPartials()
+    {
+        auto data = randomData(64 * 1024, 7);
+        m_server.serve("fresh.bin", data);
+
+        QTemporaryDir dir;
+        auto old = dir.filePath("old.bin.part");
+        auto recent = dir.filePath("recent.bin.part");
+        FS::write(old, "abandoned");
+        FS::write(old + ".validator", "\"etag\"");
+        FS::write(recent, "still going");
+        for (auto file : { old, old + ".validator" }) {
+            QFile f(file);
+            QVERIFY(f.open(QIODevice::ReadWrite));
+            QVERIFY(f.setFileTime(QDateTime::currentDateTime().addDays(-8), QFileDevice::FileModificationTime));
+        }
+
+        NetJob job("fresh", m_network, 6);
+        job.setAskRetry(false);
+        job.addNetAction(Net::Download::makeFile(m_server.url("fresh.bin"), dir.filePath("fresh.bin"), Net::Download::Option::Resumable));
+        QVERIFY(run(job));
+
+        QVERIFY(!QFile::exists(old));
+        QVERIFY(!QFile::exists(old + ".validator"));
+        QVERIFY(QFile::exists(recent));
+    }
+
+    void test_TarArchive()
+    {
+        auto content = randomData(2 * 1024 * 1024 + 100, 6);
+        auto archive = tarGz(content);
+        m_server.serve("java.tar.gz", archive);
+
+        QTemporaryDir dir;
+        auto destination = dir.filePath("java");
+        FS::write(FS::PathCombine(destination, "old"), "previous install");
+
+        // a bad checksum leaves the previous install alone
+        {
+            NetJob job("tar", m_network, 6);
+            job.setAskRetry(false);
+            auto dl = Net::Download::makeTarArchive(m_server.url("java.tar.gz"), destination, true);
+            dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1("something else")));
+            job.addNetAction(dl);
+            QVERIFY(!run(job));
+        }
+        QVERIFY(QFile::exists(FS::PathCombine(destination, "old")));
+        QVERIFY(!QFile::exists(destination + ".part"));
+
+        NetJob job("tar", m_network, 6);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeTarArchive(m_server.url("java.tar.gz"), destination, true);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(archive)));
+        job.addNetAction(dl);
+        QVERIFY(run(job));
+
+        QCOMPARE(FS::read(FS::PathCombine(destination, "release")), content);
+        QVERIFY(!QFile::exists(FS::PathCombine(destination, "old")));
+        QVERIFY(!QFile::exists(destination + ".part"));
+    }
+
+    void test_ResumeTarArchive()
+    {
+        auto content = randomData(3 * 1024 * 1024, 8);
+        auto archive = tarGz(content);
+        m_server.serve("resume.tar.gz", archive);
+        m_server.dropAfter("resume.tar.gz", archive.size() / 2);
+
+        QTemporaryDir dir;
+        auto destination = dir.filePath("java");
+        NetJob job("tar", m_network, 6);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeTarArchive(m_server.url("resume.tar.gz"), destination, true, Net::Download::Option::Resumable);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(archive)));
+        job.addNetAction(dl);
+        QVERIFY(run(job));
+
+        QCOMPARE(FS::read(FS::PathCombine(destination, "release")), content);
+        auto ranges = m_server.ranges("resume.tar.gz");
+        QCOMPARE(ranges.size(), 2);
+        QVERIFY(!ranges[1].isEmpty());
+        // neither the staging folder nor the archive are left behind
+        QVERIFY(!QFile::exists(destination + ".part"));
+        QVERIFY(!QFile::exists(destination + ".archive"));
+        QVERIFY(!QFile::exists(destination + ".archive.part"));
+    }
+
+    void test_SharedTransfer()
+    {
+        auto data = randomData(8 * 1024 * 1024, 7);
+        m_server.serve("shared.bin", data);
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("shared.bin");
+        auto makeJob = [&] {
+            auto job = makeShared<NetJob>("shared", m_network, 6);
+            job->setAskRetry(false);
+            auto dl = Net::Download::makeFile(m_server.url("shared.bin"), path);
+            dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(data)));
+            job->addNetAction(dl);
+            return job;
+        };
+        auto first = makeJob();
+        auto second = makeJob();
+        QSignalSpy firstDone(first.get(), &Task::succeeded);
+        QSignalSpy secondDone(second.get(), &Task::succeeded);
+
+        auto requests = m_server.requestCount();
+        auto shared = Net::NetRequest::sharedTransfers();
+        first->start();
+        second->start();
+        QTRY_COMPARE_WITH_TIMEOUT(firstDone.count() + secondDone.count(), 2, 60000);
+
+        QCOMPARE(m_server.requestCount(), requests + 1);
+        QCOMPARE(Net::NetRequest::sharedTransfers(), shared + 1);
+        QCOMPARE(FS::read(path), data);
+
+        // once it's done, the same thing can be transferred again
+        QVERIFY(run(*makeJob()));
+        QCOMPARE(m_server.requestCount(), requests + 2);
+    }
+
+    void test_FinalProgressWithoutLength()
+    {
+        auto data = randomData(4 * 1024 * 1024, 10);
+        m_server.serve("unsized.bin", data);
+        m_server.hideLength("unsized.bin");
+
+        QTemporaryDir dir;
+        NetJob job("unsized", m_network, 1);
+        job.setAskRetry(false);
+        auto dl = Net::Download::makeFile(m_server.url("unsized.bin"), dir.filePath("unsized.bin"));
+        QSignalSpy progress(dl.get(), &Task::progress);
+        job.addNetAction(dl);
+
+        QVERIFY(run(job));
+        // the total is never known, but the last update still has everything
+        QVERIFY(!progress.isEmpty());
+        QCOMPARE(progress.last().at(0).toLongLong(), qint64(data.size()));
+    }
+
+    void test_SharedTransferValidates()
+    {
+        auto data = randomData(1024 * 1024, 8);
+        m_server.serve("checked.bin", data);
+
+        QTemporaryDir dir;
+        auto path = dir.filePath("checked.bin");
+        auto makeJob = [&](const QByteArray& expected) {
+            auto job = makeShared<NetJob>("shared", m_network, 6);
+            job->setAskRetry(false);
+            auto dl = Net::Download::makeFile(m_server.url("checked.bin"), path);
+            dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, expected));
+            job->addNetAction(dl);
+            return job;
+        };
+        auto first = makeJob(sha1(data));
+        // expects something else from the same URL, which the shared transfer doesn't give it
+        auto second = makeJob(sha1(randomData(1024, 9)));
+        second->setAutoRetryLimit(0);
+        QSignalSpy firstDone(first.get(), &Task::succeeded);
+        QSignalSpy secondFailed(second.get(), &Task::failed);
+
+        auto requests = m_server.requestCount();
+        first->start();
+        second->start();
+        QTRY_COMPARE_WITH_TIMEOUT(firstDone.count() + secondFailed.count(), 2, 60000);
+
+        QCOMPARE(m_server.requestCount(), requests + 1);
+        QCOMPARE(FS::read(path), data);
+    }
+
+    void test_Benchmark_SmallObjects()
+    {
+        // about what an asset download looks like
+        const int count = 3000;
+        for (int i = 0; i < count; i++)
+            m_server.serve(QString("objects/%1").arg(i), randomData(4096 + i % 1024, i));
+
+        QBENCHMARK_ONCE
+        {
+            QTemporaryDir dir;
+            NetJob job("objects", m_network, 32);
+            job.setAskRetry(false);
+            for (int i = 0; i < count; i++) {
+                auto name = QString("objects/%1").arg(i);
+                auto dl = Net::Download::makeFile(m_server.url(name), dir.filePath(name));
+                dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, sha1(randomData(4096 + i % 1024, i))));
+                job.addNetAction(dl);
+            }
+            QVERIFY(run(job));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(NetRequestTest)
+
+#include "NetRequest_test.moc"
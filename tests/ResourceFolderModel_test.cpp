@@ -33,15 +33,25 @@
  *      limitations under the License.
  */
 
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QImage>
+#include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTest>
 #include <QTimer>
 #include "BaseInstance.h"
 
 #include <FileSystem.h>
+#include <quazip/quazip.h>
+#include <quazip/quazipfile.h>
 
 #include <minecraft/mod/ModFolderModel.h>
 #include <minecraft/mod/ResourceFolderModel.h>
+#include <minecraft/mod/ResourcePackFolderModel.h>
+#include <minecraft/mod/tasks/LocalModParseTask.h>
+#include <minecraft/mod/tasks/ModParsePipeline.h>
 
 #define EXEC_UPDATE_TASK(EXEC, VERIFY)                                                  \
     QEventLoop loop;                                                                    \
@@ -64,6 +74,32 @@
 class ResourceFolderModelTest : public QObject {
     Q_OBJECT
 
+    // a fabric mod with a 128x128 icon
+    static bool writeMod(const QString& path, int i)
+    {
+        QImage image(128, 128, QImage::Format_ARGB32);
+        image.fill(QColor(i % 256, 0, 0));
+        QByteArray icon;
+        QBuffer buffer(&icon);
+        if (!buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, "PNG"))
+            return false;
+
+        auto metadata = QString(R"({"schemaVersion": 1, "id": "mod%1", "name": "Mod %1", "version": "1.%1", "icon": "icon.png"})").arg(i);
+
+        QuaZip zip(path);
+        if (!zip.open(QuaZip::mdCreate))
+            return false;
+        for (auto const& [name, data] :
+             { std::pair(QString("fabric.mod.json"), metadata.toUtf8()), std::pair(QString("icon.png"), icon) }) {
+            QuaZipFile file(&zip);
+            if (!file.open(QIODevice::WriteOnly, QuaZipNewInfo(name)) || file.write(data) != data.size())
+                return false;
+            file.close();
+        }
+        zip.close();
+        return zip.getZipError() == ZIP_OK;
+    }
+
    private slots:
     // test for GH-1178 - install a folder with files to a mod list
     void test_1178()
@@ -243,6 +279,203 @@ class ResourceFolderModelTest : public QObject {
         QVERIFY(res_2.enabled() == initial_enabled_res_2);
         QVERIFY(res_2.internal_id() == id_2);
     }
+
+    void test_parseCache()
+    {
+        QTemporaryDir tmp;
+        QString packs = FS::PathCombine(tmp.path(), "resourcepacks");
+        QString pack = FS::PathCombine(packs, "test_resource_pack_idk.zip");
+        QString cache = FS::PathCombine(tmp.path(), "cache", "resourcepacks.dat");
+        QVERIFY(FS::ensureFolderPathExists(packs));
+        QVERIFY(QFile::copy(QFINDTESTDATA("testdata/ResourceFolderModel/test_resource_pack_idk.zip"), pack));
+
+        QString description;
+        {
+            ResourcePackFolderModel model(packs, nullptr);
+            model.setParseCache(cache);
+            { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+            QCOMPARE(model.size(), 1);
+            QVERIFY(model.hasPendingParseTasks());
+            QTRY_VERIFY_WITH_TIMEOUT(!model.hasPendingParseTasks(), 4000);
+            QCOMPARE(model[0]->packFormat(), 3);
+            description = model[0]->description();
+        }
+        QVERIFY(QFileInfo::exists(cache));
+
+        // the pack didn't change, so it doesn't need to be parsed again
+        {
+            ResourcePackFolderModel model(packs, nullptr);
+            model.setParseCache(cache);
+            { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+            QCOMPARE(model.size(), 1);
+            QVERIFY(!model.hasPendingParseTasks());
+            QCOMPARE(model[0]->packFormat(), 3);
+            QCOMPARE(model[0]->description(), description);
+        }
+
+        // disabling it only renames it, that's not a reason to parse it again either
+        QVERIFY(QFile::rename(pack, pack + ".disabled"));
+        {
+            ResourcePackFolderModel model(packs, nullptr);
+            model.setParseCache(cache);
+            { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+            QCOMPARE(model.size(), 1);
+            QVERIFY(!model[0]->enabled());
+            QVERIFY(!model.hasPendingParseTasks());
+            QCOMPARE(model[0]->description(), description);
+        }
+        QVERIFY(QFile::rename(pack + ".disabled", pack));
+
+        // now it did
+        {
+            QFile file(pack);
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+        }
+        {
+            ResourcePackFolderModel model(packs, nullptr);
+            model.setParseCache(cache);
+            { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+            QCOMPARE(model.size(), 1);
+            QVERIFY(model.hasPendingParseTasks());
+            QTRY_VERIFY_WITH_TIMEOUT(!model.hasPendingParseTasks(), 4000);
+            QCOMPARE(model[0]->packFormat(), 3);
+        }
+    }
+
+    void test_incrementalUpdate()
+    {
+        QTemporaryDir tmp;
+        for (int i = 0; i < 10; i++) {
+            QFile file(FS::PathCombine(tmp.path(), QString("mod%1.jar").arg(i)));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(i + 1, 'x'));
+        }
+
+        ModFolderModel model(tmp.path(), nullptr);
+        { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+        QCOMPARE(model.size(), 10);
+        QTRY_VERIFY_WITH_TIMEOUT(!model.hasPendingParseTasks(), 4000);
+
+        QHash<QString, Resource*> loaded;
+        for (auto const& res : model.all())
+            loaded.insert(res->internal_id(), res.get());
+
+        QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+
+        // disabling a mod behind the model's back only touches that one row
+        QVERIFY(QFile::rename(FS::PathCombine(tmp.path(), "mod3.jar"), FS::PathCombine(tmp.path(), "mod3.jar.disabled")));
+        { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+        QCOMPARE(model.size(), 10);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(inserted.size(), 1);
+        QVERIFY(model.find("mod3.jar.disabled"));
+        QVERIFY(!model.find("mod3.jar"));
+        for (auto const& res : model.all()) {
+            if (res->internal_id() != "mod3.jar.disabled")
+                QCOMPARE(res.get(), loaded.value(res->internal_id()));
+        }
+
+        // a mod that changed gets loaded again, in its row
+        {
+            QFile file(FS::PathCombine(tmp.path(), "mod5.jar"));
+            QVERIFY(file.open(QIODevice::Append));
+            file.write("more");
+            QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+        }
+        { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+
+        QCOMPARE(model.size(), 10);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(inserted.size(), 1);
+        QVERIFY(static_cast<Resource*>(model.find("mod5.jar")) != loaded.value("mod5.jar"));
+        QCOMPARE(static_cast<Resource*>(model.find("mod4.jar")), loaded.value("mod4.jar"));
+
+        // and nothing happens when nothing changed
+        { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(inserted.size(), 1);
+    }
+
+    void test_parsePipeline()
+    {
+        const int mods = 300;
+        QTemporaryDir tmp;
+        for (int i = 0; i < mods; i++)
+            QVERIFY(writeMod(FS::PathCombine(tmp.path(), QString("mod%1.jar").arg(i)), i));
+
+        ModFolderModel model(tmp.path(), nullptr);
+        QSignalSpy parsed(&model, &ResourceFolderModel::parseFinished);
+        QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+        { EXEC_UPDATE_TASK(model.update(), QVERIFY) }
+        QCOMPARE(model.size(), mods);
+        QTRY_VERIFY_WITH_TIMEOUT(!model.hasPendingParseTasks(), 10000);
+
+        for (auto mod : model.allMods()) {
+            QVERIFY(mod->valid());
+            auto i = mod->details().mod_id.mid(3);
+            QCOMPARE(mod->name(), "Mod " + i);
+            QCOMPARE(mod->version(), "1." + i);
+            QCOMPARE(mod->iconPath(), QString("icon.png"));
+        }
+
+        // the results come in batches, not one by one
+        QVERIFY(parsed.size() < mods);
+        QVERIFY(changed.size() <= parsed.size());
+
+        // the icon is left alone until the mod gets shown
+        QByteArray icon;
+        QVERIFY(ModUtils::readIconFile(ResourceType::ZIPFILE, QFileInfo(FS::PathCombine(tmp.path(), "mod7.jar")), "icon.png", icon));
+        QCOMPARE(QImage::fromData(icon, "PNG").size(), QSize(128, 128));
+    }
+
+    void test_parsePipelineAbort()
+    {
+        QTemporaryDir tmp;
+        QList<LocalModParseTask::Ptr> tasks;
+        for (int i = 0; i < 4; i++) {
+            auto path = FS::PathCombine(tmp.path(), QString("mod%1.jar").arg(i));
+            QVERIFY(writeMod(path, i));
+            tasks.append(makeShared<LocalModParseTask>(i, ResourceType::ZIPFILE, QFileInfo(path)));
+        }
+
+        ModParsePipeline pipeline;
+        pipeline.setMaxInFlight(1);
+        QSignalSpy aborted(tasks[3].get(), &Task::aborted);
+        QList<LocalModParseTask::Ptr> out;
+        connect(&pipeline, &ModParsePipeline::finished, this, [&out](QList<LocalModParseTask::Ptr> batch) { out += batch; });
+
+        // aborted before it had its turn
+        tasks[3]->abort();
+        for (auto const& task : tasks)
+            pipeline.add(task);
+        QVERIFY(pipeline.isBusy());
+        QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 10000);
+
+        // all of them came out, and are done like any other task
+        QCOMPARE(out.size(), tasks.size());
+        QCOMPARE(aborted.size(), 1);
+        for (int i = 0; i < 3; i++) {
+            QVERIFY(tasks[i]->wasSuccessful());
+            QCOMPARE(tasks[i]->result()->details.mod_id, QString("mod%1").arg(i));
+        }
+        QVERIFY(tasks[3]->isFinished());
+        QVERIFY(!tasks[3]->wasSuccessful());
+
+        // the ones still going when the pipeline goes away get aborted
+        auto leftover = makeShared<LocalModParseTask>(4, ResourceType::ZIPFILE, QFileInfo(FS::PathCombine(tmp.path(), "mod0.jar")));
+        {
+            ModParsePipeline doomed;
+            doomed.add(leftover);
+        }
+        QVERIFY(leftover->isFinished());
+    }
 };
 
 QTEST_GUILESS_MAIN(ResourceFolderModelTest)
@@ -0,0 +1,132 @@
+#include <QCryptographicHash>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <java/download/RuntimeStore.h>
+
+class RuntimeStoreTest : public QObject {
+    Q_OBJECT
+
+    static int objectCount(const Java::RuntimeStore& store)
+    {
+        int count = 0;
+        QDir root(store.path());
+        for (const auto& prefix : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            if (prefix.size() == 2)
+                count += QDir(root.absoluteFilePath(prefix)).entryList(QDir::Files).size();
+        }
+        return count;
+    }
+
+    static void makeRuntime(const QString& path, const QByteArray& release)
+    {
+        FS::write(FS::PathCombine(path, "legal", "LICENSE"), "GPLv2 with the classpath exception");
+        FS::write(FS::PathCombine(path, "conf", "security", "java.security"), "securerandom.source=file:/dev/random");
+        FS::write(FS::PathCombine(path, "release"), release);
+    }
+
+   private slots:
+    void test_Ingest()
+    {
+        QTemporaryDir dir;
+        Java::RuntimeStore store(dir.path());
+        if (!store.isUsable())
+            QSKIP("Files can't be linked here");
+
+        auto first = dir.filePath("first");
+        auto second = dir.filePath("second");
+        makeRuntime(first, "JAVA_VERSION=\"17.0.1\"");
+        makeRuntime(second, "JAVA_VERSION=\"17.0.2\"");
+
+        QVERIFY(store.ingest(first));
+        QCOMPARE(objectCount(store), 3);
+        QVERIFY(store.ingest(second));
+        // the license and the security config are shared
+        QCOMPARE(objectCount(store), 4);
+
+        QCOMPARE(FS::read(FS::PathCombine(second, "legal", "LICENSE")), QByteArray("GPLv2 with the classpath exception"));
+        QCOMPARE(FS::read(FS::PathCombine(second, "release")), QByteArray("JAVA_VERSION=\"17.0.2\""));
+        QVERIFY(!QFileInfo::exists(FS::PathCombine(second, "release.tmp")));
+
+        // nothing is gone, so nothing gets collected
+        QCOMPARE(store.collectGarbage(), 0);
+
+        QVERIFY(FS::deletePath(first));
+        QCOMPARE(store.collectGarbage(), 1);
+        QCOMPARE(objectCount(store), 3);
+        // the files of the runtime that's left are still there
+        QCOMPARE(FS::read(FS::PathCombine(second, "legal", "LICENSE")), QByteArray("GPLv2 with the classpath exception"));
+
+        QVERIFY(FS::deletePath(second));
+        QCOMPARE(store.collectGarbage(), 3);
+        QCOMPARE(objectCount(store), 0);
+        QVERIFY(QDir(FS::PathCombine(store.path(), "refs")).entryList(QDir::Files).isEmpty());
+    }
+
+    void test_Permissions()
+    {
+        QTemporaryDir dir;
+        Java::RuntimeStore store(dir.path());
+        if (!store.isUsable())
+            QSKIP("Files can't be linked here");
+
+        auto first = dir.filePath("first");
+        auto second = dir.filePath("second");
+        for (const auto& runtime : { first, second }) {
+            makeRuntime(runtime, "JAVA_VERSION=\"17.0.1\"");
+            auto java = FS::PathCombine(runtime, "bin", "java");
+            FS::write(java, "#!/bin/sh");
+            QFile::setPermissions(java, QFile::permissions(java) | QFileDevice::ExeUser);
+        }
+        auto license = FS::PathCombine(first, "legal", "LICENSE");
+        auto permissions = QFile::permissions(license);
+
+        QVERIFY(store.ingest(first));
+        QVERIFY(store.ingest(second));
+
+        // the executables have their own permissions, and the objects stay as they were
+        QVERIFY(QFileInfo(FS::PathCombine(second, "bin", "java")).isExecutable());
+        QVERIFY(QFileInfo(FS::PathCombine(first, "bin", "java")).isExecutable());
+        QCOMPARE(QFile::permissions(license), permissions);
+        for (const auto& prefix : QDir(store.path()).entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QDir objects(FS::PathCombine(store.path(), prefix));
+            for (const auto& object : objects.entryList(QDir::Files))
+                QVERIFY(!QFileInfo(objects.absoluteFilePath(object)).isExecutable());
+        }
+
+        auto target = dir.filePath("third/bin/java");
+        auto sha1 = QString::fromLatin1(QCryptographicHash::hash("#!/bin/sh", QCryptographicHash::Sha1).toHex());
+        QVERIFY(store.materialize(sha1, target, true));
+        QVERIFY(QFileInfo(target).isExecutable());
+        QCOMPARE(FS::hardLinkCount(target), uintmax_t(1));
+    }
+
+    void test_Materialize()
+    {
+        QTemporaryDir dir;
+        Java::RuntimeStore store(dir.path());
+        if (!store.isUsable())
+            QSKIP("Files can't be linked here");
+
+        auto file = dir.filePath("first/bin/java");
+        FS::write(file, "#!/bin/sh");
+        const QString sha1 = "6c1ea8a06a9dd22cc3f77d8a2e6f79e7d2e1a0fb";  // doesn't matter, it's just a name here
+        QVERIFY(!store.has(sha1));
+        QVERIFY(store.adopt(file, sha1));
+        QVERIFY(store.has(sha1));
+
+        auto target = dir.filePath("second/bin/java");
+        FS::write(target, "something else");
+        QVERIFY(store.materialize(sha1, target));
+        QCOMPARE(FS::read(target), QByteArray("#!/bin/sh"));
+
+        // not a SHA-1, doesn't go in
+        QVERIFY(!store.adopt(file, "../../escape"));
+    }
+};
+
+QTEST_GUILESS_MAIN(RuntimeStoreTest)
+
+#include "RuntimeStore_test.moc"
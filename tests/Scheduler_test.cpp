@@ -0,0 +1,228 @@
+#include <QDateTime>
+#include <QLocale>
+#include <QTest>
+
+#include <net/Scheduler.h>
+
+using Net::Scheduler;
+
+class SchedulerTest : public QObject {
+    Q_OBJECT
+
+    struct Submitted {
+        quint64 ticket;
+        std::shared_ptr<bool> started;
+    };
+
+    Submitted submit(const QString& host, Scheduler::Priority priority = Scheduler::Priority::Normal, QObject* context = nullptr)
+    {
+        auto started = std::make_shared<bool>(false);
+        auto ticket = Scheduler::instance().submit(context ? context : this, host, priority, [started] { *started = true; });
+        return { ticket, started };
+    }
+
+    static int startedCount(const QList<Submitted>& submitted)
+    {
+        int count = 0;
+        for (const auto& s : submitted)
+            count += *s.started ? 1 : 0;
+        return count;
+    }
+
+    static void finishAll(const QList<Submitted>& submitted)
+    {
+        for (const auto& s : submitted)
+            Scheduler::instance().finish(s.ticket);
+        QCoreApplication::processEvents();
+        QCOMPARE(Scheduler::instance().active(), 0);
+        QCOMPARE(Scheduler::instance().waiting(), 0);
+    }
+
+   private slots:
+    void test_HostLimit()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(4, 2);
+
+        QList<Submitted> a, b;
+        for (int i = 0; i < 3; i++)
+            a << submit("a.example");
+        for (int i = 0; i < 3; i++)
+            b << submit("b.example");
+        QCoreApplication::processEvents();
+
+        QCOMPARE(startedCount(a), 2);
+        QCOMPARE(startedCount(b), 2);
+        QCOMPARE(scheduler.active(), 4);
+
+        // the slot goes to the host that has room, in order
+        scheduler.finish(a[0].ticket, { 200, false, 1024, 0 });
+        QCoreApplication::processEvents();
+        QVERIFY(*a[2].started);
+        QVERIFY(!*b[2].started);
+
+        finishAll(a + b);
+    }
+
+    void test_Priority()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(4, 4);
+
+        QList<Submitted> bulk;
+        for (int i = 0; i < 4; i++)
+            bulk << submit(QString("bulk%1.example").arg(i), Scheduler::Priority::Bulk);
+        QCoreApplication::processEvents();
+        // a quarter of the budget stays free
+        QCOMPARE(startedCount(bulk), 3);
+
+        auto interactive = submit("meta.example", Scheduler::Priority::Interactive);
+        QCoreApplication::processEvents();
+        QVERIFY(*interactive.started);
+        QCOMPARE(startedCount(bulk), 3);
+
+        finishAll(bulk << interactive);
+    }
+
+    void test_Raise()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(4, 1);
+
+        auto running = submit("a.example", Scheduler::Priority::Bulk);
+        QCoreApplication::processEvents();
+        QVERIFY(*running.started);
+        auto normal = submit("a.example");
+        auto bulk = submit("a.example", Scheduler::Priority::Bulk);
+        QCoreApplication::processEvents();
+
+        // something interactive waits for the bulk one now
+        scheduler.raise(bulk.ticket, Scheduler::Priority::Interactive);
+        // and lowering does nothing
+        scheduler.raise(bulk.ticket, Scheduler::Priority::Bulk);
+        scheduler.finish(running.ticket);
+        QCoreApplication::processEvents();
+        QVERIFY(*bulk.started);
+        QVERIFY(!*normal.started);
+
+        // the old queue entry doesn't start it twice
+        scheduler.finish(bulk.ticket);
+        QCoreApplication::processEvents();
+        QVERIFY(*normal.started);
+        QCOMPARE(scheduler.active(), 1);
+
+        finishAll({ normal });
+    }
+
+    void test_Backoff()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(8, 4);
+
+        QList<Submitted> requests;
+        for (int i = 0; i < 4; i++)
+            requests << submit("busy.example");
+        QCoreApplication::processEvents();
+        QCOMPARE(startedCount(requests), 4);
+
+        scheduler.finish(requests.takeFirst().ticket, { 429, false, 0, 0 });
+        QCOMPARE(scheduler.hostLimit("busy.example"), 2);
+        scheduler.finish(requests.takeFirst().ticket, { 503, false, 0, 0 });
+        QCOMPARE(scheduler.hostLimit("busy.example"), 1);
+
+        // two still running, over the new limit, so nothing new goes out until they're done
+        auto next = submit("busy.example");
+        requests << next;
+        QCoreApplication::processEvents();
+        QVERIFY(!*next.started);
+
+        // and it grows back while the host keeps up
+        scheduler.finish(requests.takeFirst().ticket, { 200, false, 1024, 0 });
+        scheduler.finish(requests.takeFirst().ticket, { 200, false, 1024, 0 });
+        QCoreApplication::processEvents();
+        QVERIFY(*next.started);
+        QVERIFY(scheduler.hostLimit("busy.example") > 1);
+
+        finishAll(requests);
+    }
+
+    void test_RetryAfter()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(8, 4);
+
+        auto first = submit("slow.example");
+        QCoreApplication::processEvents();
+        QVERIFY(*first.started);
+        scheduler.finish(first.ticket, { 429, false, 0, 1 });
+
+        auto second = submit("slow.example");
+        QCoreApplication::processEvents();
+        QVERIFY(!*second.started);
+        QTRY_VERIFY_WITH_TIMEOUT(*second.started, 3000);
+
+        finishAll({ second });
+    }
+
+    void test_ParseRetryAfter()
+    {
+        QCOMPARE(Scheduler::parseRetryAfter("5"), 5);
+        QCOMPARE(Scheduler::parseRetryAfter(" 12 "), 12);
+        QCOMPARE(Scheduler::parseRetryAfter("soon"), 0);
+
+        auto later = QDateTime::currentDateTimeUtc().addSecs(30);
+        auto httpDate = QLocale::c().toString(later, "ddd, dd MMM yyyy hh:mm:ss 'GMT'").toLatin1();
+        auto seconds = Scheduler::parseRetryAfter(httpDate);
+        QVERIFY2(seconds >= 28 && seconds <= 30, httpDate.constData());
+
+        auto earlier = QDateTime::currentDateTimeUtc().addSecs(-30);
+        QCOMPARE(Scheduler::parseRetryAfter(earlier.toString(Qt::RFC2822Date).toLatin1()), 0);
+    }
+
+    void test_Cancel()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(1, 1);
+
+        auto running = submit("cancel.example");
+        auto cancelled = submit("cancel.example");
+        auto next = submit("cancel.example");
+        QCoreApplication::processEvents();
+        QVERIFY(*running.started);
+        QCOMPARE(scheduler.waiting(), 2);
+
+        scheduler.finish(cancelled.ticket);
+        QCOMPARE(scheduler.waiting(), 1);
+
+        scheduler.finish(running.ticket);
+        QCoreApplication::processEvents();
+        QVERIFY(!*cancelled.started);
+        QVERIFY(*next.started);
+
+        finishAll({ next });
+    }
+
+    void test_ContextGone()
+    {
+        auto& scheduler = Scheduler::instance();
+        scheduler.setLimits(1, 1);
+
+        auto running = submit("gone.example");
+        auto context = new QObject();
+        auto waiting = submit("gone.example", Scheduler::Priority::Normal, context);
+        QCoreApplication::processEvents();
+        QVERIFY(*running.started);
+        QVERIFY(!*waiting.started);
+
+        delete context;
+        scheduler.finish(running.ticket);
+        QCoreApplication::processEvents();
+        QVERIFY(!*waiting.started);
+        QCOMPARE(scheduler.waiting(), 0);
+        QCOMPARE(scheduler.active(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(SchedulerTest)
+
+#include "Scheduler_test.moc"
@@ -0,0 +1,165 @@
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <FileSystem.h>
+#include <GZip.h>
+#include <Untar.h>
+
+class UntarTest : public QObject {
+    Q_OBJECT
+
+    static QByteArray header(const QByteArray& name, qint64 size, char type, const QByteArray& link = {})
+    {
+        QByteArray block(512, '\0');
+        auto put = [&block](int offset, const QByteArray& value) { memcpy(block.data() + offset, value.constData(), value.size()); };
+        put(0, name.left(100));
+        put(100, "0000644");
+        put(108, "0000000");
+        put(116, "0000000");
+        put(124, QByteArray::number(size, 8).rightJustified(11, '0'));
+        put(136, "00000000000");
+        block[156] = type;
+        put(157, link.left(100));
+        put(257, "ustar  ");
+
+        // the checksum is calculated with the checksum field set to spaces
+        put(148, "        ");
+        unsigned sum = 0;
+        for (auto c : block)
+            sum += static_cast<unsigned char>(c);
+        put(148, QByteArray::number(sum, 8).rightJustified(6, '0') + '\0');
+        return block;
+    }
+
+    static QByteArray padded(QByteArray data)
+    {
+        if (data.size() % 512)
+            data.append(512 - data.size() % 512, '\0');
+        return data;
+    }
+
+    static QByteArray file(const QByteArray& name, const QByteArray& content)
+    {
+        return header(name, content.size(), '0') + padded(content);
+    }
+
+    // what a JDK tarball looks like: one top level folder, which gets stripped
+    static QByteArray archive()
+    {
+        QByteArray longName = "jdk/" + QByteArray(150, 'n') + ".txt";
+        QByteArray big(100000, Qt::Uninitialized);
+        for (int i = 0; i < big.size(); i++)
+            big[i] = static_cast<char>(i * 7);
+
+        QByteArray tar;
+        tar += header("jdk/", 0, '5');
+        tar += header("jdk/bin/", 0, '5');
+        tar += file("jdk/bin/java", "#!/bin/sh\n");
+        tar += file("jdk/lib/modules", big);
+        tar += file("jdk/empty", "");
+        // a pax header, whose data has to be skipped
+        tar += header("./PaxHeaders/x", 30, 'x') + padded("30 comment=some extra data\n\n\n");
+        tar += header("././@LongLink", longName.size() + 1, 'L') + padded(longName + '\0');
+        tar += file(longName.left(100), "long");
+        tar += QByteArray(1024, '\0');
+        return tar;
+    }
+
+    static void verify(const QString& dir)
+    {
+        QCOMPARE(FS::read(FS::PathCombine(dir, "bin/java")), QByteArray("#!/bin/sh\n"));
+        QCOMPARE(FS::read(FS::PathCombine(dir, "lib/modules")).size(), 100000);
+        QCOMPARE(FS::read(FS::PathCombine(dir, "lib/modules")).at(99999), static_cast<char>(99999 * 7));
+        QVERIFY(QFile::exists(FS::PathCombine(dir, "empty")));
+        QCOMPARE(FS::read(FS::PathCombine(dir, QString(150, 'n') + ".txt")), QByteArray("long"));
+        QVERIFY(!QFile::exists(FS::PathCombine(dir, "jdk")));
+    }
+
+   private slots:
+    void test_Extract()
+    {
+        auto tar = archive();
+        QBuffer buffer(&tar);
+        buffer.open(QIODevice::ReadOnly);
+
+        QTemporaryDir dir;
+        QVERIFY(Tar::extract(&buffer, dir.path()));
+        verify(dir.path());
+    }
+
+    void test_Stream_data()
+    {
+        QTest::addColumn<int>("chunkSize");
+        QTest::newRow("1") << 1;
+        QTest::newRow("511") << 511;
+        QTest::newRow("512") << 512;
+        QTest::newRow("4099") << 4099;
+        QTest::newRow("all at once") << 1024 * 1024;
+    }
+
+    void test_Stream()
+    {
+        QFETCH(int, chunkSize);
+
+        QByteArray gz;
+        QVERIFY(GZip::zip(archive(), gz));
+
+        QTemporaryDir dir;
+        GZTar::Extractor extractor(dir.path());
+        for (int i = 0; i < gz.size(); i += chunkSize) {
+            QVERIFY(!extractor.isFinished());
+            QVERIFY(extractor.write(gz.mid(i, chunkSize)));
+        }
+        QVERIFY(extractor.isFinished());
+        verify(dir.path());
+    }
+
+    void test_Truncated()
+    {
+        auto tar = archive();
+
+        QTemporaryDir dir;
+        Tar::Extractor extractor(dir.path());
+        QVERIFY(extractor.write(tar.constData(), tar.size() / 2));
+        QVERIFY(!extractor.isFinished());
+
+        QByteArray broken = tar.left(tar.size() / 2);
+        QBuffer buffer(&broken);
+        buffer.open(QIODevice::ReadOnly);
+        QVERIFY(!Tar::extract(&buffer, dir.path()));
+    }
+
+    void test_OutsideDestination_data()
+    {
+        QTest::addColumn<QByteArray>("entry");
+        QTest::newRow("file") << file("jdk/../escaped", "boo");
+        QTest::newRow("absolute") << file("/tmp/escaped", "boo");
+        QTest::newRow("link") << header("jdk/link", 0, '2', "../../escaped");
+    }
+
+    void test_OutsideDestination()
+    {
+        QFETCH(QByteArray, entry);
+
+        QTemporaryDir dir;
+        auto destination = FS::PathCombine(dir.path(), "java");
+        QByteArray tar = header("jdk/", 0, '5') + entry + QByteArray(1024, '\0');
+        QBuffer buffer(&tar);
+        buffer.open(QIODevice::ReadOnly);
+        QVERIFY(!Tar::extract(&buffer, destination));
+        QVERIFY(!QFile::exists(FS::PathCombine(dir.path(), "escaped")));
+        QVERIFY(!QFile::exists("/tmp/escaped"));
+    }
+
+    void test_Corrupt()
+    {
+        QTemporaryDir dir;
+        GZTar::Extractor extractor(dir.path());
+        QVERIFY(!extractor.write(QByteArray(1000, 'x')));
+    }
+};
+
+QTEST_GUILESS_MAIN(UntarTest)
+
+#include "Untar_test.moc"
@@ -0,0 +1,245 @@
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+#include <quazip/quazip.h>
+#include <quazip/quazipfile.h>
+#include <zlib.h>
+
+#include <MMCZip.h>
+#include <ZipReader.h>
+
+struct ZipEntry {
+    QString name;
+    QByteArray data;
+    bool deflate = true;
+};
+
+static bool writeZip(const QString& path, const QList<ZipEntry>& entries)
+{
+    QuaZip zip(path);
+    if (!zip.open(QuaZip::mdCreate))
+        return false;
+    for (auto const& entry : entries) {
+        QuaZipFile file(&zip);
+        if (!file.open(QIODevice::WriteOnly, QuaZipNewInfo(entry.name), nullptr, 0, entry.deflate ? Z_DEFLATED : 0))
+            return false;
+        if (file.write(entry.data) != entry.data.size())
+            return false;
+        file.close();
+    }
+    zip.close();
+    return zip.getZipError() == ZIP_OK;
+}
+
+// what processZIP in LocalModParseTask looks for, in its order
+static const QStringList s_mod_metadata = { "META-INF/mods.toml", "META-INF/neoforge.mods.toml", "mcmod.info", "quilt.mod.json",
+                                            "fabric.mod.json" };
+
+class ZipReaderTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+
+    QString jar()
+    {
+        auto path = m_dir.filePath("mod.jar");
+        if (QFile::exists(path))
+            return path;
+
+        // shaped like a mod: lots of classes, a few resources and the metadata last
+        QList<ZipEntry> entries;
+        for (int i = 0; i < 3000; i++)
+            entries.append({ QString("net/example/mod/Class%1.class").arg(i), QByteArray(512 + i % 1024, char(i)) });
+        entries.append({ "assets/example/icon.png", QByteArray(4096, 'p'), false });
+        entries.append({ "fabric.mod.json", R"({"schemaVersion": 1, "id": "example", "version": "1.0"})" });
+        if (!writeZip(path, entries))
+            return {};
+        return path;
+    }
+
+   private slots:
+    void test_Read()
+    {
+        auto path = m_dir.filePath("read.zip");
+        QByteArray big;
+        for (int i = 0; i < 100000; i++)
+            big += QByteArray::number(i);
+        QVERIFY(writeZip(path, { { "stored.txt", "stored data", false },
+                                 { "deflated.txt", big },
+                                 { "empty.txt", "" },
+                                 { "assets/", "", false },
+                                 { "data/example/thing.json", "{}" } }));
+
+        ZipReader zip(path);
+        QVERIFY(zip.open());
+        QCOMPARE(zip.count(), 5);
+        QCOMPARE(zip.fileNames(), QStringList({ "stored.txt", "deflated.txt", "empty.txt", "assets/", "data/example/thing.json" }));
+
+        QCOMPARE(zip.read("stored.txt"), QByteArray("stored data"));
+        QCOMPARE(zip.read("deflated.txt"), big);
+        QCOMPARE(zip.size("deflated.txt"), qint64(big.size()));
+
+        auto empty = zip.read("empty.txt");
+        QVERIFY(!empty.isNull());
+        QVERIFY(empty.isEmpty());
+
+        QVERIFY(zip.read("missing.txt").isNull());
+        QCOMPARE(zip.size("missing.txt"), qint64(-1));
+        zip.setCaseSensitivity(Qt::CaseSensitive);
+        QVERIFY(!zip.contains("Stored.txt"));
+        QVERIFY(!zip.containsDirectory("Data/Example"));
+        // what QuaZip does on Windows
+        zip.setCaseSensitivity(Qt::CaseInsensitive);
+        QVERIFY(zip.contains("Stored.txt"));
+        QCOMPARE(zip.read("STORED.TXT"), QByteArray("stored data"));
+        QVERIFY(zip.containsDirectory("Data/Example"));
+        QVERIFY(!zip.contains("Stored.txt.bak"));
+
+        QVERIFY(zip.containsDirectory("assets"));
+        QVERIFY(zip.containsDirectory("data/example"));
+        QVERIFY(!zip.containsDirectory("data/exam"));
+        QCOMPARE(zip.findFirst({ "nope", "data/example/thing.json", "stored.txt" }), QString("data/example/thing.json"));
+        QCOMPARE(zip.findFirst({ "nope" }), QString());
+
+        // reading into the same buffer again
+        QByteArray buffer;
+        QVERIFY(zip.read("deflated.txt", buffer));
+        QVERIFY(zip.read("stored.txt", buffer));
+        QCOMPARE(buffer, QByteArray("stored data"));
+    }
+
+    void test_Damaged()
+    {
+        auto garbage = m_dir.filePath("garbage.zip");
+        {
+            QFile file(garbage);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(4096, 'x'));
+        }
+        ZipReader notZip(garbage);
+        QVERIFY(!notZip.open());
+        QVERIFY(!notZip.errorString().isEmpty());
+
+        ZipReader missing(m_dir.filePath("missing.zip"));
+        QVERIFY(!missing.open());
+
+        // cut off in the middle of the central directory
+        auto truncated = m_dir.filePath("truncated.zip");
+        QVERIFY(QFile::copy(jar(), truncated));
+        {
+            QFile file(truncated);
+            QVERIFY(file.resize(file.size() - 1000));
+        }
+        ZipReader cut(truncated);
+        QVERIFY(!cut.open());
+
+        // changed after it got opened, reading has to fail instead of crashing
+        auto shrunk = m_dir.filePath("shrunk.zip");
+        QVERIFY(QFile::copy(jar(), shrunk));
+        ZipReader reader(shrunk);
+        QVERIFY(reader.open());
+        {
+            QFile file(shrunk);
+            QVERIFY(file.resize(1000));
+        }
+        QVERIFY(reader.read("fabric.mod.json").isNull());
+        QVERIFY(reader.read("assets/example/icon.png").isNull());
+    }
+
+    void test_SizeFromHeader()
+    {
+        auto path = m_dir.filePath("lying.zip");
+        QByteArray data(1024 * 1024, 'a');
+        QVERIFY(writeZip(path, { { "small.json", "{}" }, { "big.txt", data } }));
+
+        ZipReader honest(path);
+        QVERIFY(honest.open());
+        QCOMPARE(honest.read("big.txt"), data);
+        QVERIFY(honest.read("big.txt", data.size() - 1).isNull());
+        QCOMPARE(honest.read("small.json", 1024), QByteArray("{}"));
+
+        // claims to be almost 2 GiB in the central directory, which only gets allocated as it's inflated
+        {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            auto contents = file.readAll();
+            const QByteArray signature("PK\x01\x02", 4);
+            auto header = contents.indexOf(signature);
+            while (header >= 0 && contents.mid(header + 46, 7) != "big.txt")
+                header = contents.indexOf(signature, header + 1);
+            QVERIFY(header >= 0);
+            QVERIFY(file.seek(header + 24));
+            uchar size[4];
+            qToLittleEndian<quint32>(0x7fff0000, size);
+            QCOMPARE(file.write(reinterpret_cast<const char*>(size), 4), qint64(4));
+        }
+        ZipReader lying(path);
+        QVERIFY(lying.open());
+        QCOMPARE(lying.size("big.txt"), qint64(0x7fff0000));
+        QVERIFY(lying.read("big.txt").isNull());
+        QVERIFY(lying.read("big.txt", 8 * 1024 * 1024).isNull());
+    }
+
+    void test_FindFolderOfFile()
+    {
+        auto path = m_dir.filePath("worlds.zip");
+        QVERIFY(writeZip(path, { { "saves/zz/level.dat", "" },
+                                 { "saves/aa/region/level.dat", "" },
+                                 { "saves/aa/level.dat_old", "" },
+                                 { "saves/mm/level.dat", "" } }));
+
+        ZipReader reader(path);
+        QVERIFY(reader.open());
+        QCOMPARE(MMCZip::findFolderOfFileInZip(reader, "level.dat"), QString("saves/aa/region/"));
+        QCOMPARE(MMCZip::findFolderOfFileInZip(reader, "level.dat", { "aa/" }), QString("saves/mm/"));
+        QCOMPARE(MMCZip::findFolderOfFileInZip(reader, "level.dat", {}, "saves/zz/"), QString("saves/zz/"));
+        QCOMPARE(MMCZip::findFolderOfFileInZip(reader, "missing.dat"), QString());
+
+        QuaZip zip(path);
+        QVERIFY(zip.open(QuaZip::mdUnzip));
+        QCOMPARE(MMCZip::findFolderOfFileInZip(&zip, "level.dat"), QString("saves/aa/region/"));
+    }
+
+    void test_ProbeBenchmark_data()
+    {
+        QTest::addColumn<bool>("quazip");
+        QTest::newRow("ZipReader") << false;
+        QTest::newRow("QuaZip") << true;
+    }
+
+    // opening a mod and probing for its metadata, like LocalModParseTask does
+    void test_ProbeBenchmark()
+    {
+        QFETCH(bool, quazip);
+        auto path = jar();
+        QVERIFY(!path.isEmpty());
+
+        QByteArray metadata;
+        QBENCHMARK
+        {
+            if (quazip) {
+                QuaZip zip(path);
+                QVERIFY(zip.open(QuaZip::mdUnzip));
+                for (auto const& name : s_mod_metadata) {
+                    if (zip.setCurrentFile(name)) {
+                        QuaZipFile file(&zip);
+                        QVERIFY(file.open(QIODevice::ReadOnly));
+                        metadata = file.readAll();
+                        break;
+                    }
+                }
+            } else {
+                ZipReader zip(path);
+                QVERIFY(zip.open());
+                auto name = zip.findFirst(s_mod_metadata);
+                QVERIFY(zip.read(name, metadata));
+            }
+        }
+        QVERIFY(metadata.contains("\"id\": \"example\""));
+    }
+};
+
+QTEST_GUILESS_MAIN(ZipReaderTest)
+
+#include "ZipReader_test.moc"